@@ -440,24 +440,17 @@ Status CarnotImpl::ExecutePlan(const planpb::Plan& logical_plan, const sole::uui
     }
   }
 
-  // Compute bytes processed and records processed across all agents for all queries,
-  // regardless of flags.
-  for (const auto& agent_stats : input_agent_stats) {
-    bytes_processed += agent_stats.bytes_processed();
-    rows_processed += agent_stats.records_processed();
-  }
-
+  // This agent reports only the data that it processed itself. The stats of the upstream agents
+  // are forwarded as their own entries, and the totals are summed over all entries once, so that
+  // agents reached through several paths (e.g. a PEM feeding multiple merge Kelvins) are counted
+  // once: the GRPCRouter keeps a single entry per agent.
   agent_operator_exec_stats.set_execution_time_ns(timer.ElapsedTime_us() * 1000);
   agent_operator_exec_stats.set_bytes_processed(bytes_processed);
   agent_operator_exec_stats.set_records_processed(rows_processed);
 
-  std::vector<queryresultspb::AgentExecutionStats> all_agent_stats;
-  if (analyze) {
-    all_agent_stats = input_agent_stats;
-  }
-
   // Even if analyze is set to false, send the most basic exec stats (rows, etc) per agent.
   // analyze=true will send per operator stats.
+  std::vector<queryresultspb::AgentExecutionStats> all_agent_stats = input_agent_stats;
   all_agent_stats.push_back(agent_operator_exec_stats);
 
   return SendFinalExecutionStatsToOutgoingConns(query_id, outgoing_conns,
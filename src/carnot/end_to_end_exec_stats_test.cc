@@ -0,0 +1,239 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <grpcpp/grpcpp.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/testing/testing.h"
+#include "src/common/uuid/uuid_utils.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+
+using exec::RowBatchBuilder;
+using table_store::schema::RowDescriptor;
+
+constexpr char kOnePEMOneKelvinState[] = R"proto(
+carnot_info {
+  agent_id {
+    high_bits: 0x0000000100000000
+    low_bits: 0x0000000000000001
+  }
+  query_broker_address: "pem"
+  has_grpc_server: false
+  has_data_store: true
+  processes_data: true
+  accepts_remote_sources: false
+  asid: 123
+}
+carnot_info {
+  agent_id {
+    high_bits: 0x0000000100000000
+    low_bits: 0x0000000000000002
+  }
+  query_broker_address: "kelvin"
+  grpc_address: "kelvin:1111"
+  has_grpc_server: true
+  has_data_store: false
+  processes_data: true
+  accepts_remote_sources: true
+  asid: 456
+  ssl_targetname: "kelvin.pl.svc"
+}
+)proto";
+
+constexpr char kEventsSchema[] = R"proto(
+relation_map {
+  key: "events"
+  value {
+    columns {
+      column_name: "key"
+      column_type: INT64
+      column_semantic_type: ST_NONE
+    }
+    columns {
+      column_name: "value"
+      column_type: INT64
+      column_semantic_type: ST_NONE
+    }
+  }
+}
+)proto";
+
+constexpr char kHeadQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='events')
+df = df.head(10)
+px.display(df, 'out')
+)pxl";
+
+queryresultspb::AgentExecutionStats AgentStats(const sole::uuid& agent_id,
+                                               int64_t records_processed) {
+  queryresultspb::AgentExecutionStats stats;
+  ToProto(agent_id, stats.mutable_agent_id());
+  stats.set_records_processed(records_processed);
+  stats.set_bytes_processed(records_processed * 2 * sizeof(int64_t));
+  return stats;
+}
+
+// Runs the plan of the Kelvin that receives the results of the merge Kelvins, with the test
+// standing in for the merge Kelvins.
+class ExecStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Test::SetUp();
+    result_server_ = std::make_unique<exec::LocalGRPCResultSinkServer>();
+
+    auto server_config = std::make_unique<Carnot::ServerConfig>();
+    server_config->grpc_server_creds = grpc::InsecureServerCredentials();
+    server_config->grpc_server_port = 0;
+    exec::GRPCRouter* router = &server_config->grpc_router;
+
+    auto func_registry = std::make_unique<udf::Registry>("default_registry");
+    funcs::RegisterFuncsOrDie(func_registry.get());
+    auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+        [this](const std::string& address, const std::string&) {
+          return result_server_->StubGenerator(address);
+        },
+        [](grpc::ClientContext*) {},
+    });
+    kelvin_carnot_ = Carnot::Create(sole::uuid4(), std::move(func_registry),
+                                    std::make_shared<table_store::TableStore>(),
+                                    std::move(clients_config), std::move(server_config))
+                         .ConsumeValueOrDie();
+
+    grpc::ServerBuilder router_builder;
+    router_builder.RegisterService(router);
+    router_server_ = router_builder.BuildAndStart();
+    ASSERT_NE(router_server_, nullptr);
+    grpc::ChannelArguments args;
+    router_stub_ = carnotpb::ResultSinkService::NewStub(router_server_->InProcessChannel(args));
+  }
+
+  void TearDown() override {
+    if (router_server_ != nullptr) {
+      router_server_->Shutdown();
+    }
+  }
+
+  StatusOr<planpb::Plan> PlanKelvinQuery(const std::string& query) {
+    PX_ASSIGN_OR_RETURN(auto registry_info, udfexporter::ExportUDFInfo());
+    PX_ASSIGN_OR_RETURN(auto planner, planner::LogicalPlanner::Create(registry_info->info_pb()));
+    planner::plannerpb::QueryRequest query_request;
+    query_request.set_query_str(query);
+    *query_request.mutable_logical_planner_state() =
+        planner::testutils::LoadLogicalPlannerStatePB(kOnePEMOneKelvinState, kEventsSchema);
+    PX_ASSIGN_OR_RETURN(auto distributed_plan, planner->Plan(query_request));
+    PX_ASSIGN_OR_RETURN(auto plan_pb, distributed_plan->ToProto());
+    return plan_pb.qb_address_to_plan().at("kelvin");
+  }
+
+  // Sends one stream to the Kelvin, as an upstream agent does: an initiate message followed by
+  // the given requests.
+  void SendStream(const sole::uuid& query_id,
+                  std::vector<carnotpb::TransferResultChunkRequest> requests) {
+    carnotpb::TransferResultChunkRequest initiate_req;
+    ToProto(query_id, initiate_req.mutable_query_id());
+    *initiate_req.mutable_initiate_conn() =
+        carnotpb::TransferResultChunkRequest::InitiateConnection();
+
+    grpc::ClientContext context;
+    carnotpb::TransferResultChunkResponse response;
+    auto writer = router_stub_->TransferResultChunk(&context, &response);
+    ASSERT_TRUE(writer->Write(initiate_req));
+    for (auto& req : requests) {
+      ToProto(query_id, req.mutable_query_id());
+      ASSERT_TRUE(writer->Write(req));
+    }
+    writer->WritesDone();
+    ASSERT_TRUE(writer->Finish().ok());
+  }
+
+  std::unique_ptr<exec::LocalGRPCResultSinkServer> result_server_;
+  std::unique_ptr<Carnot> kelvin_carnot_;
+  std::unique_ptr<grpc::Server> router_server_;
+  std::unique_ptr<carnotpb::ResultSinkService::Stub> router_stub_;
+};
+
+int64_t GRPCSourceID(const planpb::Plan& plan) {
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().has_grpc_source_op()) {
+        return node.id();
+      }
+    }
+  }
+  return -1;
+}
+
+// With merge Kelvins, every merge Kelvin forwards the stats of the same PEM. The totals must
+// count the PEM, each merge Kelvin and the Kelvin itself exactly once.
+TEST_F(ExecStatsTest, totals_count_each_agent_once) {
+  ASSERT_OK_AND_ASSIGN(planpb::Plan kelvin_plan, PlanKelvinQuery(kHeadQuery));
+  const int64_t grpc_source_id = GRPCSourceID(kelvin_plan);
+  ASSERT_NE(grpc_source_id, -1);
+
+  auto query_id = sole::uuid4();
+  Status kelvin_status;
+  std::thread kelvin_thread(
+      [&] { kelvin_status = kelvin_carnot_->ExecutePlan(kelvin_plan, query_id); });
+
+  const sole::uuid pem_id = sole::uuid4();
+  const std::vector<sole::uuid> merge_kelvin_ids = {sole::uuid4(), sole::uuid4()};
+  for (size_t i = 0; i < merge_kelvin_ids.size(); ++i) {
+    carnotpb::TransferResultChunkRequest stats_req;
+    auto* info = stats_req.mutable_execution_and_timing_info();
+    *info->add_agent_execution_stats() = AgentStats(pem_id, 3);
+    *info->add_agent_execution_stats() = AgentStats(merge_kelvin_ids[i], 5 * (i + 1));
+    SendStream(query_id, {stats_req});
+  }
+
+  // The results that complete the query.
+  RowDescriptor rd({types::DataType::INT64, types::DataType::INT64});
+  auto rb = RowBatchBuilder(rd, 2, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({1, 2})
+                .AddColumn<types::Int64Value>({3, 4})
+                .get();
+  carnotpb::TransferResultChunkRequest rb_req;
+  EXPECT_OK(rb.ToProto(rb_req.mutable_query_result()->mutable_row_batch()));
+  rb_req.mutable_query_result()->set_grpc_source_id(grpc_source_id);
+  SendStream(query_id, {rb_req});
+
+  kelvin_thread.join();
+  ASSERT_OK(kelvin_status);
+
+  ASSERT_OK_AND_ASSIGN(auto exec_stats, result_server_->exec_stats());
+  // The Kelvin's own source read the 2 rows above.
+  EXPECT_EQ(exec_stats.execution_stats().records_processed(), 3 + 5 + 10 + 2);
+  EXPECT_EQ(exec_stats.agent_execution_stats_size(), 4);
+}
+
+}  // namespace carnot
+}  // namespace px
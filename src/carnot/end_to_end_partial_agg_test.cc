@@ -0,0 +1,344 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <grpcpp/grpcpp.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "src/carnot/carnot.h"
+#include "src/carnot/exec/local_grpc_result_server.h"
+#include "src/carnot/exec/test_utils.h"
+#include "src/carnot/funcs/funcs.h"
+#include "src/carnot/planner/logical_planner.h"
+#include "src/carnot/planner/test_utils.h"
+#include "src/carnot/udf_exporter/udf_exporter.h"
+#include "src/common/testing/testing.h"
+#include "src/table_store/table_store.h"
+
+DECLARE_int64(carnot_partial_agg_max_groups);
+
+namespace px {
+namespace carnot {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+constexpr char kKelvinGRPCAddress[] = "kelvin:1111";
+
+constexpr char kOnePEMOneKelvinState[] = R"proto(
+carnot_info {
+  agent_id {
+    high_bits: 0x0000000100000000
+    low_bits: 0x0000000000000001
+  }
+  query_broker_address: "pem"
+  has_grpc_server: false
+  has_data_store: true
+  processes_data: true
+  accepts_remote_sources: false
+  asid: 123
+}
+carnot_info {
+  agent_id {
+    high_bits: 0x0000000100000000
+    low_bits: 0x0000000000000002
+  }
+  query_broker_address: "kelvin"
+  grpc_address: "kelvin:1111"
+  has_grpc_server: true
+  has_data_store: false
+  processes_data: true
+  accepts_remote_sources: true
+  asid: 456
+  ssl_targetname: "kelvin.pl.svc"
+}
+)proto";
+
+constexpr char kEventsSchema[] = R"proto(
+relation_map {
+  key: "events"
+  value {
+    columns {
+      column_name: "key"
+      column_type: INT64
+      column_semantic_type: ST_NONE
+    }
+    columns {
+      column_name: "value"
+      column_type: INT64
+      column_semantic_type: ST_NONE
+    }
+  }
+}
+)proto";
+
+constexpr char kGroupByQuery[] = R"pxl(
+import px
+df = px.DataFrame(table='events')
+df = df.groupby('key').agg(total=('value', px.sum), num=('value', px.count))
+px.display(df, 'out')
+)pxl";
+
+// Forwards the result streams of the PEM to the GRPC router of the Kelvin. Keeps the exec stats of
+// the PEM and the partial aggregates it sent, so that the test can inspect them.
+class ForwardingResultSinkService final : public carnotpb::ResultSinkService::Service {
+ public:
+  explicit ForwardingResultSinkService(
+      std::unique_ptr<carnotpb::ResultSinkService::StubInterface> stub)
+      : stub_(std::move(stub)) {}
+
+  ::grpc::Status TransferResultChunk(
+      ::grpc::ServerContext*,
+      ::grpc::ServerReader<::px::carnotpb::TransferResultChunkRequest>* reader,
+      ::px::carnotpb::TransferResultChunkResponse* response) override {
+    grpc::ClientContext ctx;
+    carnotpb::TransferResultChunkResponse forward_response;
+    auto writer = stub_->TransferResultChunk(&ctx, &forward_response);
+    carnotpb::TransferResultChunkRequest req;
+    while (reader->Read(&req)) {
+      {
+        const std::lock_guard<std::mutex> lock(mu_);
+        if (req.has_execution_and_timing_info()) {
+          exec_stats_.push_back(req.execution_and_timing_info());
+          // The Kelvin may already have finished the query when the stats arrive.
+          continue;
+        }
+        if (req.has_query_result() && req.query_result().has_row_batch()) {
+          partial_row_batches_.push_back(req.query_result().row_batch());
+        }
+      }
+      if (!writer->Write(req)) {
+        break;
+      }
+    }
+    writer->WritesDone();
+    auto status = writer->Finish();
+    response->set_success(status.ok());
+    return status;
+  }
+
+  std::vector<carnotpb::TransferResultChunkRequest::QueryExecutionAndTimingInfo> exec_stats() {
+    const std::lock_guard<std::mutex> lock(mu_);
+    return exec_stats_;
+  }
+
+  std::vector<table_store::schemapb::RowBatchData> partial_row_batches() {
+    const std::lock_guard<std::mutex> lock(mu_);
+    return partial_row_batches_;
+  }
+
+ private:
+  std::unique_ptr<carnotpb::ResultSinkService::StubInterface> stub_;
+  std::mutex mu_;
+  std::vector<carnotpb::TransferResultChunkRequest::QueryExecutionAndTimingInfo> exec_stats_;
+  std::vector<table_store::schemapb::RowBatchData> partial_row_batches_;
+};
+
+class PartialAggTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    Test::SetUp();
+    result_server_ = std::make_unique<exec::LocalGRPCResultSinkServer>();
+
+    auto kelvin_server_config = std::make_unique<Carnot::ServerConfig>();
+    kelvin_server_config->grpc_server_creds = grpc::InsecureServerCredentials();
+    kelvin_server_config->grpc_server_port = 0;
+    exec::GRPCRouter* kelvin_router = &kelvin_server_config->grpc_router;
+    kelvin_carnot_ = CreateCarnot(std::make_shared<table_store::TableStore>(),
+                                  std::move(kelvin_server_config));
+
+    grpc::ServerBuilder router_builder;
+    router_builder.RegisterService(kelvin_router);
+    router_server_ = router_builder.BuildAndStart();
+    ASSERT_NE(router_server_, nullptr);
+
+    grpc::ChannelArguments args;
+    forwarder_ = std::make_unique<ForwardingResultSinkService>(
+        carnotpb::ResultSinkService::NewStub(router_server_->InProcessChannel(args)));
+    grpc::ServerBuilder forwarder_builder;
+    forwarder_builder.RegisterService(forwarder_.get());
+    forwarder_server_ = forwarder_builder.BuildAndStart();
+    ASSERT_NE(forwarder_server_, nullptr);
+
+    auto pem_table_store = std::make_shared<table_store::TableStore>();
+    pem_table_store->AddTable("events", EventsTable());
+    auto pem_server_config = std::make_unique<Carnot::ServerConfig>();
+    pem_server_config->grpc_server_creds = grpc::InsecureServerCredentials();
+    pem_server_config->grpc_server_port = 0;
+    pem_carnot_ = CreateCarnot(pem_table_store, std::move(pem_server_config));
+  }
+
+  void TearDown() override {
+    if (forwarder_server_ != nullptr) {
+      forwarder_server_->Shutdown();
+    }
+    if (router_server_ != nullptr) {
+      router_server_->Shutdown();
+    }
+  }
+
+  std::unique_ptr<Carnot> CreateCarnot(std::shared_ptr<table_store::TableStore> table_store,
+                                       std::unique_ptr<Carnot::ServerConfig> server_config) {
+    auto func_registry = std::make_unique<udf::Registry>("default_registry");
+    funcs::RegisterFuncsOrDie(func_registry.get());
+    auto clients_config = std::make_unique<Carnot::ClientsConfig>(Carnot::ClientsConfig{
+        [this](const std::string& address, const std::string&)
+            -> std::unique_ptr<carnotpb::ResultSinkService::StubInterface> {
+          if (address == kKelvinGRPCAddress) {
+            grpc::ChannelArguments args;
+            return carnotpb::ResultSinkService::NewStub(forwarder_server_->InProcessChannel(args));
+          }
+          return result_server_->StubGenerator(address);
+        },
+        [](grpc::ClientContext*) {},
+    });
+    return Carnot::Create(sole::uuid4(), std::move(func_registry), table_store,
+                          std::move(clients_config), std::move(server_config))
+        .ConsumeValueOrDie();
+  }
+
+  // Every batch has more distinct keys than the partial aggregate is allowed to keep.
+  std::shared_ptr<table_store::Table> EventsTable() {
+    table_store::schema::Relation rel({types::DataType::INT64, types::DataType::INT64},
+                                      {"key", "value"});
+    auto table = table_store::Table::Create("events", rel);
+    std::vector<std::vector<types::Int64Value>> keys = {{0, 1, 2, 3}, {4, 5, 0, 1}, {2, 3, 4, 5}};
+    std::vector<std::vector<types::Int64Value>> values = {
+        {1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}};
+    for (size_t i = 0; i < keys.size(); ++i) {
+      RowBatch rb(RowDescriptor(rel.col_types()), keys[i].size());
+      PX_CHECK_OK(rb.AddColumn(types::ToArrow(keys[i], arrow::default_memory_pool())));
+      PX_CHECK_OK(rb.AddColumn(types::ToArrow(values[i], arrow::default_memory_pool())));
+      PX_CHECK_OK(table->WriteRowBatch(rb));
+      for (size_t j = 0; j < keys[i].size(); ++j) {
+        expected_totals_[keys[i][j].val] += values[i][j].val;
+        ++expected_counts_[keys[i][j].val];
+      }
+    }
+    return table;
+  }
+
+  StatusOr<planner::distributedpb::DistributedPlan> PlanQuery(const std::string& query) {
+    PX_ASSIGN_OR_RETURN(auto registry_info, udfexporter::ExportUDFInfo());
+    PX_ASSIGN_OR_RETURN(auto planner, planner::LogicalPlanner::Create(registry_info->info_pb()));
+    planner::plannerpb::QueryRequest query_request;
+    query_request.set_query_str(query);
+    *query_request.mutable_logical_planner_state() =
+        planner::testutils::LoadLogicalPlannerStatePB(kOnePEMOneKelvinState, kEventsSchema);
+    PX_ASSIGN_OR_RETURN(auto distributed_plan, planner->Plan(query_request));
+    return distributed_plan->ToProto();
+  }
+
+  std::unique_ptr<exec::LocalGRPCResultSinkServer> result_server_;
+  std::unique_ptr<Carnot> kelvin_carnot_;
+  std::unique_ptr<Carnot> pem_carnot_;
+  std::unique_ptr<grpc::Server> router_server_;
+  std::unique_ptr<ForwardingResultSinkService> forwarder_;
+  std::unique_ptr<grpc::Server> forwarder_server_;
+  std::map<int64_t, int64_t> expected_totals_;
+  std::map<int64_t, int64_t> expected_counts_;
+};
+
+std::vector<planpb::AggregateOperator> AggOps(const planpb::Plan& plan) {
+  std::vector<planpb::AggregateOperator> agg_ops;
+  for (const auto& fragment : plan.nodes()) {
+    for (const auto& node : fragment.nodes()) {
+      if (node.op().has_agg_op()) {
+        agg_ops.push_back(node.op().agg_op());
+      }
+    }
+  }
+  return agg_ops;
+}
+
+TEST_F(PartialAggTest, pem_partial_agg_merged_by_kelvin) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_partial_agg_max_groups, 2);
+
+  ASSERT_OK_AND_ASSIGN(planner::distributedpb::DistributedPlan plan, PlanQuery(kGroupByQuery));
+  ASSERT_EQ(plan.qb_address_to_plan().count("pem"), 1);
+  ASSERT_EQ(plan.qb_address_to_plan().count("kelvin"), 1);
+  const planpb::Plan& pem_plan = plan.qb_address_to_plan().at("pem");
+  const planpb::Plan& kelvin_plan = plan.qb_address_to_plan().at("kelvin");
+
+  // The planner splits the aggregate into a partial aggregate on the PEM and a finalize aggregate
+  // on the Kelvin.
+  std::vector<planpb::AggregateOperator> pem_aggs = AggOps(pem_plan);
+  ASSERT_EQ(pem_aggs.size(), 1);
+  EXPECT_TRUE(pem_aggs[0].partial_agg());
+  EXPECT_FALSE(pem_aggs[0].finalize_results());
+  std::vector<planpb::AggregateOperator> kelvin_aggs = AggOps(kelvin_plan);
+  ASSERT_EQ(kelvin_aggs.size(), 1);
+  EXPECT_FALSE(kelvin_aggs[0].partial_agg());
+  EXPECT_TRUE(kelvin_aggs[0].finalize_results());
+
+  auto query_id = sole::uuid4();
+  Status kelvin_status;
+  std::thread kelvin_thread(
+      [&] { kelvin_status = kelvin_carnot_->ExecutePlan(kelvin_plan, query_id); });
+  EXPECT_OK(pem_carnot_->ExecutePlan(pem_plan, query_id, /* analyze */ true));
+  kelvin_thread.join();
+  ASSERT_OK(kelvin_status);
+
+  // The partial aggregate flushed its groups before eos, so the Kelvin received some of the groups
+  // more than once.
+  int64_t num_partial_rows = 0;
+  for (const auto& rb : forwarder_->partial_row_batches()) {
+    num_partial_rows += rb.num_rows();
+  }
+  EXPECT_GT(num_partial_rows, static_cast<int64_t>(expected_totals_.size()));
+
+  bool found_flushes = false;
+  for (const auto& exec_stats : forwarder_->exec_stats()) {
+    for (const auto& agent_stats : exec_stats.agent_execution_stats()) {
+      for (const auto& op_stats : agent_stats.operator_execution_stats()) {
+        auto it = op_stats.extra_info().find("partial_agg_flushes");
+        if (it != op_stats.extra_info().end()) {
+          found_flushes = true;
+          EXPECT_NE(it->second, "0");
+        }
+      }
+    }
+  }
+  EXPECT_TRUE(found_flushes);
+
+  // The Kelvin merges the partial results into a single row per group.
+  std::map<int64_t, int64_t> totals;
+  std::map<int64_t, int64_t> counts;
+  for (const RowBatch& rb : result_server_->query_results("out")) {
+    ASSERT_EQ(rb.num_columns(), 3);
+    auto keys = std::static_pointer_cast<arrow::Int64Array>(rb.ColumnAt(0));
+    auto sums = std::static_pointer_cast<arrow::Int64Array>(rb.ColumnAt(1));
+    auto nums = std::static_pointer_cast<arrow::Int64Array>(rb.ColumnAt(2));
+    for (int64_t i = 0; i < rb.num_rows(); ++i) {
+      EXPECT_EQ(totals.count(keys->Value(i)), 0) << "duplicate group " << keys->Value(i);
+      totals[keys->Value(i)] = sums->Value(i);
+      counts[keys->Value(i)] = nums->Value(i);
+    }
+  }
+  EXPECT_EQ(totals, expected_totals_);
+  EXPECT_EQ(counts, expected_counts_);
+}
+
+}  // namespace carnot
+}  // namespace px
@@ -20,10 +20,14 @@
 
 #include <arrow/array.h>
 #include <arrow/array/builder_base.h>
+#include <arrow/builder.h>
 #include <arrow/status.h>
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
+#include <string>
 
+#include <absl/strings/str_cat.h>
 #include <magic_enum.hpp>
 
 #include "src/carnot/exec/expression_evaluator.h"
@@ -35,6 +39,11 @@
 #include "src/shared/types/type_utils.h"
 #include "src/shared/types/types.h"
 
+DEFINE_int64(carnot_partial_agg_max_groups,
+             gflags::Int64FromEnv("PL_CARNOT_PARTIAL_AGG_MAX_GROUPS", 64 * 1024),
+             "The maximum number of groups a partial aggregate keeps before it sends its partial "
+             "results downstream to be merged.");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -78,6 +87,38 @@ void ExtractToColumnWrapper(const std::vector<GroupArgs>& group_args,
   }
 }
 
+// Partial aggregates store the states of all of their UDAs in a single string column. Each state
+// is prefixed by its length.
+void AppendSerializedState(std::string_view state, std::string* out) {
+  uint64_t size = state.size();
+  out->append(reinterpret_cast<const char*>(&size), sizeof(size));
+  out->append(state);
+}
+
+StatusOr<std::vector<std::string_view>> SplitSerializedStates(std::string_view data,
+                                                              size_t num_states) {
+  std::vector<std::string_view> states;
+  states.reserve(num_states);
+  while (!data.empty()) {
+    uint64_t size;
+    if (data.size() < sizeof(size)) {
+      return error::Internal("Partial aggregate state is truncated");
+    }
+    std::memcpy(&size, data.data(), sizeof(size));
+    data.remove_prefix(sizeof(size));
+    if (data.size() < size) {
+      return error::Internal("Partial aggregate state is truncated");
+    }
+    states.push_back(data.substr(0, size));
+    data.remove_prefix(size);
+  }
+  if (states.size() != num_states) {
+    return error::Internal("Expected $0 partial aggregate states, got $1", num_states,
+                           states.size());
+  }
+  return states;
+}
+
 }  // namespace
 
 std::string AggNode::DebugStringImpl() {
@@ -105,11 +146,21 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     }
   }
 
-  size_t output_size = plan_node_->values().size() + plan_node_->groups().size();
+  // Partial aggregates output the serialized values as a single column.
+  size_t values_output_size = IsPartialAgg() ? 1 : plan_node_->values().size();
+  size_t output_size = values_output_size + plan_node_->groups().size();
   if (output_size != output_descriptor_->size()) {
     return error::InvalidArgument("Output size mismatch in aggregate");
   }
 
+  if (IsFinalizeAgg()) {
+    // The serialized values are the last input column, after the groups.
+    serialized_col_idx_ = input_descriptor_->size() - 1;
+    if (input_descriptor_->type(serialized_col_idx_) != types::STRING) {
+      return error::InvalidArgument("Finalize aggregate expects serialized values as input");
+    }
+  }
+
   if (HasNoGroups()) {
     return Status::OK();
   }
@@ -127,10 +178,7 @@ Status AggNode::InitImpl(const plan::Operator& plan_node) {
     group_data_types_.emplace_back(input_descriptor_->type(group.idx));
   }
 
-  auto values_size = plan_node_->values().size();
-  for (size_t i = 0; i < values_size; ++i) {
-    auto values_idx = i + groups_size;
-    DCHECK(values_idx < output_descriptor_->size());
+  for (size_t values_idx = groups_size; values_idx < output_descriptor_->size(); ++values_idx) {
     value_data_types_.emplace_back(output_descriptor_->type(values_idx));
   }
 
@@ -146,6 +194,15 @@ Status AggNode::OpenImpl(ExecState* exec_state) {
   if (HasNoGroups()) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
+  if (IsFinalizeAgg()) {
+    for (const auto& value : plan_node_->values()) {
+      auto def = exec_state->GetUDADefinition(value->uda_id());
+      if (!def->supports_partial()) {
+        return error::InvalidArgument("UDA '$0' does not support partial aggregation",
+                                      value->name());
+      }
+    }
+  }
   return Status::OK();
 }
 
@@ -157,6 +214,10 @@ Status AggNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_
 }
 
 Status AggNode::CloseImpl(ExecState*) {
+  if (IsPartialAgg()) {
+    stats()->AddExtraInfo("partial_agg_flushes", absl::StrCat(num_partial_flushes_));
+    stats()->AddExtraInfo("partial_agg_flush_every_batch", flush_every_batch_ ? "true" : "false");
+  }
   udas_no_groups_.clear();
   group_args_chunk_.clear();
   group_args_pool_.Clear();
@@ -175,27 +236,104 @@ Status AggNode::ClearAggState(ExecState* exec_state) {
     PX_RETURN_IF_ERROR(CreateUDAInfoValues(&udas_no_groups_, exec_state));
   }
   agg_hash_map_.clear();
+  // The pools own the row tuples and values of the groups that were just cleared, as well as the
+  // row tuples in group_args_chunk_, which are recreated for the next row batch.
+  group_args_chunk_.clear();
+  group_args_pool_.Clear();
+  udas_pool_.Clear();
+  return Status::OK();
+}
+
+bool AggNode::ShouldFlushPartialAggregates() const {
+  if (!IsPartialAgg() || agg_hash_map_.empty()) {
+    return false;
+  }
+  return flush_every_batch_ ||
+         static_cast<int64_t>(agg_hash_map_.size()) >= FLAGS_carnot_partial_agg_max_groups;
+}
+
+Status AggNode::FlushPartialAggregates(ExecState* exec_state) {
+  int64_t num_groups = agg_hash_map_.size();
+  if (!flush_every_batch_ && rows_since_flush_ < kMinPartialAggReduction * num_groups) {
+    flush_every_batch_ = true;
+  }
+  ++num_partial_flushes_;
+  return EmitAggHashMap(exec_state, /*eow*/ false, /*eos*/ false);
+}
+
+Status AggNode::EmitAggHashMap(ExecState* exec_state, bool eow, bool eos) {
+  RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
+  PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
+  output_rb.set_eow(eow);
+  output_rb.set_eos(eos);
+  PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
+  rows_since_flush_ = 0;
+  return ClearAggState(exec_state);
+}
+
+Status AggNode::AppendSerializedUDAs(const std::vector<UDAInfo>& udas,
+                                     arrow::ArrayBuilder* builder) {
+  std::string serialized;
+  for (const auto& uda_info : udas) {
+    PX_ASSIGN_OR_RETURN(auto state,
+                        uda_info.def->Serialize(uda_info.uda.get(), function_ctx_.get()));
+    AppendSerializedState(state, &serialized);
+  }
+  PX_RETURN_IF_ERROR(static_cast<arrow::StringBuilder*>(builder)->Append(serialized));
+  return Status::OK();
+}
+
+Status AggNode::MergeSerializedUDAs(std::string_view data, std::vector<UDAInfo>* udas) {
+  PX_ASSIGN_OR_RETURN(auto states, SplitSerializedStates(data, udas->size()));
+  for (size_t i = 0; i < udas->size(); ++i) {
+    const auto& uda_info = (*udas)[i];
+    // Deserialize into a fresh UDA: UDAs may add to their state on Deserialize, so a UDA reused
+    // across rows would carry over the state of the previous rows (and groups).
+    std::unique_ptr<udf::UDA> serialized_uda = uda_info.def->Make();
+    PX_RETURN_IF_ERROR(uda_info.def->Deserialize(
+        serialized_uda.get(), function_ctx_.get(),
+        types::StringValue(states[i].data(), states[i].size())));
+    PX_RETURN_IF_ERROR(
+        uda_info.def->Merge(uda_info.uda.get(), serialized_uda.get(), function_ctx_.get()));
+  }
   return Status::OK();
 }
 
 Status AggNode::AggregateGroupByNone(ExecState* exec_state, const RowBatch& rb) {
   auto values = plan_node_->values();
-  for (size_t i = 0; i < values.size(); ++i) {
-    PX_RETURN_IF_ERROR(
-        EvaluateSingleExpressionNoGroups(exec_state, udas_no_groups_[i], values[i].get(), rb));
+  if (IsFinalizeAgg()) {
+    auto serialized_col = rb.ColumnAt(serialized_col_idx_).get();
+    for (int64_t row_idx = 0; row_idx < rb.num_rows(); ++row_idx) {
+      PX_RETURN_IF_ERROR(MergeSerializedUDAs(
+          types::GetValueFromArrowArray<types::STRING>(serialized_col, row_idx),
+          &udas_no_groups_));
+    }
+  } else {
+    for (size_t i = 0; i < values.size(); ++i) {
+      PX_RETURN_IF_ERROR(
+          EvaluateSingleExpressionNoGroups(exec_state, udas_no_groups_[i], values[i].get(), rb));
+    }
   }
 
   if (ReadyToEmitBatches(rb)) {
     RowBatch output_rb(*output_descriptor_, 1);
-    for (size_t i = 0; i < values.size(); ++i) {
-      const auto& uda_info = udas_no_groups_[i];
-      auto builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
-                                             exec_state->exec_mem_pool());
-      PX_RETURN_IF_ERROR(
-          uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+    if (IsPartialAgg()) {
+      auto builder = types::MakeArrowBuilder(types::STRING, exec_state->exec_mem_pool());
+      PX_RETURN_IF_ERROR(AppendSerializedUDAs(udas_no_groups_, builder.get()));
       SharedArray out_col;
       PX_RETURN_IF_ERROR(builder->Finish(&out_col));
       PX_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
+    } else {
+      for (size_t i = 0; i < values.size(); ++i) {
+        const auto& uda_info = udas_no_groups_[i];
+        auto builder = types::MakeArrowBuilder(uda_info.def->finalize_return_type(),
+                                               exec_state->exec_mem_pool());
+        PX_RETURN_IF_ERROR(
+            uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(), builder.get()));
+        SharedArray out_col;
+        PX_RETURN_IF_ERROR(builder->Finish(&out_col));
+        PX_RETURN_IF_ERROR(output_rb.AddColumn(out_col));
+      }
     }
     output_rb.set_eow(rb.eow());
     output_rb.set_eos(rb.eos());
@@ -325,6 +463,10 @@ Status AggNode::ConvertAggHashMapToRowBatch(ExecState* exec_state, RowBatch* out
     }
     // Actually Finalize the UDA based on the column wrapper chunks.
     PX_RETURN_IF_ERROR(EvaluateAggHashValue(exec_state, val));
+    if (IsPartialAgg()) {
+      PX_RETURN_IF_ERROR(AppendSerializedUDAs(val->udas, value_builders[0].get()));
+      continue;
+    }
     for (size_t i = 0; i < val->udas.size(); ++i) {
       const auto& uda_info = val->udas[i];
       PX_RETURN_IF_ERROR(uda_info.def->FinalizeArrow(uda_info.uda.get(), function_ctx_.get(),
@@ -362,13 +504,12 @@ Status AggNode::AggregateGroupByClause(ExecState* exec_state, const RowBatch& rb
     PX_RETURN_IF_ERROR(EvaluatePartialAggregates(exec_state, rb.num_rows()));
   }
   PX_RETURN_IF_ERROR(ResetGroupArgs());
+  rows_since_flush_ += rb.num_rows();
   if (ReadyToEmitBatches(rb)) {
-    RowBatch output_rb(*output_descriptor_, agg_hash_map_.size());
-    PX_RETURN_IF_ERROR(ConvertAggHashMapToRowBatch(exec_state, &output_rb));
-    output_rb.set_eow(rb.eow());
-    output_rb.set_eos(rb.eos());
-    PX_RETURN_IF_ERROR(SendRowBatchToChildren(exec_state, output_rb));
-    PX_RETURN_IF_ERROR(ClearAggState(exec_state));
+    return EmitAggHashMap(exec_state, rb.eow(), rb.eos());
+  }
+  if (ShouldFlushPartialAggregates()) {
+    return FlushPartialAggregates(exec_state);
   }
   return Status::OK();
 }
@@ -431,6 +572,15 @@ Status AggNode::EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UD
 }
 
 Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
+  if (IsFinalizeAgg()) {
+    // The only stored column holds the serialized values, see CreateColumnMapping.
+    auto* serialized_col = static_cast<types::StringValueColumnWrapper*>(val->agg_cols[0].get());
+    for (size_t i = 0; i < serialized_col->Size(); ++i) {
+      PX_RETURN_IF_ERROR(MergeSerializedUDAs((*serialized_col)[i], &val->udas));
+    }
+    serialized_col->Clear();
+    return Status::OK();
+  }
   size_t values_size = plan_node_->values().size();
   for (size_t i = 0; i < values_size; ++i) {
     const auto& uda_info = val->udas[i];
@@ -480,6 +630,14 @@ Status AggNode::EvaluateAggHashValue(ExecState* exec_state, AggHashValue* val) {
 }
 
 Status AggNode::CreateColumnMapping() {
+  if (IsFinalizeAgg()) {
+    // The value expressions refer to the input of the partial aggregates, the finalize aggregate
+    // only needs the serialized values.
+    plan_cols_to_stored_map_[serialized_col_idx_] = 0;
+    stored_cols_to_plan_idx_.emplace_back(serialized_col_idx_);
+    stored_cols_data_types_.emplace_back(types::STRING);
+    return Status::OK();
+  }
   for (const auto& expr : plan_node_->values()) {
     plan::ExpressionWalker<int> walker;
 
@@ -520,10 +678,14 @@ Status AggNode::CreateUDAInfoValues(std::vector<UDAInfo>* val, ExecState* exec_s
 
   for (const auto& value : plan_node_->values()) {
     std::vector<types::DataType> types;
-    types.reserve(value->Deps().size());
-    for (auto* dep : value->Deps()) {
-      PX_ASSIGN_OR_RETURN(auto type, GetTypeOfDep(*dep));
-      types.push_back(type);
+    // The deps of a finalize aggregate refer to the input of the partial aggregates, not to the
+    // input of this node.
+    if (!IsFinalizeAgg()) {
+      types.reserve(value->Deps().size());
+      for (auto* dep : value->Deps()) {
+        PX_ASSIGN_OR_RETURN(auto type, GetTypeOfDep(*dep));
+        types.push_back(type);
+      }
     }
     auto def = exec_state->GetUDADefinition(value->uda_id());
     auto uda = def->Make();
@@ -21,6 +21,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -44,6 +45,11 @@ namespace px {
 namespace carnot {
 namespace exec {
 
+// A partial aggregate that has to flush its groups early should reduce the number of rows by at
+// least this factor. Otherwise, it flushes its groups after every row batch for the rest of the
+// query, so that it doesn't hold on to groups that are unlikely to be merged.
+constexpr int64_t kMinPartialAggReduction = 2;
+
 struct UDAInfo {
   UDAInfo(std::unique_ptr<udf::UDA> uda_inst, udf::UDADefinition* def_ptr)
       : uda(std::move(uda_inst)), def(def_ptr) {}
@@ -85,12 +91,28 @@ class AggNode : public ProcessingNode {
  private:
   AggHashMap agg_hash_map_;
   bool HasNoGroups() const { return plan_node_->groups().empty(); }
+  // A partial aggregate outputs the serialized state of its UDAs instead of their results.
+  bool IsPartialAgg() const { return plan_node_->partial_agg() && !plan_node_->finalize_results(); }
+  // A finalize aggregate merges the serialized states output by partial aggregates.
+  bool IsFinalizeAgg() const {
+    return plan_node_->finalize_results() && !plan_node_->partial_agg();
+  }
   // ReadyToEmitBatches returns true when the input stream has reached a point where output batches
   // can be emitted. In the windowed aggregate case, this happens whenever end of window (eow) is
   // reached. In the blocking aggregate case, this happens at eos only.
   bool ReadyToEmitBatches(const table_store::schema::RowBatch& rb) const;
   // When we see a new window, we need to be able to clear the aggregate state.
   Status ClearAggState(ExecState* exec_state);
+  // Partial aggregates keep a bounded number of groups. Once they reach the limit, they send the
+  // partial results they have so far and start over, the finalize aggregate merges the duplicates.
+  bool ShouldFlushPartialAggregates() const;
+  Status FlushPartialAggregates(ExecState* exec_state);
+  Status EmitAggHashMap(ExecState* exec_state, bool eow, bool eos);
+
+  // Appends the serialized state of all of the UDAs as a single value to the string builder.
+  Status AppendSerializedUDAs(const std::vector<UDAInfo>& udas, arrow::ArrayBuilder* builder);
+  // Merges a value written by AppendSerializedUDAs into the UDAs.
+  Status MergeSerializedUDAs(std::string_view data, std::vector<UDAInfo>* udas);
 
   Status EvaluateSingleExpressionNoGroups(ExecState* exec_state, const UDAInfo& uda_info,
                                           plan::AggregateExpression* expr,
@@ -108,6 +130,19 @@ class AggNode : public ProcessingNode {
   std::vector<UDAInfo> udas_no_groups_;
   // END: Variables specific to GroupByNone Agg.
 
+  // Variables specific to finalize aggregates.
+  // The index of the input column with the serialized UDA states.
+  int64_t serialized_col_idx_ = -1;
+  // END: Variables specific to finalize aggregates.
+
+  // Variables specific to partial aggregates.
+  int64_t rows_since_flush_ = 0;
+  int64_t num_partial_flushes_ = 0;
+  // Set once the partial aggregate stops reducing the data well enough, see
+  // kMinPartialAggReduction.
+  bool flush_every_batch_ = false;
+  // END: Variables specific to partial aggregates.
+
   // Variables specific to GroupBy Agg.
 
   // As the row batches come in we insert the correct values into the hash map based
@@ -19,7 +19,15 @@
 #include "src/carnot/exec/agg_node.h"
 
 #include <algorithm>
-
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_join.h>
+#include <absl/strings/str_split.h>
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -30,6 +38,8 @@
 #include "src/common/testing/testing.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DECLARE_int64(carnot_partial_agg_max_groups);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -71,6 +81,62 @@ class MinSumWithInitUDA : public udf::UDA {
   types::Int64Value sum_ = 0;
 };
 
+// MinSumUDA with support for partial aggregates.
+class PartialMinSumUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value arg1, types::Int64Value arg2) {
+    sum_ = sum_.val + std::min(arg1.val, arg2.val);
+  }
+  void Merge(udf::FunctionContext*, const PartialMinSumUDA& other) {
+    sum_ = sum_.val + other.sum_.val;
+  }
+  types::Int64Value Finalize(udf::FunctionContext*) { return sum_; }
+  types::StringValue Serialize(udf::FunctionContext*) { return absl::StrCat(sum_.val); }
+  Status Deserialize(udf::FunctionContext*, const types::StringValue& data) {
+    if (!absl::SimpleAtoi(data, &sum_.val)) {
+      return error::InvalidArgument("Invalid partial minsum: $0", data);
+    }
+    return Status::OK();
+  }
+
+ protected:
+  types::Int64Value sum_ = 0;
+};
+
+// Collects the distinct frames it is given, like FoldStackTraceUDA. Deserialize() adds to the
+// state rather than replacing it, so each partial state must be merged from a fresh UDA.
+class PartialFramesUDA : public udf::UDA {
+ public:
+  void Update(udf::FunctionContext*, types::Int64Value, types::StringValue frame) {
+    frames_.insert(std::move(frame));
+  }
+  void Merge(udf::FunctionContext*, const PartialFramesUDA& other) {
+    frames_.insert(other.frames_.begin(), other.frames_.end());
+  }
+  types::StringValue Finalize(udf::FunctionContext*) { return absl::StrJoin(frames_, ";"); }
+  types::StringValue Serialize(udf::FunctionContext*) { return absl::StrJoin(frames_, ";"); }
+  Status Deserialize(udf::FunctionContext*, const types::StringValue& data) {
+    for (std::string_view frame : absl::StrSplit(data, ';', absl::SkipEmpty())) {
+      frames_.emplace(frame);
+    }
+    return Status::OK();
+  }
+
+ protected:
+  std::set<std::string> frames_;
+};
+
+// Partial aggregates output the serialized UDA states as one value, each prefixed by its length.
+std::string SerializedStates(const std::vector<std::string>& states) {
+  std::string serialized;
+  for (const auto& state : states) {
+    uint64_t size = state.size();
+    serialized.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    serialized.append(state);
+  }
+  return serialized;
+}
+
 constexpr char kBlockingNoGroupAgg[] = R"(
 op_type: AGGREGATE_OPERATOR
 agg_op {
@@ -270,6 +336,96 @@ agg_op {
   value_names: "value1"
 })";
 
+constexpr char kPartialSingleGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "partial_minsum"
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    id: 2
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: true
+  finalize_results: false
+})";
+
+constexpr char kFinalizeSingleGroupAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "partial_minsum"
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    id: 2
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: false
+  finalize_results: true
+})";
+
+constexpr char kFinalizeFramesAgg[] = R"(
+op_type: AGGREGATE_OPERATOR
+agg_op {
+  windowed: false
+  values {
+    name: "partial_frames"
+    args {
+      column {
+        node:0
+        index: 0
+      }
+    }
+    args {
+      column {
+        node:0
+        index: 1
+      }
+    }
+    id: 3
+  }
+  groups {
+     node: 0
+     index: 0
+  }
+  group_names: "g1"
+  value_names: "value1"
+  partial_agg: false
+  finalize_results: true
+})";
+
 std::unique_ptr<ExecState> MakeTestExecState(udf::Registry* registry) {
   auto table_store = std::make_shared<table_store::TableStore>();
   return std::make_unique<ExecState>(registry, table_store, MockResultSinkStubGenerator,
@@ -289,11 +445,15 @@ class AggNodeTest : public ::testing::Test {
     func_registry_ = std::make_unique<udf::Registry>("test");
     EXPECT_TRUE(func_registry_->Register<MinSumUDA>("minsum").ok());
     EXPECT_TRUE(func_registry_->Register<MinSumWithInitUDA>("minsum_w_init").ok());
+    EXPECT_TRUE(func_registry_->Register<PartialMinSumUDA>("partial_minsum").ok());
+    EXPECT_TRUE(func_registry_->Register<PartialFramesUDA>("partial_frames").ok());
 
     exec_state_ = MakeTestExecState(func_registry_.get());
     EXPECT_OK(exec_state_->AddUDA(0, "minsum",
                                   std::vector<types::DataType>({types::INT64, types::INT64})));
     EXPECT_OK(exec_state_->AddUDA(1, "minsum_w_init", {types::INT64, types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddUDA(2, "partial_minsum", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddUDA(3, "partial_frames", {types::INT64, types::STRING}));
   }
 
  protected:
@@ -611,6 +771,119 @@ TEST_F(AggNodeTest, single_group_blocking_init_args) {
       .Close();
 }
 
+TEST_F(AggNodeTest, partial_agg_flushes_bounded_groups) {
+  PX_SET_FOR_SCOPE(FLAGS_carnot_partial_agg_max_groups, 2);
+  auto plan_node = PlanNodeFromPbtxt(kPartialSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::INT64});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1, 2, 2})
+                       .AddColumn<types::Int64Value>({2, 3, 3, 1})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::StringValue>(
+                              {SerializedStates({"2"}), SerializedStates({"3"})})
+                          .get(),
+                      false)
+      // Every row is a new group, so the partial aggregate starts flushing after every batch.
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({3, 4})
+                       .AddColumn<types::Int64Value>({5, 1})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<types::Int64Value>({3, 4})
+                          .AddColumn<types::StringValue>(
+                              {SerializedStates({"3"}), SerializedStates({"1"})})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 1})
+                       .AddColumn<types::Int64Value>({4, 0})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+                          .AddColumn<types::Int64Value>({1})
+                          .AddColumn<types::StringValue>({SerializedStates({"1"})})
+                          .get(),
+                      false)
+      .ConsumeNext(RowBatchBuilder(input_rd, 0, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({})
+                       .AddColumn<types::Int64Value>({})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 0, /*eow*/ true, /*eos*/ true)
+                          .AddColumn<types::Int64Value>({})
+                          .AddColumn<types::StringValue>({})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, finalize_agg_merges_partial_groups) {
+  auto plan_node = PlanNodeFromPbtxt(kFinalizeSingleGroupAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::INT64});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 4, /*eow*/ false, /*eos*/ false)
+                       .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                       .AddColumn<types::StringValue>(
+                           {SerializedStates({"2"}), SerializedStates({"3"}),
+                            SerializedStates({"3"}), SerializedStates({"1"})})
+                       .get(),
+                   0, 0)
+      .ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1})
+                       .AddColumn<types::StringValue>({SerializedStates({"1"})})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 4, true, true)
+                          .AddColumn<types::Int64Value>({1, 2, 3, 4})
+                          .AddColumn<types::Int64Value>({3, 3, 3, 1})
+                          .get(),
+                      false)
+      .Close();
+}
+
+TEST_F(AggNodeTest, finalize_agg_merges_each_partial_state_separately) {
+  auto plan_node = PlanNodeFromPbtxt(kFinalizeFramesAgg);
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+
+  RowDescriptor output_rd({types::DataType::INT64, types::DataType::STRING});
+
+  auto tester = exec::ExecNodeTester<AggNode, plan::AggregateOperator>(
+      *plan_node, output_rd, {input_rd}, exec_state_.get());
+
+  // The frames of one group must not leak into the next group, or the next row of the group.
+  tester
+      .ConsumeNext(RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                       .AddColumn<types::Int64Value>({1, 2, 1})
+                       .AddColumn<types::StringValue>({SerializedStates({"foo;main"}),
+                                                       SerializedStates({"bar;main"}),
+                                                       SerializedStates({"baz"})})
+                       .get(),
+                   0)
+      .ExpectRowBatch(RowBatchBuilder(output_rd, 2, true, true)
+                          .AddColumn<types::Int64Value>({1, 2})
+                          .AddColumn<types::StringValue>({"baz;foo;main", "bar;main"})
+                          .get(),
+                      false)
+      .Close();
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
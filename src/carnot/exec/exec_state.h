@@ -34,6 +34,7 @@
 #include "src/carnot/udf/model_pool.h"
 #include "src/carnot/udf/registry.h"
 #include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
 #include "src/shared/metadata/metadata_state.h"
 #include "src/table_store/table/table_store.h"
 
@@ -55,6 +56,21 @@ using TraceStubGenerator = std::function<
     std::unique_ptr<opentelemetry::proto::collector::trace::v1::TraceService::StubInterface>(
         const std::string& address, bool insecure)>;
 
+// Sizing of the bloom filters used for semi-join reduction. Past max entries the false positive
+// rate grows, which only lets more rows through the probe side of the join.
+constexpr int kSemiJoinFilterMaxEntries = 1 << 16;
+constexpr double kSemiJoinFilterErrorRate = 0.01;
+
+/**
+ * A bloom filter over the join keys sent by one side of a join, used to drop the rows of the other
+ * side that can't have a match before they leave this Carnot instance.
+ */
+struct SemiJoinFilter {
+  std::unique_ptr<bloomfilter::XXHash64BloomFilter> bloom_filter;
+  // Set once the building sink has seen eos, after which the filter can be probed.
+  bool complete = false;
+};
+
 /**
  * ExecState manages the execution state for a single query. A new one will
  * be constructed for every query executed in Carnot and it will not be reused.
@@ -202,6 +218,30 @@ class ExecState {
 
   ExecMetrics* exec_metrics() { return exec_metrics_; }
 
+  // Creates the semi-join filter with the given ID. Called by the node that builds the filter.
+  StatusOr<SemiJoinFilter*> CreateSemiJoinFilter(int64_t id) {
+    if (semi_join_filters_.contains(id)) {
+      return error::Internal("Semi-join filter $0 already exists.", id);
+    }
+    PX_ASSIGN_OR_RETURN(auto bloom_filter,
+                        bloomfilter::XXHash64BloomFilter::Create(kSemiJoinFilterMaxEntries,
+                                                                 kSemiJoinFilterErrorRate));
+    auto filter = std::make_unique<SemiJoinFilter>();
+    filter->bloom_filter = std::move(bloom_filter);
+    auto filter_ptr = filter.get();
+    semi_join_filters_[id] = std::move(filter);
+    return filter_ptr;
+  }
+
+  // Returns the semi-join filter with the given ID, or nullptr if no node in this plan builds it.
+  SemiJoinFilter* GetSemiJoinFilter(int64_t id) {
+    auto it = semi_join_filters_.find(id);
+    if (it == semi_join_filters_.end()) {
+      return nullptr;
+    }
+    return it->second.get();
+  }
+
  private:
   udf::Registry* func_registry_;
   std::shared_ptr<table_store::TableStore> table_store_;
@@ -221,6 +261,8 @@ class ExecState {
   bool current_source_set_ = false;
   std::map<int64_t, bool> source_id_to_keep_running_map_;
 
+  absl::flat_hash_map<int64_t, std::unique_ptr<SemiJoinFilter>> semi_join_filters_;
+
   std::vector<std::unique_ptr<carnotpb::ResultSinkService::StubInterface>> result_sink_stubs_pool_;
   // Mapping of remote address to stub that serves that address.
   absl::flat_hash_map<std::string, carnotpb::ResultSinkService::StubInterface*>
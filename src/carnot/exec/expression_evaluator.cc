@@ -37,6 +37,10 @@
 #include "src/shared/types/types.h"
 #include "src/shared/types/typespb/wrapper/types_pb_wrapper.h"
 
+DEFINE_bool(carnot_fused_expressions,
+            gflags::BoolFromEnv("PL_CARNOT_FUSED_EXPRESSIONS", false),
+            "Whether map and filter nodes evaluate expressions with fused kernels");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -66,6 +70,8 @@ std::unique_ptr<ScalarExpressionEvaluator> ScalarExpressionEvaluator::Create(
       return std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx);
     case ScalarExpressionEvaluatorType::kArrowNative:
       return std::make_unique<ArrowNativeScalarExpressionEvaluator>(expressions, function_ctx);
+    case ScalarExpressionEvaluatorType::kFused:
+      return std::make_unique<FusedScalarExpressionEvaluator>(expressions, function_ctx);
     default:
       CHECK(0) << "Unknown expression type";
   }
@@ -268,12 +274,37 @@ Status VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
     return Status::OK();
   }
 
-  PX_ASSIGN_OR_RETURN(auto result, VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
-                                       exec_state, input, expr));
+  PX_ASSIGN_OR_RETURN(auto result, EvaluateSingleExpression(exec_state, input, expr));
   PX_RETURN_IF_ERROR(output->AddColumn(result->ConvertToArrow(exec_state->exec_mem_pool())));
   return Status::OK();
 }
 
+StatusOr<types::SharedColumnWrapper>
+FusedScalarExpressionEvaluator::EvaluateSingleExpression(
+    ExecState* exec_state, const RowBatch& input, const plan::ScalarExpression& expr) {
+  auto it = fused_expressions_.find(&expr);
+  if (it == fused_expressions_.end()) {
+    PX_ASSIGN_OR_RETURN(auto fused, CompileFusedExpression(exec_state, expr, input.desc()));
+    it = fused_expressions_.emplace(&expr, std::move(fused)).first;
+  }
+  const FusedExpression& fused = it->second;
+  if (fused.kernel == nullptr) {
+    return VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(exec_state, input, expr);
+  }
+
+  FusedKernelInputs inputs;
+  inputs.input = &input;
+  inputs.constants = fused.constants;
+  inputs.fallback_results.reserve(fused.fallbacks.size());
+  for (const auto* fallback : fused.fallbacks) {
+    PX_ASSIGN_OR_RETURN(auto result,
+                        VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression(
+                            exec_state, input, *fallback));
+    inputs.fallback_results.push_back(std::move(result));
+  }
+  return fused.kernel->Evaluate(inputs);
+}
+
 Status ArrowNativeScalarExpressionEvaluator::Open(ExecState* exec_state) {
   for (const auto& kv : exec_state->id_to_scalar_udf_map()) {
     auto udf = kv.second->Make();
@@ -26,7 +26,11 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <gflags/gflags.h>
+
 #include "src/carnot/exec/exec_state.h"
+#include "src/carnot/exec/fused_kernel.h"
 #include "src/carnot/plan/scalar_expression.h"
 #include "src/carnot/udf/base.h"
 #include "src/carnot/udf/udf.h"
@@ -34,6 +38,8 @@
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/table_store.h"
 
+DECLARE_bool(carnot_fused_expressions);
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -89,6 +95,7 @@ class ExpressionEvaluator {
 enum class ScalarExpressionEvaluatorType : uint8_t {
   kVectorNative = 0,
   kArrowNative = 1,
+  kFused = 2,
 };
 
 /**
@@ -141,7 +148,7 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
   Status Open(ExecState* exec_state) override;
   Status Close(ExecState* exec_state) override;
 
-  StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
+  virtual StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
       ExecState* exec_state, const table_store::schema::RowBatch& input,
       const plan::ScalarExpression& expr);
 
@@ -151,6 +158,28 @@ class VectorNativeScalarExpressionEvaluator : public ScalarExpressionEvaluator {
                                   table_store::schema::RowBatch* output) override;
 };
 
+/**
+ * A scalar expression evaluator that compiles the builtin arithmetic, comparison and logical
+ * functions of each expression into a single FusedKernel. The parts of an expression that can't
+ * be fused are evaluated the same way as the VectorNativeScalarExpressionEvaluator.
+ */
+class FusedScalarExpressionEvaluator : public VectorNativeScalarExpressionEvaluator {
+ public:
+  using VectorNativeScalarExpressionEvaluator::VectorNativeScalarExpressionEvaluator;
+
+  StatusOr<types::SharedColumnWrapper> EvaluateSingleExpression(
+      ExecState* exec_state, const table_store::schema::RowBatch& input,
+      const plan::ScalarExpression& expr) override;
+
+ protected:
+  using VectorNativeScalarExpressionEvaluator::EvaluateSingleExpression;
+
+ private:
+  // Expressions are compiled for the descriptor of the first row batch they are evaluated on,
+  // all row batches of a node share the same descriptor.
+  absl::flat_hash_map<const plan::ScalarExpression*, FusedExpression> fused_expressions_;
+};
+
 /**
  * A scalar expression evaluator that uses Arrow arrays for intermediate state.
  */
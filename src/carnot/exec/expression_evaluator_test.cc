@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 
+#include <absl/strings/match.h>
 #include <google/protobuf/text_format.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -76,6 +77,27 @@ class InitArgUDF : public udf::ScalarUDF {
   int64_t i_;
 };
 
+class GreaterThanUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::Int64Value v1, types::Int64Value v2) {
+    return v1.val > v2.val;
+  }
+};
+
+class LogicalAndUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::BoolValue b1, types::BoolValue b2) {
+    return b1.val && b2.val;
+  }
+};
+
+class ContainsUDF : public udf::ScalarUDF {
+ public:
+  types::BoolValue Exec(FunctionContext*, types::StringValue str, types::StringValue substr) {
+    return absl::StrContains(str, substr);
+  }
+};
+
 std::shared_ptr<plan::ScalarExpression> AddScalarExpr() {
   planpb::ScalarExpression se_pb;
   google::protobuf::TextFormat::MergeFromString(kAddScalarFuncPbtxt, &se_pb);
@@ -158,7 +180,8 @@ class ScalarExpressionTest : public ::testing::TestWithParam<ScalarExpressionEva
 
 INSTANTIATE_TEST_SUITE_P(TestVecAndArrow, ScalarExpressionTest,
                          ::testing::Values(ScalarExpressionEvaluatorType::kVectorNative,
-                                           ScalarExpressionEvaluatorType::kArrowNative));
+                                           ScalarExpressionEvaluatorType::kArrowNative,
+                                           ScalarExpressionEvaluatorType::kFused));
 
 TEST_P(ScalarExpressionTest, basic_tests) {
   RowDescriptor rd_output({types::DataType::INT64});
@@ -270,6 +293,120 @@ TEST_P(ScalarExpressionTest, eval_init_arg_udf) {
   EXPECT_EQ("init_arg, 1234, c", casted->GetString(2));
 }
 
+// logicalAnd(greaterThan(col0, <value>), contains(col2, "b"))
+constexpr char kPartiallyFusableScalarFuncTmpl[] = R"pb(
+func {
+  name: "logicalAnd"
+  id: 3
+  args {
+    func {
+      name: "greaterThan"
+      id: 2
+      args {
+        column {
+          node: 0
+          index: 0
+        }
+      }
+      args {
+        constant {
+          data_type: INT64
+          int64_value: $0
+        }
+      }
+      args_data_types: INT64
+      args_data_types: INT64
+    }
+  }
+  args {
+    func {
+      name: "contains"
+      id: 4
+      args {
+        column {
+          node: 0
+          index: 2
+        }
+      }
+      args {
+        constant {
+          data_type: STRING
+          string_value: "b"
+        }
+      }
+      args_data_types: STRING
+      args_data_types: STRING
+    }
+  }
+  args_data_types: BOOLEAN
+  args_data_types: BOOLEAN
+}
+)pb";
+
+class PartiallyFusableExpressionTest : public ScalarExpressionTest {
+ public:
+  void SetUp() override {
+    ScalarExpressionTest::SetUp();
+    EXPECT_OK(func_registry_->Register<GreaterThanUDF>("greaterThan"));
+    EXPECT_OK(func_registry_->Register<LogicalAndUDF>("logicalAnd"));
+    EXPECT_OK(func_registry_->Register<ContainsUDF>("contains"));
+    EXPECT_OK(exec_state_->AddScalarUDF(2, "greaterThan", {types::INT64, types::INT64}));
+    EXPECT_OK(exec_state_->AddScalarUDF(3, "logicalAnd", {types::BOOLEAN, types::BOOLEAN}));
+    EXPECT_OK(exec_state_->AddScalarUDF(4, "contains", {types::STRING, types::STRING}));
+  }
+};
+
+INSTANTIATE_TEST_SUITE_P(TestAllEvaluators, PartiallyFusableExpressionTest,
+                         ::testing::Values(ScalarExpressionEvaluatorType::kVectorNative,
+                                           ScalarExpressionEvaluatorType::kArrowNative,
+                                           ScalarExpressionEvaluatorType::kFused));
+
+TEST_P(PartiallyFusableExpressionTest, eval_with_fallback) {
+  RowDescriptor rd_output({types::DataType::BOOLEAN});
+  RowBatch output_rb(rd_output, input_rb_->num_rows());
+
+  auto se = ScalarExpressionOf(absl::Substitute(kPartiallyFusableScalarFuncTmpl, 1));
+  RunEvaluator({se}, &output_rb);
+
+  auto out_col = output_rb.ColumnAt(0);
+  EXPECT_EQ(3, out_col->length());
+  auto casted = static_cast<arrow::BooleanArray*>(out_col.get());
+  EXPECT_FALSE(casted->Value(0));
+  EXPECT_TRUE(casted->Value(1));
+  EXPECT_FALSE(casted->Value(2));
+}
+
+TEST_P(PartiallyFusableExpressionTest, fused_kernel_shared_across_constants) {
+  auto se1 = ScalarExpressionOf(absl::Substitute(kPartiallyFusableScalarFuncTmpl, 1));
+  auto se2 = ScalarExpressionOf(absl::Substitute(kPartiallyFusableScalarFuncTmpl, 2));
+
+  ASSERT_OK_AND_ASSIGN(auto fused1,
+                       CompileFusedExpression(exec_state_.get(), *se1, input_rb_->desc()));
+  ASSERT_OK_AND_ASSIGN(auto fused2,
+                       CompileFusedExpression(exec_state_.get(), *se2, input_rb_->desc()));
+
+  ASSERT_NE(nullptr, fused1.kernel);
+  EXPECT_EQ(fused1.kernel, fused2.kernel);
+  ASSERT_EQ(1UL, fused1.constants.size());
+  EXPECT_EQ(1, fused1.constants[0]->Int64Value());
+  EXPECT_EQ(2, fused2.constants[0]->Int64Value());
+  // contains() can't be fused, so it's evaluated outside of the kernel.
+  ASSERT_EQ(1UL, fused1.fallbacks.size());
+  EXPECT_EQ(plan::Expression::kFunc, fused1.fallbacks[0]->ExpressionType());
+
+  FusedKernelInputs inputs;
+  inputs.input = input_rb_.get();
+  inputs.constants = fused2.constants;
+  inputs.fallback_results.push_back(std::make_shared<types::BoolValueColumnWrapper>(
+      std::vector<types::BoolValue>{false, true, true}));
+  ASSERT_OK_AND_ASSIGN(auto result, fused2.kernel->Evaluate(inputs));
+  ASSERT_EQ(types::DataType::BOOLEAN, result->data_type());
+  auto* bools = static_cast<types::BoolValueColumnWrapper*>(result.get());
+  EXPECT_FALSE((*bools)[0].val);
+  EXPECT_FALSE((*bools)[1].val);
+  EXPECT_TRUE((*bools)[2].val);
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
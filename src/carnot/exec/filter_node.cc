@@ -60,8 +60,14 @@ Status FilterNode::InitImpl(const plan::Operator& plan_node) {
 
 Status FilterNode::PrepareImpl(ExecState* exec_state) {
   function_ctx_ = exec_state->CreateFunctionContext();
-  evaluator_ = std::make_unique<VectorNativeScalarExpressionEvaluator>(
-      plan::ConstScalarExpressionVector{plan_node_->expression()}, function_ctx_.get());
+  plan::ConstScalarExpressionVector expressions{plan_node_->expression()};
+  if (FLAGS_carnot_fused_expressions) {
+    evaluator_ =
+        std::make_unique<FusedScalarExpressionEvaluator>(expressions, function_ctx_.get());
+  } else {
+    evaluator_ =
+        std::make_unique<VectorNativeScalarExpressionEvaluator>(expressions, function_ctx_.get());
+  }
   return Status::OK();
 }
 
@@ -0,0 +1,726 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/fused_kernel.h"
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+#include <absl/strings/str_cat.h>
+#include <absl/synchronization/mutex.h>
+
+#include "src/carnot/udf/udf_definition.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+using types::DataType;
+using types::DataTypeTraits;
+
+namespace internal {
+
+/**
+ * A node of a fused kernel. Nodes are only ever used through TypedFusedNode, the base class
+ * exists so that kernels can own nodes of any type.
+ */
+class FusedNode {
+ public:
+  virtual ~FusedNode() = default;
+};
+
+/**
+ * A node that produces values of the native type T.
+ */
+template <typename T>
+class TypedFusedNode : public FusedNode {
+ public:
+  // Writes the values of rows [offset, offset + n) to out. n is at most kFusedKernelBlockSize.
+  virtual void Eval(const FusedKernelInputs& inputs, size_t offset, size_t n, T* out) const = 0;
+};
+
+}  // namespace internal
+
+namespace {
+
+using internal::FusedNode;
+using internal::TypedFusedNode;
+
+// The native types that fused kernels compute with.
+enum class NativeType : uint8_t {
+  kNone = 0,
+  kBool,
+  kInt64,
+  kFloat64,
+};
+
+NativeType NativeTypeOf(DataType data_type) {
+  switch (data_type) {
+    case DataType::BOOLEAN:
+      return NativeType::kBool;
+    case DataType::INT64:
+    case DataType::TIME64NS:
+      return NativeType::kInt64;
+    case DataType::FLOAT64:
+      return NativeType::kFloat64;
+    default:
+      return NativeType::kNone;
+  }
+}
+
+template <typename T>
+struct NativeTypeTraits {};
+template <>
+struct NativeTypeTraits<bool> {
+  static constexpr NativeType value = NativeType::kBool;
+};
+template <>
+struct NativeTypeTraits<int64_t> {
+  static constexpr NativeType value = NativeType::kInt64;
+};
+template <>
+struct NativeTypeTraits<double> {
+  static constexpr NativeType value = NativeType::kFloat64;
+};
+
+template <typename T>
+struct TypeTag {
+  using type = T;
+};
+
+// Calls fn with the TypeTag of the native type that matches type. Only the listed types are
+// instantiated, so that nodes are only generated for the type combinations an op supports.
+template <typename... TTypes, typename TFunc>
+std::unique_ptr<FusedNode> DispatchNativeType(NativeType type, TFunc&& fn) {
+  std::unique_ptr<FusedNode> node;
+  static_cast<void>(((NativeTypeTraits<TTypes>::value == type
+                          ? (node = fn(TypeTag<TTypes>{}), true)
+                          : false) ||
+                     ...));
+  return node;
+}
+
+/**
+ * Leaf nodes.
+ */
+template <DataType DT>
+class ColumnNode : public TypedFusedNode<typename DataTypeTraits<DT>::native_type> {
+  using T = typename DataTypeTraits<DT>::native_type;
+
+ public:
+  explicit ColumnNode(int64_t col_idx) : col_idx_(col_idx) {}
+
+  void Eval(const FusedKernelInputs& inputs, size_t offset, size_t n, T* out) const override {
+    const arrow::Array* arr = inputs.input->ColumnAt(col_idx_).get();
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = types::GetValueFromArrowArray<DT>(arr, offset + i);
+    }
+  }
+
+ private:
+  int64_t col_idx_;
+};
+
+template <DataType DT>
+typename DataTypeTraits<DT>::native_type ScalarNativeValue(const plan::ScalarValue& val) {
+  if constexpr (DT == DataType::BOOLEAN) {
+    return val.BoolValue();
+  } else if constexpr (DT == DataType::INT64) {
+    return val.Int64Value();
+  } else if constexpr (DT == DataType::TIME64NS) {
+    return val.Time64NSValue();
+  } else {
+    static_assert(DT == DataType::FLOAT64);
+    return val.Float64Value();
+  }
+}
+
+template <DataType DT>
+class ConstantNode : public TypedFusedNode<typename DataTypeTraits<DT>::native_type> {
+  using T = typename DataTypeTraits<DT>::native_type;
+
+ public:
+  explicit ConstantNode(size_t idx) : idx_(idx) {}
+
+  void Eval(const FusedKernelInputs& inputs, size_t, size_t n, T* out) const override {
+    std::fill_n(out, n, ScalarNativeValue<DT>(*inputs.constants[idx_]));
+  }
+
+ private:
+  size_t idx_;
+};
+
+template <DataType DT>
+class FallbackNode : public TypedFusedNode<typename DataTypeTraits<DT>::native_type> {
+  using T = typename DataTypeTraits<DT>::native_type;
+  using ColumnWrapperType = types::ColumnWrapperTmpl<typename DataTypeTraits<DT>::value_type>;
+
+ public:
+  explicit FallbackNode(size_t idx) : idx_(idx) {}
+
+  void Eval(const FusedKernelInputs& inputs, size_t offset, size_t n, T* out) const override {
+    const auto* col = static_cast<const ColumnWrapperType*>(inputs.fallback_results[idx_].get());
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = (*col)[offset + i].val;
+    }
+  }
+
+ private:
+  size_t idx_;
+};
+
+template <template <DataType> class TNode, typename TArg>
+std::unique_ptr<FusedNode> MakeLeafNode(DataType data_type, TArg arg) {
+  switch (data_type) {
+    case DataType::BOOLEAN:
+      return std::make_unique<TNode<DataType::BOOLEAN>>(arg);
+    case DataType::INT64:
+      return std::make_unique<TNode<DataType::INT64>>(arg);
+    case DataType::FLOAT64:
+      return std::make_unique<TNode<DataType::FLOAT64>>(arg);
+    case DataType::TIME64NS:
+      return std::make_unique<TNode<DataType::TIME64NS>>(arg);
+    default:
+      return nullptr;
+  }
+}
+
+/**
+ * Function nodes. The semantics of the ops match the builtin UDFs of the same name.
+ */
+template <typename TL, typename TR>
+struct AddOp {
+  using result_type = std::common_type_t<TL, TR>;
+  static result_type Apply(TL l, TR r) { return l + r; }
+};
+template <typename TL, typename TR>
+struct SubtractOp {
+  using result_type = std::common_type_t<TL, TR>;
+  static result_type Apply(TL l, TR r) { return l - r; }
+};
+template <typename TL, typename TR>
+struct MultiplyOp {
+  using result_type = std::common_type_t<TL, TR>;
+  static result_type Apply(TL l, TR r) { return l * r; }
+};
+template <typename TL, typename TR>
+struct GreaterThanOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l > r; }
+};
+template <typename TL, typename TR>
+struct GreaterThanEqualOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l >= r; }
+};
+template <typename TL, typename TR>
+struct LessThanOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l < r; }
+};
+template <typename TL, typename TR>
+struct LessThanEqualOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l <= r; }
+};
+template <typename TL, typename TR>
+struct EqualOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l == r; }
+};
+template <typename TL, typename TR>
+struct NotEqualOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l != r; }
+};
+template <typename TL, typename TR>
+struct LogicalAndOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l && r; }
+};
+template <typename TL, typename TR>
+struct LogicalOrOp {
+  using result_type = bool;
+  static bool Apply(TL l, TR r) { return l || r; }
+};
+template <typename T>
+struct NegateOp {
+  using result_type = T;
+  static T Apply(T v) { return -v; }
+};
+template <typename T>
+struct LogicalNotOp {
+  using result_type = bool;
+  static bool Apply(T v) { return !v; }
+};
+
+template <typename TArg, typename TOp>
+class UnaryNode : public TypedFusedNode<typename TOp::result_type> {
+  using TOut = typename TOp::result_type;
+
+ public:
+  explicit UnaryNode(std::unique_ptr<FusedNode> arg) : arg_(std::move(arg)) {}
+
+  void Eval(const FusedKernelInputs& inputs, size_t offset, size_t n, TOut* out) const override {
+    std::array<TArg, kFusedKernelBlockSize> arg;
+    static_cast<const TypedFusedNode<TArg>*>(arg_.get())->Eval(inputs, offset, n, arg.data());
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = TOp::Apply(arg[i]);
+    }
+  }
+
+ private:
+  std::unique_ptr<FusedNode> arg_;
+};
+
+template <typename TL, typename TR, typename TOp>
+class BinaryNode : public TypedFusedNode<typename TOp::result_type> {
+  using TOut = typename TOp::result_type;
+
+ public:
+  BinaryNode(std::unique_ptr<FusedNode> left, std::unique_ptr<FusedNode> right)
+      : left_(std::move(left)), right_(std::move(right)) {}
+
+  void Eval(const FusedKernelInputs& inputs, size_t offset, size_t n, TOut* out) const override {
+    std::array<TL, kFusedKernelBlockSize> left;
+    std::array<TR, kFusedKernelBlockSize> right;
+    static_cast<const TypedFusedNode<TL>*>(left_.get())->Eval(inputs, offset, n, left.data());
+    static_cast<const TypedFusedNode<TR>*>(right_.get())->Eval(inputs, offset, n, right.data());
+    for (size_t i = 0; i < n; ++i) {
+      out[i] = TOp::Apply(left[i], right[i]);
+    }
+  }
+
+ private:
+  std::unique_ptr<FusedNode> left_;
+  std::unique_ptr<FusedNode> right_;
+};
+
+template <template <typename> class TOp, typename... TTypes>
+std::unique_ptr<FusedNode> MakeUnaryNode(std::unique_ptr<FusedNode> arg, NativeType arg_type) {
+  return DispatchNativeType<TTypes...>(arg_type, [&](auto tag) -> std::unique_ptr<FusedNode> {
+    using T = typename decltype(tag)::type;
+    return std::make_unique<UnaryNode<T, TOp<T>>>(std::move(arg));
+  });
+}
+
+template <template <typename, typename> class TOp, typename... TTypes>
+std::unique_ptr<FusedNode> MakeBinaryNode(std::unique_ptr<FusedNode> left, NativeType left_type,
+                                          std::unique_ptr<FusedNode> right,
+                                          NativeType right_type) {
+  return DispatchNativeType<TTypes...>(left_type, [&](auto left_tag) {
+    using TL = typename decltype(left_tag)::type;
+    return DispatchNativeType<TTypes...>(right_type, [&](auto right_tag) {
+      using TR = typename decltype(right_tag)::type;
+      std::unique_ptr<FusedNode> node =
+          std::make_unique<BinaryNode<TL, TR, TOp<TL, TR>>>(std::move(left), std::move(right));
+      return node;
+    });
+  });
+}
+
+/**
+ * The builtin functions that can be fused, and the argument types they are fused for.
+ */
+enum class FusedOp : uint8_t {
+  kAdd,
+  kSubtract,
+  kMultiply,
+  kNegate,
+  kGreaterThan,
+  kGreaterThanEqual,
+  kLessThan,
+  kLessThanEqual,
+  kEqual,
+  kNotEqual,
+  kLogicalAnd,
+  kLogicalOr,
+  kLogicalNot,
+};
+
+enum class FusedOpClass : uint8_t {
+  // Numeric arguments, the output is a float if any of the arguments is.
+  kArithmetic,
+  // Numeric arguments, boolean output.
+  kOrdering,
+  // Integer or boolean arguments of the same type, boolean output. Floats aren't fused because
+  // the builtin equality of floats is approximate.
+  kEquality,
+  // Boolean arguments and output.
+  kLogical,
+};
+
+struct FusedOpInfo {
+  FusedOp op;
+  FusedOpClass op_class;
+  size_t num_args;
+};
+
+const absl::flat_hash_map<std::string, FusedOpInfo>& FusedOps() {
+  static const auto* ops = new absl::flat_hash_map<std::string, FusedOpInfo>({
+      {"add", {FusedOp::kAdd, FusedOpClass::kArithmetic, 2}},
+      {"subtract", {FusedOp::kSubtract, FusedOpClass::kArithmetic, 2}},
+      {"multiply", {FusedOp::kMultiply, FusedOpClass::kArithmetic, 2}},
+      {"negate", {FusedOp::kNegate, FusedOpClass::kArithmetic, 1}},
+      {"greaterThan", {FusedOp::kGreaterThan, FusedOpClass::kOrdering, 2}},
+      {"greaterThanEqual", {FusedOp::kGreaterThanEqual, FusedOpClass::kOrdering, 2}},
+      {"lessThan", {FusedOp::kLessThan, FusedOpClass::kOrdering, 2}},
+      {"lessThanEqual", {FusedOp::kLessThanEqual, FusedOpClass::kOrdering, 2}},
+      {"equal", {FusedOp::kEqual, FusedOpClass::kEquality, 2}},
+      {"notEqual", {FusedOp::kNotEqual, FusedOpClass::kEquality, 2}},
+      {"logicalAnd", {FusedOp::kLogicalAnd, FusedOpClass::kLogical, 2}},
+      {"logicalOr", {FusedOp::kLogicalOr, FusedOpClass::kLogical, 2}},
+      {"logicalNot", {FusedOp::kLogicalNot, FusedOpClass::kLogical, 1}},
+  });
+  return *ops;
+}
+
+/**
+ * The analyzed form of an expression, which decides which parts of the expression are fused.
+ */
+struct ExprSpec {
+  enum Kind : uint8_t {
+    kColumn,
+    kConstant,
+    // Evaluated outside of the kernel and passed in through the fallback results.
+    kFallback,
+    kFunc,
+  };
+
+  Kind kind;
+  const plan::ScalarExpression* expr;
+  DataType data_type;
+  FusedOp op = FusedOp::kAdd;
+  std::vector<ExprSpec> children;
+
+  NativeType native_type() const { return NativeTypeOf(data_type); }
+};
+
+bool ArgsHaveType(const std::vector<ExprSpec>& args, std::initializer_list<NativeType> types) {
+  return std::all_of(args.begin(), args.end(), [&](const ExprSpec& arg) {
+    return std::find(types.begin(), types.end(), arg.native_type()) != types.end();
+  });
+}
+
+// Returns whether a function with the given op, arguments and return type can be fused.
+bool CanFuse(const FusedOpInfo& info, const std::vector<ExprSpec>& args, DataType return_type) {
+  if (args.size() != info.num_args) {
+    return false;
+  }
+  NativeType output_type = NativeTypeOf(return_type);
+  switch (info.op_class) {
+    case FusedOpClass::kArithmetic: {
+      if (!ArgsHaveType(args, {NativeType::kInt64, NativeType::kFloat64})) {
+        return false;
+      }
+      bool all_int = ArgsHaveType(args, {NativeType::kInt64});
+      return output_type == (all_int ? NativeType::kInt64 : NativeType::kFloat64);
+    }
+    case FusedOpClass::kOrdering:
+      return output_type == NativeType::kBool &&
+             ArgsHaveType(args, {NativeType::kInt64, NativeType::kFloat64});
+    case FusedOpClass::kEquality:
+      return output_type == NativeType::kBool &&
+             (ArgsHaveType(args, {NativeType::kInt64}) || ArgsHaveType(args, {NativeType::kBool}));
+    case FusedOpClass::kLogical:
+      return output_type == NativeType::kBool && ArgsHaveType(args, {NativeType::kBool});
+  }
+  return false;
+}
+
+StatusOr<ExprSpec> AnalyzeExpression(ExecState* exec_state, const plan::ScalarExpression& expr,
+                                     const RowDescriptor& input_desc) {
+  ExprSpec spec{ExprSpec::kFallback, &expr, DataType::DATA_TYPE_UNKNOWN};
+  switch (expr.ExpressionType()) {
+    case plan::Expression::kConstant: {
+      const auto& val = static_cast<const plan::ScalarValue&>(expr);
+      spec.data_type = val.DataType();
+      if (spec.native_type() != NativeType::kNone && !val.IsNull()) {
+        spec.kind = ExprSpec::kConstant;
+      }
+      return spec;
+    }
+    case plan::Expression::kColumn: {
+      const auto& col = static_cast<const plan::Column&>(expr);
+      spec.data_type = input_desc.type(col.Index());
+      if (spec.native_type() != NativeType::kNone) {
+        spec.kind = ExprSpec::kColumn;
+      }
+      return spec;
+    }
+    case plan::Expression::kFunc: {
+      const auto& fn = static_cast<const plan::ScalarFunc&>(expr);
+      auto def = exec_state->GetScalarUDFDefinition(fn.udf_id());
+      if (def == nullptr) {
+        return error::Internal("No definition for UDF $0 ($1)", fn.name(), fn.udf_id());
+      }
+      spec.data_type = def->exec_return_type();
+
+      for (const auto& arg : fn.arg_deps()) {
+        PX_ASSIGN_OR_RETURN(auto child, AnalyzeExpression(exec_state, *arg, input_desc));
+        spec.children.push_back(std::move(child));
+      }
+      auto it = FusedOps().find(fn.name());
+      if (it != FusedOps().end() && fn.init_arguments().empty() &&
+          CanFuse(it->second, spec.children, spec.data_type)) {
+        spec.kind = ExprSpec::kFunc;
+        spec.op = it->second.op;
+      } else {
+        // The whole subtree is evaluated by the fallback.
+        spec.children.clear();
+      }
+      return spec;
+    }
+    default:
+      return error::InvalidArgument("Unsupported expression type in scalar expression: $0",
+                                    expr.DebugString());
+  }
+}
+
+// Appends the fingerprint of the kernel for spec to fingerprint, and collects the constants and
+// fallbacks of the expression. Both are visited in pre-order, the same order as BuildNode.
+void FingerprintExpression(const ExprSpec& spec, std::string* fingerprint,
+                           FusedExpression* fused) {
+  switch (spec.kind) {
+    case ExprSpec::kColumn:
+      absl::StrAppend(fingerprint, "col(", static_cast<const plan::Column*>(spec.expr)->Index(),
+                      ":", types::ToString(spec.data_type), ")");
+      return;
+    case ExprSpec::kConstant:
+      absl::StrAppend(fingerprint, "const(", types::ToString(spec.data_type), ")");
+      fused->constants.push_back(static_cast<const plan::ScalarValue*>(spec.expr));
+      return;
+    case ExprSpec::kFallback:
+      absl::StrAppend(fingerprint, "fallback(", types::ToString(spec.data_type), ")");
+      fused->fallbacks.push_back(spec.expr);
+      return;
+    case ExprSpec::kFunc:
+      absl::StrAppend(fingerprint, static_cast<const plan::ScalarFunc*>(spec.expr)->name(), ":",
+                      types::ToString(spec.data_type), "(");
+      for (const auto& child : spec.children) {
+        FingerprintExpression(child, fingerprint, fused);
+        absl::StrAppend(fingerprint, ",");
+      }
+      absl::StrAppend(fingerprint, ")");
+      return;
+  }
+}
+
+struct BuildState {
+  size_t num_constants = 0;
+  size_t num_fallbacks = 0;
+};
+
+std::unique_ptr<FusedNode> BuildFuncNode(const ExprSpec& spec,
+                                         std::vector<std::unique_ptr<FusedNode>> args) {
+  using NT = NativeType;
+  NT t0 = spec.children[0].native_type();
+  NT t1 = spec.children.size() > 1 ? spec.children[1].native_type() : NT::kNone;
+  switch (spec.op) {
+    case FusedOp::kAdd:
+      return MakeBinaryNode<AddOp, int64_t, double>(std::move(args[0]), t0, std::move(args[1]), t1);
+    case FusedOp::kSubtract:
+      return MakeBinaryNode<SubtractOp, int64_t, double>(std::move(args[0]), t0,
+                                                         std::move(args[1]), t1);
+    case FusedOp::kMultiply:
+      return MakeBinaryNode<MultiplyOp, int64_t, double>(std::move(args[0]), t0,
+                                                         std::move(args[1]), t1);
+    case FusedOp::kNegate:
+      return MakeUnaryNode<NegateOp, int64_t, double>(std::move(args[0]), t0);
+    case FusedOp::kGreaterThan:
+      return MakeBinaryNode<GreaterThanOp, int64_t, double>(std::move(args[0]), t0,
+                                                            std::move(args[1]), t1);
+    case FusedOp::kGreaterThanEqual:
+      return MakeBinaryNode<GreaterThanEqualOp, int64_t, double>(std::move(args[0]), t0,
+                                                                 std::move(args[1]), t1);
+    case FusedOp::kLessThan:
+      return MakeBinaryNode<LessThanOp, int64_t, double>(std::move(args[0]), t0,
+                                                         std::move(args[1]), t1);
+    case FusedOp::kLessThanEqual:
+      return MakeBinaryNode<LessThanEqualOp, int64_t, double>(std::move(args[0]), t0,
+                                                              std::move(args[1]), t1);
+    case FusedOp::kEqual:
+      return MakeBinaryNode<EqualOp, bool, int64_t>(std::move(args[0]), t0, std::move(args[1]),
+                                                    t1);
+    case FusedOp::kNotEqual:
+      return MakeBinaryNode<NotEqualOp, bool, int64_t>(std::move(args[0]), t0,
+                                                       std::move(args[1]), t1);
+    case FusedOp::kLogicalAnd:
+      return MakeBinaryNode<LogicalAndOp, bool>(std::move(args[0]), t0, std::move(args[1]), t1);
+    case FusedOp::kLogicalOr:
+      return MakeBinaryNode<LogicalOrOp, bool>(std::move(args[0]), t0, std::move(args[1]), t1);
+    case FusedOp::kLogicalNot:
+      return MakeUnaryNode<LogicalNotOp, bool>(std::move(args[0]), t0);
+  }
+  return nullptr;
+}
+
+StatusOr<std::unique_ptr<FusedNode>> BuildNode(const ExprSpec& spec, BuildState* state) {
+  std::unique_ptr<FusedNode> node;
+  switch (spec.kind) {
+    case ExprSpec::kColumn:
+      node = MakeLeafNode<ColumnNode>(spec.data_type,
+                                      static_cast<const plan::Column*>(spec.expr)->Index());
+      break;
+    case ExprSpec::kConstant:
+      node = MakeLeafNode<ConstantNode>(spec.data_type, state->num_constants++);
+      break;
+    case ExprSpec::kFallback:
+      node = MakeLeafNode<FallbackNode>(spec.data_type, state->num_fallbacks++);
+      break;
+    case ExprSpec::kFunc: {
+      std::vector<std::unique_ptr<FusedNode>> args;
+      for (const auto& child : spec.children) {
+        PX_ASSIGN_OR_RETURN(auto arg, BuildNode(child, state));
+        args.push_back(std::move(arg));
+      }
+      node = BuildFuncNode(spec, std::move(args));
+      break;
+    }
+  }
+  if (node == nullptr) {
+    return error::Internal("Failed to build fused node for expression: $0",
+                           spec.expr->DebugString());
+  }
+  return node;
+}
+
+template <typename T, DataType DT>
+void EvaluateBlocks(const TypedFusedNode<T>& root, const FusedKernelInputs& inputs,
+                    size_t num_rows, types::ColumnWrapper* output) {
+  auto* out = static_cast<types::ColumnWrapperTmpl<typename DataTypeTraits<DT>::value_type>*>(
+      output);
+  std::array<T, kFusedKernelBlockSize> block;
+  for (size_t offset = 0; offset < num_rows; offset += kFusedKernelBlockSize) {
+    size_t n = std::min(kFusedKernelBlockSize, num_rows - offset);
+    root.Eval(inputs, offset, n, block.data());
+    for (size_t i = 0; i < n; ++i) {
+      (*out)[offset + i] = block[i];
+    }
+  }
+}
+
+/**
+ * The process wide cache of compiled kernels, keyed by their fingerprint.
+ */
+struct FusedKernelCache {
+  absl::Mutex lock;
+  absl::flat_hash_map<std::string, std::shared_ptr<const FusedKernel>> kernels
+      ABSL_GUARDED_BY(lock);
+};
+
+FusedKernelCache* GetFusedKernelCache() {
+  static auto* cache = new FusedKernelCache();
+  return cache;
+}
+
+}  // namespace
+
+FusedKernel::FusedKernel(std::unique_ptr<internal::FusedNode> root, DataType output_type)
+    : root_(std::move(root)), output_type_(output_type) {}
+
+FusedKernel::~FusedKernel() = default;
+
+StatusOr<types::SharedColumnWrapper> FusedKernel::Evaluate(const FusedKernelInputs& inputs) const {
+  size_t num_rows = inputs.input->num_rows();
+  auto output = types::ColumnWrapper::Make(output_type_, num_rows);
+  switch (output_type_) {
+    case DataType::BOOLEAN:
+      EvaluateBlocks<bool, DataType::BOOLEAN>(
+          *static_cast<const TypedFusedNode<bool>*>(root_.get()), inputs, num_rows, output.get());
+      break;
+    case DataType::INT64:
+      EvaluateBlocks<int64_t, DataType::INT64>(
+          *static_cast<const TypedFusedNode<int64_t>*>(root_.get()), inputs, num_rows,
+          output.get());
+      break;
+    case DataType::TIME64NS:
+      EvaluateBlocks<int64_t, DataType::TIME64NS>(
+          *static_cast<const TypedFusedNode<int64_t>*>(root_.get()), inputs, num_rows,
+          output.get());
+      break;
+    case DataType::FLOAT64:
+      EvaluateBlocks<double, DataType::FLOAT64>(
+          *static_cast<const TypedFusedNode<double>*>(root_.get()), inputs, num_rows,
+          output.get());
+      break;
+    default:
+      return error::Internal("Unsupported output type for fused kernel: $0",
+                             types::ToString(output_type_));
+  }
+  return output;
+}
+
+StatusOr<FusedExpression> CompileFusedExpression(ExecState* exec_state,
+                                                 const plan::ScalarExpression& expr,
+                                                 const RowDescriptor& input_desc) {
+  FusedExpression fused;
+  PX_ASSIGN_OR_RETURN(auto spec, AnalyzeExpression(exec_state, expr, input_desc));
+  // Columns and constants are already cheap to evaluate, and expressions that fall back entirely
+  // don't gain anything from a kernel.
+  if (spec.kind != ExprSpec::kFunc) {
+    return fused;
+  }
+
+  std::string fingerprint;
+  FingerprintExpression(spec, &fingerprint, &fused);
+
+  auto* cache = GetFusedKernelCache();
+  {
+    absl::MutexLock lock(&cache->lock);
+    auto it = cache->kernels.find(fingerprint);
+    if (it != cache->kernels.end()) {
+      fused.kernel = it->second;
+      return fused;
+    }
+  }
+
+  BuildState state;
+  PX_ASSIGN_OR_RETURN(auto root, BuildNode(spec, &state));
+  DCHECK_EQ(state.num_constants, fused.constants.size());
+  DCHECK_EQ(state.num_fallbacks, fused.fallbacks.size());
+  fused.kernel = std::make_shared<const FusedKernel>(std::move(root), spec.data_type);
+
+  absl::MutexLock lock(&cache->lock);
+  if (cache->kernels.size() >= kMaxCachedFusedKernels) {
+    // Compiling a kernel is cheap compared to running it, so a simple reset is enough to bound
+    // the memory used by queries with many distinct expressions.
+    cache->kernels.clear();
+  }
+  cache->kernels.emplace(fingerprint, fused.kernel);
+  return fused;
+}
+
+size_t NumCachedFusedKernels() {
+  auto* cache = GetFusedKernelCache();
+  absl::MutexLock lock(&cache->lock);
+  return cache->kernels.size();
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
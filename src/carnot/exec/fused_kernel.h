@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "src/carnot/exec/exec_state.h"
+#include "src/carnot/plan/scalar_expression.h"
+#include "src/common/base/base.h"
+#include "src/shared/types/column_wrapper.h"
+#include "src/shared/types/types.h"
+#include "src/table_store/table_store.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+// Fused kernels evaluate this many rows at a time, so that the intermediate results of an
+// expression stay in the cache instead of being materialized for the whole row batch.
+constexpr size_t kFusedKernelBlockSize = 256;
+// The maximum number of compiled kernels kept in the process wide kernel cache.
+constexpr size_t kMaxCachedFusedKernels = 1024;
+
+/**
+ * The inputs of a FusedKernel for a single row batch. Kernels refer to the constants of the
+ * expression and to the results of subexpressions that couldn't be fused by their index.
+ */
+struct FusedKernelInputs {
+  const table_store::schema::RowBatch* input = nullptr;
+  std::vector<const plan::ScalarValue*> constants;
+  std::vector<types::SharedColumnWrapper> fallback_results;
+};
+
+namespace internal {
+class FusedNode;
+}  // namespace internal
+
+/**
+ * A FusedKernel evaluates a tree of builtin arithmetic, comparison and logical functions in a
+ * single pass over blocks of rows, instead of materializing a column for every subexpression.
+ *
+ * Kernels don't depend on the values of the constants in the expression and never change once
+ * they are compiled, so a kernel is shared by all expressions with the same structure.
+ */
+class FusedKernel {
+ public:
+  FusedKernel(std::unique_ptr<internal::FusedNode> root, types::DataType output_type);
+  ~FusedKernel();
+
+  types::DataType output_type() const { return output_type_; }
+
+  /**
+   * Evaluates the kernel for all of the rows of the input row batch.
+   * @param inputs The row batch, constants and fallback results to evaluate the kernel with.
+   * @return A column wrapper of output_type() with one value per input row.
+   */
+  StatusOr<types::SharedColumnWrapper> Evaluate(const FusedKernelInputs& inputs) const;
+
+ private:
+  std::unique_ptr<internal::FusedNode> root_;
+  types::DataType output_type_;
+};
+
+/**
+ * A scalar expression compiled into a FusedKernel, along with the parts of the expression that
+ * are passed to the kernel through FusedKernelInputs, in the order of their indices.
+ */
+struct FusedExpression {
+  // Null when the root of the expression isn't a function that can be fused.
+  std::shared_ptr<const FusedKernel> kernel;
+  std::vector<const plan::ScalarValue*> constants;
+  // Subexpressions that the kernel can't evaluate itself, they must be evaluated for every row
+  // batch and passed to the kernel as fallback results.
+  std::vector<const plan::ScalarExpression*> fallbacks;
+};
+
+/**
+ * Compiles the expression into a FusedKernel for row batches with the given descriptor.
+ *
+ * Kernels are cached by a fingerprint of the expression structure and input types, so each
+ * distinct expression is only compiled once per process.
+ */
+StatusOr<FusedExpression> CompileFusedExpression(
+    ExecState* exec_state, const plan::ScalarExpression& expr,
+    const table_store::schema::RowDescriptor& input_desc);
+
+/**
+ * @return The number of kernels in the process wide kernel cache.
+ */
+size_t NumCachedFusedKernels();
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -31,10 +31,20 @@
 #include "src/common/base/base.h"
 #include "src/common/uuid/uuid.h"
 
+DEFINE_int64(carnot_grpc_query_buffer_bytes,
+             gflags::Int64FromEnv("PL_CARNOT_GRPC_QUERY_BUFFER_BYTES", 256 * 1024 * 1024),
+             "The maximum size of the row batches a query may have received from other Carnot "
+             "instances but not yet processed. Past this limit, the senders are blocked until the "
+             "query catches up.");
+
 namespace px {
 namespace carnot {
 namespace exec {
 
+// Consuming row batches wakes up the streams that are waiting for buffer space, but a
+// cancellation of the stream does not, so they also wake up this often to check for it.
+constexpr std::chrono::milliseconds kBufferSpaceCancelCheckInterval{100};
+
 GRPCRouter::SourceNodeTracker* GRPCRouter::GetSourceNodeTracker(QueryTracker* query_tracker,
                                                                 int64_t source_id) {
   absl::base_internal::SpinLockHolder query_lock(&query_tracker->query_lock);
@@ -52,6 +62,7 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
   }
 
   auto snt = GetSourceNodeTracker(query_tracker, req->query_result().grpc_source_id());
+  query_tracker->buffered_bytes += req->ByteSizeLong();
   {
     absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
     // It's possible that we see row batches before we have gotten information about the query. To
@@ -68,6 +79,16 @@ Status GRPCRouter::EnqueueRowBatch(QueryTracker* query_tracker,
   return Status::OK();
 }
 
+void GRPCRouter::WaitForBufferSpace(QueryTracker* query_tracker, ::grpc::ServerContext* context) {
+  // Not reading from the stream lets the gRPC flow control window fill up, at which point the
+  // sink's writes block until this query has consumed enough of what it has already received.
+  std::unique_lock<std::mutex> lock(query_tracker->buffer_space_mutex);
+  while (query_tracker->buffered_bytes > FLAGS_carnot_grpc_query_buffer_bytes &&
+         !context->IsCancelled()) {
+    query_tracker->buffer_space_cv.wait_for(lock, kBufferSpaceCancelCheckInterval);
+  }
+}
+
 void GRPCRouter::MarkResultStreamClosed(QueryTracker* query_tracker, int64_t source_id) {
   auto snt = GetSourceNodeTracker(query_tracker, source_id);
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
@@ -130,8 +151,9 @@ void GRPCRouter::MarkResultStreamContextAsComplete(QueryTracker* query_tracker,
     absl::base_internal::SpinLockHolder query_lock(&state->query_tracker->query_lock);
     for (const auto& agent : req->execution_and_timing_info().agent_execution_stats()) {
       auto agent_id = px::ParseUUID(agent.agent_id()).ConsumeValueOrDie();
-      // There are some cases where we get duplicate exec stats.
-      if (state->query_tracker->seen_agents.contains(agent_id)) {
+      // There are some cases where we get duplicate exec stats. For example, with merge Kelvins
+      // every merge Kelvin forwards the stats of each PEM that it received results from.
+      if (!state->query_tracker->seen_agents.insert(agent_id).second) {
         continue;
       }
       state->query_tracker->agent_exec_stats.push_back(agent);
@@ -179,6 +201,9 @@ std::vector<statuspb::Status> GRPCRouter::GetIncomingWorkerErrors(const sole::uu
     if (!result_status.ok()) {
       break;
     }
+    if (state.query_tracker != nullptr) {
+      WaitForBufferSpace(state.query_tracker.get(), context);
+    }
     req = std::make_unique<carnotpb::TransferResultChunkRequest>();
   }
 
@@ -224,6 +249,10 @@ Status GRPCRouter::AddGRPCSourceNode(sole::uuid query_id, int64_t source_id,
 
   absl::base_internal::SpinLockHolder snt_lock(&snt->node_lock);
   snt->source_node = source_node;
+  // The source node keeps the query tracker alive, so that it can release the buffer space of the
+  // row batches it consumes even after the query has been deleted from the router.
+  source_node->set_release_buffer_func(
+      [query_tracker](int64_t num_bytes) { query_tracker->ReleaseBufferedBytes(num_bytes); });
   if (snt->connection_initiated_by_sink) {
     source_node->set_upstream_initiated_connection();
   }
@@ -275,6 +304,15 @@ Status GRPCRouter::DeleteGRPCSourceNode(sole::uuid query_id, int64_t source_id)
     return error::Internal("Query map for query ID $0 does not contain GRPC source $1",
                            query_id.str(), source_id);
   }
+  {
+    // Row batches in the backlog will never be consumed, so their buffer space is released here.
+    absl::base_internal::SpinLockHolder snt_lock(&it->second.node_lock);
+    int64_t backlog_bytes = 0;
+    for (const auto& req : it->second.response_backlog) {
+      backlog_bytes += req->ByteSizeLong();
+    }
+    query_tracker->ReleaseBufferedBytes(backlog_bytes);
+  }
   query_tracker->source_node_trackers.erase(it);
   return Status::OK();
 }
@@ -301,6 +339,15 @@ void GRPCRouter::DeleteQuery(sole::uuid query_id) {
   }
 }
 
+int64_t GRPCRouter::GetQueryBufferedBytes(const sole::uuid& query_id) {
+  absl::base_internal::SpinLockHolder lock(&id_to_query_tracker_map_lock_);
+  auto it = id_to_query_tracker_map_.find(query_id);
+  if (it == id_to_query_tracker_map_.end()) {
+    return 0;
+  }
+  return it->second->buffered_bytes;
+}
+
 size_t GRPCRouter::NumQueriesTracking() const {
   absl::base_internal::SpinLockHolder lock(&id_to_query_tracker_map_lock_);
   return id_to_query_tracker_map_.size();
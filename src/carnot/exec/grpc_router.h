@@ -19,8 +19,11 @@
 #pragma once
 
 #include <stdint.h>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -97,6 +100,12 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
   StatusOr<std::vector<queryresultspb::AgentExecutionStats>> GetIncomingWorkerExecStats(
       const sole::uuid& query_id);
 
+  /**
+   * @brief The number of bytes of row batches received for the query that haven't been consumed
+   * by its source nodes yet.
+   */
+  int64_t GetQueryBufferedBytes(const sole::uuid& query_id);
+
   /**
    * @brief Number of queries currently being tracked.
    * @return size_t number of queries being tracked.
@@ -139,6 +148,24 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
     std::vector<statuspb::Status> upstream_exec_errors GUARDED_BY(query_lock);
     absl::base_internal::SpinLock query_lock;
 
+    // Bytes of row batches received but not yet consumed by a source node, across all of the
+    // query's sources. Once this goes over the query's buffer limit, the router stops reading
+    // from the query's streams until the source nodes catch up, which makes gRPC flow control
+    // block the senders.
+    std::atomic<int64_t> buffered_bytes = 0;
+    // Signalled whenever buffered_bytes is decreased, to wake up the streams that are waiting for
+    // buffer space.
+    std::mutex buffer_space_mutex;
+    std::condition_variable buffer_space_cv;
+
+    void ReleaseBufferedBytes(int64_t num_bytes) {
+      {
+        std::lock_guard<std::mutex> lock(buffer_space_mutex);
+        buffered_bytes -= num_bytes;
+      }
+      buffer_space_cv.notify_all();
+    }
+
     void ResetRestartExecutionFunc() ABSL_EXCLUSIVE_LOCKS_REQUIRED(query_lock) {
       restart_execution_func_ = std::function<void()>();
     }
@@ -158,6 +185,8 @@ class GRPCRouter final : public carnotpb::ResultSinkService::Service {
 
   Status EnqueueRowBatch(QueryTracker* query_tracker,
                          std::unique_ptr<carnotpb::TransferResultChunkRequest> req);
+  // Blocks until the query has buffer space for more row batches, or the stream is cancelled.
+  void WaitForBufferSpace(QueryTracker* query_tracker, ::grpc::ServerContext* context);
 
   struct TransferResultChunkState {
     int64_t source_node_id = 0;
@@ -23,6 +23,7 @@
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <absl/strings/substitute.h>
 #include <absl/synchronization/barrier.h>
@@ -308,6 +309,80 @@ TEST_F(GRPCRouterTest, router_and_stats_test) {
   EXPECT_EQ(exec_stats.size(), 1);
 }
 
+TEST_F(GRPCRouterTest, exec_stats_kept_once_per_agent) {
+  auto query_uuid = sole::uuid4();
+  auto pem_uuid = sole::uuid4();
+  std::vector<sole::uuid> merge_kelvin_uuids = {sole::uuid4(), sole::uuid4()};
+
+  // Each merge Kelvin forwards the stats of the PEM that sent it results, along with its own.
+  for (const auto& merge_kelvin_uuid : merge_kelvin_uuids) {
+    carnotpb::TransferResultChunkRequest initiate_stream_req;
+    ToProto(query_uuid, initiate_stream_req.mutable_query_id());
+    *initiate_stream_req.mutable_initiate_conn() =
+        carnotpb::TransferResultChunkRequest::InitiateConnection();
+
+    carnotpb::TransferResultChunkRequest stats_req;
+    ToProto(query_uuid, stats_req.mutable_query_id());
+    auto pem_stats = stats_req.mutable_execution_and_timing_info()->add_agent_execution_stats();
+    ToProto(pem_uuid, pem_stats->mutable_agent_id());
+    pem_stats->set_records_processed(3);
+    auto kelvin_stats = stats_req.mutable_execution_and_timing_info()->add_agent_execution_stats();
+    ToProto(merge_kelvin_uuid, kelvin_stats->mutable_agent_id());
+    kelvin_stats->set_records_processed(3);
+
+    carnotpb::TransferResultChunkResponse response;
+    grpc::ClientContext context;
+    auto writer = stub_->TransferResultChunk(&context, &response);
+    writer->Write(initiate_stream_req);
+    writer->Write(stats_req);
+    writer->WritesDone();
+    EXPECT_TRUE(writer->Finish().ok());
+  }
+
+  ASSERT_OK_AND_ASSIGN(auto exec_stats, service_->GetIncomingWorkerExecStats(query_uuid));
+  std::vector<std::string> agent_ids;
+  for (const auto& agent_stats : exec_stats) {
+    agent_ids.push_back(ParseUUID(agent_stats.agent_id()).ConsumeValueOrDie().str());
+  }
+  EXPECT_THAT(agent_ids,
+              ::testing::UnorderedElementsAre(pem_uuid.str(), merge_kelvin_uuids[0].str(),
+                                              merge_kelvin_uuids[1].str()));
+}
+
+TEST_F(GRPCRouterTest, buffered_bytes_released_on_delete) {
+  int64_t grpc_source_node_id = 1;
+  auto query_id = sole::uuid4();
+
+  carnotpb::TransferResultChunkRequest initiate_stream_req;
+  ToProto(query_id, initiate_stream_req.mutable_query_id());
+  *initiate_stream_req.mutable_initiate_conn() =
+      carnotpb::TransferResultChunkRequest::InitiateConnection();
+
+  RowDescriptor input_rd({types::DataType::INT64});
+  auto rb1 = RowBatchBuilder(input_rd, 2, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({1, 2})
+                 .get();
+  carnotpb::TransferResultChunkRequest rb_req1;
+  EXPECT_OK(rb1.ToProto(rb_req1.mutable_query_result()->mutable_row_batch()));
+  rb_req1.mutable_query_result()->set_grpc_source_id(grpc_source_node_id);
+  ToProto(query_id, rb_req1.mutable_query_id());
+
+  // Send a row batch before the source node exists, so that it stays in the backlog.
+  carnotpb::TransferResultChunkResponse response;
+  grpc::ClientContext context;
+  auto writer = stub_->TransferResultChunk(&context, &response);
+  EXPECT_TRUE(writer->Write(initiate_stream_req));
+  EXPECT_TRUE(writer->Write(rb_req1));
+  writer->WritesDone();
+  auto writer_s = writer->Finish();
+  EXPECT_TRUE(writer_s.ok()) << writer_s.error_message();
+
+  EXPECT_EQ(rb_req1.ByteSizeLong(), service_->GetQueryBufferedBytes(query_id));
+  ASSERT_OK(service_->DeleteGRPCSourceNode(query_id, grpc_source_node_id));
+  EXPECT_EQ(0, service_->GetQueryBufferedBytes(query_id));
+  service_->DeleteQuery(query_id);
+}
+
 TEST_F(GRPCRouterTest, delete_node_router_test) {
   int64_t grpc_source_node_id = 1;
   RowDescriptor input_rd({types::DataType::INT64, types::DataType::BOOLEAN});
@@ -18,17 +18,25 @@
 
 #include "src/carnot/exec/grpc_sink_node.h"
 
+#include <arrow/array.h>
+#include <farmhash.h>
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/carnotpb/carnot.pb.h"
+#include "src/carnot/exec/row_batch_utils.h"
 #include "src/carnot/planpb/plan.pb.h"
+#include "src/common/base/hash_utils.h"
 #include "src/common/base/macros.h"
 #include "src/common/uuid/uuid_utils.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
 #include "src/table_store/table_store.h"
 
 namespace px {
@@ -44,21 +52,23 @@ std::string GRPCSinkNode::DebugStringImpl() {
     destination = absl::Substitute("table_name: $0", plan_node_->table_name());
   } else if (plan_node_->has_grpc_source_id()) {
     destination = absl::Substitute("source_id: $0", plan_node_->grpc_source_id());
+  } else if (plan_node_->is_partitioned()) {
+    destination = absl::Substitute("partitions: $0", destinations_.size());
   }
   return absl::Substitute("Exec::GRPCSinkNode: {address: $0, $1, output: $2}",
                           plan_node_->address(), destination, input_descriptor_->DebugString());
 }
 
-StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(
-    plan::GRPCSinkOperator* plan_node, ExecState* exec_state) {
+StatusOr<carnotpb::TransferResultChunkRequest> GRPCSinkNode::RequestWithMetadata(
+    const Destination& dest, ExecState* exec_state) const {
   carnotpb::TransferResultChunkRequest req;
   // Set the metadata for the RowBatch (where it should go).
-  req.set_address(plan_node->address());
+  req.set_address(dest.address);
 
-  if (plan_node->has_grpc_source_id()) {
-    req.mutable_query_result()->set_grpc_source_id(plan_node->grpc_source_id());
-  } else if (plan_node->has_table_name()) {
-    req.mutable_query_result()->set_table_name(plan_node->table_name());
+  if (plan_node_->has_grpc_source_id() || plan_node_->is_partitioned()) {
+    req.mutable_query_result()->set_grpc_source_id(dest.grpc_source_id);
+  } else if (plan_node_->has_table_name()) {
+    req.mutable_query_result()->set_table_name(plan_node_->table_name());
   } else {
     return error::Internal("GRPCSink has neither source ID nor table name set.");
   }
@@ -73,19 +83,26 @@ Status GRPCSinkNode::OptionallyCheckConnection(ExecState* exec_state) {
   }
 
   auto time_now = std::chrono::system_clock::now();
-  auto since_last_flush =
-      std::chrono::duration_cast<std::chrono::milliseconds>(time_now - last_send_time_);
-  bool recheck_connection = since_last_flush > connection_check_timeout_;
-  if (!recheck_connection) {
-    return Status::OK();
-  }
+  for (auto& dest : destinations_) {
+    auto since_last_flush =
+        std::chrono::duration_cast<std::chrono::milliseconds>(time_now - dest.last_send_time);
+    // Sending the coalesced batches also checks the connection.
+    if (!dest.pending_batches.empty() && since_last_flush > kMaxCoalesceDelay) {
+      PX_RETURN_IF_ERROR(FlushPendingBatches(exec_state, &dest));
+      continue;
+    }
+    bool recheck_connection = since_last_flush > connection_check_timeout_;
+    if (!recheck_connection) {
+      continue;
+    }
 
-  PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
-  PX_ASSIGN_OR_RETURN(auto rb,
-                      RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
-  PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
+    PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(dest, exec_state));
+    PX_ASSIGN_OR_RETURN(auto rb, RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false,
+                                                        /* eos */ false));
+    PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
 
-  PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
+    PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req, &dest));
+  }
   return Status::OK();
 }
 
@@ -99,115 +116,160 @@ Status GRPCSinkNode::InitImpl(const plan::Operator& plan_node) {
   input_descriptor_ = std::make_unique<RowDescriptor>(input_descriptors_[0]);
   const auto* sink_plan_node = static_cast<const plan::GRPCSinkOperator*>(&plan_node);
   plan_node_ = std::make_unique<plan::GRPCSinkOperator>(*sink_plan_node);
+
+  if (!plan_node_->is_partitioned()) {
+    Destination dest;
+    dest.address = plan_node_->address();
+    dest.ssl_targetname = plan_node_->ssl_targetname();
+    dest.grpc_source_id = plan_node_->grpc_source_id();
+    destinations_.push_back(std::move(dest));
+    return Status::OK();
+  }
+
+  for (int64_t col_idx : plan_node_->partition_column_idxs()) {
+    if (col_idx < 0 || col_idx >= static_cast<int64_t>(input_descriptor_->size())) {
+      return error::InvalidArgument("GRPCSink partition column $0 is out of range for input $1",
+                                    col_idx, input_descriptor_->DebugString());
+    }
+  }
+  for (const auto& partition : plan_node_->partitions()) {
+    Destination dest;
+    dest.address = partition.address();
+    dest.ssl_targetname = partition.connection_options().ssl_targetname();
+    dest.grpc_source_id = partition.grpc_source_id();
+    destinations_.push_back(std::move(dest));
+  }
   return Status::OK();
 }
 
-Status GRPCSinkNode::PrepareImpl(ExecState*) { return Status::OK(); }
+Status GRPCSinkNode::PrepareImpl(ExecState* exec_state) {
+  // The filter is created before any node is opened, so that the MemorySource that probes it
+  // can find it in OpenImpl.
+  if (plan_node_->has_semi_join_build()) {
+    PX_ASSIGN_OR_RETURN(semi_join_filter_,
+                        exec_state->CreateSemiJoinFilter(plan_node_->semi_join_build().id()));
+  }
+  return Status::OK();
+}
 
-Status GRPCSinkNode::StartConnection(ExecState* exec_state) {
-  return StartConnectionWithRetries(exec_state, kGRPCRetries);
+Status GRPCSinkNode::StartConnection(ExecState* exec_state, Destination* dest) {
+  return StartConnectionWithRetries(exec_state, dest, kGRPCRetries);
 }
 
-Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, size_t n_retries) {
+Status GRPCSinkNode::StartConnectionWithRetries(ExecState* exec_state, Destination* dest,
+                                                size_t n_retries) {
   if (n_retries == 0) {
     cancelled_ = true;
     return error::Cancelled(
         "GRPCSinkNode $0 error: unable to write TransferResultChunkRequest on stream start"
         "to remote address $1 for query $2",
-        plan_node_->id(), plan_node_->address(), exec_state->query_id().str());
+        plan_node_->id(), dest->address, exec_state->query_id().str());
   }
 
-  stub_ = exec_state->ResultSinkServiceStub(plan_node_->address(), plan_node_->ssl_targetname());
+  dest->stub = exec_state->ResultSinkServiceStub(dest->address, dest->ssl_targetname);
 
-  context_ = std::make_unique<grpc::ClientContext>();
+  dest->context = std::make_unique<grpc::ClientContext>();
   // When we are sending the results to an external service, such as the query broker,
   // add authentication to the client context.
   if (plan_node_->has_table_name()) {
     // Adding auth to GRPC client.
-    exec_state->AddAuthToGRPCClientContext(context_.get());
+    exec_state->AddAuthToGRPCClientContext(dest->context.get());
   }
 
-  response_.Clear();
-  writer_ = stub_->TransferResultChunk(context_.get(), &response_);
+  dest->response.Clear();
+  dest->writer = dest->stub->TransferResultChunk(dest->context.get(), &dest->response);
 
-  PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
+  PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(*dest, exec_state));
   // If this is not the first connection we've made then we send a 0-row rb instead of an
   // initiate_result_stream request.
   PX_ASSIGN_OR_RETURN(auto rb,
                       RowBatch::WithZeroRows(*input_descriptor_, /* eow */ false, /* eos */ false));
   PX_RETURN_IF_ERROR(rb->ToProto(req.mutable_query_result()->mutable_row_batch()));
 
-  if (!writer_->Write(req)) {
-    return StartConnectionWithRetries(exec_state, n_retries - 1);
+  if (!dest->writer->Write(req)) {
+    return StartConnectionWithRetries(exec_state, dest, n_retries - 1);
   }
 
-  last_send_time_ = std::chrono::system_clock::now();
+  dest->last_send_time = std::chrono::system_clock::now();
   return Status::OK();
 }
 
-Status GRPCSinkNode::CancelledByServer(ExecState* exec_state) {
+Status GRPCSinkNode::CancelledByServer(ExecState* exec_state, const Destination& dest) {
   cancelled_ = true;
   return error::Cancelled(
       "GRPCSinkNode $0 of query $1 could not write result to address: $2, stream closed by "
       "server",
-      plan_node_->id(), exec_state->query_id().str(), plan_node_->address());
+      plan_node_->id(), exec_state->query_id().str(), dest.address);
 }
 
 Status GRPCSinkNode::TryWriteRequest(ExecState* exec_state,
-                                     const carnotpb::TransferResultChunkRequest& req) {
-  if (writer_->Write(req)) {
-    last_send_time_ = std::chrono::system_clock::now();
+                                     const carnotpb::TransferResultChunkRequest& req,
+                                     Destination* dest) {
+  auto write_start = std::chrono::system_clock::now();
+  if (dest->writer->Write(req)) {
+    dest->last_send_time = std::chrono::system_clock::now();
+    dest->backpressured = dest->last_send_time - write_start > kBackpressureWriteLatency;
     return Status::OK();
   }
 
   // We need to determine if the server sent a response (i.e. server closed connection) or if the
   // connection just died.
-  writer_->WritesDone();
-  auto s = writer_->Finish();
+  dest->writer->WritesDone();
+  auto s = dest->writer->Finish();
   // If the Finish call was successful, then the server closed the connection and sent a response,
   // in which case we shouldn't try to reconnect. If there's an error from the server side
   // other than a RST_STREAM, we also shouldn't retry.
   if (s.ok() || s.error_code() != grpc::StatusCode::INTERNAL ||
       !absl::StrContains(s.error_message(), "RST_STREAM")) {
-    return CancelledByServer(exec_state);
+    return CancelledByServer(exec_state, *dest);
   }
   // Otherwise, the connection was probably cancelled due to a timeout or other transient failure,
   // so we can try to restart the connection.
-  PX_RETURN_IF_ERROR(StartConnection(exec_state));
+  PX_RETURN_IF_ERROR(StartConnection(exec_state, dest));
 
   // Try again to write the request on the new connection.
-  if (!writer_->Write(req)) {
-    return CancelledByServer(exec_state);
+  if (!dest->writer->Write(req)) {
+    return CancelledByServer(exec_state, *dest);
   }
-  last_send_time_ = std::chrono::system_clock::now();
+  dest->last_send_time = std::chrono::system_clock::now();
   return Status::OK();
 }
 
-Status GRPCSinkNode::OpenImpl(ExecState* exec_state) { return StartConnection(exec_state); }
+Status GRPCSinkNode::OpenImpl(ExecState* exec_state) {
+  for (auto& dest : destinations_) {
+    PX_RETURN_IF_ERROR(StartConnection(exec_state, &dest));
+  }
+  return Status::OK();
+}
 
-Status GRPCSinkNode::CloseWriter(ExecState* exec_state) {
-  if (writer_ == nullptr) {
+Status GRPCSinkNode::CloseWriter(ExecState* exec_state, Destination* dest) {
+  if (dest->writer == nullptr) {
     return Status::OK();
   }
-  writer_->WritesDone();
-  auto s = writer_->Finish();
+  dest->writer->WritesDone();
+  auto s = dest->writer->Finish();
   if (!s.ok()) {
     LOG(ERROR) << absl::Substitute(
-        "GRPCSinkNode $0 in query $1: Error calling Finish on stream, message: $2",
-        plan_node_->id(), exec_state->query_id().str(), s.error_message());
+        "GRPCSinkNode $0 in query $1: Error calling Finish on stream to $2, message: $3",
+        plan_node_->id(), exec_state->query_id().str(), dest->address, s.error_message());
   }
   return Status::OK();
 }
 
 Status GRPCSinkNode::CloseImpl(ExecState* exec_state) {
+  if (num_coalesced_batches_ > 0) {
+    stats()->AddExtraInfo("coalesced_batches", absl::StrCat(num_coalesced_batches_));
+  }
   if (sent_eos_ || cancelled_) {
     return Status::OK();
   }
 
-  if (writer_ != nullptr) {
-    LOG(INFO) << absl::Substitute("Closing GRPCSinkNode $0 in query $1 before receiving EOS",
-                                  plan_node_->id(), exec_state->query_id().str());
-    PX_RETURN_IF_ERROR(CloseWriter(exec_state));
+  for (auto& dest : destinations_) {
+    if (dest.writer != nullptr) {
+      LOG(INFO) << absl::Substitute("Closing GRPCSinkNode $0 in query $1 before receiving EOS",
+                                    plan_node_->id(), exec_state->query_id().str());
+      PX_RETURN_IF_ERROR(CloseWriter(exec_state, &dest));
+    }
   }
 
   return Status::OK();
@@ -274,7 +336,7 @@ std::vector<int64_t> GRPCSinkNode::SplitBatchSizes(bool has_string_col,
 }
 
 Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb,
-                                       size_t parent_idx) {
+                                       Destination* dest) {
   // Calculate the individual row sizes for all the string columns.
   std::vector<int64_t> string_col_row_sizes(rb.num_rows(), 0);
   // All other columns share the same size across all rows.
@@ -290,7 +352,7 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
   for (size_t idx = 0; idx < new_batches_num_rows.size() - 1; ++idx) {
     auto num_rows = new_batches_num_rows[idx];
     PX_ASSIGN_OR_RETURN(std::unique_ptr<RowBatch> output_rb, rb.Slice(batch_idx, num_rows));
-    PX_RETURN_IF_ERROR(ConsumeNextImplNoSplit(exec_state, *output_rb, parent_idx));
+    PX_RETURN_IF_ERROR(SendBatchNoSplit(exec_state, *output_rb, dest));
     batch_idx += num_rows;
   }
 
@@ -299,35 +361,139 @@ Status GRPCSinkNode::SplitAndSendBatch(ExecState* exec_state, const RowBatch& rb
                       rb.Slice(batch_idx, rb.num_rows() - batch_idx));
   output_rb->set_eos(rb.eos());
   output_rb->set_eow(rb.eow());
-  return ConsumeNextImplNoSplit(exec_state, *output_rb, parent_idx);
+  return SendBatchNoSplit(exec_state, *output_rb, dest);
+}
+
+template <types::DataType T>
+void CombineColumnHashes(const arrow::Array* col, std::vector<uint64_t>* hashes) {
+  for (int64_t row = 0; row < col->length(); ++row) {
+    // Equal values must go to the same partition, so the canonical bytes of the value are hashed.
+    WithValueBytes<T>(col, row, [&](std::string_view bytes) {
+      (*hashes)[row] = HashCombine((*hashes)[row], ::util::Hash64(bytes.data(), bytes.size()));
+    });
+  }
+}
+
+StatusOr<std::vector<std::unique_ptr<RowBatch>>> GRPCSinkNode::PartitionBatch(
+    const RowBatch& rb) const {
+  std::vector<uint64_t> hashes(rb.num_rows(), 0);
+  for (int64_t col_idx : plan_node_->partition_column_idxs()) {
+    auto col = rb.ColumnAt(col_idx).get();
+#define TYPE_CASE(_dt_) CombineColumnHashes<_dt_>(col, &hashes);
+    PX_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+
+  std::vector<std::vector<int64_t>> partition_rows(destinations_.size());
+  for (int64_t row = 0; row < rb.num_rows(); ++row) {
+    partition_rows[hashes[row] % destinations_.size()].push_back(row);
+  }
+
+  std::vector<std::unique_ptr<RowBatch>> partitions;
+  for (const auto& rows : partition_rows) {
+    PX_ASSIGN_OR_RETURN(auto output_rb, TakeRows(rb, rows));
+    partitions.push_back(std::move(output_rb));
+  }
+  return partitions;
+}
+
+Status GRPCSinkNode::AddToSemiJoinFilter(const RowBatch& rb) {
+  int64_t col_idx = plan_node_->semi_join_build().column_idx();
+  auto col = rb.ColumnAt(col_idx).get();
+#define TYPE_CASE(_dt_) InsertIntoBloomFilter<_dt_>(col, semi_join_filter_->bloom_filter.get());
+  PX_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  if (rb.eos()) {
+    semi_join_filter_->complete = true;
+  }
+  return Status::OK();
+}
+
+Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t) {
+  if (semi_join_filter_ != nullptr) {
+    PX_RETURN_IF_ERROR(AddToSemiJoinFilter(rb));
+  }
+
+  if (!plan_node_->is_partitioned()) {
+    return SendBatch(exec_state, rb, &destinations_[0]);
+  }
+
+  PX_ASSIGN_OR_RETURN(auto partitions, PartitionBatch(rb));
+  // The end of the stream closes the stream to each destination, so a failure to send it to one
+  // destination must not leave the others open. The first error is returned once all are closed.
+  Status status;
+  for (const auto& [idx, partition_rb] : Enumerate(partitions)) {
+    // Empty partitions are only sent when they end a window or the stream, which every
+    // destination needs to see.
+    if (partition_rb->num_rows() == 0 && !rb.eow() && !rb.eos()) {
+      continue;
+    }
+    Status s = SendBatch(exec_state, *partition_rb, &destinations_[idx]);
+    if (!s.ok() && !rb.eos()) {
+      return s;
+    }
+    if (!s.ok() && status.ok()) {
+      status = s;
+    }
+  }
+  return status;
+}
+
+Status GRPCSinkNode::FlushPendingBatches(ExecState* exec_state, Destination* dest) {
+  if (dest->pending_batches.empty()) {
+    return Status::OK();
+  }
+  PX_ASSIGN_OR_RETURN(auto rb, ConcatRowBatches(dest->pending_batches));
+  num_coalesced_batches_ += dest->pending_batches.size();
+  dest->pending_batches.clear();
+  dest->pending_bytes = 0;
+  return SendBatchNoSplit(exec_state, *rb, dest);
 }
 
-Status GRPCSinkNode::ConsumeNextImpl(ExecState* exec_state, const RowBatch& rb, size_t parent_idx) {
-  if (rb.NumBytes() > (max_batch_size_ * batch_size_factor_)) {
-    return SplitAndSendBatch(exec_state, rb, parent_idx);
+Status GRPCSinkNode::SendBatch(ExecState* exec_state, const RowBatch& rb, Destination* dest) {
+  int64_t max_bytes = max_batch_size_ * batch_size_factor_;
+  // While the destination is applying flow control, small batches are held back and sent together
+  // so that the receiver gets fewer, larger messages. Batches that end a window or the stream are
+  // never held back.
+  bool coalesce = !rb.eow() && !rb.eos() && rb.NumBytes() < max_bytes;
+  if (coalesce && dest->backpressured && dest->pending_bytes + rb.NumBytes() <= max_bytes) {
+    dest->pending_batches.push_back(std::make_unique<RowBatch>(rb));
+    dest->pending_bytes += rb.NumBytes();
+    return Status::OK();
+  }
+  PX_RETURN_IF_ERROR(FlushPendingBatches(exec_state, dest));
+  if (coalesce && dest->backpressured) {
+    dest->pending_batches.push_back(std::make_unique<RowBatch>(rb));
+    dest->pending_bytes = rb.NumBytes();
+    return Status::OK();
+  }
+
+  if (rb.NumBytes() > max_bytes) {
+    return SplitAndSendBatch(exec_state, rb, dest);
   }
-  return ConsumeNextImplNoSplit(exec_state, rb, parent_idx);
+  return SendBatchNoSplit(exec_state, rb, dest);
 }
 
-Status GRPCSinkNode::ConsumeNextImplNoSplit(ExecState* exec_state, const RowBatch& rb, size_t) {
-  PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(plan_node_.get(), exec_state));
+Status GRPCSinkNode::SendBatchNoSplit(ExecState* exec_state, const RowBatch& rb,
+                                      Destination* dest) {
+  PX_ASSIGN_OR_RETURN(auto req, RequestWithMetadata(*dest, exec_state));
   // Serialize the RowBatch.
   PX_RETURN_IF_ERROR(rb.ToProto(req.mutable_query_result()->mutable_row_batch()));
 
-  PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req));
+  PX_RETURN_IF_ERROR(TryWriteRequest(exec_state, req, dest));
 
   if (!rb.eos()) {
     return Status::OK();
   }
 
-  PX_RETURN_IF_ERROR(CloseWriter(exec_state));
+  PX_RETURN_IF_ERROR(CloseWriter(exec_state, dest));
   sent_eos_ = true;
 
-  return response_.success()
+  return dest->response.success()
              ? Status::OK()
              : error::Internal(absl::Substitute(
                    "GRPCSinkNode $0 encountered error sending stream to address $1, message: $2",
-                   plan_node_->id(), plan_node_->address(), response_.message()));
+                   plan_node_->id(), dest->address, dest->response.message()));
 }
 
 }  // namespace exec
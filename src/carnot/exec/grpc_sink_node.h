@@ -51,6 +51,13 @@ constexpr float kBatchSizeFactor = 0.9f;
 // Number of times to retry connecting to grpc before giving up.
 constexpr size_t kGRPCRetries = 3;
 
+// A write that blocks for longer than this means the receiver has run out of buffer for the
+// query and is applying flow control. The sink then coalesces small batches into larger ones until
+// writes are fast again.
+constexpr std::chrono::milliseconds kBackpressureWriteLatency{5};
+// Coalesced batches are sent once they have waited this long, even if they are still small.
+constexpr std::chrono::milliseconds kMaxCoalesceDelay{100};
+
 class GRPCSinkNode : public SinkNode {
  public:
   GRPCSinkNode(size_t max_batch_size, float batch_size_factor)
@@ -65,7 +72,7 @@ class GRPCSinkNode : public SinkNode {
     connection_check_timeout_ = timeout;
   }
   const std::chrono::time_point<std::chrono::system_clock>& testing_last_send_time() const {
-    return last_send_time_;
+    return destinations_[0].last_send_time;
   }
 
  protected:
@@ -76,37 +83,67 @@ class GRPCSinkNode : public SinkNode {
   Status CloseImpl(ExecState* exec_state) override;
   Status ConsumeNextImpl(ExecState* exec_state, const table_store::schema::RowBatch& rb,
                          size_t parent_index) override;
-  Status ConsumeNextImplNoSplit(ExecState* exec_state, const table_store::schema::RowBatch& rb,
-                                size_t parent_index);
-  Status SplitAndSendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
-                           size_t parent_index);
   std::vector<int64_t> SplitBatchSizes(bool has_string_col,
                                        const std::vector<int64_t>& string_col_row_sizes,
                                        int64_t other_col_row_size) const;
+  // Splits the row batch into one row batch per partition, by the hash of the partition columns.
+  StatusOr<std::vector<std::unique_ptr<table_store::schema::RowBatch>>> PartitionBatch(
+      const table_store::schema::RowBatch& rb) const;
 
  private:
-  Status CloseWriter(ExecState* exec_state);
-  Status StartConnection(ExecState* exec_state);
-  Status StartConnectionWithRetries(ExecState* exec_state, size_t n_retries);
-  Status CancelledByServer(ExecState* exec_state);
-  Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req);
+  // A stream to one of the destinations of the sink. Partitioned sinks have one destination per
+  // partition, all other sinks have a single destination.
+  struct Destination {
+    std::string address;
+    std::string ssl_targetname;
+    // Only used by sinks that send to a GRPC source.
+    int64_t grpc_source_id = 0;
+
+    std::unique_ptr<grpc::ClientContext> context;
+    carnotpb::TransferResultChunkResponse response;
+    carnotpb::ResultSinkService::StubInterface* stub = nullptr;
+    std::unique_ptr<grpc::ClientWriterInterface<carnotpb::TransferResultChunkRequest>> writer;
+    std::chrono::time_point<std::chrono::system_clock> last_send_time;
+
+    // Set when the last write to this destination was slowed down by flow control.
+    bool backpressured = false;
+    // Small batches waiting to be sent as one while the destination is backpressured.
+    std::vector<std::unique_ptr<table_store::schema::RowBatch>> pending_batches;
+    int64_t pending_bytes = 0;
+  };
+
+  StatusOr<carnotpb::TransferResultChunkRequest> RequestWithMetadata(const Destination& dest,
+                                                                     ExecState* exec_state) const;
+  Status SendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                   Destination* dest);
+  Status SendBatchNoSplit(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                          Destination* dest);
+  Status SplitAndSendBatch(ExecState* exec_state, const table_store::schema::RowBatch& rb,
+                           Destination* dest);
+  Status FlushPendingBatches(ExecState* exec_state, Destination* dest);
+  Status CloseWriter(ExecState* exec_state, Destination* dest);
+  Status StartConnection(ExecState* exec_state, Destination* dest);
+  Status StartConnectionWithRetries(ExecState* exec_state, Destination* dest, size_t n_retries);
+  Status CancelledByServer(ExecState* exec_state, const Destination& dest);
+  Status TryWriteRequest(ExecState* exec_state, const carnotpb::TransferResultChunkRequest& req,
+                         Destination* dest);
+  Status AddToSemiJoinFilter(const table_store::schema::RowBatch& rb);
 
   bool cancelled_ = false;
 
-  std::unique_ptr<grpc::ClientContext> context_;
-  carnotpb::TransferResultChunkResponse response_;
-
-  carnotpb::ResultSinkService::StubInterface* stub_;
-  std::unique_ptr<grpc::ClientWriterInterface<carnotpb::TransferResultChunkRequest>> writer_;
+  std::vector<Destination> destinations_;
+  // Owned by the exec state. Only set when this sink builds a semi-join filter.
+  SemiJoinFilter* semi_join_filter_ = nullptr;
 
   std::unique_ptr<plan::GRPCSinkOperator> plan_node_;
   std::unique_ptr<table_store::schema::RowDescriptor> input_descriptor_;
 
   std::chrono::milliseconds connection_check_timeout_ = kDefaultConnectionCheckTimeoutMS;
-  std::chrono::time_point<std::chrono::system_clock> last_send_time_;
 
   size_t max_batch_size_;
   float batch_size_factor_;
+
+  int64_t num_coalesced_batches_ = 0;
 };
 
 }  // namespace exec
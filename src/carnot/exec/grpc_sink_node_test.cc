@@ -18,9 +18,12 @@
 
 #include "src/carnot/exec/grpc_sink_node.h"
 
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <google/protobuf/text_format.h>
 #include <grpcpp/test/mock_stream.h>
 #include <gtest/gtest.h>
 #include <sole.hpp>
@@ -763,6 +766,319 @@ TEST_F(GRPCSinkNodeTest, check_connection_after_eos) {
   tester.Close();
 }
 
+// Returns a Write action that records the request and takes longer than the sink's backpressure
+// threshold, as a write that is blocked by flow control would.
+auto SlowWrite(std::vector<TransferResultChunkRequest>* requests) {
+  return Invoke([requests](const TransferResultChunkRequest& req, grpc::WriteOptions) {
+    requests->push_back(req);
+    std::this_thread::sleep_for(2 * kBackpressureWriteLatency);
+    return true;
+  });
+}
+
+std::vector<int64_t> RowBatchInt64Data(const TransferResultChunkRequest& req) {
+  const auto& data = req.query_result().row_batch().cols(0).int64_data().data();
+  return std::vector<int64_t>(data.begin(), data.end());
+}
+
+TEST_F(GRPCSinkNodeTest, coalesce_while_backpressured) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto.grpc_sink_op()));
+  RowDescriptor input_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> requests;
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _)).WillRepeatedly(SlowWrite(&requests));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  // Each batch below has 2 int64 rows, so 16 bytes, and at most 2 of them fit in 40 bytes.
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, input_rd, {input_rd}, exec_state_.get(), /*max_batch_size*/ 40,
+      /*batch_size_factor*/ 1.0f);
+  // Only the initiate stream request has been sent.
+  ASSERT_EQ(1, requests.size());
+
+  auto consume = [&](int64_t val, bool eos) {
+    tester.ConsumeNext(RowBatchBuilder(input_rd, 2, /*eow*/ eos, eos)
+                           .AddColumn<types::Int64Value>({val, val})
+                           .get(),
+                       0, 0);
+  };
+
+  // The first batch is sent right away, and its slow write marks the destination as
+  // backpressured.
+  consume(1, /*eos*/ false);
+  EXPECT_EQ(2, requests.size());
+
+  // While backpressured, small batches are held back.
+  consume(2, /*eos*/ false);
+  consume(3, /*eos*/ false);
+  EXPECT_EQ(2, requests.size());
+
+  // The next batch would go over the max batch size, so the held batches are sent as one.
+  consume(4, /*eos*/ false);
+  ASSERT_EQ(3, requests.size());
+  EXPECT_EQ(std::vector<int64_t>({2, 2, 3, 3}), RowBatchInt64Data(requests[2]));
+  EXPECT_EQ(4, requests[2].query_result().row_batch().num_rows());
+
+  // The end of stream is never held back, and flushes the batches held before it.
+  consume(5, /*eos*/ true);
+  ASSERT_EQ(5, requests.size());
+  EXPECT_EQ(std::vector<int64_t>({4, 4}), RowBatchInt64Data(requests[3]));
+  EXPECT_FALSE(requests[3].query_result().row_batch().eos());
+  EXPECT_EQ(std::vector<int64_t>({5, 5}), RowBatchInt64Data(requests[4]));
+  EXPECT_TRUE(requests[4].query_result().row_batch().eow());
+  EXPECT_TRUE(requests[4].query_result().row_batch().eos());
+
+  tester.Close();
+}
+
+TEST_F(GRPCSinkNodeTest, coalesced_batches_flushed_after_delay) {
+  auto op_proto = planpb::testutils::CreateTestGRPCSink1PB();
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto.grpc_sink_op()));
+  RowDescriptor input_rd({types::DataType::INT64});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<TransferResultChunkRequest> requests;
+  auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+  EXPECT_CALL(*writer, Write(_, _)).WillRepeatedly(SlowWrite(&requests));
+  EXPECT_CALL(*writer, WritesDone());
+  EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+  EXPECT_CALL(*mock_, TransferResultChunkRaw(_, _))
+      .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, input_rd, {input_rd}, exec_state_.get());
+
+  for (int64_t val : {1, 2}) {
+    tester.ConsumeNext(RowBatchBuilder(input_rd, 1, /*eow*/ false, /*eos*/ false)
+                           .AddColumn<types::Int64Value>({val})
+                           .get(),
+                       0, 0);
+  }
+  // The first batch made the destination backpressured, so the second one is held back.
+  ASSERT_EQ(2, requests.size());
+
+  // Held batches are not sent before they have waited kMaxCoalesceDelay.
+  EXPECT_OK(tester.node()->OptionallyCheckConnection(exec_state_.get()));
+  EXPECT_EQ(2, requests.size());
+
+  std::this_thread::sleep_for(kMaxCoalesceDelay + std::chrono::milliseconds(10));
+  EXPECT_OK(tester.node()->OptionallyCheckConnection(exec_state_.get()));
+  ASSERT_EQ(3, requests.size());
+  EXPECT_EQ(std::vector<int64_t>({2}), RowBatchInt64Data(requests[2]));
+
+  tester.Close();
+}
+
+constexpr char kPartitionedSinkOperator[] = R"proto(
+partitions {
+  address: "kelvin1:1234"
+  grpc_source_id: 1
+}
+partitions {
+  address: "kelvin2:1234"
+  grpc_source_id: 2
+}
+partition_column_idxs: 0
+)proto";
+
+TEST(GRPCSinkNodePartitionTest, partitioned_result) {
+  planpb::GRPCSinkOperator op_proto;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString(kPartitionedSinkOperator, &op_proto));
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+
+  TransferResultChunkResponse resp;
+  resp.set_success(true);
+
+  std::vector<std::string> addresses = {"kelvin1:1234", "kelvin2:1234"};
+  absl::flat_hash_map<std::string, std::unique_ptr<MockResultSinkServiceStub>> stubs;
+  std::vector<std::vector<TransferResultChunkRequest>> requests(addresses.size());
+  for (const auto& [idx, address] : Enumerate(addresses)) {
+    auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+    auto* partition_requests = &requests[idx];
+    EXPECT_CALL(*writer, Write(_, _))
+        .WillRepeatedly(DoAll(Invoke([partition_requests](const TransferResultChunkRequest& req,
+                                                          grpc::WriteOptions) {
+                                partition_requests->push_back(req);
+                              }),
+                              Return(true)));
+    EXPECT_CALL(*writer, WritesDone());
+    EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+
+    auto stub = std::make_unique<MockResultSinkServiceStub>();
+    EXPECT_CALL(*stub, TransferResultChunkRaw(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+    stubs[address] = std::move(stub);
+  }
+
+  auto func_registry = std::make_unique<udf::Registry>("test_registry");
+  auto exec_state = std::make_unique<ExecState>(
+      func_registry.get(), std::make_shared<table_store::TableStore>(),
+      [&stubs](const std::string& address,
+               const std::string&) -> std::unique_ptr<ResultSinkService::StubInterface> {
+        return std::move(stubs[address]);
+      },
+      MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+      [](grpc::ClientContext*) {});
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, RowDescriptor({}), {input_rd}, exec_state.get());
+
+  auto rb1 = RowBatchBuilder(input_rd, 6, /*eow*/ false, /*eos*/ false)
+                 .AddColumn<types::Int64Value>({1, 2, 3, 4, 5, 6})
+                 .AddColumn<types::StringValue>({"a", "b", "c", "d", "e", "f"})
+                 .get();
+  tester.ConsumeNext(rb1, 0, 0);
+  auto rb2 = RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                 .AddColumn<types::Int64Value>({3, 2, 1})
+                 .AddColumn<types::StringValue>({"g", "h", "i"})
+                 .get();
+  tester.ConsumeNext(rb2, 0, 0);
+  tester.Close();
+
+  // Every row is sent to exactly one partition, and rows with the same partition key are always
+  // sent to the same partition.
+  int64_t total_rows = 0;
+  absl::flat_hash_map<int64_t, size_t> key_to_partition;
+  for (const auto& [idx, partition_requests] : Enumerate(requests)) {
+    ASSERT_GE(partition_requests.size(), 2);
+    for (const auto& req : partition_requests) {
+      EXPECT_EQ(addresses[idx], req.address());
+      EXPECT_EQ(idx + 1, req.query_result().grpc_source_id());
+      const auto& row_batch = req.query_result().row_batch();
+      total_rows += row_batch.num_rows();
+      for (int64_t key : row_batch.cols(0).int64_data().data()) {
+        auto [it, inserted] = key_to_partition.try_emplace(key, idx);
+        EXPECT_EQ(idx, it->second);
+      }
+    }
+    // Every partition receives the end of stream.
+    EXPECT_TRUE(partition_requests.back().query_result().row_batch().eos());
+  }
+  EXPECT_EQ(9, total_rows);
+  EXPECT_EQ(6, key_to_partition.size());
+}
+
+// Creates the stubs of the destinations of kPartitionedSinkOperator. Each stream responds with
+// the given success, records the requests it receives and expects to be closed exactly once.
+absl::flat_hash_map<std::string, std::unique_ptr<MockResultSinkServiceStub>> PartitionStubs(
+    const std::vector<bool>& success,
+    std::vector<std::vector<TransferResultChunkRequest>>* requests) {
+  std::vector<std::string> addresses = {"kelvin1:1234", "kelvin2:1234"};
+  requests->resize(addresses.size());
+  absl::flat_hash_map<std::string, std::unique_ptr<MockResultSinkServiceStub>> stubs;
+  for (const auto& [idx, address] : Enumerate(addresses)) {
+    TransferResultChunkResponse resp;
+    resp.set_success(success[idx]);
+    auto writer = new grpc::testing::MockClientWriter<TransferResultChunkRequest>();
+    auto* partition_requests = &(*requests)[idx];
+    EXPECT_CALL(*writer, Write(_, _))
+        .WillRepeatedly(DoAll(Invoke([partition_requests](const TransferResultChunkRequest& req,
+                                                          grpc::WriteOptions) {
+                                partition_requests->push_back(req);
+                              }),
+                              Return(true)));
+    EXPECT_CALL(*writer, WritesDone()).Times(1);
+    EXPECT_CALL(*writer, Finish()).WillOnce(Return(grpc::Status::OK));
+
+    auto stub = std::make_unique<MockResultSinkServiceStub>();
+    EXPECT_CALL(*stub, TransferResultChunkRaw(_, _))
+        .WillOnce(DoAll(SetArgPointee<1>(resp), Return(writer)));
+    stubs[address] = std::move(stub);
+  }
+  return stubs;
+}
+
+std::unique_ptr<ExecState> PartitionExecState(
+    udf::Registry* func_registry,
+    absl::flat_hash_map<std::string, std::unique_ptr<MockResultSinkServiceStub>>* stubs) {
+  return std::make_unique<ExecState>(
+      func_registry, std::make_shared<table_store::TableStore>(),
+      [stubs](const std::string& address,
+              const std::string&) -> std::unique_ptr<ResultSinkService::StubInterface> {
+        return std::move((*stubs)[address]);
+      },
+      MockMetricsStubGenerator, MockTraceStubGenerator, sole::uuid4(), nullptr, nullptr,
+      [](grpc::ClientContext*) {});
+}
+
+TEST(GRPCSinkNodePartitionTest, signed_zeros_in_same_partition) {
+  planpb::GRPCSinkOperator op_proto;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString(kPartitionedSinkOperator, &op_proto));
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto));
+  RowDescriptor input_rd({types::DataType::FLOAT64});
+
+  std::vector<std::vector<TransferResultChunkRequest>> requests;
+  auto stubs = PartitionStubs({true, true}, &requests);
+  auto func_registry = std::make_unique<udf::Registry>("test_registry");
+  auto exec_state = PartitionExecState(func_registry.get(), &stubs);
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, RowDescriptor({}), {input_rd}, exec_state.get());
+  auto rb = RowBatchBuilder(input_rd, 4, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Float64Value>({0.0, -0.0, 0.0, -0.0})
+                .get();
+  tester.ConsumeNext(rb, 0, 0);
+  tester.Close();
+
+  // All of the rows are sent to the same partition.
+  std::vector<int64_t> rows_per_partition;
+  for (const auto& partition_requests : requests) {
+    int64_t num_rows = 0;
+    for (const auto& req : partition_requests) {
+      num_rows += req.query_result().row_batch().num_rows();
+    }
+    rows_per_partition.push_back(num_rows);
+  }
+  EXPECT_THAT(rows_per_partition, ::testing::UnorderedElementsAre(0, 4));
+}
+
+TEST(GRPCSinkNodePartitionTest, eos_closes_all_partitions_on_error) {
+  planpb::GRPCSinkOperator op_proto;
+  ASSERT_TRUE(
+      google::protobuf::TextFormat::ParseFromString(kPartitionedSinkOperator, &op_proto));
+  auto plan_node = std::make_unique<plan::GRPCSinkOperator>(1);
+  ASSERT_OK(plan_node->Init(op_proto));
+  RowDescriptor input_rd({types::DataType::INT64, types::DataType::STRING});
+
+  // The first destination fails the stream, which must not keep the second one from receiving
+  // the end of stream and being closed.
+  std::vector<std::vector<TransferResultChunkRequest>> requests;
+  auto stubs = PartitionStubs({false, true}, &requests);
+  auto func_registry = std::make_unique<udf::Registry>("test_registry");
+  auto exec_state = PartitionExecState(func_registry.get(), &stubs);
+
+  auto tester = exec::ExecNodeTester<GRPCSinkNode, plan::GRPCSinkOperator>(
+      *plan_node, RowDescriptor({}), {input_rd}, exec_state.get());
+  auto rb = RowBatchBuilder(input_rd, 3, /*eow*/ true, /*eos*/ true)
+                .AddColumn<types::Int64Value>({1, 2, 3})
+                .AddColumn<types::StringValue>({"a", "b", "c"})
+                .get();
+  EXPECT_NOT_OK(tester.node()->ConsumeNext(exec_state.get(), rb, 0));
+  tester.Close();
+
+  for (const auto& partition_requests : requests) {
+    ASSERT_FALSE(partition_requests.empty());
+    EXPECT_TRUE(partition_requests.back().query_result().row_batch().eos());
+  }
+}
+
 }  // namespace exec
 }  // namespace carnot
 }  // namespace px
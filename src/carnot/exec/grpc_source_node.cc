@@ -22,6 +22,7 @@
 #include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
 #include "src/carnot/planpb/plan.pb.h"
@@ -47,7 +48,11 @@ Status GRPCSourceNode::PrepareImpl(ExecState*) { return Status::OK(); }
 
 Status GRPCSourceNode::OpenImpl(ExecState*) { return Status::OK(); }
 
-Status GRPCSourceNode::CloseImpl(ExecState*) { return Status::OK(); }
+Status GRPCSourceNode::CloseImpl(ExecState*) {
+  stats()->AddExtraInfo("peak_queued_batches", absl::StrCat(peak_queued_batches_.load()));
+  stats()->AddExtraInfo("peak_queued_bytes", absl::StrCat(peak_queued_bytes_.load()));
+  return Status::OK();
+}
 
 Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
   PX_RETURN_IF_ERROR(PopRowBatch());
@@ -57,9 +62,19 @@ Status GRPCSourceNode::GenerateNextImpl(ExecState* exec_state) {
 
 Status GRPCSourceNode::EnqueueRowBatch(
     std::unique_ptr<carnotpb::TransferResultChunkRequest> row_batch) {
+  int64_t num_bytes = row_batch->ByteSizeLong();
   if (!row_batch_queue_.enqueue(std::move(row_batch))) {
     return error::Internal("Failed to enqueue RowBatch");
   }
+  int64_t queued_bytes = queued_bytes_ += num_bytes;
+  int64_t queued_batches = ++queued_batches_;
+  // Only the GRPCRouter enqueues, and it holds a lock for this source while doing so.
+  if (queued_bytes > peak_queued_bytes_) {
+    peak_queued_bytes_ = queued_bytes;
+  }
+  if (queued_batches > peak_queued_batches_) {
+    peak_queued_batches_ = queued_batches;
+  }
   return Status::OK();
 }
 
@@ -72,6 +87,12 @@ Status GRPCSourceNode::PopRowBatch() {
         "Called GRPCSourceNode::OptionallyPopRowBatch but there was no available row batch in the "
         "queue.");
   }
+  int64_t num_bytes = rb_request->ByteSizeLong();
+  queued_bytes_ -= num_bytes;
+  --queued_batches_;
+  if (release_buffer_func_) {
+    release_buffer_func_(num_bytes);
+  }
   if (!rb_request->has_query_result() || !rb_request->query_result().has_row_batch()) {
     return error::Internal(
         "GRPCSourceNode::PopRowBatch expected TransferResultChunkRequest to have RowBatch "
@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -56,6 +58,13 @@ class GRPCSourceNode : public SourceNode {
   void set_upstream_closed_connection() { upstream_closed_connection_ = true; }
   bool upstream_closed_connection() const { return upstream_closed_connection_; }
 
+  // Called with the size of every row batch request once it has been taken off the queue, so that
+  // the GRPCRouter can give the buffer space back to the senders of the query.
+  void set_release_buffer_func(std::function<void(int64_t)> release_buffer_func) {
+    release_buffer_func_ = std::move(release_buffer_func);
+  }
+  int64_t queued_bytes() const { return queued_bytes_; }
+
  protected:
   std::string DebugStringImpl() override;
   Status InitImpl(const plan::Operator& plan_node) override;
@@ -72,6 +81,13 @@ class GRPCSourceNode : public SourceNode {
       row_batch_queue_;
 
   std::unique_ptr<plan::GRPCSourceOperator> plan_node_;
+  std::function<void(int64_t)> release_buffer_func_;
+  // Queue depth, updated by the GRPCRouter threads that enqueue and the exec thread that dequeues.
+  std::atomic<int64_t> queued_bytes_ = 0;
+  std::atomic<int64_t> queued_batches_ = 0;
+  std::atomic<int64_t> peak_queued_bytes_ = 0;
+  std::atomic<int64_t> peak_queued_batches_ = 0;
+
   bool upstream_initiated_connection_ = false;
   bool upstream_closed_connection_ = false;
 };
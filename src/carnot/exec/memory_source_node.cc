@@ -21,10 +21,13 @@
 
 #include <limits>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <absl/strings/str_cat.h>
 #include <absl/strings/substitute.h>
 
+#include "src/carnot/exec/row_batch_utils.h"
 #include "src/carnot/planpb/plan.pb.h"
 #include "src/common/base/base.h"
 
@@ -87,14 +90,38 @@ Status MemorySourceNode::OpenImpl(ExecState* exec_state) {
   }
   cursor_ = std::make_unique<Table::Cursor>(table_, start_spec, stop_spec);
 
+  if (plan_node_->has_semi_join_probe()) {
+    // If no node in this plan builds the filter, the source returns all of its rows.
+    semi_join_filter_ = exec_state->GetSemiJoinFilter(plan_node_->semi_join_probe().id());
+  }
+
   return Status::OK();
 }
 
 Status MemorySourceNode::CloseImpl(ExecState*) {
   stats()->AddExtraInfo("streaming", streaming_ ? "true" : "false");
+  if (semi_join_filter_ != nullptr) {
+    stats()->AddExtraInfo("semi_join_rows_dropped", absl::StrCat(semi_join_rows_dropped_));
+  }
   return Status::OK();
 }
 
+StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::ApplySemiJoinFilter(
+    std::unique_ptr<RowBatch> row_batch) {
+  int64_t col_idx = plan_node_->semi_join_probe().column_idx();
+  auto col = row_batch->ColumnAt(col_idx).get();
+  std::vector<int64_t> matched_rows;
+#define TYPE_CASE(_dt_) \
+  ProbeBloomFilter<_dt_>(col, *semi_join_filter_->bloom_filter, &matched_rows);
+  PX_SWITCH_FOREACH_DATATYPE(row_batch->desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  if (static_cast<int64_t>(matched_rows.size()) == row_batch->num_rows()) {
+    return row_batch;
+  }
+  semi_join_rows_dropped_ += row_batch->num_rows() - matched_rows.size();
+  return TakeRows(*row_batch, matched_rows);
+}
+
 StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*) {
   DCHECK(table_ != nullptr);
 
@@ -120,6 +147,9 @@ StatusOr<std::unique_ptr<RowBatch>> MemorySourceNode::GetNextRowBatch(ExecState*
     row_batch->set_eow(true);
     row_batch->set_eos(true);
   }
+  if (semi_join_filter_ != nullptr) {
+    return ApplySemiJoinFilter(std::move(row_batch));
+  }
   return row_batch;
 }
 
@@ -134,6 +164,10 @@ bool MemorySourceNode::InfiniteStreamNextBatchReady() { return cursor_->NextBatc
 bool MemorySourceNode::NextBatchReady() {
   // Next batch is ready if we haven't seen an eow and if it's an infinite_stream that has batches
   // to push.
+  // Sources that probe a semi-join filter also wait until the filter has been fully built.
+  if (semi_join_filter_ != nullptr && !semi_join_filter_->complete) {
+    return false;
+  }
   return HasBatchesRemaining() && (!streaming_ || InfiniteStreamNextBatchReady());
 }
 
@@ -57,6 +57,8 @@ class MemorySourceNode : public SourceNode {
  private:
   StatusOr<std::unique_ptr<RowBatch>> GetNextRowBatch(ExecState* exec_state);
   bool InfiniteStreamNextBatchReady();
+  // Drops the rows whose key can't be in the semi-join filter.
+  StatusOr<std::unique_ptr<RowBatch>> ApplySemiJoinFilter(std::unique_ptr<RowBatch> row_batch);
   // Whether this memory source will stream future results.
   bool streaming_ = false;
 
@@ -64,6 +66,10 @@ class MemorySourceNode : public SourceNode {
 
   std::unique_ptr<plan::MemorySourceOperator> plan_node_;
   table_store::Table* table_ = nullptr;
+
+  // Owned by the exec state. Only set when this source probes a semi-join filter.
+  SemiJoinFilter* semi_join_filter_ = nullptr;
+  int64_t semi_join_rows_dropped_ = 0;
 };
 
 }  // namespace exec
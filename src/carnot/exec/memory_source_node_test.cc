@@ -20,6 +20,7 @@
 
 #include <arrow/memory_pool.h>
 #include <memory>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -107,6 +108,40 @@ TEST_F(MemorySourceNodeTest, basic) {
   EXPECT_EQ(sizeof(int64_t) * 5, tester.node()->BytesProcessed());
 }
 
+TEST_F(MemorySourceNodeTest, semi_join_probe) {
+  auto op_proto = planpb::testutils::CreateTestSource1PB();
+  auto probe = op_proto.mutable_mem_source_op()->mutable_semi_join_probe();
+  probe->set_id(1);
+  probe->set_column_idx(0);
+  std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
+  RowDescriptor output_rd({types::DataType::TIME64NS});
+
+  ASSERT_OK_AND_ASSIGN(auto filter, exec_state_->CreateSemiJoinFilter(1));
+  for (int64_t key : {2, 6}) {
+    filter->bloom_filter->Insert(
+        std::string_view(reinterpret_cast<const char*>(&key), sizeof(key)));
+  }
+
+  auto tester = exec::ExecNodeTester<MemorySourceNode, plan::MemorySourceOperator>(
+      *plan_node, output_rd, std::vector<RowDescriptor>({}), exec_state_.get());
+  // The source waits until the build side of the join has finished the filter.
+  EXPECT_FALSE(tester.node()->NextBatchReady());
+  filter->complete = true;
+  EXPECT_TRUE(tester.node()->NextBatchReady());
+
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 1, /*eow*/ false, /*eos*/ false)
+          .AddColumn<types::Time64NSValue>({2})
+          .get());
+  tester.GenerateNextResult().ExpectRowBatch(
+      RowBatchBuilder(output_rd, 1, /*eow*/ true, /*eos*/ true)
+          .AddColumn<types::Time64NSValue>({6})
+          .get());
+  EXPECT_FALSE(tester.node()->HasBatchesRemaining());
+  tester.Close();
+  EXPECT_EQ(5, tester.node()->RowsProcessed());
+}
+
 TEST_F(MemorySourceNodeTest, empty_table) {
   auto op_proto = planpb::testutils::CreateTestSource1PB("empty");
   std::unique_ptr<plan::Operator> plan_node = plan::MemorySourceOperator::FromProto(op_proto, 1);
@@ -18,6 +18,10 @@
 
 #include "src/carnot/exec/ml/transformer_executor.h"
 
+DEFINE_int32(carnot_ml_inference_threads,
+             gflags::Int32FromEnv("PL_CARNOT_ML_INFERENCE_THREADS", 1),
+             "The number of threads each model executor uses for inference");
+
 namespace px {
 namespace carnot {
 namespace exec {
@@ -49,40 +53,72 @@ static int load_ints_from_json(std::string in, int32_t* arr, int max_num) {
   return count;
 }
 
+void TransformerExecutor::Init(std::string model_proto_path) {
+  model_ = tflite::FlatBufferModel::BuildFromFile(model_proto_path.c_str());
+  tflite::ops::builtin::BuiltinOpResolver resolver;
+  tflite::InterpreterBuilder(*model_, resolver)(&tf_interpreter_);
+  tf_interpreter_->SetNumThreads(FLAGS_carnot_ml_inference_threads);
+  if (!ResizeBatch(1)) {
+    LOG(INFO) << "Failed to allocate tensors";
+  } else {
+    LOG(INFO) << "Init Transformer model";
+  }
+}
+
+bool TransformerExecutor::ResizeBatch(int batch_size) {
+  if (batch_size == batch_size_) {
+    return true;
+  }
+  tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0], {batch_size, max_length_});
+  if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
+    batch_size_ = 0;
+    return false;
+  }
+  batch_size_ = batch_size;
+  return true;
+}
+
 void TransformerExecutor::Execute(std::string doc, std::string* out) {
-  // LOG(INFO) << "inputs: " << tf_interpreter_->inputs().size() << "\n";
-  // LOG(INFO) << "input(0) name: " << tf_interpreter_->GetInputName(0) << "\n";
-
-  // int t_size = tf_interpreter_->tensors_size();
-  // for (int i = 0; i < t_size; i++) {
-  //   if (tf_interpreter_->tensor(i)->name) {
-  //     LOG(INFO) << i << ": " << tf_interpreter_->tensor(i)->name << ", "
-  //               << tf_interpreter_->tensor(i)->bytes << ", "
-  //               << tf_interpreter_->tensor(i)->type;
-  //   }
-  // }
+  std::vector<std::string> embeddings;
+  ExecuteChunk({&doc}, &embeddings);
+  *out = std::move(embeddings[0]);
+}
+
+void TransformerExecutor::ExecuteChunk(const std::vector<const std::string*>& docs,
+                                       std::vector<std::string>* embeddings) {
+  embeddings->assign(docs.size(), "");
+  // The model is always run with the same batch size, except for the last chunk of a row batch,
+  // so the tensors are only reallocated when the batch size changes.
+  if (!ResizeBatch(static_cast<int>(docs.size()))) {
+    LOG(INFO) << "Failed to allocate tensors for a batch of " << docs.size();
+    return;
+  }
   auto input = tf_interpreter_->typed_input_tensor<int32_t>(0);
   if (input == nullptr) {
     LOG(INFO) << "Error getting typed input tensor, most likely using wrong type for this model";
-    *out = "";
     return;
   }
 
-  auto count = load_ints_from_json(doc, input, max_length_);
-  if (count == 0) {
-    // Either input array was empty or there was an error parsing the json, either way don't
-    // continue.
-    *out = "";
-    return;
-  }
+  std::vector<bool> valid(docs.size());
+  bool any_valid = false;
+  for (size_t doc_idx = 0; doc_idx < docs.size(); ++doc_idx) {
+    int32_t* doc_input = input + doc_idx * max_length_;
+    auto count = load_ints_from_json(*docs[doc_idx], doc_input, max_length_);
+    // An empty input array or a json parse error gets an empty embedding, the doc is still
+    // part of the batch but with all padding tokens.
+    valid[doc_idx] = count > 0;
+    any_valid |= valid[doc_idx];
 
-  // Add 1 to each token to account for pad token.
-  for (int i = 0; i < count; i++) {
-    input[i] = input[i] + 1;
+    // Add 1 to each token to account for pad token.
+    for (int i = 0; i < count; i++) {
+      doc_input[i] = doc_input[i] + 1;
+    }
+    for (int i = count; i < max_length_; i++) {
+      doc_input[i] = 0;
+    }
   }
-
-  for (int i = count; i < max_length_; i++) {
-    input[i] = 0;
+  if (!any_valid) {
+    return;
   }
 
   const int embedding_size = 256;
@@ -91,15 +127,21 @@ void TransformerExecutor::Execute(std::string doc, std::string* out) {
 
   auto output = tf_interpreter_->typed_output_tensor<float>(0);
 
-  // Copy output to json array.
-  rapidjson::StringBuffer sb;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
-  writer.StartArray();
-  for (int i = 0; i < embedding_size; i++) {
-    writer.Double(output[i]);
+  for (size_t doc_idx = 0; doc_idx < docs.size(); ++doc_idx) {
+    if (!valid[doc_idx]) {
+      continue;
+    }
+    const float* doc_output = output + doc_idx * embedding_size;
+    // Copy output to json array.
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartArray();
+    for (int i = 0; i < embedding_size; i++) {
+      writer.Double(doc_output[i]);
+    }
+    writer.EndArray();
+    (*embeddings)[doc_idx] = sb.GetString();
   }
-  writer.EndArray();
-  *out = sb.GetString();
 }
 
 }  // namespace ml
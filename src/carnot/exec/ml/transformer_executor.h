@@ -26,14 +26,25 @@
 #include <tensorflow/lite/model.h>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/types/span.h>
+#include <gflags/gflags.h>
+
 #include "src/carnot/udf/model_executor.h"
 #include "src/common/base/utils.h"
 
+DECLARE_int32(carnot_ml_inference_threads);
+
 namespace px {
 namespace carnot {
 namespace exec {
 namespace ml {
 
+// The maximum number of documents that are run through the model in a single inference.
+constexpr size_t kMaxInferenceBatchSize = 64;
+
 class TransformerExecutor : public udf::ModelExecutor {
  public:
   TransformerExecutor() : TransformerExecutor("/embedding.proto") {}
@@ -41,24 +52,44 @@ class TransformerExecutor : public udf::ModelExecutor {
 
   static constexpr udf::ModelType Type() { return udf::kTransformer; }
 
-  void Init(std::string model_proto_path) {
-    model_ = tflite::FlatBufferModel::BuildFromFile(model_proto_path.c_str());
-    tflite::ops::builtin::BuiltinOpResolver resolver;
-    tflite::InterpreterBuilder(*model_, resolver)(&tf_interpreter_);
-    tf_interpreter_->ResizeInputTensor(tf_interpreter_->inputs()[0], {1, max_length_});
-    if (tf_interpreter_->AllocateTensors() != kTfLiteOk) {
-      LOG(INFO) << "Failed to allocate tensors";
-    } else {
-      LOG(INFO) << "Init Transformer model";
-    }
-  }
+  void Init(std::string model_proto_path);
 
   void Execute(std::string doc, std::string* out);
 
+  /**
+   * Computes the embedding of each of the docs, which are JSON arrays of token ids. Docs are run
+   * through the model in batches of up to kMaxInferenceBatchSize.
+   * @param docs The tokenized documents.
+   * @param out The output embeddings, must have room for one per doc. Docs that can't be parsed
+   * get an empty embedding.
+   */
+  template <typename TString>
+  void ExecuteBatch(absl::Span<const TString> docs, TString* out) {
+    for (size_t offset = 0; offset < docs.size(); offset += kMaxInferenceBatchSize) {
+      auto chunk = docs.subspan(offset, kMaxInferenceBatchSize);
+      std::vector<const std::string*> chunk_docs(chunk.size());
+      for (size_t i = 0; i < chunk.size(); ++i) {
+        chunk_docs[i] = &chunk[i];
+      }
+      std::vector<std::string> embeddings;
+      ExecuteChunk(chunk_docs, &embeddings);
+      for (size_t i = 0; i < chunk.size(); ++i) {
+        out[offset + i] = std::move(embeddings[i]);
+      }
+    }
+  }
+
  private:
+  // Runs a single inference over up to kMaxInferenceBatchSize docs.
+  void ExecuteChunk(const std::vector<const std::string*>& docs,
+                    std::vector<std::string>* embeddings);
+  // Resizes the input tensor to hold batch_size docs, if it doesn't already.
+  bool ResizeBatch(int batch_size);
+
   std::unique_ptr<tflite::Interpreter> tf_interpreter_;
   std::unique_ptr<tflite::FlatBufferModel> model_;
   int max_length_ = 64;
+  int batch_size_ = 0;
 };
 
 }  // namespace ml
@@ -0,0 +1,189 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <arrow/array.h>
+#include <arrow/memory_pool.h>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "src/common/base/base.h"
+#include "src/shared/bloomfilter/bloomfilter.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+#include "src/table_store/schema/row_batch.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+/**
+ * Copies the given rows of the column into a new arrow array.
+ */
+template <types::DataType T>
+StatusOr<std::shared_ptr<arrow::Array>> TakeRows(const arrow::Array* col,
+                                                 const std::vector<int64_t>& rows) {
+  auto builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto* builder =
+      static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(builder_generic.get());
+  PX_RETURN_IF_ERROR(builder->Reserve(rows.size()));
+  if constexpr (T == types::DataType::STRING) {
+    int64_t total_size = 0;
+    for (int64_t row : rows) {
+      total_size += types::GetStringViewFromArrowArray(col, row).size();
+    }
+    PX_RETURN_IF_ERROR(builder->ReserveData(total_size));
+  }
+  for (int64_t row : rows) {
+    builder->UnsafeAppend(types::GetValueFromArrowArray<T>(col, row));
+  }
+  std::shared_ptr<arrow::Array> output_array;
+  PX_RETURN_IF_ERROR(builder->Finish(&output_array));
+  return output_array;
+}
+
+/**
+ * Copies the given rows of the row batch into a new row batch with the same eow/eos.
+ */
+inline StatusOr<std::unique_ptr<table_store::schema::RowBatch>> TakeRows(
+    const table_store::schema::RowBatch& rb, const std::vector<int64_t>& rows) {
+  auto output_rb = std::make_unique<table_store::schema::RowBatch>(rb.desc(), rows.size());
+  for (int64_t col_idx = 0; col_idx < rb.num_columns(); ++col_idx) {
+    auto col = rb.ColumnAt(col_idx).get();
+#define TYPE_CASE(_dt_)                                          \
+  PX_ASSIGN_OR_RETURN(auto output_col, TakeRows<_dt_>(col, rows)); \
+  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_col));
+    PX_SWITCH_FOREACH_DATATYPE(rb.desc().type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  output_rb->set_eow(rb.eow());
+  output_rb->set_eos(rb.eos());
+  return output_rb;
+}
+
+/**
+ * Appends the columns at col_idx of the row batches into a new arrow array.
+ */
+template <types::DataType T>
+StatusOr<std::shared_ptr<arrow::Array>> ConcatColumns(
+    const std::vector<std::unique_ptr<table_store::schema::RowBatch>>& rbs, int64_t col_idx) {
+  auto builder_generic = MakeArrowBuilder(T, arrow::default_memory_pool());
+  auto* builder =
+      static_cast<typename types::DataTypeTraits<T>::arrow_builder_type*>(builder_generic.get());
+  int64_t num_rows = 0;
+  for (const auto& rb : rbs) {
+    num_rows += rb->num_rows();
+  }
+  PX_RETURN_IF_ERROR(builder->Reserve(num_rows));
+  if constexpr (T == types::DataType::STRING) {
+    int64_t total_size = 0;
+    for (const auto& rb : rbs) {
+      total_size += types::GetArrowArrayBytes<T>(rb->ColumnAt(col_idx).get());
+    }
+    PX_RETURN_IF_ERROR(builder->ReserveData(total_size));
+  }
+  for (const auto& rb : rbs) {
+    auto col = rb->ColumnAt(col_idx).get();
+    for (int64_t row = 0; row < col->length(); ++row) {
+      builder->UnsafeAppend(types::GetValueFromArrowArray<T>(col, row));
+    }
+  }
+  std::shared_ptr<arrow::Array> output_array;
+  PX_RETURN_IF_ERROR(builder->Finish(&output_array));
+  return output_array;
+}
+
+/**
+ * Concatenates row batches with the same descriptor into a single row batch with the eow/eos of
+ * the last one.
+ */
+inline StatusOr<std::unique_ptr<table_store::schema::RowBatch>> ConcatRowBatches(
+    const std::vector<std::unique_ptr<table_store::schema::RowBatch>>& rbs) {
+  DCHECK(!rbs.empty());
+  int64_t num_rows = 0;
+  for (const auto& rb : rbs) {
+    num_rows += rb->num_rows();
+  }
+  const auto& desc = rbs.front()->desc();
+  auto output_rb = std::make_unique<table_store::schema::RowBatch>(desc, num_rows);
+  for (int64_t col_idx = 0; col_idx < static_cast<int64_t>(desc.size()); ++col_idx) {
+#define TYPE_CASE(_dt_)                                              \
+  PX_ASSIGN_OR_RETURN(auto output_col, ConcatColumns<_dt_>(rbs, col_idx)); \
+  PX_RETURN_IF_ERROR(output_rb->AddColumn(output_col));
+    PX_SWITCH_FOREACH_DATATYPE(desc.type(col_idx), TYPE_CASE);
+#undef TYPE_CASE
+  }
+  output_rb->set_eow(rbs.back()->eow());
+  output_rb->set_eos(rbs.back()->eos());
+  return output_rb;
+}
+
+/**
+ * Calls fn with the bytes of the value at the given row: the characters of strings and the
+ * in-memory representation of all other types. Equal values always produce equal bytes: floats
+ * are canonicalized first, so that -0.0 and 0.0, and all NaNs, have the same bytes.
+ */
+template <types::DataType T, typename TFn>
+void WithValueBytes(const arrow::Array* col, int64_t row, TFn fn) {
+  if constexpr (T == types::DataType::STRING) {
+    fn(types::GetStringViewFromArrowArray(col, row));
+  } else {
+    auto val = types::GetValueFromArrowArray<T>(col, row);
+    if constexpr (T == types::DataType::FLOAT64) {
+      if (val == 0) {
+        val = 0;
+      } else if (std::isnan(val)) {
+        val = std::numeric_limits<decltype(val)>::quiet_NaN();
+      }
+    }
+    fn(std::string_view(reinterpret_cast<const char*>(&val), sizeof(val)));
+  }
+}
+
+/**
+ * Inserts every value of the column into the bloom filter.
+ */
+template <types::DataType T>
+void InsertIntoBloomFilter(const arrow::Array* col, bloomfilter::XXHash64BloomFilter* filter) {
+  for (int64_t row = 0; row < col->length(); ++row) {
+    WithValueBytes<T>(col, row, [filter](std::string_view key) { filter->Insert(key); });
+  }
+}
+
+/**
+ * Appends the rows of the column whose value may be in the bloom filter to matched_rows.
+ */
+template <types::DataType T>
+void ProbeBloomFilter(const arrow::Array* col, const bloomfilter::XXHash64BloomFilter& filter,
+                      std::vector<int64_t>* matched_rows) {
+  for (int64_t row = 0; row < col->length(); ++row) {
+    WithValueBytes<T>(col, row, [&](std::string_view key) {
+      if (filter.Contains(key)) {
+        matched_rows->push_back(row);
+      }
+    });
+  }
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
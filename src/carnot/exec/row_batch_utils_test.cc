@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/exec/row_batch_utils.h"
+
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "src/carnot/exec/test_utils.h"
+#include "src/common/testing/testing.h"
+#include "src/shared/types/types.h"
+
+namespace px {
+namespace carnot {
+namespace exec {
+
+using table_store::schema::RowBatch;
+using table_store::schema::RowDescriptor;
+
+TEST(ConcatRowBatchesTest, concatenates_columns_in_order) {
+  RowDescriptor rd({types::DataType::INT64, types::DataType::STRING, types::DataType::FLOAT64});
+  std::vector<std::unique_ptr<RowBatch>> rbs;
+  rbs.push_back(std::make_unique<RowBatch>(RowBatchBuilder(rd, 2, /*eow*/ false, /*eos*/ false)
+                                               .AddColumn<types::Int64Value>({1, 2})
+                                               .AddColumn<types::StringValue>({"a", "bc"})
+                                               .AddColumn<types::Float64Value>({0.5, 1.5})
+                                               .get()));
+  rbs.push_back(std::make_unique<RowBatch>(RowBatchBuilder(rd, 0, /*eow*/ false, /*eos*/ false)
+                                               .AddColumn<types::Int64Value>({})
+                                               .AddColumn<types::StringValue>({})
+                                               .AddColumn<types::Float64Value>({})
+                                               .get()));
+  rbs.push_back(std::make_unique<RowBatch>(RowBatchBuilder(rd, 3, /*eow*/ true, /*eos*/ true)
+                                               .AddColumn<types::Int64Value>({3, 4, 5})
+                                               .AddColumn<types::StringValue>({"", "def", "g"})
+                                               .AddColumn<types::Float64Value>({2.5, 3.5, 4.5})
+                                               .get()));
+
+  ASSERT_OK_AND_ASSIGN(auto output_rb, ConcatRowBatches(rbs));
+  EXPECT_EQ(5, output_rb->num_rows());
+  EXPECT_EQ(3, output_rb->num_columns());
+  EXPECT_TRUE(output_rb->eow());
+  EXPECT_TRUE(output_rb->eos());
+
+  EXPECT_TRUE(output_rb->ColumnAt(0)->Equals(types::ToArrow(
+      std::vector<types::Int64Value>{1, 2, 3, 4, 5}, arrow::default_memory_pool())));
+  EXPECT_TRUE(output_rb->ColumnAt(1)->Equals(types::ToArrow(
+      std::vector<types::StringValue>{"a", "bc", "", "def", "g"}, arrow::default_memory_pool())));
+  EXPECT_TRUE(output_rb->ColumnAt(2)->Equals(
+      types::ToArrow(std::vector<types::Float64Value>{0.5, 1.5, 2.5, 3.5, 4.5},
+                     arrow::default_memory_pool())));
+}
+
+TEST(ConcatRowBatchesTest, takes_eow_eos_from_last_batch) {
+  RowDescriptor rd({types::DataType::INT64});
+  std::vector<std::unique_ptr<RowBatch>> rbs;
+  rbs.push_back(std::make_unique<RowBatch>(RowBatchBuilder(rd, 1, /*eow*/ true, /*eos*/ true)
+                                               .AddColumn<types::Int64Value>({1})
+                                               .get()));
+  rbs.push_back(std::make_unique<RowBatch>(RowBatchBuilder(rd, 1, /*eow*/ false, /*eos*/ false)
+                                               .AddColumn<types::Int64Value>({2})
+                                               .get()));
+
+  ASSERT_OK_AND_ASSIGN(auto output_rb, ConcatRowBatches(rbs));
+  EXPECT_EQ(2, output_rb->num_rows());
+  EXPECT_FALSE(output_rb->eow());
+  EXPECT_FALSE(output_rb->eos());
+}
+
+}  // namespace exec
+}  // namespace carnot
+}  // namespace px
@@ -29,6 +29,7 @@ void RegisterCollectionOpsOrDie(udf::Registry* registry) {
   registry->RegisterOrDie<AnyUDA<types::Time64NSValue>>("any");
   registry->RegisterOrDie<AnyUDA<types::StringValue>>("any");
   registry->RegisterOrDie<AnyUDA<types::UInt128Value>>("any");
+  registry->RegisterOrDie<FoldStackTraceUDA>("fold_stack_trace");
 }
 
 }  // namespace builtins
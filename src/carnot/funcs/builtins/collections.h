@@ -17,6 +17,13 @@
  */
 
 #pragma once
+#include <map>
+#include <string>
+
+#include <rapidjson/document.h>
+#include <rapidjson/stringbuffer.h>
+#include <rapidjson/writer.h>
+
 #include "src/carnot/udf/registry.h"
 #include "src/shared/types/types.h"
 
@@ -121,6 +128,90 @@ class AnyUDA : public udf::UDA {
   bool picked = false;
 };
 
+/**
+ * Rebuilds a folded stack trace from its interned frames.
+ *
+ * The profiler can publish stack traces as rows of (stack_trace_id, depth, frame_id) plus a
+ * dictionary of frame_id => symbol, instead of re-publishing each folded string on every push.
+ * This UDA concatenates the symbols of one stack trace in depth order, separated by ';'.
+ */
+class FoldStackTraceUDA : public udf::UDA {
+ public:
+  void Update(FunctionContext*, Int64Value depth, StringValue frame) {
+    frames_.emplace(depth.val, std::move(frame));
+  }
+
+  void Merge(FunctionContext*, const FoldStackTraceUDA& other) {
+    frames_.insert(other.frames_.begin(), other.frames_.end());
+  }
+
+  StringValue Finalize(FunctionContext*) {
+    std::string folded;
+    for (const auto& [depth, frame] : frames_) {
+      if (!folded.empty()) {
+        folded += ';';
+      }
+      folded += frame;
+    }
+    return folded;
+  }
+
+  StringValue Serialize(FunctionContext*) {
+    rapidjson::StringBuffer sb;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(sb);
+    writer.StartArray();
+    for (const auto& [depth, frame] : frames_) {
+      writer.StartArray();
+      writer.Int64(depth);
+      writer.String(frame.data(), frame.size());
+      writer.EndArray();
+    }
+    writer.EndArray();
+    return sb.GetString();
+  }
+
+  Status Deserialize(FunctionContext*, const StringValue& data) {
+    rapidjson::Document d;
+    rapidjson::ParseResult ok = d.Parse(data.data(), data.size());
+    if (ok == nullptr || !d.IsArray()) {
+      return error::InvalidArgument("Failed to parse serialized stack trace frames.");
+    }
+    frames_.clear();
+    for (const auto& entry : d.GetArray()) {
+      if (!entry.IsArray() || entry.Size() != 2 || !entry[0].IsInt64() || !entry[1].IsString()) {
+        return error::InvalidArgument("Malformed serialized stack trace frame.");
+      }
+      frames_.emplace(entry[0].GetInt64(),
+                      std::string(entry[1].GetString(), entry[1].GetStringLength()));
+    }
+    return Status::OK();
+  }
+
+  static udf::UDADocBuilder Doc() {
+    return udf::UDADocBuilder("Rebuilds a folded stack trace from interned frames.")
+        .Details(
+            "Concatenates the frames of a stack trace in order of depth, separated by semicolons. "
+            "Used to expand the interned profiler tables (stack_trace_frames.beta and "
+            "stack_frames.beta) back into the folded format of stack_traces.beta.")
+        .Example(R"doc(
+        | frames = px.DataFrame('stack_trace_frames.beta')
+        | frames.asid = px.upid_to_asid(frames.upid)
+        | symbols = px.DataFrame('stack_frames.beta')
+        | # Frame IDs are assigned per agent.
+        | frames = frames.merge(symbols, how='inner', left_on=['asid', 'frame_id'],
+        |                       right_on=['asid', 'frame_id'], suffixes=['', '_x'])
+        | stacks = frames.groupby(['upid', 'stack_trace_id']).agg(
+        |     stack_trace=('depth', 'frame', px.fold_stack_trace))
+        )doc")
+        .Arg("depth", "The position of the frame in the stack trace, starting from 0 at the root.")
+        .Arg("frame", "The symbol of the frame.")
+        .Returns("The stack trace in folded format.");
+  }
+
+ private:
+  std::map<int64_t, std::string> frames_;
+};
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -109,6 +109,29 @@ TEST(CollectionsTest, CanSerializeDeserialize_Float) {
   EXPECT_EQ(uda_tester.Result(), any_uda.Finalize(nullptr));
 }
 
+TEST(CollectionsTest, FoldStackTraceUDA) {
+  auto uda_tester = udf::UDATester<FoldStackTraceUDA>();
+  // Frames may arrive in any order; they are folded by depth.
+  uda_tester.ForInput(2, "bar").ForInput(0, "main").ForInput(1, "foo").Expect("main;foo;bar");
+}
+
+TEST(CollectionsTest, CanSerializeDeserialize_FoldStackTrace) {
+  auto uda_tester = udf::UDATester<FoldStackTraceUDA>();
+  uda_tester.ForInput(1, "foo;\"quoted\"").ForInput(0, "main");
+
+  FoldStackTraceUDA fold_uda;
+  ASSERT_OK(fold_uda.Deserialize(nullptr, uda_tester.Serialize()));
+  EXPECT_EQ(fold_uda.Finalize(nullptr), "main;foo;\"quoted\"");
+
+  // Deserialize replaces the frames of the UDA, rather than adding to them.
+  auto other_tester = udf::UDATester<FoldStackTraceUDA>();
+  other_tester.ForInput(0, "main").ForInput(2, "baz");
+  ASSERT_OK(fold_uda.Deserialize(nullptr, other_tester.Serialize()));
+  EXPECT_EQ(fold_uda.Finalize(nullptr), "main;baz");
+
+  EXPECT_NOT_OK(fold_uda.Deserialize(nullptr, "not json"));
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -24,6 +24,8 @@
 #include <rapidjson/writer.h>
 #include <sentencepiece/sentencepiece_processor.h>
 
+#include <absl/types/span.h>
+
 #include <memory>
 #include <string>
 #include <vector>
@@ -61,6 +63,14 @@ class TransformerUDF : public udf::ScalarUDF {
     return output;
   }
 
+  // Runs the whole batch through the model in batched inferences, borrowing the executor once.
+  Status ExecBatch(FunctionContext* ctx, absl::Span<const StringValue> docs, StringValue* out) {
+    auto executor =
+        ctx->model_pool()->GetModelExecutor<exec::ml::TransformerExecutor>(model_proto_path_);
+    executor->ExecuteBatch(docs, out);
+    return Status::OK();
+  }
+
  private:
   std::string model_proto_path_;
 };
@@ -81,6 +91,16 @@ class SentencePieceUDF : public udf::ScalarUDF {
     return write_ints_to_json(ids.data(), ids.size());
   }
 
+  Status ExecBatch(FunctionContext*, absl::Span<const StringValue> docs, StringValue* out) {
+    std::vector<int> ids;
+    for (size_t i = 0; i < docs.size(); ++i) {
+      ids.clear();
+      processor_.Encode(docs[i], &ids);
+      out[i] = write_ints_to_json(ids.data(), ids.size());
+    }
+    return Status::OK();
+  }
+
  private:
   sentencepiece::SentencePieceProcessor processor_;
 };
@@ -73,6 +73,27 @@ static void BM_TransformerModel(benchmark::State& state) {
   }
 }
 
+// NOLINTNEXTLINE : runtime/references.
+static void BM_TransformerModelBatch(benchmark::State& state) {
+  px::carnot::builtins::TransformerUDF udf(FLAGS_embedding_dir);
+  std::vector<px::types::StringValue> docs;
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    auto ints = random_ints(64);
+    docs.push_back(px::carnot::builtins::write_ints_to_json(ints.data(), 64));
+  }
+  std::vector<px::types::StringValue> out(docs.size());
+  auto model_pool = px::carnot::udf::ModelPool::Create();
+  auto model =
+      model_pool->GetModelExecutor<px::carnot::exec::ml::TransformerExecutor>(FLAGS_embedding_dir);
+  model.reset();
+  auto ctx = px::carnot::udf::FunctionContext(nullptr, model_pool.get());
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(udf.ExecBatch(&ctx, absl::MakeConstSpan(docs), out.data()));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
 // NOLINTNEXTLINE : runtime/references.
 static void BM_SentencePiece(benchmark::State& state) {
   auto udf = px::carnot::builtins::SentencePieceUDF(FLAGS_sentencepiece_dir);
@@ -85,3 +106,7 @@ static void BM_SentencePiece(benchmark::State& state) {
 
 BENCHMARK(BM_SentencePiece)->Unit(benchmark::kMillisecond);
 BENCHMARK(BM_TransformerModel)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_TransformerModelBatch)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(4)
+    ->Range(1, 256);
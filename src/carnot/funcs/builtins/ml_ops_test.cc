@@ -25,6 +25,9 @@
 #include <utility>
 #include <vector>
 
+#include <absl/strings/substitute.h>
+#include <absl/types/span.h>
+
 #include "src/carnot/funcs/builtins/ml_ops.h"
 #include "src/carnot/udf/test_utils.h"
 #include "src/common/base/base.h"
@@ -102,6 +105,25 @@ TEST(Transformer, basic) {
   }
 }
 
+TEST(Transformer, exec_batch) {
+  auto pool = udf::ModelPool::Create();
+  FunctionContext ctx(nullptr, pool.get());
+  TransformerUDF udf(FLAGS_embedding_dir);
+
+  // More docs than fit in a single inference, including one that can't be parsed.
+  std::vector<types::StringValue> docs;
+  for (size_t i = 0; i < exec::ml::kMaxInferenceBatchSize + 3; ++i) {
+    docs.push_back(i == 1 ? "not json" : absl::Substitute("[4,197,$0,195,16,5001]", i));
+  }
+  std::vector<types::StringValue> out(docs.size());
+  ASSERT_OK(udf.ExecBatch(&ctx, absl::MakeConstSpan(docs), out.data()));
+
+  for (size_t i = 0; i < docs.size(); ++i) {
+    EXPECT_EQ(udf.Exec(&ctx, docs[i]), out[i]) << i;
+  }
+  EXPECT_EQ("", out[1]);
+}
+
 }  // namespace builtins
 }  // namespace carnot
 }  // namespace px
@@ -262,6 +262,8 @@ class UPIDToContainerIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 inline const md::ContainerInfo* UPIDToContainer(const px::md::AgentMetadataState* md,
@@ -305,6 +307,8 @@ class UPIDToContainerNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 inline const px::md::PodInfo* UPIDtoPod(const px::md::AgentMetadataState* md,
@@ -347,6 +351,8 @@ class UPIDToNamespaceUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 class UPIDToPodIDUDF : public ScalarUDF {
@@ -374,6 +380,8 @@ class UPIDToPodIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 class UPIDToPodNameUDF : public ScalarUDF {
@@ -405,6 +413,8 @@ class UPIDToPodNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 class ServiceIDToServiceNameUDF : public ScalarUDF {
@@ -572,6 +582,8 @@ class UPIDToServiceIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -618,6 +630,8 @@ class UPIDToServiceNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -650,6 +664,8 @@ class UPIDToNodeNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -1578,6 +1594,8 @@ class UPIDToReplicaSetNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -1618,6 +1636,8 @@ class UPIDToReplicaSetIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -1656,6 +1676,8 @@ class UPIDToReplicaSetStatusUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -1702,6 +1724,8 @@ class UPIDToDeploymentNameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -1747,6 +1771,8 @@ class UPIDToDeploymentIDUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -1775,6 +1801,8 @@ class UPIDToHostnameUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 /**
@@ -2834,6 +2862,8 @@ class UPIDToPodStatusUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 class UPIDToCmdLineUDF : public ScalarUDF {
@@ -2868,6 +2898,8 @@ class UPIDToCmdLineUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 inline std::string PodInfoToPodQoS(const px::md::PodInfo* pod_info) {
@@ -2905,6 +2937,8 @@ class UPIDToPodQoSUDF : public ScalarUDF {
 
   // This UDF can currently only run on PEMs, because only PEMs have the UPID information.
   static udfspb::UDFSourceExecutor Executor() { return udfspb::UDFSourceExecutor::UDF_PEM; }
+
+  static constexpr bool Deterministic() { return true; }
 };
 
 class HostnameUDF : public ScalarUDF {
@@ -324,6 +324,9 @@ std::string GRPCSinkOperator::DebugString() const {
     destination = absl::Substitute("table_name=$0", table_name());
   } else if (has_grpc_source_id()) {
     destination = absl::Substitute("source_id=$0", grpc_source_id());
+  } else if (is_partitioned()) {
+    destination = absl::Substitute("partitions=$0, partition_cols=[$1]", pb_.partitions_size(),
+                                   absl::StrJoin(pb_.partition_column_idxs(), ","));
   }
   return absl::Substitute("Op:GRPCSink($0, $1)", address(), destination);
 }
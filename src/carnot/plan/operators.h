@@ -97,6 +97,8 @@ class MemorySourceOperator : public Operator {
   std::vector<int64_t> Columns() const { return column_idxs_; }
   const types::TabletID& Tablet() const { return pb_.tablet(); }
   bool streaming() const { return pb_.streaming(); }
+  bool has_semi_join_probe() const { return pb_.has_semi_join_probe(); }
+  const planpb::SemiJoinFilter& semi_join_probe() const { return pb_.semi_join_probe(); }
 
  private:
   planpb::MemorySourceOperator pb_;
@@ -144,6 +146,8 @@ class AggregateOperator : public Operator {
   const std::vector<GroupInfo>& groups() const { return groups_; }
   const std::vector<std::shared_ptr<AggregateExpression>>& values() const { return values_; }
   bool windowed() const { return pb_.windowed(); }
+  bool partial_agg() const { return pb_.partial_agg(); }
+  bool finalize_results() const { return pb_.finalize_results(); }
 
  private:
   std::vector<std::shared_ptr<AggregateExpression>> values_;
@@ -215,6 +219,22 @@ class GRPCSinkOperator : public Operator {
   }
   std::string table_name() const { return pb_.output_table().table_name(); }
 
+  // Partitioned sinks send each row to the partition picked by the hash of its values in the
+  // partition columns.
+  bool is_partitioned() const { return pb_.partitions_size() > 0; }
+  const google::protobuf::RepeatedPtrField<planpb::GRPCSinkOperator::Partition>& partitions()
+      const {
+    return pb_.partitions();
+  }
+  std::vector<int64_t> partition_column_idxs() const {
+    return std::vector<int64_t>(pb_.partition_column_idxs().begin(),
+                                pb_.partition_column_idxs().end());
+  }
+
+  // Sinks that build a semi-join filter add the key of every row they send to it.
+  bool has_semi_join_build() const { return pb_.has_semi_join_build(); }
+  const planpb::SemiJoinFilter& semi_join_build() const { return pb_.semi_join_build(); }
+
  private:
   planpb::GRPCSinkOperator pb_;
 };
@@ -93,6 +93,7 @@ class Analyzer : public RuleExecutor<IR> {
   void CreateDataTypeResolutionBatch() {
     RuleBatch* intermediate_resolution_batch =
         CreateRuleBatch<FailOnMax>("DataTypeResolution", 100);
+    intermediate_resolution_batch->set_incremental(true);
     intermediate_resolution_batch->AddRule<ResolveTypesRule>(compiler_state_);
     intermediate_resolution_batch->AddRule<DropToMapOperatorRule>(compiler_state_);
   }
@@ -35,6 +35,8 @@ class DropToMapOperatorRule : public Rule {
   explicit DropToMapOperatorRule(CompilerState* compiler_state)
       : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
 
+  bool Matches(const IRNode* ir_node) const override { return Match(ir_node, Drop()); }
+
  protected:
   StatusOr<bool> Apply(IRNode* ir_node) override;
 
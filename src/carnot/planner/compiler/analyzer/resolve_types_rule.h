@@ -36,6 +36,7 @@ class ResolveTypesRule : public Rule {
   explicit ResolveTypesRule(CompilerState* compiler_state)
       : Rule(compiler_state, /*use_topo*/ true, /*reverse_topological_execution*/ false) {}
 
+  bool Matches(const IRNode* ir_node) const override { return Match(ir_node, Operator()); }
   StatusOr<bool> Apply(IRNode* ir_node) override;
 };
 
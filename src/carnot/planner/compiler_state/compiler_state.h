@@ -25,6 +25,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 #include "src/carnot/planner/compiler_state/registry_info.h"
 
 #include "src/common/base/base.h"
@@ -139,7 +141,28 @@ class CompilerState : public NotCopyable {
     return &table_names_to_sensitive_columns_;
   }
   RegistryInfo* registry_info() const { return registry_info_; }
-  types::Time64NSValue time_now() const { return time_now_; }
+  /**
+   * Returns the compile time. The plan of a query that calls this can't be reused at a later
+   * time, so prefer RelativeTimeBound() for the time bounds of tables.
+   */
+  types::Time64NSValue time_now() const {
+    time_now_used_ = true;
+    return time_now_;
+  }
+  bool time_now_used() const { return time_now_used_; }
+
+  /**
+   * Returns a table time bound that is offset_ns from the compile time. Unlike time_now(), these
+   * bounds are tracked, so that a compiled plan can be reused later by shifting them.
+   */
+  int64_t RelativeTimeBound(int64_t offset_ns) {
+    int64_t time_ns = time_now_.val + offset_ns;
+    relative_time_bounds_.insert(time_ns);
+    return time_ns;
+  }
+  const absl::flat_hash_set<int64_t>& relative_time_bounds() const {
+    return relative_time_bounds_;
+  }
   const std::string& result_address() const { return result_address_; }
   const std::string& result_ssl_targetname() const { return result_ssl_targetname_; }
 
@@ -181,6 +204,8 @@ class CompilerState : public NotCopyable {
   SensitiveColumnMap table_names_to_sensitive_columns_;
   RegistryInfo* registry_info_;
   types::Time64NSValue time_now_;
+  mutable bool time_now_used_ = false;
+  absl::flat_hash_set<int64_t> relative_time_bounds_;
   std::map<IDRegistryKey, int64_t> udf_to_id_map_;
   std::map<IDRegistryKey, int64_t> uda_to_id_map_;
 
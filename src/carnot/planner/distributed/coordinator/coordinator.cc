@@ -34,6 +34,10 @@
 #include "src/common/uuid/uuid.h"
 #include "src/shared/upid/upid.h"
 
+DEFINE_bool(carnot_planner_partial_agg, gflags::BoolFromEnv("PL_CARNOT_PLANNER_PARTIAL_AGG", true),
+            "Whether aggregates whose UDAs all support partial aggregation are split into a "
+            "partial aggregate on the PEMs and a finalize aggregate on the Kelvin.");
+
 namespace px {
 namespace carnot {
 namespace planner {
@@ -177,10 +181,117 @@ StatusOr<SchemaToAgentsMap> LoadSchemaMap(
   return agent_schema_map;
 }
 
+/**
+ * Returns an ID that no GRPC bridge of the plan uses yet.
+ */
+int64_t NextGRPCBridgeID(const IR* plan) {
+  int64_t max_id = -1;
+  for (IRNode* node : plan->FindNodesOfType(IRNodeType::kGRPCSink)) {
+    auto sink = static_cast<GRPCSinkIR*>(node);
+    if (sink->has_destination_id()) {
+      max_id = std::max(max_id, sink->destination_id());
+    }
+  }
+  for (IRNode* node : plan->FindNodesOfType(IRNodeType::kGRPCSourceGroup)) {
+    max_id = std::max(max_id, static_cast<GRPCSourceGroupIR*>(node)->source_id());
+  }
+  return max_id + 1;
+}
+
+/**
+ * Partitions the GRPC source groups of the Kelvin plan that only feed a grouped aggregate by the
+ * group columns, so that each Kelvin merges the groups of one partition. The output of each
+ * aggregate is sent over a new GRPC bridge, where the partitions are gathered again.
+ *
+ * @return the ids of the operators that merge the partitions.
+ */
+StatusOr<absl::flat_hash_set<int64_t>> PartitionGroupedAggs(IR* kelvin_plan,
+                                                            int64_t* grpc_id_counter) {
+  absl::flat_hash_set<int64_t> merge_op_ids;
+  for (IRNode* node : kelvin_plan->FindNodesOfType(IRNodeType::kGRPCSourceGroup)) {
+    auto group = static_cast<GRPCSourceGroupIR*>(node);
+    if (group->Children().size() != 1 || !Match(group->Children()[0], BlockingAgg())) {
+      continue;
+    }
+    auto agg = static_cast<BlockingAggIR*>(group->Children()[0]);
+    if (agg->group_by_all()) {
+      continue;
+    }
+
+    std::vector<std::string> partition_columns;
+    for (ColumnIR* group_col : agg->groups()) {
+      partition_columns.push_back(group_col->col_name());
+    }
+
+    std::vector<OperatorIR*> agg_children = agg->Children();
+    PX_ASSIGN_OR_RETURN(GRPCSinkIR * grpc_sink, kelvin_plan->CreateNode<GRPCSinkIR>(
+                                                    agg->ast(), agg, *grpc_id_counter));
+    PX_RETURN_IF_ERROR(grpc_sink->SetResolvedType(agg->resolved_type()));
+    PX_ASSIGN_OR_RETURN(GRPCSourceGroupIR * gather_group,
+                        kelvin_plan->CreateNode<GRPCSourceGroupIR>(
+                            agg->ast(), *grpc_id_counter, agg->resolved_type()));
+    for (OperatorIR* child : agg_children) {
+      PX_RETURN_IF_ERROR(child->ReplaceParent(agg, gather_group));
+    }
+    ++(*grpc_id_counter);
+
+    group->SetPartitionColumns(partition_columns);
+    merge_op_ids.insert({group->id(), agg->id(), grpc_sink->id()});
+  }
+  return merge_op_ids;
+}
+
+Status CoordinatorImpl::AddMergeKelvins(const IR* split_plan, DistributedPlan* distributed_plan,
+                                        const std::vector<int64_t>& source_node_ids) {
+  std::vector<const CarnotInfo*> merge_kelvins;
+  for (const auto& carnot_info : remote_processor_nodes_) {
+    if (&carnot_info != &GetRemoteProcessor() && !carnot_info.has_data_store()) {
+      merge_kelvins.push_back(&carnot_info);
+    }
+  }
+  if (merge_kelvins.empty()) {
+    return Status::OK();
+  }
+
+  CarnotInstance* remote_carnot = distributed_plan->kelvin();
+  IR* remote_plan = remote_carnot->plan();
+  int64_t grpc_id_counter = NextGRPCBridgeID(split_plan);
+  PX_ASSIGN_OR_RETURN(absl::flat_hash_set<int64_t> merge_op_ids,
+                      PartitionGroupedAggs(remote_plan, &grpc_id_counter));
+  if (merge_op_ids.empty()) {
+    return Status::OK();
+  }
+
+  // The merge Kelvins only run the merge of their partition. The Kelvin that gathers the results
+  // merges the first partition, and keeps the rest of the plan.
+  absl::flat_hash_set<int64_t> ops_to_prune;
+  for (IRNode* op : remote_plan->FindNodesThatMatch(Operator())) {
+    if (!merge_op_ids.contains(op->id())) {
+      ops_to_prune.insert(op->id());
+    }
+  }
+  for (const CarnotInfo* merge_kelvin_info : merge_kelvins) {
+    PX_ASSIGN_OR_RETURN(int64_t merge_node_id, distributed_plan->AddCarnot(*merge_kelvin_info));
+    PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> merge_plan_uptr, remote_plan->Clone());
+    PX_RETURN_IF_ERROR(merge_plan_uptr->Prune(ops_to_prune));
+
+    CarnotInstance* merge_carnot = distributed_plan->Get(merge_node_id);
+    merge_carnot->AddPlan(merge_plan_uptr.get());
+    distributed_plan->AddPlan(std::move(merge_plan_uptr));
+    for (int64_t source_node_id : source_node_ids) {
+      if (distributed_plan->HasNode(source_node_id)) {
+        distributed_plan->AddEdge(source_node_id, merge_node_id);
+      }
+    }
+    distributed_plan->AddEdge(merge_node_id, remote_carnot->id());
+    distributed_plan->AddMergeKelvin(merge_carnot);
+  }
+  return Status::OK();
+}
+
 StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const IR* logical_plan) {
-  // TODO(zasgar) set support_partial_agg to true to enable partial aggs.
   PX_ASSIGN_OR_RETURN(std::unique_ptr<Splitter> splitter,
-                      Splitter::Create(compiler_state_, /* support_partial_agg */ false));
+                      Splitter::Create(compiler_state_, FLAGS_carnot_planner_partial_agg));
   PX_ASSIGN_OR_RETURN(std::unique_ptr<BlockingSplitPlan> split_plan,
                       splitter->SplitKelvinAndAgents(logical_plan));
   auto distributed_plan = std::make_unique<DistributedPlan>();
@@ -229,6 +340,10 @@ StatusOr<std::unique_ptr<DistributedPlan>> CoordinatorImpl::CoordinateImpl(const
   distributed_plan->SetKelvin(remote_carnot);
   distributed_plan->AddPlanToAgentMap(std::move(agent_to_plan_map.plan_to_agents));
 
+  // Spread the merge of grouped aggregates across the other Kelvins.
+  PX_RETURN_IF_ERROR(AddMergeKelvins(split_plan->original_plan.get(), distributed_plan.get(),
+                                     source_node_ids));
+
   return distributed_plan;
 }
 
@@ -93,6 +93,10 @@ class CoordinatorImpl : public Coordinator {
  private:
   const distributedpb::CarnotInfo& GetRemoteProcessor() const;
   bool HasExecutableNodes(const IR* plan);
+  // When there is more than one Kelvin, hash-partitions the grouped aggregates of the Kelvin plan
+  // by group key, and adds a merge Kelvin for each partition other than the first.
+  Status AddMergeKelvins(const IR* split_plan, DistributedPlan* distributed_plan,
+                         const std::vector<int64_t>& source_node_ids);
 
   // Nodes that have a source of data.
   std::vector<CarnotInfo> data_store_nodes_;
@@ -164,11 +164,20 @@ class DistributedPlan {
 
   CarnotInstance* kelvin() const { return kelvin_; }
 
+  // Merge Kelvins each merge one partition of hash-partitioned aggregates, and send the result to
+  // the Kelvin set by SetKelvin, which merges the first partition and gathers the others.
+  void AddMergeKelvin(CarnotInstance* merge_kelvin) {
+    DCHECK(id_to_node_map_.contains(merge_kelvin->id()));
+    merge_kelvins_.push_back(merge_kelvin);
+  }
+  const std::vector<CarnotInstance*>& merge_kelvins() const { return merge_kelvins_; }
+
  private:
   plan::DAG dag_;
   absl::flat_hash_map<int64_t, std::unique_ptr<CarnotInstance>> id_to_node_map_;
   absl::flat_hash_map<IR*, absl::flat_hash_set<int64_t>> plan_to_agent_map_;
   CarnotInstance* kelvin_ = nullptr;
+  std::vector<CarnotInstance*> merge_kelvins_;
   std::vector<std::unique_ptr<IR>> plan_pool_;
   absl::flat_hash_map<int64_t, IR*> agent_to_plan_map_;
   absl::flat_hash_map<sole::uuid, int64_t> uuid_to_id_map_;
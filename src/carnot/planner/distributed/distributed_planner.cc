@@ -51,20 +51,35 @@ Status StitchPlan(DistributedPlan* distributed_plan) {
 
   DistributedSetSourceGroupGRPCAddressRule set_grpc_address_rule;
   PX_RETURN_IF_ERROR(set_grpc_address_rule.Apply(remote_carnot));
+  for (CarnotInstance* merge_kelvin : distributed_plan->merge_kelvins()) {
+    PX_RETURN_IF_ERROR(set_grpc_address_rule.Apply(merge_kelvin));
+  }
 
-  // Connect the plans.
+  // Connect the plans. Partitioned sinks number their partitions in the order that they are
+  // connected, so every plan connects to the Kelvins in the same order.
   for (const auto& [plan, agents] : distributed_plan->plan_to_agent_map()) {
     PX_ASSIGN_OR_RETURN(auto did_connect_plan, AssociateDistributedPlanEdgesRule::ConnectGraphs(
                                                    plan, agents, remote_plan));
     DCHECK(did_connect_plan);
+    for (CarnotInstance* merge_kelvin : distributed_plan->merge_kelvins()) {
+      PX_RETURN_IF_ERROR(
+          AssociateDistributedPlanEdgesRule::ConnectGraphs(plan, agents, merge_kelvin->plan()));
+    }
+  }
+  for (CarnotInstance* merge_kelvin : distributed_plan->merge_kelvins()) {
+    PX_RETURN_IF_ERROR(AssociateDistributedPlanEdgesRule::ConnectGraphs(
+        merge_kelvin->plan(), {merge_kelvin->id()}, remote_plan));
   }
 
   // TODO(philkuz) make this connect to self without a grpc bridge.
   PX_RETURN_IF_ERROR(
       AssociateDistributedPlanEdgesRule::ConnectGraphs(remote_plan, {remote_node_id}, remote_plan));
 
-  // Expand GRPCSourceGroups in the remote_plan.
+  // Expand GRPCSourceGroups in the Kelvin plans.
   GRPCSourceGroupConversionRule conversion_rule;
+  for (CarnotInstance* merge_kelvin : distributed_plan->merge_kelvins()) {
+    PX_RETURN_IF_ERROR(conversion_rule.Execute(merge_kelvin->plan()));
+  }
   PX_RETURN_IF_ERROR(conversion_rule.Execute(remote_plan));
   return MergeSameNodeGRPCBridgeRule(remote_node_id).Execute(remote_plan).status();
 }
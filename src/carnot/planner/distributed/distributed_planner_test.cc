@@ -213,6 +213,67 @@ TEST_F(DistributedPlannerTest, three_agents_one_kelvin) {
   EXPECT_THAT(grpc_sink_destinations, UnorderedElementsAreArray(grpc_source_ids));
 }
 
+TEST_F(DistributedPlannerTest, one_pem_three_kelvins_partitioned_agg) {
+  auto mem_src = MakeMemSource(MakeRelation());
+  compiler_state_->relation_map()->emplace("table", MakeRelation());
+  auto mean_func = MakeMeanFuncWithFloatType(MakeColumn("cpu0", 0));
+  auto agg = MakeBlockingAgg(mem_src, {MakeColumn("count", 0)}, {{"mean", mean_func}});
+  MakeMemSink(agg, "out");
+
+  ResolveTypesRule rule(compiler_state_.get());
+  ASSERT_OK(rule.Execute(graph.get()));
+
+  distributedpb::DistributedState ps_pb =
+      LoadDistributedStatePb(testutils::kOnePEMThreeKelvinsDistributedState);
+  std::unique_ptr<DistributedPlanner> physical_planner =
+      DistributedPlanner::Create().ConsumeValueOrDie();
+  std::unique_ptr<DistributedPlan> physical_plan =
+      physical_planner->Plan(ps_pb, compiler_state_.get(), graph.get()).ConsumeValueOrDie();
+
+  // The PEM sends to all three Kelvins, and the two merge Kelvins send to the first Kelvin.
+  ASSERT_EQ(physical_plan->dag().nodes().size(), 4UL);
+  ASSERT_EQ(physical_plan->merge_kelvins().size(), 2UL);
+  EXPECT_EQ(physical_plan->dag().TopologicalSort().back(), 0);
+
+  // The PEM partitions its rows by the group column.
+  auto pem_instance = physical_plan->Get(1);
+  EXPECT_THAT(pem_instance->carnot_info().query_broker_address(), ContainsRegex("pem"));
+  std::vector<IRNode*> grpc_sinks = pem_instance->plan()->FindNodesOfType(IRNodeType::kGRPCSink);
+  ASSERT_EQ(grpc_sinks.size(), 1);
+  auto pem_sink = static_cast<GRPCSinkIR*>(grpc_sinks[0]);
+  EXPECT_THAT(pem_sink->partition_columns(), ElementsAre("count"));
+
+  planpb::Operator pem_sink_pb;
+  ASSERT_OK(pem_sink->ToProto(&pem_sink_pb, pem_instance->id()));
+  const auto& grpc_sink_op = pem_sink_pb.grpc_sink_op();
+  EXPECT_THAT(grpc_sink_op.partition_column_idxs(), ElementsAre(0));
+  ASSERT_EQ(grpc_sink_op.partitions_size(), 3);
+  EXPECT_EQ(grpc_sink_op.partitions(0).address(), "1111");
+  EXPECT_EQ(grpc_sink_op.partitions(1).address(), "1112");
+  EXPECT_EQ(grpc_sink_op.partitions(2).address(), "1113");
+
+  // Each merge Kelvin aggregates its partition and sends the result to the first Kelvin.
+  for (CarnotInstance* merge_kelvin : physical_plan->merge_kelvins()) {
+    SCOPED_TRACE(merge_kelvin->carnot_info().query_broker_address());
+    IR* merge_plan = merge_kelvin->plan();
+    EXPECT_EQ(merge_plan->FindNodesOfType(IRNodeType::kGRPCSource).size(), 1);
+    EXPECT_EQ(merge_plan->FindNodesOfType(IRNodeType::kBlockingAgg).size(), 1);
+    EXPECT_EQ(merge_plan->FindNodesOfType(IRNodeType::kMemorySink).size(), 0);
+    std::vector<IRNode*> merge_sinks = merge_plan->FindNodesOfType(IRNodeType::kGRPCSink);
+    ASSERT_EQ(merge_sinks.size(), 1);
+    EXPECT_EQ(static_cast<GRPCSinkIR*>(merge_sinks[0])->destination_address(), "1111");
+  }
+
+  // The first Kelvin aggregates its own partition and gathers the others.
+  IR* kelvin_plan = physical_plan->Get(0)->plan();
+  EXPECT_EQ(kelvin_plan->FindNodesOfType(IRNodeType::kBlockingAgg).size(), 1);
+  EXPECT_EQ(kelvin_plan->FindNodesOfType(IRNodeType::kMemorySink).size(), 1);
+  EXPECT_EQ(kelvin_plan->FindNodesOfType(IRNodeType::kGRPCSink).size(), 0);
+  std::vector<IRNode*> unions = kelvin_plan->FindNodesOfType(IRNodeType::kUnion);
+  ASSERT_EQ(unions.size(), 1);
+  EXPECT_EQ(static_cast<UnionIR*>(unions[0])->parents().size(), 3);
+}
+
 using DistributedPlannerUDTFTests = DistributedRulesTest;
 TEST_F(DistributedPlannerUDTFTests, UDTFOnlyOnPEMsDoesntRunOnKelvin) {
   uint32_t asid = 123;
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/carnot/planner/distributed/splitter/semi_join_filter_rule.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+namespace {
+
+// One side of a join, as seen from the PEM that produces it.
+struct JoinSide {
+  GRPCSinkIR* sink = nullptr;
+  MemorySourceIR* source = nullptr;
+  // The name of the key column at the sink and at the source.
+  std::string sink_column;
+  std::string source_column;
+  GRPCSourceGroupIR* group = nullptr;
+  // The operators between the source and the sink.
+  std::vector<OperatorIR*> ops;
+  bool has_filter_or_limit = false;
+};
+
+GRPCSinkIR* FindSink(const IR* plan, GRPCSourceGroupIR* group) {
+  for (IRNode* node : plan->FindNodesThatMatch(GRPCSink())) {
+    auto sink = static_cast<GRPCSinkIR*>(node);
+    if (sink->has_destination_id() && sink->destination_id() == group->source_id()) {
+      return sink;
+    }
+  }
+  return nullptr;
+}
+
+// Traces the key column from the sink back to the MemorySource that produces it. Returns false if
+// the side doesn't meet the requirements of the rule.
+bool TraceJoinSide(GRPCSinkIR* sink, const std::string& column, JoinSide* side) {
+  side->sink = sink;
+  side->sink_column = column;
+  std::string current_column = column;
+  OperatorIR* op = sink->parents()[0];
+  while (!Match(op, MemorySource())) {
+    if (op->parents().size() != 1) {
+      return false;
+    }
+    if (Match(op, Map())) {
+      auto map = static_cast<MapIR*>(op);
+      bool found = false;
+      for (const auto& col_expr : map->col_exprs()) {
+        if (col_expr.name != current_column) {
+          continue;
+        }
+        if (!Match(col_expr.node, ColumnNode())) {
+          return false;
+        }
+        current_column = static_cast<ColumnIR*>(col_expr.node)->col_name();
+        found = true;
+        break;
+      }
+      if (!found && !map->keep_input_columns()) {
+        return false;
+      }
+    } else if (Match(op, Filter()) || Match(op, Limit())) {
+      side->has_filter_or_limit = true;
+    } else {
+      return false;
+    }
+    side->ops.push_back(op);
+    op = op->parents()[0];
+  }
+
+  side->source = static_cast<MemorySourceIR*>(op);
+  side->source_column = current_column;
+  auto type_or_s = side->source->resolved_table_type()->GetColumnType(current_column);
+  if (!type_or_s.ok() || !type_or_s.ValueOrDie()->IsValueType()) {
+    return false;
+  }
+  auto value_type = std::static_pointer_cast<ValueType>(type_or_s.ConsumeValueOrDie());
+  return value_type->semantic_type() == types::ST_UPID;
+}
+
+bool CanBuild(const JoinSide& side) {
+  return !side.source->streaming() && !side.sink->builds_semi_join_filter();
+}
+
+bool CanProbe(const JoinSide& side) {
+  // The rows of the probe side must only reach the join, on both the PEM and the Kelvin.
+  if (side.group->Children().size() != 1) {
+    return false;
+  }
+  if (side.source->probes_semi_join_filter() || side.source->Children().size() != 1) {
+    return false;
+  }
+  for (OperatorIR* op : side.ops) {
+    // A Limit would return different rows once its input is filtered.
+    if (Match(op, Limit()) || op->Children().size() != 1) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+StatusOr<bool> SemiJoinFilterRule::Apply(IRNode* node) {
+  if (!Match(node, Join())) {
+    return false;
+  }
+  auto join = static_cast<JoinIR*>(node);
+  if (join->join_type() != JoinIR::JoinType::kInner &&
+      join->join_type() != JoinIR::JoinType::kLeft) {
+    return false;
+  }
+  DCHECK_EQ(join->parents().size(), 2U);
+  if (!Match(join->parents()[0], GRPCSourceGroup()) ||
+      !Match(join->parents()[1], GRPCSourceGroup())) {
+    return false;
+  }
+
+  // Look for a key pair where both sides are upids that come straight from a table.
+  for (size_t i = 0; i < join->left_on_columns().size(); ++i) {
+    std::vector<ColumnIR*> key_columns(2);
+    for (ColumnIR* col : {join->left_on_columns()[i], join->right_on_columns()[i]}) {
+      DCHECK(col->container_op_parent_idx_set());
+      key_columns[col->container_op_parent_idx()] = col;
+    }
+    if (key_columns[0] == nullptr || key_columns[1] == nullptr) {
+      continue;
+    }
+
+    std::vector<JoinSide> sides(2);
+    bool traced = true;
+    for (size_t parent_idx = 0; parent_idx < 2; ++parent_idx) {
+      auto group = static_cast<GRPCSourceGroupIR*>(join->parents()[parent_idx]);
+      sides[parent_idx].group = group;
+      GRPCSinkIR* sink = FindSink(join->graph(), group);
+      traced = traced && sink != nullptr &&
+               TraceJoinSide(sink, key_columns[parent_idx]->col_name(), &sides[parent_idx]);
+    }
+    if (!traced || sides[0].source == sides[1].source) {
+      continue;
+    }
+
+    // Left joins keep every row of parent 0, so only parent 1 can be probed. Inner joins build
+    // the filter from the side that is filtered down on the PEM, which is likely the smaller one.
+    size_t build_idx = 0;
+    if (join->join_type() == JoinIR::JoinType::kInner && !sides[0].has_filter_or_limit &&
+        sides[1].has_filter_or_limit) {
+      build_idx = 1;
+    }
+    const JoinSide& build = sides[build_idx];
+    const JoinSide& probe = sides[1 - build_idx];
+    if (!CanBuild(build) || !CanProbe(probe)) {
+      continue;
+    }
+
+    build.sink->SetSemiJoinBuild(join->id(), build.sink_column);
+    probe.source->SetSemiJoinProbe(join->id(), probe.source_column);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -0,0 +1,60 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+
+#include "src/carnot/planner/rules/rules.h"
+
+namespace px {
+namespace carnot {
+namespace planner {
+namespace distributed {
+
+/**
+ * @brief Sets up semi-join reduction for Kelvin joins on upid keys, which PEMs otherwise send
+ * both full sides of.
+ *
+ * A upid always belongs to the agent whose table recorded it, so all the rows that can match a
+ * PEM's row on a upid key come from that same PEM. The GRPCSink of one side of the join (the
+ * build side) therefore adds the keys it sends to a bloom filter, and the MemorySource of the
+ * other side (the probe side) drops the rows whose keys aren't in that filter, all within the plan
+ * of the PEM.
+ *
+ * Applies to the grpc bridge plan, where the join and the PEM operators are still in the same
+ * graph. Only applies when:
+ * 1. The join is inner or left. The probe side must not be the preserved side of a left join.
+ * 2. Both sides are chains of Map and Filter (and Limit, on the build side only) from a
+ *    MemorySource to the GRPCSink, that pass through the upid key column unchanged.
+ * 3. The build MemorySource is not streaming, so that the filter is eventually complete.
+ * 4. No other operator reads the output of the probe side's operators.
+ */
+class SemiJoinFilterRule : public Rule {
+ public:
+  explicit SemiJoinFilterRule(CompilerState* compiler_state)
+      : Rule(compiler_state, /*use_topo*/ false, /*reverse_topological_execution*/ false) {}
+
+ protected:
+  StatusOr<bool> Apply(IRNode* node) override;
+};
+
+}  // namespace distributed
+}  // namespace planner
+}  // namespace carnot
+}  // namespace px
@@ -26,6 +26,7 @@
 #include "src/carnot/planner/distributed/splitter/presplit_analyzer/presplit_analyzer.h"
 #include "src/carnot/planner/distributed/splitter/presplit_optimizer/presplit_optimizer.h"
 #include "src/carnot/planner/distributed/splitter/scalar_udfs_run_on_executor_rule.h"
+#include "src/carnot/planner/distributed/splitter/semi_join_filter_rule.h"
 #include "src/carnot/planner/distributed/splitter/splitter.h"
 
 namespace px {
@@ -139,6 +140,11 @@ StatusOr<std::unique_ptr<BlockingSplitPlan>> Splitter::SplitKelvinAndAgents(cons
   PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> grpc_bridge_plan,
                       CreateGRPCBridgePlan(logical_plan.get(), on_kelvin, source_ids));
 
+  // Annotate the PEM side of upid-keyed joins before the plan is split, while the joins are still
+  // in the same graph as the operators that feed them.
+  SemiJoinFilterRule semi_join_rule(compiler_state_);
+  PX_RETURN_IF_ERROR(semi_join_rule.Execute(grpc_bridge_plan.get()));
+
   PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> pem_plan, grpc_bridge_plan->Clone());
   PX_ASSIGN_OR_RETURN(std::unique_ptr<IR> kelvin_plan, grpc_bridge_plan->Clone());
 
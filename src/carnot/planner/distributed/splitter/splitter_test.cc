@@ -569,6 +569,79 @@ TEST_F(SplitterTest, agg_join_children) {
   EXPECT_EQ(join_parent->source_id(), grpc_sink->destination_id());
 }
 
+TEST_F(SplitterTest, upid_join_semi_join_filter) {
+  Relation pods_relation({types::UINT128, types::STRING}, {"upid", "pod"},
+                         {types::ST_UPID, types::ST_NONE});
+  Relation conns_relation({types::UINT128, types::INT64}, {"upid", "bytes"},
+                          {types::ST_UPID, types::ST_NONE});
+  compiler_state_->relation_map()->emplace("pods", pods_relation);
+  compiler_state_->relation_map()->emplace("conns", conns_relation);
+
+  auto pods = MakeMemSource("pods", pods_relation);
+  auto conns = MakeMemSource("conns", conns_relation);
+  auto join = MakeJoin({pods, conns}, "inner", pods_relation, conns_relation, {"upid"}, {"upid"},
+                       {"", "_x"});
+  MakeMemSink(join, "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  ASSERT_OK_AND_ASSIGN(auto splitter,
+                       Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false));
+  ASSERT_OK_AND_ASSIGN(auto split_plan, splitter->SplitKelvinAndAgents(graph.get()));
+  auto before_blocking = split_plan->before_blocking.get();
+
+  // The sink of the first side of the join builds the filter, and the source of the other side
+  // probes it.
+  auto pods_children = GetEquivalentInNewPlan(before_blocking, pods)->Children();
+  ASSERT_EQ(pods_children.size(), 1);
+  ASSERT_MATCH(pods_children[0], GRPCSink());
+  auto pods_sink = static_cast<GRPCSinkIR*>(pods_children[0]);
+  EXPECT_TRUE(pods_sink->builds_semi_join_filter());
+  EXPECT_EQ(pods_sink->semi_join_filter_id(), join->id());
+  EXPECT_EQ(pods_sink->semi_join_column(), "upid");
+
+  auto new_conns = GetEquivalentInNewPlan(before_blocking, conns);
+  EXPECT_TRUE(new_conns->probes_semi_join_filter());
+  EXPECT_EQ(new_conns->semi_join_filter_id(), join->id());
+  EXPECT_EQ(new_conns->semi_join_column(), "upid");
+
+  planpb::Operator pb;
+  ASSERT_OK(new_conns->ToProto(&pb));
+  EXPECT_EQ(pb.mem_source_op().semi_join_probe().id(), join->id());
+  EXPECT_EQ(pb.mem_source_op().semi_join_probe().column_idx(), 0);
+}
+
+TEST_F(SplitterTest, outer_join_no_semi_join_filter) {
+  Relation pods_relation({types::UINT128, types::STRING}, {"upid", "pod"},
+                         {types::ST_UPID, types::ST_NONE});
+  Relation conns_relation({types::UINT128, types::INT64}, {"upid", "bytes"},
+                          {types::ST_UPID, types::ST_NONE});
+  compiler_state_->relation_map()->emplace("pods", pods_relation);
+  compiler_state_->relation_map()->emplace("conns", conns_relation);
+
+  auto pods = MakeMemSource("pods", pods_relation);
+  auto conns = MakeMemSource("conns", conns_relation);
+  // Every row of both sides is kept by an outer join, so neither can be filtered.
+  MakeMemSink(MakeJoin({pods, conns}, "outer", pods_relation, conns_relation, {"upid"}, {"upid"},
+                       {"", "_x"}),
+              "out");
+
+  ResolveTypesRule type_rule(compiler_state_.get());
+  ASSERT_OK(type_rule.Execute(graph.get()));
+
+  ASSERT_OK_AND_ASSIGN(auto splitter,
+                       Splitter::Create(compiler_state_.get(), /* perform_partial_agg */ false));
+  ASSERT_OK_AND_ASSIGN(auto split_plan, splitter->SplitKelvinAndAgents(graph.get()));
+  auto before_blocking = split_plan->before_blocking.get();
+
+  for (auto node : before_blocking->FindNodesThatMatch(GRPCSink())) {
+    EXPECT_FALSE(static_cast<GRPCSinkIR*>(node)->builds_semi_join_filter());
+  }
+  EXPECT_FALSE(GetEquivalentInNewPlan(before_blocking, pods)->probes_semi_join_filter());
+  EXPECT_FALSE(GetEquivalentInNewPlan(before_blocking, conns)->probes_semi_join_filter());
+}
+
 TEST_F(SplitterTest, simple_split_test) {
   auto mem_src = MakeMemSource("cpu", cpu_relation);
   auto map1 = MakeMap(mem_src, {{"cpu0", MakeColumn("cpu0", 0)}, {"cpu1", MakeColumn("cpu1", 0)}});
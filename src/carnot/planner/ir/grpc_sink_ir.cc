@@ -31,6 +31,12 @@ Status GRPCSinkIR::CopyFromNodeImpl(const IRNode* node,
   destination_ssl_targetname_ = grpc_sink->destination_ssl_targetname_;
   name_ = grpc_sink->name_;
   out_columns_ = grpc_sink->out_columns_;
+  partition_columns_ = grpc_sink->partition_columns_;
+  semi_join_filter_id_ = grpc_sink->semi_join_filter_id_;
+  semi_join_column_ = grpc_sink->semi_join_column_;
+  for (const auto& partition : grpc_sink->partitions_) {
+    AddPartition(partition.address, partition.ssl_targetname);
+  }
   return Status::OK();
 }
 
@@ -53,9 +59,56 @@ Status GRPCSinkIR::ToProto(planpb::Operator* op) const {
   return Status::OK();
 }
 
+Status GRPCSinkIR::AddPartitionDestinationIDMap(const std::string& address,
+                                                int64_t destination_id, int64_t agent_id) {
+  for (auto& partition : partitions_) {
+    if (partition.address == address) {
+      partition.agent_id_to_destination_id[agent_id] = destination_id;
+      return Status::OK();
+    }
+  }
+  return CreateIRNodeError("No partition sent to '$0' found in grpc sink '$1'", address,
+                           DebugString());
+}
+
 Status GRPCSinkIR::ToProto(planpb::Operator* op, int64_t agent_id) const {
   auto pb = op->mutable_grpc_sink_op();
   op->set_op_type(planpb::GRPC_SINK_OPERATOR);
+  if (builds_semi_join_filter()) {
+    DCHECK(is_type_resolved());
+    auto column_names = resolved_table_type()->ColumnNames();
+    auto it = std::find(column_names.begin(), column_names.end(), semi_join_column_);
+    if (it == column_names.end()) {
+      return CreateIRNodeError("Semi-join column '$0' not found in grpc sink '$1'",
+                               semi_join_column_, DebugString());
+    }
+    pb->mutable_semi_join_build()->set_id(semi_join_filter_id_);
+    pb->mutable_semi_join_build()->set_column_idx(std::distance(column_names.begin(), it));
+  }
+  if (is_partitioned()) {
+    DCHECK(is_type_resolved());
+    auto column_names = resolved_table_type()->ColumnNames();
+    for (const auto& col_name : partition_columns_) {
+      auto it = std::find(column_names.begin(), column_names.end(), col_name);
+      if (it == column_names.end()) {
+        return CreateIRNodeError("Partition column '$0' not found in grpc sink '$1'", col_name,
+                                 DebugString());
+      }
+      pb->add_partition_column_idxs(std::distance(column_names.begin(), it));
+    }
+    for (const auto& partition : partitions_) {
+      auto partition_pb = pb->add_partitions();
+      partition_pb->set_address(partition.address);
+      partition_pb->mutable_connection_options()->set_ssl_targetname(partition.ssl_targetname);
+      auto it = partition.agent_id_to_destination_id.find(agent_id);
+      if (it == partition.agent_id_to_destination_id.end()) {
+        return CreateIRNodeError("No agent ID '$0' found for partition '$1' in grpc sink '$2'",
+                                 agent_id, partition.address, DebugString());
+      }
+      partition_pb->set_grpc_source_id(it->second);
+    }
+    return Status::OK();
+  }
   pb->set_address(destination_address());
   pb->mutable_connection_options()->set_ssl_targetname(destination_ssl_targetname());
   if (!agent_id_to_destination_id_.contains(agent_id)) {
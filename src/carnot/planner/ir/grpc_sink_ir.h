@@ -114,6 +114,36 @@ class GRPCSinkIR : public OperatorIR {
   bool DestinationAddressSet() const { return destination_address_ != ""; }
   const std::string& destination_ssl_targetname() const { return destination_ssl_targetname_; }
 
+  /**
+   * @brief Partitioned sinks hash the rows by the values of their partition columns, and send
+   * each partition to a different GRPC source group. Used to spread the merge of partial
+   * aggregates by group key across several Kelvins.
+   */
+  bool is_partitioned() const { return !partition_columns_.empty(); }
+  const std::vector<std::string>& partition_columns() const { return partition_columns_; }
+  void SetPartitionColumns(const std::vector<std::string>& columns) {
+    partition_columns_ = columns;
+  }
+  // Adds the destination of the next partition of a partitioned sink.
+  void AddPartition(const std::string& address, std::string_view ssl_targetname) {
+    partitions_.push_back({address, std::string(ssl_targetname), {}});
+  }
+  size_t num_partitions() const { return partitions_.size(); }
+  // Maps the agent to the ID of the GRPC source that receives its rows of the partition sent to
+  // address.
+  Status AddPartitionDestinationIDMap(const std::string& address, int64_t destination_id,
+                                      int64_t agent_id);
+
+  // Sinks that build a semi-join filter add the value of column of every row they send to the
+  // filter with the given ID, which a MemorySource in the same plan probes.
+  void SetSemiJoinBuild(int64_t filter_id, const std::string& column) {
+    semi_join_filter_id_ = filter_id;
+    semi_join_column_ = column;
+  }
+  bool builds_semi_join_filter() const { return semi_join_filter_id_ != -1; }
+  int64_t semi_join_filter_id() const { return semi_join_filter_id_; }
+  const std::string& semi_join_column() const { return semi_join_column_; }
+
   bool has_output_table() const { return sink_type_ == GRPCSinkType::kExternal; }
   std::string name() const { return name_; }
   void set_name(const std::string& name) { name_ = name; }
@@ -156,6 +186,17 @@ class GRPCSinkIR : public OperatorIR {
   std::string name_;
   std::vector<std::string> out_columns_;
   absl::flat_hash_map<int64_t, int64_t> agent_id_to_destination_id_;
+  int64_t semi_join_filter_id_ = -1;
+  std::string semi_join_column_;
+
+  struct Partition {
+    std::string address;
+    std::string ssl_targetname;
+    absl::flat_hash_map<int64_t, int64_t> agent_id_to_destination_id;
+  };
+  // Used when the sink is partitioned.
+  std::vector<std::string> partition_columns_;
+  std::vector<Partition> partitions_;
 };
 
 }  // namespace planner
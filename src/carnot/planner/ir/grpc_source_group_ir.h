@@ -62,6 +62,17 @@ class GRPCSourceGroupIR : public OperatorIR {
   void SetGRPCAddress(const std::string& grpc_address) { grpc_address_ = grpc_address; }
   void SetSSLTargetName(const std::string& ssl_targetname) { ssl_targetname_ = ssl_targetname; }
 
+  /**
+   * @brief Marks this source group as one partition of a hash-partitioned stream. The sinks added
+   * to a partitioned group are partitioned by the given columns, and send this group only the
+   * rows of its partition.
+   */
+  void SetPartitionColumns(const std::vector<std::string>& columns) {
+    partition_columns_ = columns;
+  }
+  bool is_partitioned() const { return !partition_columns_.empty(); }
+  const std::vector<std::string>& partition_columns() const { return partition_columns_; }
+
   /**
    * @brief Associate the passed in GRPCSinkOperator with this Source Group. The sink_op passed in
    * will most likely exist outside of the graph this contains, so instead of holding a pointer, we
@@ -99,6 +110,7 @@ class GRPCSourceGroupIR : public OperatorIR {
   int64_t source_id_ = -1;
   std::string grpc_address_ = "";
   std::string ssl_targetname_ = "";
+  std::vector<std::string> partition_columns_;
   std::vector<std::pair<GRPCSinkIR*, absl::flat_hash_set<int64_t>>> dependent_sinks_;
 };
 }  // namespace planner
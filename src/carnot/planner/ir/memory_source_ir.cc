@@ -64,6 +64,17 @@ Status MemorySourceIR::ToProto(planpb::Operator* op) const {
   }
 
   pb->set_streaming(streaming());
+
+  if (probes_semi_join_filter()) {
+    auto column_names = resolved_table_type()->ColumnNames();
+    auto it = std::find(column_names.begin(), column_names.end(), semi_join_column_);
+    if (it == column_names.end()) {
+      return CreateIRNodeError("Semi-join column '$0' not found in memory source '$1'",
+                               semi_join_column_, DebugString());
+    }
+    pb->mutable_semi_join_probe()->set_id(semi_join_filter_id_);
+    pb->mutable_semi_join_probe()->set_column_idx(std::distance(column_names.begin(), it));
+  }
   return Status::OK();
 }
 
@@ -106,6 +117,8 @@ Status MemorySourceIR::CopyFromNodeImpl(const IRNode* node,
   column_index_map_set_ = source_ir->column_index_map_set_;
   column_index_map_ = source_ir->column_index_map_;
   streaming_ = source_ir->streaming_;
+  semi_join_filter_id_ = source_ir->semi_join_filter_id_;
+  semi_join_column_ = source_ir->semi_join_column_;
 
   return Status::OK();
 }
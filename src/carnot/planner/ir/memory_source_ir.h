@@ -80,6 +80,16 @@ class MemorySourceIR : public OperatorIR {
 
   Status ToProto(planpb::Operator*) const override;
 
+  // Sources that probe a semi-join filter only return the rows whose value of column may be in
+  // the filter with the given ID, which is built by a GRPCSink in the same plan.
+  void SetSemiJoinProbe(int64_t filter_id, const std::string& column) {
+    semi_join_filter_id_ = filter_id;
+    semi_join_column_ = column;
+  }
+  bool probes_semi_join_filter() const { return semi_join_filter_id_ != -1; }
+  int64_t semi_join_filter_id() const { return semi_join_filter_id_; }
+  const std::string& semi_join_column() const { return semi_join_column_; }
+
   bool select_all() const { return column_names_.size() == 0; }
 
   Status CopyFromNodeImpl(const IRNode* node,
@@ -126,6 +136,9 @@ class MemorySourceIR : public OperatorIR {
 
   types::TabletID tablet_value_;
   bool has_tablet_value_ = false;
+
+  int64_t semi_join_filter_id_ = -1;
+  std::string semi_join_column_;
 };
 
 }  // namespace planner
@@ -18,8 +18,13 @@
 
 #include "src/carnot/planner/logical_planner.h"
 
+#include <string>
 #include <utility>
 
+#include <farmhash.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/ast_utils.h"
 #include "src/carnot/planner/otel_generator/otel_generator.h"
@@ -125,30 +130,144 @@ Status LogicalPlanner::Init(const udfspb::UDFInfo& udf_info) {
 
 StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
     const plannerpb::QueryRequest& query_request) {
-  // Compile into the IR.
-
   auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
   VLOG(1) << "Max output rows: " << ms;
   PX_ASSIGN_OR_RETURN(
       std::unique_ptr<CompilerState> compiler_state,
       CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  return Plan(query_request, compiler_state.get());
+}
 
+StatusOr<std::unique_ptr<distributed::DistributedPlan>> LogicalPlanner::Plan(
+    const plannerpb::QueryRequest& query_request, CompilerState* compiler_state) {
+  // Compile into the IR.
   std::vector<plannerpb::FuncToExecute> exec_funcs(query_request.exec_funcs().begin(),
                                                    query_request.exec_funcs().end());
   PX_ASSIGN_OR_RETURN(
       std::shared_ptr<IR> single_node_plan,
-      compiler_.CompileToIR(query_request.query_str(), compiler_state.get(), exec_funcs));
+      compiler_.CompileToIR(query_request.query_str(), compiler_state, exec_funcs));
   // Create the distributed plan.
   PX_ASSIGN_OR_RETURN(
       auto distributed_plan,
       distributed_planner_->Plan(query_request.logical_planner_state().distributed_state(),
-                                 compiler_state.get(), single_node_plan.get()));
+                                 compiler_state, single_node_plan.get()));
   distributed_plan->SetExecutionCompleteAddress(
       query_request.logical_planner_state().result_address(),
       query_request.logical_planner_state().result_ssl_targetname());
   return distributed_plan;
 }
 
+namespace {
+
+// The plan cache key is a fingerprint of everything that the plan is compiled from, except for
+// the time. The request embeds the schemas and agent state, which can be large, so only its
+// 128-bit fingerprint is kept.
+absl::uint128 PlanCacheKey(const plannerpb::QueryRequest& query_request) {
+  std::string serialized;
+  {
+    google::protobuf::io::StringOutputStream string_stream(&serialized);
+    google::protobuf::io::CodedOutputStream coded_stream(&string_stream);
+    // Map fields are otherwise serialized in an arbitrary order.
+    coded_stream.SetSerializationDeterministic(true);
+    query_request.SerializeToCodedStream(&coded_stream);
+  }
+  auto fingerprint = ::util::Fingerprint128(serialized.data(), serialized.size());
+  return absl::MakeUint128(::util::Uint128High64(fingerprint), ::util::Uint128Low64(fingerprint));
+}
+
+// Shifts the relative time bounds of the plan's memory sources by delta_ns.
+void ShiftTimeBounds(const absl::flat_hash_set<int64_t>& relative_time_bounds, int64_t delta_ns,
+                     distributedpb::DistributedPlan* plan) {
+  auto shift = [&](google::protobuf::Int64Value* time) {
+    if (relative_time_bounds.contains(time->value())) {
+      time->set_value(time->value() + delta_ns);
+    }
+  };
+  for (auto& [address, carnot_plan] : *plan->mutable_qb_address_to_plan()) {
+    for (auto& fragment : *carnot_plan.mutable_nodes()) {
+      for (auto& node : *fragment.mutable_nodes()) {
+        if (!node.op().has_mem_source_op()) {
+          continue;
+        }
+        auto* mem_source = node.mutable_op()->mutable_mem_source_op();
+        if (mem_source->has_start_time()) {
+          shift(mem_source->mutable_start_time());
+        }
+        if (mem_source->has_stop_time()) {
+          shift(mem_source->mutable_stop_time());
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+StatusOr<distributedpb::DistributedPlan> LogicalPlanner::PlanToProto(
+    const plannerpb::QueryRequest& query_request) {
+  absl::uint128 key = PlanCacheKey(query_request);
+  int64_t time_now = px::CurrentTimeNS();
+
+  {
+    absl::MutexLock lock(&plan_cache_lock_);
+    auto it = plan_cache_index_.find(key);
+    if (it != plan_cache_index_.end()) {
+      ++plan_cache_stats_.hits;
+      // Move the plan to the front, as the most recently used.
+      plan_cache_.splice(plan_cache_.begin(), plan_cache_, it->second);
+      const CachedPlan& cached = *it->second;
+      distributedpb::DistributedPlan plan = cached.plan;
+      ShiftTimeBounds(cached.relative_time_bounds, time_now - cached.compile_time_ns, &plan);
+      return plan;
+    }
+    ++plan_cache_stats_.misses;
+  }
+
+  auto ms = query_request.logical_planner_state().plan_options().max_output_rows_per_table();
+  PX_ASSIGN_OR_RETURN(
+      std::unique_ptr<CompilerState> compiler_state,
+      CreateCompilerState(query_request.logical_planner_state(), registry_info_.get(), ms));
+  PX_ASSIGN_OR_RETURN(auto distributed_plan, Plan(query_request, compiler_state.get()));
+  distributed_plan->SetPlanOptions(query_request.logical_planner_state().plan_options());
+  PX_ASSIGN_OR_RETURN(distributedpb::DistributedPlan plan, distributed_plan->ToProto());
+
+  absl::MutexLock lock(&plan_cache_lock_);
+  if (compiler_state->time_now_used()) {
+    ++plan_cache_stats_.uncacheable;
+    return plan;
+  }
+  // The plan may not fit in the cache, or a concurrent query may have cached it in the meantime.
+  size_t plan_bytes = plan.SpaceUsedLong();
+  if (plan_bytes > plan_cache_max_bytes_ || plan_cache_index_.contains(key)) {
+    return plan;
+  }
+  plan_cache_.push_front(CachedPlan{key, plan, compiler_state->time_now().val,
+                                    compiler_state->relative_time_bounds(), plan_bytes});
+  plan_cache_index_[key] = plan_cache_.begin();
+  plan_cache_bytes_ += plan_bytes;
+  EvictPlansLocked(plan_cache_max_bytes_);
+  return plan;
+}
+
+void LogicalPlanner::set_plan_cache_max_bytes(size_t max_bytes) {
+  absl::MutexLock lock(&plan_cache_lock_);
+  plan_cache_max_bytes_ = max_bytes;
+  EvictPlansLocked(max_bytes);
+}
+
+PlanCacheStats LogicalPlanner::plan_cache_stats() const {
+  absl::MutexLock lock(&plan_cache_lock_);
+  return plan_cache_stats_;
+}
+
+void LogicalPlanner::EvictPlansLocked(size_t max_bytes) {
+  while (plan_cache_bytes_ > max_bytes) {
+    plan_cache_bytes_ -= plan_cache_.back().bytes;
+    plan_cache_index_.erase(plan_cache_.back().key);
+    plan_cache_.pop_back();
+  }
+}
+
 StatusOr<std::unique_ptr<compiler::MutationsIR>> LogicalPlanner::CompileTrace(
     const plannerpb::CompileMutationsRequest& mutations_req) {
   // Compile into the IR.
@@ -17,10 +17,18 @@
  */
 
 #pragma once
+#include <list>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <absl/base/thread_annotations.h>
+#include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
+#include <absl/numeric/int128.h>
+#include <absl/synchronization/mutex.h>
+
 #include "src/carnot/planner/compiler/compiler.h"
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/distributed/distributed_plan/distributed_plan.h"
@@ -33,12 +41,25 @@ namespace px {
 namespace carnot {
 namespace planner {
 
+/**
+ * PlanCacheStats counts the lookups in the LogicalPlanner's cache of compiled plans.
+ */
+struct PlanCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  // Misses whose plan could not be cached, because it depends on the compile time in a way that
+  // can't be updated, such as through px.now().
+  int64_t uncacheable = 0;
+};
+
 /**
  * @brief The logical planner takes in queries and a Logical Planner State and
  *
  */
 class LogicalPlanner : public NotCopyable {
  public:
+  static constexpr size_t kDefaultPlanCacheMaxBytes = 64 * 1024 * 1024;
+
   /**
    * @brief The Creation function for the planner.
    *
@@ -57,6 +78,26 @@ class LogicalPlanner : public NotCopyable {
   StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
       const plannerpb::QueryRequest& query);
 
+  /**
+   * @brief Plans the query and returns the distributed plan proto, with the plan options of the
+   * query. Plans are cached by the query script, arguments and planner state, so repeated
+   * queries, such as refreshes of a live view, are not recompiled. The relative time bounds of
+   * tables (eg. start_time='-5m') are shifted to the time of the repeated query.
+   *
+   * @param query: QueryRequest
+   * @return distributedpb::DistributedPlan or error if one occurs during compilation.
+   */
+  StatusOr<distributedpb::DistributedPlan> PlanToProto(const plannerpb::QueryRequest& query);
+
+  /**
+   * @brief Sets the maximum total size, in bytes of memory, of the plans in the cache used by
+   * PlanToProto. The least recently used plans are evicted first. Plans larger than the limit are
+   * not cached, so a limit of zero disables the cache.
+   */
+  void set_plan_cache_max_bytes(size_t max_bytes);
+
+  PlanCacheStats plan_cache_stats() const;
+
   StatusOr<std::unique_ptr<compiler::MutationsIR>> CompileTrace(
       const plannerpb::CompileMutationsRequest& mutations_req);
 
@@ -70,9 +111,34 @@ class LogicalPlanner : public NotCopyable {
   LogicalPlanner() {}
 
  private:
+  // A compiled plan, along with what is needed to reuse it at a later time.
+  struct CachedPlan {
+    // A fingerprint of the query request, see PlanCacheKey().
+    absl::uint128 key;
+    distributedpb::DistributedPlan plan;
+    int64_t compile_time_ns;
+    absl::flat_hash_set<int64_t> relative_time_bounds;
+    // The memory used by the plan, counted against the cache's byte limit.
+    size_t bytes;
+  };
+
+  StatusOr<std::unique_ptr<distributed::DistributedPlan>> Plan(
+      const plannerpb::QueryRequest& query, CompilerState* compiler_state);
+
+  void EvictPlansLocked(size_t max_bytes) ABSL_EXCLUSIVE_LOCKS_REQUIRED(plan_cache_lock_);
+
   compiler::Compiler compiler_;
   std::unique_ptr<distributed::Planner> distributed_planner_;
   std::unique_ptr<planner::RegistryInfo> registry_info_;
+
+  mutable absl::Mutex plan_cache_lock_;
+  size_t plan_cache_max_bytes_ ABSL_GUARDED_BY(plan_cache_lock_) = kDefaultPlanCacheMaxBytes;
+  size_t plan_cache_bytes_ ABSL_GUARDED_BY(plan_cache_lock_) = 0;
+  // The cached plans, from most to least recently used, and an index into them by key.
+  std::list<CachedPlan> plan_cache_ ABSL_GUARDED_BY(plan_cache_lock_);
+  absl::flat_hash_map<absl::uint128, std::list<CachedPlan>::iterator> plan_cache_index_
+      ABSL_GUARDED_BY(plan_cache_lock_);
+  PlanCacheStats plan_cache_stats_ ABSL_GUARDED_BY(plan_cache_lock_);
 };
 
 StatusOr<std::unique_ptr<CompilerState>> CreateCompilerState(
@@ -45,6 +45,25 @@ void BM_Query(benchmark::State& state) {
 
 BENCHMARK(BM_Query);
 
+// NOLINTNEXTLINE : runtime/references.
+void BM_QueryCached(benchmark::State& state) {
+  auto info = udfexporter::ExportUDFInfo().ConsumeValueOrDie()->info_pb();
+  auto planner = LogicalPlanner::Create(info).ConsumeValueOrDie();
+  plannerpb::QueryRequest query_request;
+  query_request.set_query_str(testutils::kHttpRequestStats);
+  *query_request.mutable_logical_planner_state() =
+      testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  for (auto _ : state) {
+    auto plan_or_s = planner->PlanToProto(query_request);
+    EXPECT_OK(plan_or_s);
+  }
+  PlanCacheStats stats = planner->plan_cache_stats();
+  state.counters["cache_hits"] = stats.hits;
+  state.counters["cache_misses"] = stats.misses;
+}
+
+BENCHMARK(BM_QueryCached);
+
 }  // namespace logical_planner
 }  // namespace planner
 }  // namespace carnot
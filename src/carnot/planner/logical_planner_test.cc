@@ -805,6 +805,79 @@ px.export(otel_df, px.otel.Data(
 )))otel");
 }
 
+// Returns the start times of the memory sources in the plan.
+std::vector<int64_t> MemorySourceStartTimes(const distributedpb::DistributedPlan& plan) {
+  std::vector<int64_t> start_times;
+  for (const auto& [address, carnot_plan] : plan.qb_address_to_plan()) {
+    for (const auto& fragment : carnot_plan.nodes()) {
+      for (const auto& node : fragment.nodes()) {
+        if (node.op().has_mem_source_op() && node.op().mem_source_op().has_start_time()) {
+          start_times.push_back(node.op().mem_source_op().start_time().value());
+        }
+      }
+    }
+  }
+  return start_times;
+}
+
+TEST_F(LogicalPlannerTest, PlanCache) {
+  auto planner = LogicalPlanner::Create(info_).ConsumeValueOrDie();
+  auto state = testutils::CreateTwoPEMsOneKelvinPlannerState(testutils::kHttpEventsSchema);
+  auto relative_query = MakeQueryRequest(state, R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time='-5m', select=['time_', 'upid'])
+px.display(df, 'out')
+)pxl");
+  auto absolute_query = MakeQueryRequest(state, R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time=10, select=['time_', 'upid'])
+px.display(df, 'out')
+)pxl");
+  auto now_query = MakeQueryRequest(state, R"pxl(
+import px
+df = px.DataFrame(table='http_events', start_time=px.now() - px.minutes(5))
+px.display(df, 'out')
+)pxl");
+
+  ASSERT_OK_AND_ASSIGN(auto compiled_plan, planner->PlanToProto(relative_query));
+  ASSERT_OK_AND_ASSIGN(auto cached_plan, planner->PlanToProto(relative_query));
+  EXPECT_EQ(1, planner->plan_cache_stats().misses);
+  EXPECT_EQ(1, planner->plan_cache_stats().hits);
+
+  // The relative start time is shifted to the time of the second query.
+  auto compiled_start_times = MemorySourceStartTimes(compiled_plan);
+  auto cached_start_times = MemorySourceStartTimes(cached_plan);
+  ASSERT_EQ(2, compiled_start_times.size());
+  ASSERT_EQ(compiled_start_times.size(), cached_start_times.size());
+  EXPECT_GE(cached_start_times[0], compiled_start_times[0]);
+
+  // Absolute times are not shifted.
+  ASSERT_OK(planner->PlanToProto(absolute_query));
+  ASSERT_OK_AND_ASSIGN(cached_plan, planner->PlanToProto(absolute_query));
+  EXPECT_EQ(2, planner->plan_cache_stats().hits);
+  EXPECT_THAT(MemorySourceStartTimes(cached_plan), ::testing::Each(10));
+
+  // Plans that use px.now() are always recompiled.
+  ASSERT_OK(planner->PlanToProto(now_query));
+  ASSERT_OK(planner->PlanToProto(now_query));
+  EXPECT_EQ(2, planner->plan_cache_stats().uncacheable);
+  EXPECT_EQ(2, planner->plan_cache_stats().hits);
+
+  // Plans are evicted, least recently used first, to stay within the byte limit. The relative and
+  // absolute plans have about the same size, so only one of them fits.
+  planner->set_plan_cache_max_bytes(compiled_plan.SpaceUsedLong() * 3 / 2);
+  ASSERT_OK(planner->PlanToProto(relative_query));
+  ASSERT_OK(planner->PlanToProto(relative_query));
+  EXPECT_EQ(5, planner->plan_cache_stats().misses);
+  EXPECT_EQ(3, planner->plan_cache_stats().hits);
+
+  // Plans that don't fit are not cached.
+  planner->set_plan_cache_max_bytes(0);
+  ASSERT_OK(planner->PlanToProto(relative_query));
+  EXPECT_EQ(6, planner->plan_cache_stats().misses);
+  EXPECT_EQ(3, planner->plan_cache_stats().hits);
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
@@ -114,14 +114,12 @@ StatusOr<QLObjectPtr> DataFrameConstructor(CompilerState* compiler_state, IR* gr
 
   if (!NoneObject::IsNoneObject(args.GetArg("start_time"))) {
     PX_ASSIGN_OR_RETURN(ExpressionIR * start_time, GetArgAs<ExpressionIR>(ast, args, "start_time"));
-    PX_ASSIGN_OR_RETURN(auto start_time_ns,
-                        ParseAllTimeFormats(compiler_state->time_now().val, start_time));
+    PX_ASSIGN_OR_RETURN(auto start_time_ns, ParseTimeBound(compiler_state, start_time));
     mem_source_op->SetTimeStartNS(start_time_ns);
   }
   if (!NoneObject::IsNoneObject(args.GetArg("end_time"))) {
     PX_ASSIGN_OR_RETURN(ExpressionIR * end_time, GetArgAs<ExpressionIR>(ast, args, "end_time"));
-    PX_ASSIGN_OR_RETURN(auto end_time_ns,
-                        ParseAllTimeFormats(compiler_state->time_now().val, end_time));
+    PX_ASSIGN_OR_RETURN(auto end_time_ns, ParseTimeBound(compiler_state, end_time));
     mem_source_op->SetTimeStopNS(end_time_ns);
   }
   return Dataframe::Create(compiler_state, mem_source_op, visitor);
@@ -35,6 +35,17 @@ StatusOr<int64_t> ParseAllTimeFormats(int64_t time_now, ExpressionIR* time_expr)
   return 0;
 }
 
+StatusOr<int64_t> ParseTimeBound(CompilerState* compiler_state, ExpressionIR* time_expr) {
+  if (Match(time_expr, String())) {
+    auto offset_or_s = StringToTimeInt(static_cast<StringIR*>(time_expr)->str());
+    if (offset_or_s.ok()) {
+      return compiler_state->RelativeTimeBound(offset_or_s.ConsumeValueOrDie());
+    }
+  }
+  // Any other time is absolute, so does not depend on the compile time.
+  return ParseAllTimeFormats(/* time_now */ 0, time_expr);
+}
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
@@ -25,6 +25,7 @@
 #include <absl/container/flat_hash_set.h>
 #include <pypa/ast/ast.hh>
 
+#include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/time.h"
 #include "src/carnot/planner/objects/collection_object.h"
 #include "src/carnot/planner/objects/funcobject.h"
@@ -36,6 +37,12 @@ namespace compiler {
 
 StatusOr<int64_t> ParseAllTimeFormats(int64_t time_now, ExpressionIR* time_expr);
 
+/**
+ * Parses the start or end time of a table. Durations such as '-5m' are relative to the compile
+ * time, and are tracked by the compiler state as relative time bounds.
+ */
+StatusOr<int64_t> ParseTimeBound(CompilerState* compiler_state, ExpressionIR* time_expr);
+
 }  // namespace compiler
 }  // namespace planner
 }  // namespace carnot
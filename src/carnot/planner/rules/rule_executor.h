@@ -23,6 +23,8 @@
 #include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_set.h>
+
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/ir/ir.h"
 #include "src/carnot/planner/rules/rules.h"
@@ -108,9 +110,19 @@ class BaseRuleBatch {
   }
   const std::string name() const { return name_; }
 
+  /**
+   * @brief Incremental batches run every rule on the whole graph once, and afterwards only on the
+   * nodes touched by the previous iteration: the nodes a rule changed or created, and their
+   * parents and children. Only suitable for rules whose Apply() changes the neighborhood of the
+   * node it is called on, and which don't override Execute().
+   */
+  bool incremental() const { return incremental_; }
+  void set_incremental(bool incremental) { incremental_ = incremental; }
+
  private:
   std::string name_;
   std::unique_ptr<Strategy> strategy_;
+  bool incremental_ = false;
   std::vector<std::unique_ptr<TRuleType>> rules_;
 };
 
@@ -126,6 +138,10 @@ class RuleExecutor {
   // TODO(philkuz) figure out how to collect stats on the execution.
   Status Execute(TPlan* ir_graph) {
     for (const auto& rb : rule_batches) {
+      if (rb->incremental()) {
+        PX_RETURN_IF_ERROR(ExecuteIncremental(rb.get(), ir_graph));
+        continue;
+      }
       bool can_continue = true;
       int64_t iteration = 0;
       // We continue executing a batch until a stop condition is met.
@@ -161,6 +177,47 @@ class RuleExecutor {
   }
 
  private:
+  Status ExecuteIncremental(TRuleBatch* rb, TPlan* ir_graph) {
+    absl::flat_hash_set<int64_t> worklist = ir_graph->dag().nodes();
+    for (int64_t iteration = 1; !worklist.empty(); ++iteration) {
+      absl::flat_hash_set<int64_t> nodes_before = ir_graph->dag().nodes();
+      absl::flat_hash_set<int64_t> touched_nodes;
+      bool graph_is_updated = false;
+      for (const auto& rule : rb->rules()) {
+        PX_ASSIGN_OR_RETURN(bool rule_updates_graph,
+                            rule->ExecuteOnWorklist(ir_graph, worklist, &touched_nodes));
+        graph_is_updated = graph_is_updated || rule_updates_graph;
+      }
+      if (!graph_is_updated) {
+        break;
+      }
+      if (iteration >= rb->max_iterations()) {
+        return rb->MaxIterationsHandler();
+      }
+
+      // The next iteration visits the touched and created nodes, and their current neighbors.
+      for (int64_t node : ir_graph->dag().nodes()) {
+        if (!nodes_before.contains(node)) {
+          touched_nodes.insert(node);
+        }
+      }
+      worklist.clear();
+      for (int64_t node : touched_nodes) {
+        if (!ir_graph->HasNode(node)) {
+          continue;
+        }
+        worklist.insert(node);
+        for (int64_t parent : ir_graph->dag().ParentsOf(node)) {
+          worklist.insert(parent);
+        }
+        for (int64_t child : ir_graph->dag().DependenciesOf(node)) {
+          worklist.insert(child);
+        }
+      }
+    }
+    return Status::OK();
+  }
+
   std::vector<std::unique_ptr<TRuleBatch>> rule_batches;
 };
 
@@ -182,6 +182,55 @@ TEST_F(RuleExecutorTest, exit_early) {
   EXPECT_NOT_OK(executor->Execute(graph.get()));
 }
 
+// Counts the operators it is applied to, and changes the given node the first time it sees it.
+class ChangeNodeOnceRule : public Rule {
+ public:
+  explicit ChangeNodeOnceRule(int64_t node_id)
+      : Rule(nullptr, /*use_topo*/ true, /*reverse_topological_execution*/ false),
+        node_id_(node_id) {}
+
+  bool Matches(const IRNode* ir_node) const override { return Match(ir_node, Operator()); }
+
+  absl::flat_hash_map<int64_t, int64_t> visits;
+
+ protected:
+  StatusOr<bool> Apply(IRNode* ir_node) override {
+    ++visits[ir_node->id()];
+    return ir_node->id() == node_id_ && visits[ir_node->id()] == 1;
+  }
+
+ private:
+  int64_t node_id_;
+};
+
+// Tests that incremental batches only revisit the neighborhood of changed nodes.
+TEST_F(RuleExecutorTest, incremental_rule_batch) {
+  auto other_src =
+      graph->CreateNode<MemorySourceIR>(ast, "other", std::vector<std::string>{}).ValueOrDie();
+
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 10);
+  rule_batch->set_incremental(true);
+  auto rule = rule_batch->AddRule<ChangeNodeOnceRule>(map->id());
+  ASSERT_OK(executor->Execute(graph.get()));
+
+  // The map and its parent are visited again after the map changes, the other source is not.
+  EXPECT_EQ(2, rule->visits[map->id()]);
+  EXPECT_EQ(2, rule->visits[mem_src->id()]);
+  EXPECT_EQ(1, rule->visits[other_src->id()]);
+  // Expressions don't match the rule.
+  EXPECT_FALSE(rule->visits.contains(func->id()));
+}
+
+// Tests that incremental batches still respect the max iterations of their strategy.
+TEST_F(RuleExecutorTest, incremental_rule_batch_max_iterations) {
+  std::unique_ptr<TestExecutor> executor = std::move(TestExecutor::Create().ValueOrDie());
+  RuleBatch* rule_batch = executor->CreateRuleBatch<FailOnMax>("resolve", 1);
+  rule_batch->set_incremental(true);
+  rule_batch->AddRule<ChangeNodeOnceRule>(map->id());
+  EXPECT_NOT_OK(executor->Execute(graph.get()));
+}
+
 }  // namespace planner
 }  // namespace carnot
 }  // namespace px
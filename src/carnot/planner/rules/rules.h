@@ -17,12 +17,14 @@
  */
 
 #pragma once
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <string>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/container/flat_hash_set.h>
 
 #include "src/carnot/planner/compiler_state/compiler_state.h"
 #include "src/carnot/planner/compiler_state/registry_info.h"
@@ -65,6 +67,60 @@ class BaseRule {
     return any_changed;
   }
 
+  /**
+   * @brief Applies the rule to the nodes of the worklist, in the same order that Execute() visits
+   * them. Used by incremental rule batches, which only revisit the nodes touched by the previous
+   * iteration.
+   *
+   * @param worklist - the nodes to apply the rule to.
+   * @param touched_nodes - the nodes that the rule changed, along with the parents and children
+   * they had before the change, are added to this set.
+   * @return true: if the rule changes any node.
+   */
+  StatusOr<bool> ExecuteOnWorklist(TPlan* graph, const absl::flat_hash_set<int64_t>& worklist,
+                                   absl::flat_hash_set<int64_t>* touched_nodes) {
+    std::vector<int64_t> nodes;
+    if (!use_topo_) {
+      nodes.assign(worklist.begin(), worklist.end());
+    } else {
+      for (int64_t node_i : graph->dag().TopologicalSort()) {
+        if (worklist.contains(node_i)) {
+          nodes.push_back(node_i);
+        }
+      }
+      if (reverse_topological_execution_) {
+        std::reverse(nodes.begin(), nodes.end());
+      }
+    }
+
+    bool any_changed = false;
+    for (int64_t node_i : nodes) {
+      // The node may have been deleted by a prior call to Apply on a parent or child node.
+      if (!graph->HasNode(node_i) || !Matches(graph->Get(node_i))) {
+        continue;
+      }
+      // The neighbors are collected before the rule runs, as the rule may delete the node.
+      std::vector<int64_t> parents = graph->dag().ParentsOf(node_i);
+      std::vector<int64_t> children = graph->dag().DependenciesOf(node_i);
+      PX_ASSIGN_OR_RETURN(bool node_is_changed, Apply(graph->Get(node_i)));
+      if (node_is_changed) {
+        touched_nodes->insert(node_i);
+        touched_nodes->insert(parents.begin(), parents.end());
+        touched_nodes->insert(children.begin(), children.end());
+      }
+      any_changed = any_changed || node_is_changed;
+    }
+    PX_RETURN_IF_ERROR(EmptyDeleteQueue(graph));
+    return any_changed;
+  }
+
+  /**
+   * @brief Returns false for nodes that the rule never changes, so that incremental rule batches
+   * can skip them. Rules declare the nodes they handle with a pattern from pattern_match.h, ie
+   * `return Match(node, Operator());`.
+   */
+  virtual bool Matches(const typename RuleTraits<TPlan>::node_type*) const { return true; }
+
  protected:
   StatusOr<bool> ExecuteTopologicalSorted(TPlan* graph) {
     bool any_changed = false;
@@ -74,6 +74,17 @@ class AnyUDA : public BaseFunc {
  *      Status Init(FunctionContext *ctx, UDFValue... init_args) {}
  *  This function is called once during initialization of each instance (many instances
  *  may exists in a given query). The arguments are as provided by the query.
+ *
+ * A ScalarUDF with a single Exec argument can also declare:
+ *      static constexpr bool Deterministic() { return true; }
+ *  if Exec returns the same value for the same argument for the duration of a query. Exec is
+ *  then called once per distinct argument of each batch, instead of once per record.
+ *
+ * A ScalarUDF with a single Exec argument can also implement:
+ *      Status ExecBatch(FunctionContext *ctx, absl::Span<const UDFValue> args, UDFValue* out) {}
+ *  which is called once per batch with all of its records, instead of calling Exec for each
+ *  record. This is meant for UDFs with a high fixed cost per call, such as model inference.
+ *  Exec must still be implemented, it defines the types of the UDF.
  */
 class ScalarUDF : public AnyUDF {
  public:
@@ -176,6 +187,21 @@ struct check_executor_fn<T, typename std::enable_if_t<has_udf_executor_fn<T>::va
                 "must have a valid Executor fn, in form: UDFSourceExecutor Executor()");
 };
 
+// SFINAE test for ExecBatch fn.
+template <typename T, typename = void>
+struct has_udf_exec_batch_fn : std::false_type {};
+
+template <typename T>
+struct has_udf_exec_batch_fn<T, std::void_t<decltype(&T::ExecBatch)>> : std::true_type {};
+
+// SFINAE test for Deterministic fn.
+template <typename T, typename = void>
+struct is_udf_deterministic : std::false_type {};
+
+template <typename T>
+struct is_udf_deterministic<T, std::void_t<decltype(&T::Deterministic)>>
+    : std::bool_constant<T::Deterministic()> {};
+
 template <typename ReturnType, typename TUDF, typename... Types>
 static constexpr std::array<types::DataType, sizeof...(Types)> GetArgumentTypesHelper(
     ReturnType (TUDF::*)(FunctionContext*, Types...)) {
@@ -228,6 +254,36 @@ class ScalarUDFTraits {
    */
   static constexpr bool HasExecutor() { return has_udf_executor_fn<T>::value; }
 
+  /**
+   * Checks if the UDF implements ExecBatch, which is called once for all of the records of a
+   * batch.
+   */
+  static constexpr bool HasExecBatch() {
+    if constexpr (has_udf_exec_batch_fn<T>::value) {
+      static_assert(ExecArguments().size() == 1, "ExecBatch is only supported with one argument");
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * Checks if the UDF's Exec is executed once per distinct argument of a batch.
+   * This applies to deterministic UDFs with a single argument of a hashable type.
+   */
+  static constexpr bool MemoizeExec() {
+    constexpr auto exec_argument_types = ExecArguments();
+    if constexpr (exec_argument_types.size() != 1) {
+      return false;
+    } else {
+      return is_udf_deterministic<T>::value &&
+             (exec_argument_types[0] == types::DataType::INT64 ||
+              exec_argument_types[0] == types::DataType::UINT128 ||
+              exec_argument_types[0] == types::DataType::TIME64NS ||
+              exec_argument_types[0] == types::DataType::STRING);
+    }
+  }
+
   template <typename Q = T, std::enable_if_t<ScalarUDFTraits<Q>::HasInit(), void>* = nullptr>
   static constexpr auto InitArguments() {
     return GetArgumentTypesHelper(&Q::Init);
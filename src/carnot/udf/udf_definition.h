@@ -205,6 +205,8 @@ class UDADefinition : public UDFDefinition {
                                update_arguments_.end());
 
     merge_fn_ = UDAWrapper<T>::Merge;
+    serialize_fn_ = UDAWrapper<T>::Serialize;
+    deserialize_fn_ = UDAWrapper<T>::Deserialize;
     finalize_arrow_fn_ = UDAWrapper<T>::FinalizeArrow;
     finalize_value_fn = UDAWrapper<T>::FinalizeValue;
 
@@ -239,6 +241,12 @@ class UDADefinition : public UDFDefinition {
   }
 
   Status Merge(UDA* uda1, UDA* uda2, FunctionContext* ctx) { return merge_fn_(uda1, uda2, ctx); }
+  StatusOr<types::StringValue> Serialize(UDA* uda, FunctionContext* ctx) {
+    return serialize_fn_(uda, ctx);
+  }
+  Status Deserialize(UDA* uda, FunctionContext* ctx, const types::StringValue& data) {
+    return deserialize_fn_(uda, ctx, data);
+  }
   Status FinalizeValue(UDA* uda, FunctionContext* ctx, types::BaseValueType* output) {
     return finalize_value_fn(uda, ctx, output);
   }
@@ -267,6 +275,9 @@ class UDADefinition : public UDFDefinition {
   std::function<Status(UDA* uda, FunctionContext* ctx, types::BaseValueType* output)>
       finalize_value_fn;
   std::function<Status(UDA* uda1, UDA* uda2, FunctionContext* ctx)> merge_fn_;
+  std::function<StatusOr<types::StringValue>(UDA* uda, FunctionContext* ctx)> serialize_fn_;
+  std::function<Status(UDA* uda, FunctionContext* ctx, const types::StringValue& data)>
+      deserialize_fn_;
   std::function<Status(UDA* uda, FunctionContext* ctx,
                        const std::vector<std::shared_ptr<types::BaseValueType>>& inputs)>
       init_wrapper_fn_;
@@ -67,6 +67,34 @@ class InitArgUDF : public ScalarUDF {
   int64_t i_;
 };
 
+class DeterministicUDF : public ScalarUDF {
+ public:
+  types::StringValue Exec(FunctionContext*, types::UInt128Value upid) {
+    ++invoke_count;
+    return absl::StrCat("pod-", upid.High64(), "-", upid.Low64());
+  }
+
+  static constexpr bool Deterministic() { return true; }
+
+  int invoke_count = 0;
+};
+
+class BatchedUDF : public ScalarUDF {
+ public:
+  types::Int64Value Exec(FunctionContext*, types::StringValue str) { return str.size(); }
+
+  Status ExecBatch(FunctionContext*, absl::Span<const types::StringValue> strs,
+                   types::Int64Value* out) {
+    ++exec_batch_count;
+    for (size_t i = 0; i < strs.size(); ++i) {
+      out[i] = strs[i].size() + 100;
+    }
+    return Status::OK();
+  }
+
+  int exec_batch_count = 0;
+};
+
 TEST(UDFDefinition, no_args) {
   auto ctx = FunctionContext(nullptr, nullptr);
   ScalarUDFDefinition def("noargudf");
@@ -161,6 +189,89 @@ TEST(UDFDefinition, init_args) {
   EXPECT_EQ("init_arg, 10, hello", out[2]);
 }
 
+TEST(UDFDefinition, memoized_exec) {
+  EXPECT_TRUE(ScalarUDFTraits<DeterministicUDF>::MemoizeExec());
+  EXPECT_FALSE(ScalarUDFTraits<SubStrUDF>::MemoizeExec());
+
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("deterministic");
+  EXPECT_OK(def.Init<DeterministicUDF>());
+
+  types::UInt128ValueColumnWrapper upids({absl::MakeUint128(1, 2), absl::MakeUint128(3, 4),
+                                          absl::MakeUint128(1, 2), absl::MakeUint128(1, 2)});
+
+  types::StringValueColumnWrapper out(upids.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&upids}, &out, upids.Size()));
+
+  EXPECT_EQ(2, static_cast<DeterministicUDF*>(u.get())->invoke_count);
+  EXPECT_EQ("pod-1-2", out[0]);
+  EXPECT_EQ("pod-3-4", out[1]);
+  EXPECT_EQ("pod-1-2", out[2]);
+  EXPECT_EQ("pod-1-2", out[3]);
+}
+
+TEST(UDFDefinition, memoized_exec_arrow) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::UInt128Value> upids = {absl::MakeUint128(1, 2), absl::MakeUint128(3, 4),
+                                            absl::MakeUint128(3, 4)};
+  auto upids_arrow = ToArrow(upids, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::StringBuilder>();
+  auto u = std::make_shared<DeterministicUDF>();
+  EXPECT_OK(ScalarUDFWrapper<DeterministicUDF>::ExecBatchArrow(
+      u.get(), &ctx, {upids_arrow.get()}, output_builder.get(), upids.size()));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* res_arr = static_cast<arrow::StringArray*>(res.get());
+  EXPECT_EQ(2, u->invoke_count);
+  ASSERT_EQ(3, res_arr->length());
+  EXPECT_EQ("pod-1-2", res_arr->GetString(0));
+  EXPECT_EQ("pod-3-4", res_arr->GetString(1));
+  EXPECT_EQ("pod-3-4", res_arr->GetString(2));
+}
+
+TEST(UDFDefinition, exec_batch) {
+  EXPECT_TRUE(ScalarUDFTraits<BatchedUDF>::HasExecBatch());
+  EXPECT_FALSE(ScalarUDFTraits<SubStrUDF>::HasExecBatch());
+
+  auto ctx = FunctionContext(nullptr, nullptr);
+  ScalarUDFDefinition def("batched");
+  EXPECT_OK(def.Init<BatchedUDF>());
+
+  types::StringValueColumnWrapper strs({"a", "bc", "", "def"});
+  types::Int64ValueColumnWrapper out(strs.Size());
+  auto u = def.Make();
+  EXPECT_OK(def.ExecBatch(u.get(), &ctx, {&strs}, &out, strs.Size()));
+
+  EXPECT_EQ(1, static_cast<BatchedUDF*>(u.get())->exec_batch_count);
+  EXPECT_EQ(101, out[0].val);
+  EXPECT_EQ(102, out[1].val);
+  EXPECT_EQ(100, out[2].val);
+  EXPECT_EQ(103, out[3].val);
+}
+
+TEST(UDFDefinition, exec_batch_arrow) {
+  auto ctx = FunctionContext(nullptr, nullptr);
+  std::vector<types::StringValue> strs = {"a", "bc", "def"};
+  auto strs_arrow = ToArrow(strs, arrow::default_memory_pool());
+
+  auto output_builder = std::make_shared<arrow::Int64Builder>();
+  auto u = std::make_shared<BatchedUDF>();
+  EXPECT_OK(ScalarUDFWrapper<BatchedUDF>::ExecBatchArrow(u.get(), &ctx, {strs_arrow.get()},
+                                                         output_builder.get(), strs.size()));
+
+  std::shared_ptr<arrow::Array> res;
+  EXPECT_TRUE(output_builder->Finish(&res).ok());
+  auto* res_arr = static_cast<arrow::Int64Array*>(res.get());
+  EXPECT_EQ(1, u->exec_batch_count);
+  ASSERT_EQ(3, res_arr->length());
+  EXPECT_EQ(101, res_arr->Value(0));
+  EXPECT_EQ(102, res_arr->Value(1));
+  EXPECT_EQ(103, res_arr->Value(2));
+}
+
 // Test UDA, takes the min of two arguments and then sums them.
 class MinSumUDA : public udf::UDA {
  public:
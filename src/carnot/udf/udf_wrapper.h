@@ -22,8 +22,14 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
+
 #include "src/carnot/udf/udf.h"
 #include "src/carnot/udf/udtf.h"
 #include "src/common/base/base.h"
@@ -132,6 +138,138 @@ Status ExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput*
   return Status::OK();
 }
 
+// The key that memoized UDFs use to find repeated arguments. Strings are keyed by views into the
+// input batch, which outlives the memo.
+template <types::DataType TArgType>
+using MemoKey = std::conditional_t<TArgType == types::DataType::STRING, std::string_view,
+                                   typename types::DataTypeTraits<TArgType>::native_type>;
+
+template <types::DataType TArgType>
+inline MemoKey<TArgType> GetMemoKey(const types::BaseValueType* arg, size_t idx) {
+  const auto& val = CastToUDFValueType<TArgType>(arg)[idx];
+  if constexpr (TArgType == types::DataType::STRING) {
+    return std::string_view(val);
+  } else {
+    return val.val;
+  }
+}
+
+template <types::DataType TArgType>
+inline MemoKey<TArgType> GetMemoKey(const arrow::Array* arg, size_t idx) {
+  if constexpr (TArgType == types::DataType::STRING) {
+    return types::GetStringViewFromArrowArray(arg, idx);
+  } else {
+    return types::GetValueFromArrowArray<TArgType>(arg, idx);
+  }
+}
+
+/**
+ * The memoized version of ExecWrapper, for UDFs where ScalarUDFTraits<TUDF>::MemoizeExec().
+ * Calls Exec once for each distinct argument in the batch, and copies the result to the
+ * records with repeated arguments.
+ */
+template <typename TUDF, typename TOutput>
+Status MemoizedExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                           const types::BaseValueType* arg) {
+  constexpr types::DataType arg_type = ScalarUDFTraits<TUDF>::ExecArguments()[0];
+  const auto* args = CastToUDFValueType<arg_type>(arg);
+
+  // Maps each distinct argument to the first record that has it.
+  absl::flat_hash_map<MemoKey<arg_type>, size_t> first_idx;
+  for (size_t idx = 0; idx < count; ++idx) {
+    auto [it, inserted] = first_idx.try_emplace(GetMemoKey<arg_type>(arg, idx), idx);
+    if (inserted) {
+      out[idx] = udf->Exec(ctx, args[idx]);
+    } else {
+      out[idx] = out[it->second];
+    }
+  }
+  return Status::OK();
+}
+
+/**
+ * The memoized version of ExecWrapperArrow, for UDFs where ScalarUDFTraits<TUDF>::MemoizeExec().
+ */
+template <typename TUDF, typename TOutput>
+Status MemoizedExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                                const arrow::Array* arg) {
+  constexpr types::DataType arg_type = ScalarUDFTraits<TUDF>::ExecArguments()[0];
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+  using result_type = decltype(UnWrap(
+      std::declval<typename types::DataTypeTraits<return_type>::value_type>()));
+
+  // The results of the distinct arguments, and the index of each record's result.
+  std::vector<result_type> results;
+  std::vector<size_t> result_idx(count);
+  absl::flat_hash_map<MemoKey<arg_type>, size_t> memo;
+  size_t total_size = 0;
+  for (size_t idx = 0; idx < count; ++idx) {
+    auto [it, inserted] = memo.try_emplace(GetMemoKey<arg_type>(arg, idx), results.size());
+    if (inserted) {
+      results.push_back(
+          UnWrap(udf->Exec(ctx, types::GetValueFromArrowArray<arg_type>(arg, idx))));
+    }
+    result_idx[idx] = it->second;
+    // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+    if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
+      total_size += results[it->second].size();
+    }
+  }
+
+  // The exact size of the output is known, so reserve it all up front.
+  PX_RETURN_IF_ERROR(out->Reserve(count));
+  if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
+    PX_RETURN_IF_ERROR(out->ReserveData(total_size));
+  }
+  for (size_t idx = 0; idx < count; ++idx) {
+    out->UnsafeAppend(results[result_idx[idx]]);
+  }
+  return Status::OK();
+}
+
+/**
+ * The batched version of ExecWrapper, for UDFs where ScalarUDFTraits<TUDF>::HasExecBatch().
+ */
+template <typename TUDF, typename TOutput>
+Status BatchedExecWrapper(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                          const types::BaseValueType* arg) {
+  constexpr types::DataType arg_type = ScalarUDFTraits<TUDF>::ExecArguments()[0];
+  const auto* args = CastToUDFValueType<arg_type>(arg);
+  return udf->ExecBatch(ctx, absl::MakeConstSpan(args, count), out);
+}
+
+/**
+ * The batched version of ExecWrapperArrow, for UDFs where ScalarUDFTraits<TUDF>::HasExecBatch().
+ */
+template <typename TUDF, typename TOutput>
+Status BatchedExecWrapperArrow(TUDF* udf, FunctionContext* ctx, size_t count, TOutput* out,
+                               const arrow::Array* arg) {
+  constexpr types::DataType arg_type = ScalarUDFTraits<TUDF>::ExecArguments()[0];
+  constexpr types::DataType return_type = ScalarUDFTraits<TUDF>::ReturnType();
+
+  std::vector<typename types::DataTypeTraits<arg_type>::value_type> args;
+  args.reserve(count);
+  for (size_t idx = 0; idx < count; ++idx) {
+    args.emplace_back(types::GetValueFromArrowArray<arg_type>(arg, idx));
+  }
+  std::vector<typename types::DataTypeTraits<return_type>::value_type> results(count);
+  PX_RETURN_IF_ERROR(udf->ExecBatch(ctx, absl::MakeConstSpan(args), results.data()));
+
+  PX_RETURN_IF_ERROR(out->Reserve(count));
+  // PX_CARNOT_UPDATE_FOR_NEW_TYPES.
+  if constexpr (std::is_same_v<arrow::StringBuilder, TOutput>) {
+    size_t total_size = 0;
+    for (const auto& res : results) {
+      total_size += res.size();
+    }
+    PX_RETURN_IF_ERROR(out->ReserveData(total_size));
+  }
+  for (const auto& res : results) {
+    out->UnsafeAppend(UnWrap(res));
+  }
+  return Status::OK();
+}
+
 /**
  * Checks types between column wrapper and array of types::UDFDataTypes.
  * @return true if all types match.
@@ -200,10 +338,18 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapperArrow<TUDF>(
-        static_cast<TUDF*>(udf), ctx, count,
-        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output),
-        inputs, std::make_index_sequence<exec_argument_types.size()>{});
+    auto* casted_output =
+        static_cast<typename types::DataTypeTraits<return_type>::arrow_builder_type*>(output);
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return BatchedExecWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                           inputs[0]);
+    } else if constexpr (ScalarUDFTraits<TUDF>::MemoizeExec()) {
+      return MemoizedExecWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                            inputs[0]);
+    } else {
+      return ExecWrapperArrow<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output, inputs,
+                                    std::make_index_sequence<exec_argument_types.size()>{});
+    }
   }
 
   /**
@@ -241,9 +387,17 @@ struct ScalarUDFWrapper {
     // The outer wrapper just casts the output type and UDF type. We then pass in
     // the inputs with a sequence based on the number of arguments to iterate through and
     // cast the inputs.
-    return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
-                             input_as_base_value,
-                             std::make_index_sequence<exec_argument_types.size()>{});
+    if constexpr (ScalarUDFTraits<TUDF>::HasExecBatch()) {
+      return BatchedExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                      input_as_base_value[0]);
+    } else if constexpr (ScalarUDFTraits<TUDF>::MemoizeExec()) {
+      return MemoizedExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                                       input_as_base_value[0]);
+    } else {
+      return ExecWrapper<TUDF>(static_cast<TUDF*>(udf), ctx, count, casted_output,
+                               input_as_base_value,
+                               std::make_index_sequence<exec_argument_types.size()>{});
+    }
   }
 
   /**
@@ -405,6 +559,36 @@ struct UDAWrapper {
     return Status::OK();
   }
 
+  /**
+   * Serializes the partial aggregate state of the UDA, so that it can be merged into a UDA of the
+   * same type by a different Carnot instance.
+   * @return The serialized state, or an error if the UDA doesn't support partial aggregates.
+   */
+  static StatusOr<types::StringValue> Serialize(UDA* uda, FunctionContext* ctx) {
+    if constexpr (SupportsPartial) {
+      return static_cast<TUDA*>(uda)->Serialize(ctx);
+    } else {
+      PX_UNUSED(uda);
+      PX_UNUSED(ctx);
+      return error::Unimplemented("UDA does not support partial aggregation");
+    }
+  }
+
+  /**
+   * Replaces the state of the UDA with a state created by Serialize.
+   * @return Status of the Deserialize.
+   */
+  static Status Deserialize(UDA* uda, FunctionContext* ctx, const types::StringValue& data) {
+    if constexpr (SupportsPartial) {
+      return static_cast<TUDA*>(uda)->Deserialize(ctx, data);
+    } else {
+      PX_UNUSED(uda);
+      PX_UNUSED(ctx);
+      PX_UNUSED(data);
+      return error::Unimplemented("UDA does not support partial aggregation");
+    }
+  }
+
   /**
    * Finalize the UDA into an arrow builder. The arrow builder needs to be correct type
    * for the finalize return type.
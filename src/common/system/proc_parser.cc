@@ -515,6 +515,8 @@ Status ProcParser::ParseProcMapsFile(int32_t pid, std::string filename,
       smap_info.vmem_end = std::strtoull(vmem[1].data(), NULL, 16);
       smap_info.permissions = std::string(split[1]);
       smap_info.offset = split[2];
+      smap_info.dev = split[3];
+      smap_info.inode = std::strtoull(std::string(split[4]).c_str(), NULL, 10);
       smap_info.pathname = "[anonymous]";
       if (split.size() == kProcMapNumFields) {
         smap_info.pathname = absl::StripAsciiWhitespace(split[kProcMapNumFields - 1]);
@@ -143,6 +143,8 @@ class ProcParser {
     uint64_t vmem_end = 0;
     std::string permissions;
     std::string offset;
+    std::string dev;
+    uint64_t inode = 0;
     std::string pathname;
 
     int64_t size_bytes = 0;
@@ -382,6 +384,9 @@ class ProcParser {
   Status ParseProcMapsFile(int32_t pid, std::string filename, std::vector<ProcessSMaps>* out) const;
 };
 
+// Returns true if the stats of the network interface are included in ProcParser::NetworkStats.
+bool ShouldIncludeNetIFace(const std::string_view iface);
+
 // TODO(jps): Change to GetPIDStartTimeTicks(const pid_t pid), i.e. remove the version that
 // uses a filesystem path as an arg.
 StatusOr<int64_t> GetPIDStartTimeTicks(const std::filesystem::path& proc_pid_path);
@@ -222,6 +222,8 @@ TEST_F(ProcParserTest, ParsePIDSMaps) {
   auto& first = stats.front();
   EXPECT_EQ("55e816b37000-55e816b65000", first.ToAddress());
   EXPECT_EQ("00000000", first.offset);
+  EXPECT_EQ("103:02", first.dev);
+  EXPECT_EQ(55579316, first.inode);
   EXPECT_EQ("/usr/bin/vim.basic", first.pathname);
   EXPECT_EQ(184 * 1024, first.size_bytes);
   EXPECT_EQ(4 * 1024, first.kernel_page_size_bytes);
@@ -247,6 +249,8 @@ TEST_F(ProcParserTest, ParsePIDSMaps) {
   auto& last = stats.back();
   EXPECT_EQ("ffffffffff600000-ffffffffff601000", last.ToAddress());
   EXPECT_EQ("00000000", last.offset);
+  EXPECT_EQ("00:00", last.dev);
+  EXPECT_EQ(0, last.inode);
   EXPECT_EQ("[vsyscall]", last.pathname);
   EXPECT_EQ(4 * 1024, last.size_bytes);
   EXPECT_EQ(4 * 1024, last.kernel_page_size_bytes);
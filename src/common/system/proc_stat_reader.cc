@@ -0,0 +1,384 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/common/system/proc_stat_reader.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <thread>
+
+#include "src/common/system/proc_pid_path.h"
+
+namespace px {
+namespace system {
+
+namespace {
+
+// The files read by the reader, indexed by FileKind.
+constexpr std::string_view kFileNames[] = {"stat", "io", "net/dev"};
+
+// Buffers start at this size, and double whenever a file does not fit.
+constexpr size_t kInitialBufSize = 4096;
+
+// Batches are split across threads only if each thread gets at least this many pids.
+constexpr size_t kMinPIDsPerShard = 64;
+
+constexpr std::string_view kWhitespace = " \t\n";
+
+// Returns the next whitespace separated token of s, and advances s past it.
+// Returns an empty token if there are no tokens left.
+std::string_view NextToken(std::string_view* s) {
+  size_t begin = s->find_first_not_of(kWhitespace);
+  if (begin == std::string_view::npos) {
+    *s = {};
+    return {};
+  }
+  size_t end = s->find_first_of(kWhitespace, begin);
+  if (end == std::string_view::npos) {
+    end = s->size();
+  }
+  std::string_view token = s->substr(begin, end - begin);
+  s->remove_prefix(end);
+  return token;
+}
+
+// Returns the next line of s, without the newline, and advances s past it.
+std::string_view NextLine(std::string_view* s) {
+  size_t end = s->find('\n');
+  std::string_view line = s->substr(0, end);
+  s->remove_prefix(end == std::string_view::npos ? s->size() : end + 1);
+  return line;
+}
+
+template <typename T>
+bool ParseInt(std::string_view token, T* val) {
+  auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), *val);
+  return ec == std::errc() && ptr == token.data() + token.size();
+}
+
+// Reads the whole file into buf, which is grown as needed.
+Status PReadFile(int fd, std::string* buf, std::string_view* contents) {
+  if (buf->empty()) {
+    buf->resize(kInitialBufSize);
+  }
+  size_t total = 0;
+  while (true) {
+    if (total == buf->size()) {
+      buf->resize(2 * buf->size());
+    }
+    ssize_t n = pread(fd, buf->data() + total, buf->size() - total, total);
+    if (n < 0) {
+      return error::Internal("Failed to read file. errno $0.", errno);
+    }
+    if (n == 0) {
+      break;
+    }
+    total += n;
+  }
+  *contents = std::string_view(buf->data(), total);
+  return Status::OK();
+}
+
+}  // namespace
+
+ProcStatReader::ProcStatReader(const Options& options)
+    : options_(options), bufs_(std::max<size_t>(options.num_threads, 1)) {}
+
+ProcStatReader::~ProcStatReader() {
+  for (auto& [pid, files] : pid_files_) {
+    PX_UNUSED(pid);
+    CloseFiles(&files);
+  }
+}
+
+Status ProcStatReader::ParseStat(std::string_view contents, int64_t page_size_bytes,
+                                 int64_t kernel_tick_time_ns, ProcParser::ProcessStats* out) {
+  // See ProcParser::ParseProcPIDStat for the format. The command can contain spaces and
+  // parentheses, so fields are counted from the last closing parenthesis.
+  size_t close_paren_idx = contents.rfind(')');
+  if (close_paren_idx == std::string_view::npos) {
+    return error::Internal("Invalid command name in stat file.");
+  }
+  std::string_view pid_field = contents.substr(0, contents.find('('));
+  bool ok = ParseInt(NextToken(&pid_field), &out->pid);
+
+  // Field numbers are those of proc(5), minus one.
+  constexpr int kMinorFaultsField = 9;
+  constexpr int kMajorFaultsField = 11;
+  constexpr int kUTimeField = 13;
+  constexpr int kKTimeField = 14;
+  constexpr int kNumThreadsField = 19;
+  constexpr int kVSizeField = 22;
+  constexpr int kRSSField = 23;
+
+  std::string_view fields = contents.substr(close_paren_idx + 1);
+  // Fields 0 and 1 are the pid and the command.
+  for (int field = 2; field <= kRSSField; ++field) {
+    std::string_view token = NextToken(&fields);
+    if (token.empty()) {
+      return error::Internal("Incorrect number of fields in stat file.");
+    }
+    switch (field) {
+      case kMinorFaultsField:
+        ok &= ParseInt(token, &out->minor_faults);
+        break;
+      case kMajorFaultsField:
+        ok &= ParseInt(token, &out->major_faults);
+        break;
+      case kUTimeField:
+        ok &= ParseInt(token, &out->utime_ns);
+        break;
+      case kKTimeField:
+        ok &= ParseInt(token, &out->ktime_ns);
+        break;
+      case kNumThreadsField:
+        ok &= ParseInt(token, &out->num_threads);
+        break;
+      case kVSizeField:
+        ok &= ParseInt(token, &out->vsize_bytes);
+        break;
+      case kRSSField:
+        ok &= ParseInt(token, &out->rss_bytes);
+        break;
+      default:
+        break;
+    }
+  }
+  if (!ok) {
+    return error::Internal("Failed to parse stat file.");
+  }
+
+  // The kernel tracks utime and ktime in kernel ticks, and RSS in pages.
+  out->utime_ns *= kernel_tick_time_ns;
+  out->ktime_ns *= kernel_tick_time_ns;
+  out->rss_bytes *= page_size_bytes;
+  return Status::OK();
+}
+
+Status ProcStatReader::ParseIO(std::string_view contents, ProcParser::ProcessStats* out) {
+  // See ProcParser::ParseProcPIDStatIO for the format.
+  while (!contents.empty()) {
+    std::string_view line = NextLine(&contents);
+    size_t colon_idx = line.find(':');
+    if (colon_idx == std::string_view::npos) {
+      continue;
+    }
+    std::string_view key = line.substr(0, colon_idx);
+    std::string_view rest = line.substr(colon_idx + 1);
+    std::string_view val = NextToken(&rest);
+
+    int64_t* out_val = nullptr;
+    if (key == "rchar") {
+      out_val = &out->rchar_bytes;
+    } else if (key == "wchar") {
+      out_val = &out->wchar_bytes;
+    } else if (key == "read_bytes") {
+      out_val = &out->read_bytes;
+    } else if (key == "write_bytes") {
+      out_val = &out->write_bytes;
+    } else {
+      continue;
+    }
+    if (!ParseInt(val, out_val)) {
+      *out_val = -1;
+    }
+  }
+  return Status::OK();
+}
+
+Status ProcStatReader::ParseNetDev(std::string_view contents, ProcParser::NetworkStats* out) {
+  // See ProcParser::ParseProcPIDNetDev for the format.
+  // Fields are numbered from the first field after the interface name.
+  constexpr int kNumFields = 16;
+  constexpr int kRxBytesField = 0;
+  constexpr int kRxPacketsField = 1;
+  constexpr int kRxErrsField = 2;
+  constexpr int kRxDropField = 3;
+  constexpr int kTxBytesField = 8;
+  constexpr int kTxPacketsField = 9;
+  constexpr int kTxErrsField = 10;
+  constexpr int kTxDropField = 11;
+
+  // Ignore the first two lines since they are just headers.
+  NextLine(&contents);
+  NextLine(&contents);
+
+  while (!contents.empty()) {
+    std::string_view line = NextLine(&contents);
+    if (line.find_first_not_of(kWhitespace) == std::string_view::npos) {
+      continue;
+    }
+    // Large counters can directly follow the colon, so the name is not a whitespace token.
+    size_t colon_idx = line.find(':');
+    if (colon_idx == std::string_view::npos) {
+      return error::Internal("Failed to parse net dev file, missing interface name.");
+    }
+    std::string_view iface_field = line.substr(0, colon_idx);
+    std::string_view iface = NextToken(&iface_field);
+
+    std::string_view fields = line.substr(colon_idx + 1);
+    std::string_view tokens[kNumFields];
+    for (auto& token : tokens) {
+      token = NextToken(&fields);
+      if (token.empty()) {
+        return error::Internal("Failed to parse net dev file, incorrect number of fields.");
+      }
+    }
+
+    if (!ShouldIncludeNetIFace(iface)) {
+      continue;
+    }
+
+    int64_t vals[kNumFields] = {};
+    bool ok = true;
+    for (int i : {kRxBytesField, kRxPacketsField, kRxErrsField, kRxDropField, kTxBytesField,
+                  kTxPacketsField, kTxErrsField, kTxDropField}) {
+      ok &= ParseInt(tokens[i], &vals[i]);
+    }
+    if (!ok) {
+      return error::Internal("Failed to parse net dev file.");
+    }
+
+    out->rx_bytes += vals[kRxBytesField];
+    out->rx_packets += vals[kRxPacketsField];
+    out->rx_errs += vals[kRxErrsField];
+    out->rx_drops += vals[kRxDropField];
+    out->tx_bytes += vals[kTxBytesField];
+    out->tx_packets += vals[kTxPacketsField];
+    out->tx_errs += vals[kTxErrsField];
+    out->tx_drops += vals[kTxDropField];
+  }
+  return Status::OK();
+}
+
+Status ProcStatReader::ReadFile(int32_t pid, FileKind kind, PIDFiles* files, std::string* buf,
+                                std::string_view* contents) {
+  int& fd = files->fds[kind];
+  if (fd >= 0) {
+    if (PReadFile(fd, buf, contents).ok()) {
+      return Status::OK();
+    }
+    // The process exited, and its pid may have been reused. Retry with a new descriptor.
+    close(fd);
+    fd = -1;
+    --num_open_files_;
+  }
+
+  const std::filesystem::path fpath = ProcPidPath(pid, kFileNames[kind]);
+  int new_fd = open(fpath.c_str(), O_RDONLY | O_CLOEXEC);
+  if (new_fd < 0) {
+    return error::Internal("Failed to open file: $0.", fpath.string());
+  }
+  Status s = PReadFile(new_fd, buf, contents);
+  // Shards of a batch may race on the limit, so it can be exceeded by a few descriptors.
+  if (!s.ok() || num_open_files_ >= options_.max_open_files) {
+    close(new_fd);
+  } else {
+    fd = new_fd;
+    ++num_open_files_;
+  }
+  return s;
+}
+
+Status ProcStatReader::ReadPIDStats(int32_t pid, PIDFiles* files, int64_t page_size_bytes,
+                                    int64_t kernel_tick_time_ns, std::string* buf,
+                                    ProcParser::ProcessStats* stats) {
+  std::string_view contents;
+  PX_RETURN_IF_ERROR(ReadFile(pid, kStat, files, buf, &contents));
+  PX_RETURN_IF_ERROR(ParseStat(contents, page_size_bytes, kernel_tick_time_ns, stats));
+  PX_RETURN_IF_ERROR(ReadFile(pid, kIO, files, buf, &contents));
+  return ParseIO(contents, stats);
+}
+
+std::vector<Status> ProcStatReader::ReadProcessStats(
+    const std::vector<int32_t>& pids, int64_t page_size_bytes, int64_t kernel_tick_time_ns,
+    std::vector<ProcParser::ProcessStats>* stats) {
+  std::vector<Status> statuses(pids.size());
+  stats->assign(pids.size(), ProcParser::ProcessStats());
+
+  // Entries are created up front, so that the shards below do not modify the map.
+  // Pointers are taken only once all entries exist, since inserts can rehash the map.
+  for (int32_t pid : pids) {
+    pid_files_[pid].used = true;
+  }
+  std::vector<PIDFiles*> files(pids.size());
+  for (size_t i = 0; i < pids.size(); ++i) {
+    files[i] = &pid_files_.find(pids[i])->second;
+  }
+
+  auto read_shard = [&](size_t shard, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      statuses[i] = ReadPIDStats(pids[i], files[i], page_size_bytes, kernel_tick_time_ns,
+                                 &bufs_[shard], &(*stats)[i]);
+    }
+  };
+
+  const size_t num_shards = std::clamp<size_t>(pids.size() / kMinPIDsPerShard, 1, bufs_.size());
+  const size_t shard_size = (pids.size() + num_shards - 1) / num_shards;
+  std::vector<std::thread> threads;
+  for (size_t shard = 1; shard < num_shards; ++shard) {
+    const size_t begin = std::min(pids.size(), shard * shard_size);
+    threads.emplace_back(read_shard, shard, begin, std::min(pids.size(), begin + shard_size));
+  }
+  read_shard(0, 0, std::min(pids.size(), shard_size));
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  return statuses;
+}
+
+Status ProcStatReader::ReadNetDev(int32_t pid, ProcParser::NetworkStats* out) {
+  PIDFiles* files = &pid_files_[pid];
+  files->used = true;
+
+  std::string_view contents;
+  PX_RETURN_IF_ERROR(ReadFile(pid, kNetDev, files, &bufs_[0], &contents));
+  return ParseNetDev(contents, out);
+}
+
+void ProcStatReader::EndIteration() {
+  for (auto iter = pid_files_.begin(); iter != pid_files_.end();) {
+    PIDFiles& files = iter->second;
+    if (files.used) {
+      files.used = false;
+      ++iter;
+    } else {
+      CloseFiles(&files);
+      pid_files_.erase(iter++);
+    }
+  }
+}
+
+void ProcStatReader::CloseFiles(PIDFiles* files) {
+  for (int& fd : files->fds) {
+    if (fd >= 0) {
+      close(fd);
+      fd = -1;
+      --num_open_files_;
+    }
+  }
+}
+
+}  // namespace system
+}  // namespace px
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/common/system/proc_parser.h"
+
+namespace px {
+namespace system {
+
+/**
+ * Reads the per-process /proc files that are sampled periodically (stat, io and net/dev) for many
+ * processes at a time, at a lower cost than ProcParser:
+ *  - File descriptors are kept open across sampling iterations, and the files are re-read with
+ *    pread() from offset zero, which makes the kernel regenerate their contents. This saves the
+ *    path lookup and open/close of every file on every iteration.
+ *  - Contents are read into reused buffers, and parsed in place without allocations.
+ *  - A batch of processes can be split across several threads.
+ *
+ * Descriptors of processes that were not read during an iteration are closed by EndIteration(),
+ * so the caller should call it once per sampling iteration.
+ *
+ * Not thread-safe: the reader manages its own threads.
+ */
+class ProcStatReader : public NotCopyMoveable {
+ public:
+  struct Options {
+    // Beyond this many open files, files are opened and closed on every read, like ProcParser.
+    size_t max_open_files = 4096;
+
+    // The number of threads across which ReadProcessStats() spreads a batch.
+    size_t num_threads = 1;
+  };
+
+  ProcStatReader() : ProcStatReader(Options{}) {}
+  explicit ProcStatReader(const Options& options);
+  ~ProcStatReader();
+
+  /**
+   * Reads /proc/<pid>/stat and /proc/<pid>/io of each of the pids.
+   * The process_name field of the stats is not populated.
+   *
+   * @param pids The processes to read, which must be distinct.
+   * @param page_size_bytes The size of memory page in bytes.
+   * @param kernel_tick_time_ns The time of each kernel tick in nanoseconds.
+   * @param stats Output stats, one per pid.
+   * @return Status of reading each pid, one per pid.
+   */
+  std::vector<Status> ReadProcessStats(const std::vector<int32_t>& pids, int64_t page_size_bytes,
+                                       int64_t kernel_tick_time_ns,
+                                       std::vector<ProcParser::ProcessStats>* stats);
+
+  /**
+   * Reads /proc/<pid>/net/dev, accumulating the stats of the interfaces that ProcParser includes.
+   */
+  Status ReadNetDev(int32_t pid, ProcParser::NetworkStats* out);
+
+  /**
+   * Closes the files of processes that were not read since the previous call.
+   */
+  void EndIteration();
+
+  size_t num_open_files() const { return num_open_files_; }
+
+  // Parsers of the file contents. Exposed for testing.
+  static Status ParseStat(std::string_view contents, int64_t page_size_bytes,
+                          int64_t kernel_tick_time_ns, ProcParser::ProcessStats* out);
+  static Status ParseIO(std::string_view contents, ProcParser::ProcessStats* out);
+  static Status ParseNetDev(std::string_view contents, ProcParser::NetworkStats* out);
+
+ private:
+  enum FileKind { kStat = 0, kIO, kNetDev, kNumFileKinds };
+
+  struct PIDFiles {
+    int fds[kNumFileKinds] = {-1, -1, -1};
+    bool used = true;
+  };
+
+  // Returns the contents of the file, read into buf. Uses a kept-open descriptor if possible.
+  // Only touches the entry of the pid, so calls for different pids can run concurrently,
+  // as long as the entries were created beforehand.
+  Status ReadFile(int32_t pid, FileKind kind, PIDFiles* files, std::string* buf,
+                  std::string_view* contents);
+
+  Status ReadPIDStats(int32_t pid, PIDFiles* files, int64_t page_size_bytes,
+                      int64_t kernel_tick_time_ns, std::string* buf,
+                      ProcParser::ProcessStats* stats);
+
+  void CloseFiles(PIDFiles* files);
+
+  const Options options_;
+
+  absl::flat_hash_map<int32_t, PIDFiles> pid_files_;
+
+  // Number of kept-open descriptors. Atomic, because shards of a batch open files concurrently.
+  std::atomic<size_t> num_open_files_ = 0;
+
+  // One read buffer per thread.
+  std::vector<std::string> bufs_;
+};
+
+}  // namespace system
+}  // namespace px
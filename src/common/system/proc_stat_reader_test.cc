@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/common/system/proc_stat_reader.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "src/common/testing/test_environment.h"
+#include "src/common/testing/testing.h"
+
+DECLARE_string(proc_path);
+
+namespace px {
+namespace system {
+
+constexpr char kTestDataBasePath[] = "src/common/system";
+constexpr int64_t kBytesPerPage = 4096;
+constexpr int64_t kKernelTickTimeNS = 100;
+
+namespace {
+std::string GetPathToTestDataFile(std::string_view fname) {
+  return testing::BazelRunfilePath(std::filesystem::path(kTestDataBasePath) / fname);
+}
+}  // namespace
+
+// The reader must agree with ProcParser.
+TEST(ProcStatReaderTest, MatchesProcParser) {
+  PX_SET_FOR_SCOPE(FLAGS_proc_path, GetPathToTestDataFile("testdata/proc"));
+
+  ProcParser parser;
+  ProcParser::ProcessStats expected;
+  ASSERT_OK(parser.ParseProcPIDStat(123, kBytesPerPage, kKernelTickTimeNS, &expected));
+  ASSERT_OK(parser.ParseProcPIDStatIO(123, &expected));
+  ProcParser::NetworkStats expected_net;
+  ASSERT_OK(parser.ParseProcPIDNetDev(123, &expected_net));
+
+  ProcStatReader reader;
+  std::vector<ProcParser::ProcessStats> stats;
+  std::vector<Status> statuses =
+      reader.ReadProcessStats({123}, kBytesPerPage, kKernelTickTimeNS, &stats);
+  ASSERT_EQ(statuses.size(), 1);
+  ASSERT_OK(statuses[0]);
+
+  EXPECT_EQ(stats[0].pid, expected.pid);
+  EXPECT_EQ(stats[0].minor_faults, expected.minor_faults);
+  EXPECT_EQ(stats[0].major_faults, expected.major_faults);
+  EXPECT_EQ(stats[0].utime_ns, expected.utime_ns);
+  EXPECT_EQ(stats[0].ktime_ns, expected.ktime_ns);
+  EXPECT_EQ(stats[0].num_threads, expected.num_threads);
+  EXPECT_EQ(stats[0].vsize_bytes, expected.vsize_bytes);
+  EXPECT_EQ(stats[0].rss_bytes, expected.rss_bytes);
+  EXPECT_EQ(stats[0].rchar_bytes, expected.rchar_bytes);
+  EXPECT_EQ(stats[0].wchar_bytes, expected.wchar_bytes);
+  EXPECT_EQ(stats[0].read_bytes, expected.read_bytes);
+  EXPECT_EQ(stats[0].write_bytes, expected.write_bytes);
+
+  ProcParser::NetworkStats net;
+  ASSERT_OK(reader.ReadNetDev(123, &net));
+  EXPECT_EQ(net.rx_bytes, expected_net.rx_bytes);
+  EXPECT_EQ(net.rx_packets, expected_net.rx_packets);
+  EXPECT_EQ(net.rx_errs, expected_net.rx_errs);
+  EXPECT_EQ(net.rx_drops, expected_net.rx_drops);
+  EXPECT_EQ(net.tx_bytes, expected_net.tx_bytes);
+  EXPECT_EQ(net.tx_packets, expected_net.tx_packets);
+  EXPECT_EQ(net.tx_errs, expected_net.tx_errs);
+  EXPECT_EQ(net.tx_drops, expected_net.tx_drops);
+}
+
+TEST(ProcStatReaderTest, ReportsErrorsPerPID) {
+  PX_SET_FOR_SCOPE(FLAGS_proc_path, GetPathToTestDataFile("testdata/proc"));
+
+  ProcStatReader reader;
+  std::vector<ProcParser::ProcessStats> stats;
+  // 456 has no io file, and 999 does not exist.
+  std::vector<Status> statuses =
+      reader.ReadProcessStats({123, 456, 999}, kBytesPerPage, kKernelTickTimeNS, &stats);
+  ASSERT_EQ(statuses.size(), 3);
+  EXPECT_OK(statuses[0]);
+  EXPECT_NOT_OK(statuses[1]);
+  EXPECT_NOT_OK(statuses[2]);
+  EXPECT_EQ(stats[0].pid, 4602);
+}
+
+TEST(ProcStatReaderTest, KeepsFilesOpenAcrossIterations) {
+  ProcStatReader reader;
+  std::vector<ProcParser::ProcessStats> stats;
+
+  for (int i = 0; i < 3; ++i) {
+    std::vector<Status> statuses =
+        reader.ReadProcessStats({getpid()}, kBytesPerPage, kKernelTickTimeNS, &stats);
+    ASSERT_OK(statuses[0]);
+    EXPECT_EQ(stats[0].pid, getpid());
+    EXPECT_GT(stats[0].num_threads, 0);
+    EXPECT_EQ(reader.num_open_files(), 2);
+    reader.EndIteration();
+  }
+
+  // Files of a process that is not read for an iteration are closed.
+  reader.EndIteration();
+  EXPECT_EQ(reader.num_open_files(), 0);
+}
+
+TEST(ProcStatReaderTest, RespectsMaxOpenFiles) {
+  ProcStatReader reader({.max_open_files = 1, .num_threads = 1});
+  std::vector<ProcParser::ProcessStats> stats;
+
+  std::vector<Status> statuses =
+      reader.ReadProcessStats({getpid()}, kBytesPerPage, kKernelTickTimeNS, &stats);
+  ASSERT_OK(statuses[0]);
+  EXPECT_EQ(reader.num_open_files(), 1);
+  ProcParser::NetworkStats net;
+  ASSERT_OK(reader.ReadNetDev(getpid(), &net));
+  EXPECT_EQ(reader.num_open_files(), 1);
+}
+
+TEST(ProcStatReaderTest, ParseNetDevWithoutSpaceAfterInterface) {
+  constexpr std::string_view kNetDev =
+      "Inter-|   Receive |  Transmit\n"
+      " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets ...\n"
+      "  eth0:12345678901 10 1 2 0 0 0 0 100 20 3 4 0 0 0 0\n"
+      "    lo: 5 5 0 0 0 0 0 0 5 5 0 0 0 0 0 0\n";
+  ProcParser::NetworkStats stats;
+  ASSERT_OK(ProcStatReader::ParseNetDev(kNetDev, &stats));
+  EXPECT_EQ(stats.rx_bytes, 12345678901);
+  EXPECT_EQ(stats.rx_packets, 10);
+  EXPECT_EQ(stats.rx_errs, 1);
+  EXPECT_EQ(stats.rx_drops, 2);
+  EXPECT_EQ(stats.tx_bytes, 100);
+  EXPECT_EQ(stats.tx_packets, 20);
+  EXPECT_EQ(stats.tx_errs, 3);
+  EXPECT_EQ(stats.tx_drops, 4);
+
+  EXPECT_NOT_OK(ProcStatReader::ParseNetDev("header\nheader\n eth0: 1 2 3\n", &stats));
+}
+
+TEST(ProcStatReaderTest, ParseStatRejectsMalformedInput) {
+  ProcParser::ProcessStats stats;
+  EXPECT_NOT_OK(ProcStatReader::ParseStat("123 (foo", kBytesPerPage, kKernelTickTimeNS, &stats));
+  EXPECT_NOT_OK(ProcStatReader::ParseStat("123 (foo) S 1 2 3", kBytesPerPage, kKernelTickTimeNS,
+                                          &stats));
+}
+
+}  // namespace system
+}  // namespace px
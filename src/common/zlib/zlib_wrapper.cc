@@ -17,6 +17,7 @@
  */
 
 #include <zlib.h>
+#include <algorithm>
 #include <string>
 
 #include "src/common/base/base.h"
@@ -60,5 +61,55 @@ StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size) {
   return out;
 }
 
+StatusOr<InflatePrefixResult> InflatePrefix(std::string_view in, InflateFormat format,
+                                            size_t max_output_bytes) {
+  // Output is produced in blocks, so that small outputs do not reserve the full limit up-front.
+  constexpr size_t kOutputBlockSize = 4096;
+
+  int window_bits = MAX_WBITS;
+  switch (format) {
+    case InflateFormat::kGzip:
+      window_bits = MAX_WBITS + 16;
+      break;
+    case InflateFormat::kZlib:
+      window_bits = MAX_WBITS;
+      break;
+    case InflateFormat::kRawDeflate:
+      window_bits = -MAX_WBITS;
+      break;
+  }
+
+  z_stream zs = {};
+  if (inflateInit2(&zs, window_bits) != Z_OK) {
+    return error::Internal("inflateInit2 failed while decompressing.");
+  }
+
+  zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+  zs.avail_in = in.size();
+
+  InflatePrefixResult result;
+  int ret = Z_OK;
+  while (ret == Z_OK && zs.total_out < max_output_bytes) {
+    size_t block_size = std::min(kOutputBlockSize, max_output_bytes - zs.total_out);
+    result.out.resize(zs.total_out + block_size);
+    zs.next_out = reinterpret_cast<Bytef*>(result.out.data() + zs.total_out);
+    zs.avail_out = block_size;
+
+    ret = inflate(&zs, Z_SYNC_FLUSH);
+  }
+  result.out.resize(zs.total_out);
+  std::string error_msg = zs.msg != nullptr ? zs.msg : "unknown error";
+
+  inflateEnd(&zs);
+
+  // Z_BUF_ERROR means no progress was possible: the input ran out before the end of the stream.
+  if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+    return error::Internal("Exception during zlib decompression: $0", error_msg);
+  }
+  result.stream_end = (ret == Z_STREAM_END);
+
+  return result;
+}
+
 }  // namespace zlib
 }  // namespace px
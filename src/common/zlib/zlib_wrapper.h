@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <limits>
 #include <string>
 
 #include "src/common/base/statusor.h"
@@ -35,5 +36,39 @@ namespace zlib {
  */
 StatusOr<std::string> Inflate(std::string_view in, size_t output_block_size = 16384);
 
+/**
+ * The framing of compressed data accepted by InflatePrefix().
+ */
+enum class InflateFormat {
+  // gzip header and trailer (RFC 1952).
+  kGzip,
+  // zlib header and trailer (RFC 1950). This is what HTTP calls "deflate".
+  kZlib,
+  // No header or trailer (RFC 1951). Some HTTP servers send this as "deflate".
+  kRawDeflate,
+};
+
+struct InflatePrefixResult {
+  // The decompressed content, at most max_output_bytes long.
+  std::string out;
+  // True if the end of the compressed stream was reached.
+  // False if the input was truncated or decompression stopped at max_output_bytes.
+  bool stream_end = false;
+};
+
+/**
+ * @brief Inflates as much of a possibly truncated compressed buffer as is available,
+ * producing at most max_output_bytes of output.
+ *
+ * Unlike Inflate(), running out of input is not an error, and decompression stops as soon as
+ * the output limit is reached, so the cost is bounded by max_output_bytes regardless of the
+ * compression ratio of the input.
+ *
+ * @return Status or the decompressed prefix. Errors are only returned for corrupt input.
+ */
+StatusOr<InflatePrefixResult> InflatePrefix(
+    std::string_view in, InflateFormat format,
+    size_t max_output_bytes = std::numeric_limits<size_t>::max());
+
 }  // namespace zlib
 }  // namespace px
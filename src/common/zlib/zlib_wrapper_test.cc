@@ -19,6 +19,9 @@
 #include "src/common/zlib/zlib_wrapper.h"
 #include <zlib.h>
 #include <string>
+#include <utility>
+
+#include <absl/strings/match.h>
 
 #include "src/common/testing/testing.h"
 
@@ -46,4 +49,55 @@ TEST_F(ZlibTest, inflate_test) {
   EXPECT_OK_AND_EQ(result, GetExpectedResult());
 }
 
+TEST_F(ZlibTest, inflate_prefix_test) {
+  ASSERT_OK_AND_ASSIGN(zlib::InflatePrefixResult result,
+                       zlib::InflatePrefix(GetCompressedString(), zlib::InflateFormat::kGzip));
+  EXPECT_EQ(result.out, GetExpectedResult());
+  EXPECT_TRUE(result.stream_end);
+}
+
+TEST_F(ZlibTest, inflate_prefix_output_limit) {
+  ASSERT_OK_AND_ASSIGN(zlib::InflatePrefixResult result,
+                       zlib::InflatePrefix(GetCompressedString(), zlib::InflateFormat::kGzip, 4));
+  EXPECT_EQ(result.out, "This");
+  EXPECT_FALSE(result.stream_end);
+}
+
+TEST_F(ZlibTest, inflate_prefix_truncated_input) {
+  // Drop the trailer (CRC and size), and the last few bytes of compressed data.
+  std::string truncated = GetCompressedString().substr(0, 20);
+  ASSERT_OK_AND_ASSIGN(zlib::InflatePrefixResult result,
+                       zlib::InflatePrefix(truncated, zlib::InflateFormat::kGzip));
+  EXPECT_FALSE(result.stream_end);
+  EXPECT_TRUE(absl::StartsWith(GetExpectedResult(), result.out));
+}
+
+TEST_F(ZlibTest, inflate_prefix_deflate_formats) {
+  std::string expected = "deflate me, deflate me, deflate me";
+
+  for (auto [format, window_bits] : {std::make_pair(zlib::InflateFormat::kZlib, MAX_WBITS),
+                                     std::make_pair(zlib::InflateFormat::kRawDeflate, -MAX_WBITS)}) {
+    z_stream zs = {};
+    ASSERT_EQ(deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, window_bits, 8,
+                           Z_DEFAULT_STRATEGY),
+              Z_OK);
+    std::string compressed(deflateBound(&zs, expected.size()), '\0');
+    zs.next_in = reinterpret_cast<Bytef*>(expected.data());
+    zs.avail_in = expected.size();
+    zs.next_out = reinterpret_cast<Bytef*>(compressed.data());
+    zs.avail_out = compressed.size();
+    ASSERT_EQ(deflate(&zs, Z_FINISH), Z_STREAM_END);
+    compressed.resize(zs.total_out);
+    deflateEnd(&zs);
+
+    ASSERT_OK_AND_ASSIGN(zlib::InflatePrefixResult result, zlib::InflatePrefix(compressed, format));
+    EXPECT_EQ(result.out, expected);
+    EXPECT_TRUE(result.stream_end);
+  }
+}
+
+TEST_F(ZlibTest, inflate_prefix_corrupt_input) {
+  EXPECT_NOT_OK(zlib::InflatePrefix("not compressed at all", zlib::InflateFormat::kGzip));
+}
+
 }  // namespace px
@@ -78,6 +78,16 @@ const ContainerInfo* K8sMetadataState::ContainerInfoByID(CIDView id) const {
   return it->second.get();
 }
 
+ContainerInfo* K8sMetadataState::MutableContainerInfoByID(CIDView id) {
+  auto it = containers_by_id_.find(id);
+
+  if (it == containers_by_id_.end()) {
+    return nullptr;
+  }
+
+  return CopyOnWrite(&it->second);
+}
+
 UID K8sMetadataState::PodIDByName(K8sNameIdentView pod_name) const {
   auto it = pods_by_name_.find(pod_name);
   return (it == pods_by_name_.end()) ? "" : it->second;
@@ -152,16 +162,9 @@ std::unique_ptr<K8sMetadataState> K8sMetadataState::Clone() const {
   other->pod_cidrs_ = pod_cidrs_;
   other->service_cidr_ = service_cidr_;
 
-  other->k8s_objects_by_id_.reserve(k8s_objects_by_id_.size());
-  for (const auto& [k, v] : k8s_objects_by_id_) {
-    other->k8s_objects_by_id_[k] = v->Clone();
-  }
-
-  other->containers_by_id_.reserve(containers_by_id_.size());
-  for (const auto& [k, v] : containers_by_id_) {
-    other->containers_by_id_[k] = v->Clone();
-  }
-
+  // The objects are shared, and copied on write by the Handle*Update functions.
+  other->k8s_objects_by_id_ = k8s_objects_by_id_;
+  other->containers_by_id_ = containers_by_id_;
   other->pods_by_name_ = pods_by_name_;
   other->services_by_name_ = services_by_name_;
   other->namespaces_by_name_ = namespaces_by_name_;
@@ -235,7 +238,7 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     VLOG(1) << "Adding Pod: " << pod->DebugString();
     it = k8s_objects_by_id_.try_emplace(object_uid, std::move(pod)).first;
   }
-  auto pod_info = static_cast<PodInfo*>(it->second.get());
+  auto pod_info = static_cast<PodInfo*>(CopyOnWrite(&it->second));
 
   // We always just add to the container set even if the container is stopped.
   // We expect all cleanup to happen periodically to allow stale objects to be queried for some
@@ -253,7 +256,7 @@ Status K8sMetadataState::HandlePodUpdate(const PodUpdate& update) {
     }
 
     pod_info->AddContainer(cid);
-    containers_by_id_[cid]->set_pod_id(object_uid);
+    CopyOnWrite(&containers_by_id_[cid])->set_pod_id(object_uid);
   }
 
   for (const auto& owner_ref : update.owner_references()) {
@@ -291,7 +294,7 @@ Status K8sMetadataState::HandleContainerUpdate(const ContainerUpdate& update) {
   }
   VLOG(1) << "container update: " << update.name();
 
-  auto* container_info = it->second.get();
+  auto* container_info = CopyOnWrite(&it->second);
   container_info->set_stop_time_ns(update.stop_timestamp_ns());
   container_info->set_state(ConvertToContainerState(update.container_state()));
   container_info->set_state_message(update.message());
@@ -313,7 +316,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     VLOG(1) << "Adding Service: " << service->DebugString();
     it = k8s_objects_by_id_.try_emplace(service_uid, std::move(service)).first;
   }
-  auto service_info = static_cast<ServiceInfo*>(it->second.get());
+  auto service_info = static_cast<ServiceInfo*>(CopyOnWrite(&it->second));
 
   for (const auto& uid : update.pod_ids()) {
     if (k8s_objects_by_id_.find(uid) == k8s_objects_by_id_.end()) {
@@ -325,7 +328,7 @@ Status K8sMetadataState::HandleServiceUpdate(const ServiceUpdate& update) {
     }
     ECHECK(k8s_objects_by_id_[uid]->type() == K8sObjectType::kPod);
     // We add the service uid to the pod. Lifetime of service still handled by the service object.
-    PodInfo* pod_info = static_cast<PodInfo*>(k8s_objects_by_id_[uid].get());
+    PodInfo* pod_info = static_cast<PodInfo*>(CopyOnWrite(&k8s_objects_by_id_[uid]));
     pod_info->AddService(service_uid);
   }
   if (update.start_timestamp_ns() != 0) {
@@ -360,7 +363,7 @@ Status K8sMetadataState::HandleNamespaceUpdate(const NamespaceUpdate& update) {
     VLOG(1) << "Adding Namespace: " << ns_obj->DebugString();
     it = k8s_objects_by_id_.try_emplace(namespace_uid, std::move(ns_obj)).first;
   }
-  auto ns_info = static_cast<NamespaceInfo*>(it->second.get());
+  auto ns_info = static_cast<NamespaceInfo*>(CopyOnWrite(&it->second));
 
   ns_info->set_start_time_ns(update.start_timestamp_ns());
   ns_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -389,7 +392,7 @@ Status K8sMetadataState::HandleReplicaSetUpdate(const ReplicaSetUpdate& update)
     VLOG(1) << "Adding ReplicaSet: " << replica_set->DebugString();
     it = k8s_objects_by_id_.try_emplace(replica_set_uid, std::move(replica_set)).first;
   }
-  auto replica_set_info = static_cast<ReplicaSetInfo*>(it->second.get());
+  auto replica_set_info = static_cast<ReplicaSetInfo*>(CopyOnWrite(&it->second));
 
   for (const auto& owner_ref : update.owner_references()) {
     replica_set_info->AddOwnerReference(owner_ref.uid(), owner_ref.name(), owner_ref.kind());
@@ -422,7 +425,7 @@ Status K8sMetadataState::HandleDeploymentUpdate(const DeploymentUpdate& update)
     VLOG(1) << "Adding Deployment: " << deployment->DebugString();
     it = k8s_objects_by_id_.try_emplace(deployment_uid, std::move(deployment)).first;
   }
-  auto deployment_info = static_cast<DeploymentInfo*>(it->second.get());
+  auto deployment_info = static_cast<DeploymentInfo*>(CopyOnWrite(&it->second));
 
   deployment_info->set_start_time_ns(update.start_timestamp_ns());
   deployment_info->set_stop_time_ns(update.stop_timestamp_ns());
@@ -517,10 +520,7 @@ std::shared_ptr<AgentMetadataState> AgentMetadataState::CloneToShared() const {
   state->last_update_ts_ns_ = last_update_ts_ns_;
   state->epoch_id_ = epoch_id_;
   state->k8s_metadata_state_ = k8s_metadata_state_->Clone();
-  state->pids_by_upid_.reserve(pids_by_upid_.size());
-  for (const auto& [k, v] : pids_by_upid_) {
-    state->pids_by_upid_[k] = v->Clone();
-  }
+  state->pids_by_upid_ = pids_by_upid_;
   state->upids_ = upids_;
   return state;
 }
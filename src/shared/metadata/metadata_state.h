@@ -36,9 +36,59 @@
 namespace px {
 namespace md {
 
-using K8sMetadataObjectUPtr = std::unique_ptr<K8sMetadataObject>;
-using ContainerInfoUPtr = std::unique_ptr<ContainerInfo>;
-using PIDInfoUPtr = std::unique_ptr<PIDInfo>;
+// Metadata objects are shared between a state and its clones, and are copied when a state
+// modifies them. Each update epoch therefore only copies the objects that changed.
+using K8sMetadataObjectSPtr = std::shared_ptr<K8sMetadataObject>;
+using ContainerInfoSPtr = std::shared_ptr<ContainerInfo>;
+using PIDInfoSPtr = std::shared_ptr<PIDInfo>;
+
+/**
+ * Returns the object for modification, after replacing it with a copy if it is shared.
+ * States are only cloned by the thread that updates them, so a use count of one means that no
+ * other state refers to the object.
+ */
+template <typename T>
+T* CopyOnWrite(std::shared_ptr<T>* obj) {
+  if (obj->use_count() > 1) {
+    *obj = (*obj)->Clone();
+  }
+  return obj->get();
+}
+
+/**
+ * A read-only view of a map of shared metadata objects. It yields (key, const T*) pairs,
+ * so that readers can't modify objects that are shared with other states.
+ */
+template <typename TKey, typename T>
+class ConstSharedMapView {
+ public:
+  using Map = absl::flat_hash_map<TKey, std::shared_ptr<T>>;
+
+  class const_iterator {
+   public:
+    explicit const_iterator(typename Map::const_iterator it) : it_(it) {}
+
+    std::pair<const TKey&, const T*> operator*() const { return {it_->first, it_->second.get()}; }
+    const_iterator& operator++() {
+      ++it_;
+      return *this;
+    }
+    bool operator==(const const_iterator& other) const { return it_ == other.it_; }
+    bool operator!=(const const_iterator& other) const { return it_ != other.it_; }
+
+   private:
+    typename Map::const_iterator it_;
+  };
+
+  explicit ConstSharedMapView(const Map& map) : map_(map) {}
+
+  const_iterator begin() const { return const_iterator(map_.begin()); }
+  const_iterator end() const { return const_iterator(map_.end()); }
+  size_t size() const { return map_.size(); }
+
+ private:
+  const Map& map_;
+};
 using AgentID = sole::uuid;
 
 /**
@@ -241,6 +291,10 @@ class K8sMetadataState : NotCopyable {
    */
   const DeploymentInfo* OwnerDeploymentInfo(const K8sMetadataObject* obj_info) const;
 
+  /**
+   * Clones the state. The clone shares the metadata objects with this state, which are copied
+   * when either state modifies them.
+   */
   std::unique_ptr<K8sMetadataState> Clone() const;
 
   Status HandlePodUpdate(const PodUpdate& update);
@@ -253,7 +307,16 @@ class K8sMetadataState : NotCopyable {
 
   Status CleanupExpiredMetadata(int64_t retention_time_ns);
 
-  absl::flat_hash_map<CID, ContainerInfoUPtr>& containers_by_id() { return containers_by_id_; }
+  ConstSharedMapView<CID, ContainerInfo> containers_by_id() const {
+    return ConstSharedMapView<CID, ContainerInfo>(containers_by_id_);
+  }
+
+  /**
+   * Returns the container for modification, or nullptr if not found. The container is copied
+   * first if it is shared with another state, so states that were already published are never
+   * modified.
+   */
+  ContainerInfo* MutableContainerInfoByID(CIDView id);
   std::string DebugString(int indent_level = 0) const;
 
  private:
@@ -266,10 +329,10 @@ class K8sMetadataState : NotCopyable {
   std::vector<CIDRBlock> pod_cidrs_;
 
   // This stores K8s native objects (services, pods, etc).
-  absl::flat_hash_map<UID, K8sMetadataObjectUPtr> k8s_objects_by_id_;
+  absl::flat_hash_map<UID, K8sMetadataObjectSPtr> k8s_objects_by_id_;
 
   // This stores container objects, complementing k8s_objects_by_id_.
-  absl::flat_hash_map<CID, ContainerInfoUPtr> containers_by_id_;
+  absl::flat_hash_map<CID, ContainerInfoSPtr> containers_by_id_;
 
   /**
    * Mapping of pods by name.
@@ -349,9 +412,12 @@ class AgentMetadataState : NotCopyable {
   K8sMetadataState* k8s_metadata_state() { return k8s_metadata_state_.get(); }
   const K8sMetadataState& k8s_metadata_state() const { return *k8s_metadata_state_; }
 
+  /**
+   * Clones the state, sharing the metadata objects with this state. See K8sMetadataState::Clone().
+   */
   std::shared_ptr<AgentMetadataState> CloneToShared() const;
 
-  PIDInfo* GetPIDByUPID(UPID upid) const {
+  const PIDInfo* GetPIDByUPID(UPID upid) const {
     auto it = pids_by_upid_.find(upid);
     if (it != pids_by_upid_.end()) {
       return it->second.get();
@@ -359,7 +425,7 @@ class AgentMetadataState : NotCopyable {
     return nullptr;
   }
 
-  void AddUPID(UPID upid, std::unique_ptr<PIDInfo> pid_info) {
+  void AddUPID(UPID upid, PIDInfoSPtr pid_info) {
     DCHECK(pid_info != nullptr);
     DCHECK_EQ(pid_info->stop_time_ns(), 0);
 
@@ -368,16 +434,16 @@ class AgentMetadataState : NotCopyable {
   }
 
   void MarkUPIDAsStopped(UPID upid, int64_t ts) {
-    auto* pid_info = GetPIDByUPID(upid);
-    if (pid_info != nullptr) {
-      pid_info->set_stop_time_ns(ts);
+    auto it = pids_by_upid_.find(upid);
+    if (it != pids_by_upid_.end()) {
+      CopyOnWrite(&it->second)->set_stop_time_ns(ts);
       upids_.erase(upid);
     } else {
       DCHECK(!upids_.contains(upid));
     }
   }
 
-  const absl::flat_hash_map<UPID, PIDInfoUPtr>& pids_by_upid() const { return pids_by_upid_; }
+  const absl::flat_hash_map<UPID, PIDInfoSPtr>& pids_by_upid() const { return pids_by_upid_; }
 
   const absl::flat_hash_set<md::UPID>& upids() const { return upids_; }
 
@@ -411,7 +477,7 @@ class AgentMetadataState : NotCopyable {
   /**
    * Mapping of PIDs by UPID for active pods on the system.
    */
-  absl::flat_hash_map<UPID, PIDInfoUPtr> pids_by_upid_;
+  absl::flat_hash_map<UPID, PIDInfoSPtr> pids_by_upid_;
 
   /**
    * All active UPIDs. Unlike pids_by_upid_, this does not contain stopped pids.
@@ -278,6 +278,39 @@ TEST(K8sMetadataStateTest, CloneCopiedCIDR) {
   EXPECT_EQ(service_cidr.prefix_length, state_copy->service_cidr()->prefix_length);
 }
 
+TEST(K8sMetadataStateTest, CloneSharesUnmodifiedObjects) {
+  K8sMetadataState state;
+
+  K8sMetadataState::ContainerUpdate container_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kContainer0UpdatePbTxt, &container_update));
+  K8sMetadataState::PodUpdate pod0_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod0UpdatePbTxt, &pod0_update));
+  K8sMetadataState::PodUpdate pod1_update;
+  ASSERT_TRUE(TextFormat::MergeFromString(kPod1UpdatePbTxt, &pod1_update));
+
+  EXPECT_OK(state.HandleContainerUpdate(container_update));
+  EXPECT_OK(state.HandlePodUpdate(pod0_update));
+
+  auto state_copy = state.Clone();
+  EXPECT_EQ(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(state.ContainerInfoByID("container0_uid"),
+            state_copy->ContainerInfoByID("container0_uid"));
+
+  // Pod1 claims container0, which is copied before it is modified.
+  EXPECT_OK(state_copy->HandlePodUpdate(pod1_update));
+  EXPECT_EQ(nullptr, state.PodInfoByID("pod1_uid"));
+  EXPECT_NE(nullptr, state_copy->PodInfoByID("pod1_uid"));
+  EXPECT_EQ("pod0_uid", state.ContainerInfoByID("container0_uid")->pod_id());
+  EXPECT_EQ("pod1_uid", state_copy->ContainerInfoByID("container0_uid")->pod_id());
+  EXPECT_EQ(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+
+  pod0_update.set_stop_timestamp_ns(105);
+  EXPECT_OK(state_copy->HandlePodUpdate(pod0_update));
+  EXPECT_NE(state.PodInfoByID("pod0_uid"), state_copy->PodInfoByID("pod0_uid"));
+  EXPECT_EQ(103, state.PodInfoByID("pod0_uid")->stop_time_ns());
+  EXPECT_EQ(105, state_copy->PodInfoByID("pod0_uid")->stop_time_ns());
+}
+
 TEST(K8sMetadataStateTest, HandleContainerUpdate) {
   K8sMetadataState state;
 
@@ -635,5 +668,20 @@ TEST(K8sMetadataStateTest, CleanupExpiredMetadata) {
   }
 }
 
+TEST(AgentMetadataStateTest, CloneSharesPIDInfo) {
+  AgentMetadataState state(/* asid */ 1, /* pid */ 2);
+  UPID upid(1, 123, 456);
+  state.AddUPID(upid, std::make_unique<PIDInfo>(upid, "/bin/exe", "exe --flag", CID("cid0")));
+
+  auto state_copy = state.CloneToShared();
+  EXPECT_EQ(state.GetPIDByUPID(upid), state_copy->GetPIDByUPID(upid));
+
+  state_copy->MarkUPIDAsStopped(upid, 1000);
+  EXPECT_EQ(0, state.GetPIDByUPID(upid)->stop_time_ns());
+  EXPECT_EQ(1000, state_copy->GetPIDByUPID(upid)->stop_time_ns());
+  EXPECT_TRUE(state.upids().contains(upid));
+  EXPECT_FALSE(state_copy->upids().contains(upid));
+}
+
 }  // namespace md
 }  // namespace px
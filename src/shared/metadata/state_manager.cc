@@ -177,6 +177,21 @@ StatusOr<UPID> InitUPID(const system::ProcParser& proc_parser, uint32_t asid, ui
   return UPID(asid, pid, pid_start_time);
 }
 
+// Returns true if the UPIDs are those of exactly the given PIDs, the same check
+// ProcessContainerPIDUpdates() uses to find started and stopped PIDs.
+bool UPIDsMatchPIDs(const StartTimeOrderedUPIDSet& upids,
+                    const absl::flat_hash_set<uint32_t>& pids) {
+  if (upids.size() != pids.size()) {
+    return false;
+  }
+  for (const auto& upid : upids) {
+    if (!pids.contains(upid.pid())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 void ProcessContainerPIDUpdates(
@@ -236,8 +251,11 @@ Status ProcessPIDUpdates(
     int64_t ts, const system::ProcParser& proc_parser, AgentMetadataState* md,
     CGroupMetadataReader* md_reader,
     moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>>* pid_updates) {
-  const auto& k8s_md_state = md->k8s_metadata_state();
+  K8sMetadataState* k8s_md_state = md->k8s_metadata_state();
 
+  // The containers may be shared with states that were already published, and are read
+  // concurrently. They are only read through containers_by_id(), and are modified through
+  // MutableContainerInfoByID(), which copies them first.
   for (const auto& [cid, cinfo] : k8s_md_state->containers_by_id()) {
     if (cinfo->stop_time_ns() != 0) {
       // Ignore dead containers.
@@ -264,7 +282,7 @@ Status ProcessPIDUpdates(
     if (pod_info->stop_time_ns() != 0) {
       VLOG(1) << absl::Substitute("Found a running container in a deleted pod [cid=$0, pod_id=$1]",
                                   cid, pod_id);
-      cinfo->set_stop_time_ns(pod_info->stop_time_ns());
+      k8s_md_state->MutableContainerInfoByID(cid)->set_stop_time_ns(pod_info->stop_time_ns());
       continue;
     }
 
@@ -282,16 +300,23 @@ Status ProcessPIDUpdates(
       // NOTE: Currently, MDS sends pods that do no belong to this Agent, so this is actually
       // required to avoid repeatedly printing out the warning message above.
       if (error::IsNotFound(s)) {
-        cinfo->set_stop_time_ns(ts);
-        for (const auto& upid : cinfo->active_upids()) {
+        ContainerInfo* mutable_cinfo = k8s_md_state->MutableContainerInfoByID(cid);
+        mutable_cinfo->set_stop_time_ns(ts);
+        for (const auto& upid : mutable_cinfo->active_upids()) {
           md->MarkUPIDAsStopped(upid, ts);
         }
-        cinfo->mutable_active_upids()->clear();
+        mutable_cinfo->mutable_active_upids()->clear();
       }
       continue;
     }
 
-    ProcessContainerPIDUpdates(cid, ts, proc_parser, md, cinfo->mutable_active_upids(),
+    // Most containers' PIDs don't change between updates; those are left shared.
+    if (UPIDsMatchPIDs(cinfo->active_upids(), cgroups_active_pids)) {
+      continue;
+    }
+
+    ProcessContainerPIDUpdates(cid, ts, proc_parser, md,
+                               k8s_md_state->MutableContainerInfoByID(cid)->mutable_active_upids(),
                                &cgroups_active_pids, pid_updates);
   }
 
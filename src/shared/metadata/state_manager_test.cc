@@ -385,6 +385,36 @@ TEST_F(AgentMetadataStateTest, pid_created) {
   EXPECT_THAT(pids_started, UnorderedElementsAre(PIDStartedEvent{pid1}, PIDStartedEvent{pid2}));
 }
 
+TEST_F(AgentMetadataStateTest, pid_updates_leave_published_state_unchanged) {
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
+  GenerateTestUpdateEvents(&updates);
+
+  EXPECT_OK(ApplyK8sUpdates(2000 /*ts*/, &metadata_state_, &md_filter_, &updates));
+
+  // The published state shares its containers with metadata_state_.
+  std::shared_ptr<const AgentMetadataState> published_state = metadata_state_.CloneToShared();
+
+  moodycamel::BlockingConcurrentQueue<std::unique_ptr<PIDStatusEvent>> events;
+  FakePIDData md_reader;
+  const auto proc_path = testing::BazelRunfilePath("src/shared/metadata/testdata/proc");
+  PX_SET_FOR_SCOPE(FLAGS_proc_path, proc_path.string());
+  system::ProcParser proc_parser;
+  EXPECT_OK(ProcessPIDUpdates(1000, proc_parser, &metadata_state_, &md_reader, &events));
+
+  const ContainerInfo* cinfo =
+      metadata_state_.k8s_metadata_state()->ContainerInfoByID("container_id1");
+  ASSERT_NE(cinfo, nullptr);
+  EXPECT_EQ(2, cinfo->active_upids().size());
+
+  const ContainerInfo* published_cinfo =
+      published_state->k8s_metadata_state().ContainerInfoByID("container_id1");
+  ASSERT_NE(published_cinfo, nullptr);
+  EXPECT_NE(published_cinfo, cinfo);
+  EXPECT_EQ(0, published_cinfo->active_upids().size());
+  EXPECT_EQ(0, published_cinfo->stop_time_ns());
+  EXPECT_EQ(0, published_state->upids().size());
+}
+
 TEST_F(AgentMetadataStateTest, insert_into_filter) {
   moodycamel::BlockingConcurrentQueue<std::unique_ptr<ResourceUpdate>> updates;
   GenerateTestUpdateEvents(&updates);
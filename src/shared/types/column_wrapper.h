@@ -22,8 +22,10 @@
 #include <arrow/buffer.h>
 #include <arrow/builder.h>
 
+#include <limits>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -35,6 +37,7 @@ namespace px {
 namespace types {
 
 class ColumnWrapper;
+class StringColumnWrapper;
 using SharedColumnWrapper = std::shared_ptr<ColumnWrapper>;
 using ColumnWrapperRecordBatch = std::vector<types::SharedColumnWrapper>;
 
@@ -67,12 +70,19 @@ class ColumnWrapper {
   virtual int64_t Bytes() const = 0;
 
   virtual void Reserve(size_t size) = 0;
+  // Grows the column with default values, or drops values from its end.
+  virtual void Resize(size_t size) = 0;
   virtual void Clear() = 0;
   virtual void ShrinkToFit() = 0;
   virtual std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* mem_pool) = 0;
   // GetView returns an empty string view for all non-string columns.
   virtual std::string_view GetView(size_t idx) const = 0;
 
+  // String columns are either ColumnWrapperTmpl<StringValue> or StringColumnWrapper.
+  // Returns nullptr unless this column is a StringColumnWrapper.
+  virtual StringColumnWrapper* AsStringColumn() { return nullptr; }
+  virtual const StringColumnWrapper* AsStringColumn() const { return nullptr; }
+
   template <class TValueType>
   void Append(TValueType val);
 
@@ -135,7 +145,7 @@ class ColumnWrapperTmpl : public ColumnWrapper {
 
   void ShrinkToFit() override { data_.shrink_to_fit(); }
 
-  void Resize(size_t size) { data_.resize(size); }
+  void Resize(size_t size) override { data_.resize(size); }
 
   void Clear() override { data_.clear(); }
 
@@ -204,6 +214,153 @@ using Float64ValueColumnWrapper = ColumnWrapperTmpl<Float64Value>;
 using StringValueColumnWrapper = ColumnWrapperTmpl<StringValue>;
 using Time64NSValueColumnWrapper = ColumnWrapperTmpl<Time64NSValue>;
 
+/**
+ * A string column stored in the Arrow layout: one contiguous buffer with the bytes of every
+ * string, and an offsets array of Size() + 1 entries that delimits them. Appending a string only
+ * allocates when one of the two buffers has to grow, and ConvertToArrow() wraps the buffers in an
+ * arrow::StringArray without copying.
+ *
+ * Strings can only be read as views (GetView()). ColumnWrapper::Get<StringValue>() const returns
+ * a copy. The non-const overload returns a reference, and CHECK-fails on this column.
+ */
+class StringColumnWrapper : public ColumnWrapper {
+ public:
+  // Creates a column of size empty strings.
+  explicit StringColumnWrapper(size_t size = 0) : buffers_(std::make_shared<Buffers>(size)) {}
+  explicit StringColumnWrapper(const std::vector<std::string_view>& vals)
+      : StringColumnWrapper() {
+    AppendFromVector(vals);
+  }
+
+  ~StringColumnWrapper() override = default;
+
+  // There is no array of StringValues to point to.
+  BaseValueType* UnsafeRawData() override { return nullptr; }
+  const BaseValueType* UnsafeRawData() const override { return nullptr; }
+  DataType data_type() const override { return DataType::STRING; }
+
+  size_t Size() const override { return buffers_->offsets.size() - 1; }
+  bool Empty() const override { return Size() == 0; }
+  int64_t Bytes() const override { return buffers_->data.size(); }
+
+  StringColumnWrapper* AsStringColumn() override { return this; }
+  const StringColumnWrapper* AsStringColumn() const override { return this; }
+
+  // The returned array shares the buffers of this column. Later changes to this column first copy
+  // the buffers, so the array never observes them.
+  std::shared_ptr<arrow::Array> ConvertToArrow(arrow::MemoryPool* /*mem_pool*/) override {
+    const Buffers& buffers = *buffers_;
+    auto offsets = std::make_shared<OwnedBuffer>(buffers_, buffers.offsets.data(),
+                                                 buffers.offsets.size() * sizeof(int32_t));
+    auto data = std::make_shared<OwnedBuffer>(buffers_, buffers.data.data(), buffers.data.size());
+    return std::make_shared<arrow::StringArray>(Size(), std::move(offsets), std::move(data));
+  }
+
+  std::string_view GetView(size_t idx) const override {
+    DCHECK_LT(idx, Size());
+    const Buffers& buffers = *buffers_;
+    return std::string_view(buffers.data.data() + buffers.offsets[idx],
+                            buffers.offsets[idx + 1] - buffers.offsets[idx]);
+  }
+
+  void Append(std::string_view val) {
+    Buffers& buffers = MutableBuffers();
+    buffers.data.insert(buffers.data.end(), val.begin(), val.end());
+    DCHECK_LE(buffers.data.size(), static_cast<size_t>(std::numeric_limits<int32_t>::max()))
+        << "String column exceeds the maximum size of an arrow::StringArray.";
+    buffers.offsets.push_back(static_cast<int32_t>(buffers.data.size()));
+  }
+
+  template <typename TString>
+  void AppendFromVector(const std::vector<TString>& value_vector) {
+    size_t num_bytes = 0;
+    for (const auto& value : value_vector) {
+      num_bytes += std::string_view(value).size();
+    }
+    Reserve(Size() + value_vector.size());
+    ReserveData(Bytes() + num_bytes);
+    for (const auto& value : value_vector) {
+      Append(value);
+    }
+  }
+
+  void Reserve(size_t size) override { MutableBuffers().offsets.reserve(size + 1); }
+
+  // Reserves space for num_bytes bytes of string data, in total across all strings.
+  void ReserveData(size_t num_bytes) { MutableBuffers().data.reserve(num_bytes); }
+
+  void Resize(size_t size) override {
+    Buffers& buffers = MutableBuffers();
+    if (size < Size()) {
+      buffers.data.resize(buffers.offsets[size]);
+      buffers.offsets.resize(size + 1);
+    } else {
+      // Grows with empty strings.
+      const int32_t end = buffers.offsets.back();
+      buffers.offsets.resize(size + 1, end);
+    }
+  }
+
+  void ShrinkToFit() override {
+    Buffers& buffers = MutableBuffers();
+    buffers.offsets.shrink_to_fit();
+    buffers.data.shrink_to_fit();
+  }
+
+  void Clear() override { buffers_ = std::make_shared<Buffers>(0); }
+
+  // Return a new SharedColumnWrapper with values according to the spec:
+  //    { data[idx[0]], data[idx[1]], data[idx[2]], ... }
+  SharedColumnWrapper CopyIndexes(const std::vector<size_t>& indexes) const override {
+    DCHECK_LE(indexes.size(), Size());
+    size_t num_bytes = 0;
+    for (size_t idx : indexes) {
+      num_bytes += GetView(idx).size();
+    }
+    auto copy = std::make_shared<StringColumnWrapper>();
+    copy->Reserve(indexes.size());
+    copy->ReserveData(num_bytes);
+    for (size_t idx : indexes) {
+      copy->Append(GetView(idx));
+    }
+    return copy;
+  }
+
+  // Strings in one contiguous buffer cannot be moved out individually, so this copies them.
+  SharedColumnWrapper MoveIndexes(const std::vector<size_t>& indexes) override {
+    return CopyIndexes(indexes);
+  }
+
+ private:
+  struct Buffers {
+    explicit Buffers(size_t size) : offsets(size + 1, 0) {}
+
+    std::vector<int32_t> offsets;
+    std::vector<char> data;
+  };
+
+  // An arrow::Buffer over memory that is kept alive by a shared owner.
+  class OwnedBuffer : public arrow::Buffer {
+   public:
+    OwnedBuffer(std::shared_ptr<const void> owner, const void* data, size_t size)
+        : arrow::Buffer(static_cast<const uint8_t*>(data), static_cast<int64_t>(size)),
+          owner_(std::move(owner)) {}
+
+   private:
+    std::shared_ptr<const void> owner_;
+  };
+
+  // Buffers that were handed out by ConvertToArrow() are copied before they are modified.
+  Buffers& MutableBuffers() {
+    if (buffers_.use_count() > 1) {
+      buffers_ = std::make_shared<Buffers>(*buffers_);
+    }
+    return *buffers_;
+  }
+
+  std::shared_ptr<Buffers> buffers_;
+};
+
 template <typename TColumnWrapper, types::DataType DType>
 inline SharedColumnWrapper FromArrowImpl(const std::shared_ptr<arrow::Array>& arr) {
   CHECK_EQ(arr->type_id(), DataTypeTraits<DType>::arrow_type_id);
@@ -275,37 +432,52 @@ inline void ColumnWrapper::Append(TValueType val) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
       << "Expect " << ToString(data_type()) << " got "
       << ToString(ValueTypeTraits<TValueType>::data_type);
-  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(val);
+  AppendNoTypeCheck(std::move(val));
 }
 
 template <class TValueType>
 inline TValueType& ColumnWrapper::Get(size_t idx) {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
-  return static_cast<ColumnWrapperTmpl<TValueType>*>(this)->operator[](idx);
+  return GetNoTypeCheck<TValueType>(idx);
 }
 
 template <class TValueType>
 inline TValueType ColumnWrapper::Get(size_t idx) const {
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
-  return static_cast<const ColumnWrapperTmpl<TValueType>*>(this)->operator[](idx);
+  return GetNoTypeCheck<TValueType>(idx);
 }
 
 template <class TValueType>
 inline void ColumnWrapper::AppendNoTypeCheck(TValueType val) {
   DCHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
-  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(val);
+  if constexpr (std::is_same_v<TValueType, StringValue>) {
+    if (StringColumnWrapper* col = AsStringColumn(); col != nullptr) {
+      col->Append(val);
+      return;
+    }
+  }
+  static_cast<ColumnWrapperTmpl<TValueType>*>(this)->Append(std::move(val));
 }
 
 template <class TValueType>
 inline TValueType& ColumnWrapper::GetNoTypeCheck(size_t idx) {
   DCHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
+  if constexpr (std::is_same_v<TValueType, StringValue>) {
+    // A reference into a StringColumnWrapper can't exist, so this is checked in all builds.
+    CHECK(AsStringColumn() == nullptr) << "Use GetView() to read a StringColumnWrapper.";
+  }
   return static_cast<ColumnWrapperTmpl<TValueType>*>(this)->operator[](idx);
 }
 
 template <class TValueType>
 inline TValueType ColumnWrapper::GetNoTypeCheck(size_t idx) const {
   DCHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type);
-  return static_cast<ColumnWrapperTmpl<TValueType>*>(this)->operator[](idx);
+  if constexpr (std::is_same_v<TValueType, StringValue>) {
+    if (AsStringColumn() != nullptr) {
+      return StringValue(std::string(GetView(idx)));
+    }
+  }
+  return static_cast<const ColumnWrapperTmpl<TValueType>*>(this)->operator[](idx);
 }
 
 template <class TValueType>
@@ -313,6 +485,12 @@ inline void ColumnWrapper::AppendFromVector(const std::vector<TValueType>& val)
   CHECK_EQ(data_type(), ValueTypeTraits<TValueType>::data_type)
       << "Expect " << ToString(data_type()) << " got "
       << ToString(ValueTypeTraits<TValueType>::data_type);
+  if constexpr (std::is_same_v<TValueType, StringValue>) {
+    if (StringColumnWrapper* col = AsStringColumn(); col != nullptr) {
+      col->AppendFromVector(val);
+      return;
+    }
+  }
   static_cast<ColumnWrapperTmpl<TValueType>*>(this)->AppendFromVector(val);
 }
 
@@ -375,7 +553,8 @@ class ColumnWrapperIterator : public std::iterator<std::bidirectional_iterator_t
 
   ReturnType operator*() const {
     if constexpr (std::is_same_v<ValueType, StringValue>) {
-      return column_->Get<ValueType>(curr_idx_);
+      // GetView() works for both kinds of string columns.
+      return ReturnType(column_->GetView(curr_idx_));
     } else {
       return column_->Get<ValueType>(curr_idx_).val;
     }
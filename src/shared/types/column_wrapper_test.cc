@@ -283,5 +283,96 @@ TEST(ColumnWrapperTest, MoveIndexes) {
   }
 }
 
+TEST(StringColumnWrapperTest, AppendAndGetView) {
+  StringColumnWrapper col;
+  col.Append("abc");
+  col.Append("");
+  col.Append("de");
+
+  ASSERT_EQ(col.Size(), 3);
+  EXPECT_EQ(col.Bytes(), 5);
+  EXPECT_EQ(col.data_type(), DataType::STRING);
+  EXPECT_EQ(col.GetView(0), "abc");
+  EXPECT_EQ(col.GetView(1), "");
+  EXPECT_EQ(col.GetView(2), "de");
+}
+
+TEST(StringColumnWrapperTest, TypeErasedAccess) {
+  SharedColumnWrapper col = std::make_shared<StringColumnWrapper>();
+  col->Append(StringValue("abc"));
+  col->AppendFromVector(std::vector<StringValue>{"de", "f"});
+
+  ASSERT_EQ(col->Size(), 3);
+  const ColumnWrapper& const_col = *col;
+  EXPECT_EQ(const_col.Get<StringValue>(1), "de");
+  EXPECT_DEATH(col->Get<StringValue>(1), "Use GetView\\(\\) to read a StringColumnWrapper");
+
+  std::vector<std::string> vals(ColumnWrapperIterator<DataType::STRING>(col.get()).begin(),
+                                ColumnWrapperIterator<DataType::STRING>(col.get()).end());
+  EXPECT_THAT(vals, ::testing::ElementsAre("abc", "de", "f"));
+
+  auto tmpl_col = ColumnWrapper::Make(DataType::STRING, 0);
+  EXPECT_EQ(tmpl_col->AsStringColumn(), nullptr);
+  EXPECT_NE(col->AsStringColumn(), nullptr);
+}
+
+TEST(StringColumnWrapperTest, ConvertToArrowWithoutCopy) {
+  StringColumnWrapper col(std::vector<std::string_view>{"abc", "", "de"});
+
+  auto arr = col.ConvertToArrow(arrow::default_memory_pool());
+  ASSERT_EQ(arr->length(), 3);
+  auto* str_arr = static_cast<arrow::StringArray*>(arr.get());
+  EXPECT_EQ(str_arr->GetString(0), "abc");
+  EXPECT_EQ(str_arr->GetString(1), "");
+  EXPECT_EQ(str_arr->GetString(2), "de");
+  EXPECT_EQ(reinterpret_cast<const char*>(str_arr->value_data()->data()), col.GetView(0).data());
+
+  // Appending after the conversion copies the buffers, and leaves the array as it was.
+  col.Append("fgh");
+  EXPECT_NE(reinterpret_cast<const char*>(str_arr->value_data()->data()), col.GetView(0).data());
+  EXPECT_EQ(str_arr->length(), 3);
+  EXPECT_EQ(str_arr->GetString(2), "de");
+  EXPECT_EQ(col.GetView(3), "fgh");
+
+  // The array outlives the column.
+  auto arr2 = col.ConvertToArrow(arrow::default_memory_pool());
+  col.Clear();
+  EXPECT_EQ(col.Size(), 0);
+  EXPECT_EQ(static_cast<arrow::StringArray*>(arr2.get())->GetString(3), "fgh");
+}
+
+TEST(StringColumnWrapperTest, Resize) {
+  StringColumnWrapper col(std::vector<std::string_view>{"a", "bb", "ccc"});
+
+  col.Resize(2);
+  ASSERT_EQ(col.Size(), 2);
+  EXPECT_EQ(col.Bytes(), 3);
+  EXPECT_EQ(col.GetView(1), "bb");
+
+  col.Resize(4);
+  ASSERT_EQ(col.Size(), 4);
+  EXPECT_EQ(col.GetView(1), "bb");
+  EXPECT_EQ(col.GetView(3), "");
+}
+
+TEST(StringColumnWrapperTest, CopyAndMoveIndexes) {
+  StringColumnWrapper col(std::vector<std::string_view>{"a", "bb", "ccc", "dddd"});
+
+  auto copy = col.CopyIndexes({3, 1, 1});
+  ASSERT_EQ(copy->Size(), 3);
+  EXPECT_EQ(copy->GetView(0), "dddd");
+  EXPECT_EQ(copy->GetView(1), "bb");
+  EXPECT_EQ(copy->GetView(2), "bb");
+  EXPECT_EQ(copy->Bytes(), 8);
+  EXPECT_NE(copy->AsStringColumn(), nullptr);
+
+  auto moved = col.MoveIndexes({2, 0});
+  ASSERT_EQ(moved->Size(), 2);
+  EXPECT_EQ(moved->GetView(0), "ccc");
+  EXPECT_EQ(moved->GetView(1), "a");
+
+  EXPECT_EQ(col.CopyIndexes({})->Size(), 0);
+}
+
 }  // namespace types
 }  // namespace px
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "src/stirling/core/data_table.h"
+
+using px::stirling::DataElement;
+using px::stirling::DataTable;
+using px::stirling::DataTableSchema;
+using px::stirling::TaggedRecordBatch;
+namespace types = px::types;
+
+constexpr DataElement kElements[] = {
+    {"time_", "", types::DataType::TIME64NS, types::SemanticType::ST_NONE,
+     types::PatternType::METRIC_COUNTER},
+    {"x", "", types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"s", "", types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+constexpr auto kSchema = DataTableSchema("bench_table", "A table to benchmark", kElements);
+
+// Appends one record per time, in the given order.
+void Fill(const std::vector<uint64_t>& times, DataTable* data_table) {
+  for (uint64_t t : times) {
+    DataTable::RecordBuilder<&kSchema> r(data_table, t);
+    r.Append<r.ColIndex("time_")>(t);
+    r.Append<r.ColIndex("x")>(t);
+    r.Append<r.ColIndex("s")>("GET /index.html HTTP/1.1");
+  }
+}
+
+// Each iteration appends state.range(0) records and consumes them. If cutoff_pct is less than 100,
+// the newest records are carried over to the next iteration.
+// NOLINTNEXTLINE(runtime/references)
+void BenchmarkConsumeRecords(benchmark::State& state, bool in_order, int cutoff_pct) {
+  const uint64_t num_records = state.range(0);
+
+  std::vector<uint64_t> offsets(num_records);
+  std::iota(offsets.begin(), offsets.end(), 0);
+  if (!in_order) {
+    std::shuffle(offsets.begin(), offsets.end(), std::mt19937(37));
+  }
+
+  DataTable data_table(/*id*/ 0, kSchema);
+  uint64_t base_time = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::vector<uint64_t> times = offsets;
+    for (auto& t : times) {
+      t += base_time;
+    }
+    Fill(times, &data_table);
+    data_table.SetConsumeRecordsCutoffTime(base_time + num_records * cutoff_pct / 100);
+    base_time += num_records;
+    state.ResumeTiming();
+
+    std::vector<TaggedRecordBatch> record_batches = data_table.ConsumeRecords();
+    benchmark::DoNotOptimize(record_batches);
+  }
+  state.SetItemsProcessed(state.iterations() * num_records);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_consume_in_order(benchmark::State& state) {
+  BenchmarkConsumeRecords(state, /*in_order*/ true, /*cutoff_pct*/ 100);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_consume_in_order_with_carryover(benchmark::State& state) {
+  BenchmarkConsumeRecords(state, /*in_order*/ true, /*cutoff_pct*/ 90);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_consume_out_of_order(benchmark::State& state) {
+  BenchmarkConsumeRecords(state, /*in_order*/ false, /*cutoff_pct*/ 100);
+}
+
+// NOLINTNEXTLINE(runtime/references)
+static void BM_consume_out_of_order_with_carryover(benchmark::State& state) {
+  BenchmarkConsumeRecords(state, /*in_order*/ false, /*cutoff_pct*/ 90);
+}
+
+BENCHMARK(BM_consume_in_order)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK(BM_consume_in_order_with_carryover)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK(BM_consume_out_of_order)->RangeMultiplier(4)->Range(64, 16384);
+BENCHMARK(BM_consume_out_of_order_with_carryover)->RangeMultiplier(4)->Range(64, 16384);
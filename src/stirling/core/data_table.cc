@@ -17,6 +17,10 @@
  */
 
 #include <algorithm>
+#include <array>
+#include <limits>
+#include <memory>
+#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
@@ -27,6 +31,12 @@
 #include "src/stirling/core/types.h"
 #include "src/stirling/utils/index_sorted_vector.h"
 
+DEFINE_bool(stirling_contiguous_string_columns,
+            gflags::BoolFromEnv("PL_STIRLING_CONTIGUOUS_STRING_COLUMNS", false),
+            "If true, string columns are buffered in one contiguous buffer per column, which "
+            "converts to Arrow without copying. Consumers of the records must read strings with "
+            "ColumnWrapper::GetView().");
+
 namespace px {
 namespace stirling {
 
@@ -42,6 +52,13 @@ void DataTable::InitBuffers(types::ColumnWrapperRecordBatch* record_batch_ptr) {
   for (const auto& element : table_schema_.elements()) {
     px::types::DataType type = element.type();
 
+    if (type == types::DataType::STRING && FLAGS_stirling_contiguous_string_columns) {
+      auto col = std::make_shared<types::StringColumnWrapper>();
+      col->Reserve(kTargetCapacity);
+      record_batch_ptr->push_back(col);
+      continue;
+    }
+
 #define TYPE_CASE(_dt_)                           \
   auto col = types::ColumnWrapper::Make(_dt_, 0); \
   col->Reserve(kTargetCapacity);                  \
@@ -64,63 +81,100 @@ std::vector<TaggedRecordBatch> DataTable::ConsumeRecords() {
   absl::flat_hash_map<types::TabletID, Tablet> carryover_tablets;
   uint64_t next_start_time = start_time_;
 
+  // End time is cutoff time + 1, so the split below classifies records as:
+  //   expired < start_time
+  //   pushable <= end_time
+  uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
+                                               : std::numeric_limits<uint64_t>::max();
+
   for (auto& [tablet_id, tablet] : tablets_) {
-    // Sort based on times.
-    std::vector<size_t> sort_indexes = utils::SortedIndexes(tablet.times);
-
-    // End time is cutoff time + 1, so call to SplitSortedVector() produces the following
-    // classification: which classified according to:
-    //   expired < start_time
-    //   pushable <= end_time
-    uint64_t end_time = cutoff_time_.has_value() ? (cutoff_time_.value() + 1)
-                                                 : std::numeric_limits<uint64_t>::max();
-
-    // Split the indexes into three groups:
-    // 1) Expired indexes: these are too old to return.
-    // 2) Pushable indexes: these are the ones that we return.
-    // 3) Carryover indexes: these are too new to return, so hold on to them until the next round.
-    auto positions =
-        utils::SplitSortedVector<2>(tablet.times, sort_indexes, {start_time_, end_time});
-    int num_expired = positions[0];
-    int num_pushable = positions[1] - positions[0];
-    int num_carryover = tablet.times.size() - positions[1];
+    const std::vector<uint64_t>& times = tablet.times;
+    if (times.empty()) {
+      continue;
+    }
+
+    // Split the records into three groups, which are contiguous in time order:
+    // 1) Expired records: these are too old to return.
+    // 2) Pushable records: these are the ones that we return.
+    // 3) Carryover records: these are too new to return, so hold on to them until the next round.
+    // Records appended in time order need no sort, since time order is then append order.
+    std::vector<size_t> sort_indexes;
+    std::array<size_t, 2> positions;
+    if (tablet.times_sorted) {
+      auto pushable_begin = std::lower_bound(times.begin(), times.end(), start_time_);
+      auto pushable_end = std::lower_bound(pushable_begin, times.end(), end_time);
+      positions = {static_cast<size_t>(pushable_begin - times.begin()),
+                   static_cast<size_t>(pushable_end - times.begin())};
+    } else {
+      sort_indexes = utils::SortedIndexes(times);
+      positions = utils::SplitSortedVector<2>(times, sort_indexes, {start_time_, end_time});
+    }
+    size_t num_expired = positions[0];
+    size_t num_pushable = positions[1] - positions[0];
+    size_t num_carryover = times.size() - positions[1];
+
+    // Returns the indexes of the records in [begin, end) of time order.
+    auto time_ordered_indexes = [&](size_t begin, size_t end) {
+      std::vector<size_t> indexes(end - begin);
+      if (tablet.times_sorted) {
+        std::iota(indexes.begin(), indexes.end(), begin);
+      } else {
+        std::copy(sort_indexes.begin() + begin, sort_indexes.begin() + end, indexes.begin());
+      }
+      return indexes;
+    };
 
     // Case 1: Expired records. Just print a message.
     VLOG_IF(1, num_expired > 0) << absl::Substitute(
         "$0 records for table $1 dropped due to late arrival [cutoff time=$2, oldest event "
         "time=$3].",
-        num_expired, table_schema_.name(), end_time, tablet.times[sort_indexes[0]]);
-
-    // Case 2: Pushable records. Copy to output.
-    if (num_pushable > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> push_indexes(sort_indexes.begin() + num_expired,
-                                       sort_indexes.end() - num_carryover);
-      types::ColumnWrapperRecordBatch pushable_records;
-      for (auto& col : tablet.records) {
-        pushable_records.push_back(col->MoveIndexes(push_indexes));
-      }
-      uint64_t last_time = tablet.times[push_indexes.back()];
-      next_start_time = std::max(next_start_time, last_time);
-      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
-    }
+        num_expired, table_schema_.name(), end_time,
+        times[tablet.times_sorted ? 0 : sort_indexes[0]]);
 
     // Case 3: Carryover records.
+    // Handled before the pushable records, which may take over the columns they are moved from.
     if (num_carryover > 0) {
-      // TODO(oazizi): Consider VectorView to avoid copying.
-      std::vector<size_t> carryover_indexes(sort_indexes.begin() + num_pushable,
-                                            sort_indexes.end());
+      std::vector<size_t> carryover_indexes = time_ordered_indexes(positions[1], times.size());
       types::ColumnWrapperRecordBatch carryover_records;
       for (auto& col : tablet.records) {
         carryover_records.push_back(col->MoveIndexes(carryover_indexes));
       }
 
-      std::vector<uint64_t> times(carryover_indexes.size());
-      for (size_t i = 0; i < times.size(); ++i) {
-        times[i] = tablet.times[carryover_indexes[i]];
+      std::vector<uint64_t> carryover_times(carryover_indexes.size());
+      for (size_t i = 0; i < carryover_times.size(); ++i) {
+        carryover_times[i] = times[carryover_indexes[i]];
       }
       carryover_tablets[tablet_id] =
-          Tablet{tablet_id, std::move(times), std::move(carryover_records)};
+          Tablet{tablet_id, std::move(carryover_times), std::move(carryover_records)};
+    }
+
+    // Case 2: Pushable records.
+    if (num_pushable > 0) {
+      // When the pushable records are a prefix of the columns, the columns are handed out as they
+      // are, after dropping the carryover records from their ends. Columns are reserved with
+      // kTargetCapacity, so small batches are still copied out, to not hold on to unused capacity.
+      bool hand_out_columns =
+          tablet.times_sorted && num_expired == 0 && 2 * positions[1] >= kTargetCapacity;
+
+      std::vector<size_t> push_indexes;
+      if (!hand_out_columns) {
+        push_indexes = time_ordered_indexes(positions[0], positions[1]);
+      }
+      size_t last_index = hand_out_columns ? positions[1] - 1 : push_indexes.back();
+      next_start_time = std::max(next_start_time, times[last_index]);
+
+      types::ColumnWrapperRecordBatch pushable_records;
+      if (hand_out_columns) {
+        for (auto& col : tablet.records) {
+          col->Resize(positions[1]);
+        }
+        pushable_records = std::move(tablet.records);
+      } else {
+        for (auto& col : tablet.records) {
+          pushable_records.push_back(col->MoveIndexes(push_indexes));
+        }
+      }
+      tablets_out.push_back(TaggedRecordBatch{tablet_id, std::move(pushable_records)});
     }
   }
   tablets_ = std::move(carryover_tablets);
@@ -19,17 +19,24 @@
 #pragma once
 
 #include <algorithm>
+#include <bitset>
 #include <limits>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <absl/container/flat_hash_map.h>
+#include <absl/types/span.h>
 
 #include "src/common/base/base.h"
 #include "src/common/base/mixins.h"
 #include "src/stirling/core/types.h"
 
+DECLARE_bool(stirling_contiguous_string_columns);
+
 namespace px {
 namespace stirling {
 
@@ -43,9 +50,18 @@ struct TaggedRecordBatch {
 
 struct Tablet {
   types::TabletID tablet_id;
-  // TODO(oazizi): Convert this vector into a heap of {time, index} objects.
   std::vector<uint64_t> times;
   types::ColumnWrapperRecordBatch records;
+  // Whether times are in non-decreasing order. Most connectors append records in time order, in
+  // which case ConsumeRecords() needs no sort, and hands out the buffered columns without copying.
+  bool times_sorted = true;
+
+  void AppendTime(uint64_t time) {
+    if (!times.empty() && time < times.back()) {
+      times_sorted = false;
+    }
+    times.push_back(time);
+  }
 };
 
 class DataTable : public NotCopyable {
@@ -122,6 +138,9 @@ class DataTable : public NotCopyable {
 
   static constexpr char kTruncatedMsg[] = "... [TRUNCATED]";
 
+  // Appended strings with more unused capacity than this are shrunk to fit.
+  static constexpr size_t kMaxStringSlackBytes = 64;
+
   // RecordBuilder is used to build records into the DataTable.
   // It is to be preferred when the schema is known at compile-time, as it is more optimized.
   // If the schema is not known at compile-time, see DynamicRecordBuilder.
@@ -162,7 +181,11 @@ class DataTable : public NotCopyable {
           val.resize(max_string_bytes);
           val.append(kTruncatedMsg);
         }
-        val.shrink_to_fit();
+        // Strings are usually moved in from parsed frames, and already fit their contents.
+        // Only shrink when there is significant slack, since shrinking reallocates and copies.
+        if (val.capacity() - val.size() > kMaxStringSlackBytes) {
+          val.shrink_to_fit();
+        }
       }
 
       tablet_.records[TIndex]->Append(std::move(val));
@@ -172,6 +195,30 @@ class DataTable : public NotCopyable {
       signature_.set(TIndex);
     }
 
+    // Appends a string without taking ownership of it, for strings that are owned elsewhere,
+    // e.g. in the FrameArena of a connection. Contiguous string columns copy the bytes straight
+    // into their buffer; other string columns make a StringValue of them.
+    // Strings larger than max_string_bytes size will be truncated before being appended.
+    template <const size_t TIndex>
+    void AppendView(std::string_view val, const size_t max_string_bytes = 1024) {
+      static_assert(schema->elements()[TIndex].type() == types::DataType::STRING);
+
+      types::ColumnWrapper* col = tablet_.records[TIndex].get();
+      types::StringColumnWrapper* string_col = col->AsStringColumn();
+      if (val.size() > max_string_bytes) {
+        col->Append(types::StringValue(absl::StrCat(val.substr(0, max_string_bytes),
+                                                    kTruncatedMsg)));
+      } else if (string_col != nullptr) {
+        string_col->Append(val);
+      } else {
+        col->Append(types::StringValue(val));
+      }
+      DCHECK(!signature_[TIndex]) << absl::Substitute(
+          "Attempt to Append() to column $0 (name=$1) multiple times", TIndex,
+          schema->ColName(TIndex));
+      signature_.set(TIndex);
+    }
+
     ~RecordBuilder() {
       DCHECK(signature_.all()) << absl::Substitute(
           "Must call Append() on all columns. Table name = $0, Column unfilled = [$1]",
@@ -191,12 +238,230 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema->elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
+    }
+
+    Tablet& tablet_;
+    std::bitset<schema->elements().size()> signature_;
+    types::TabletIDView tablet_id_ = "";
+  };
+
+  // ColumnarRecordBuilder appends a batch of records to the DataTable, one column at a time.
+  // It is to be preferred over RecordBuilder when a connector produces many records at once:
+  // each column is grown once and filled in a tight loop, and the checks that RecordBuilder does
+  // on every value are done once per column instead.
+  //
+  // Example usage:
+  // DataTable::ColumnarRecordBuilder<&kTable> r(data_table, times);
+  // r.AppendColumn<r.ColIndex("field0")>(vals0);
+  // r.AppendColumn<r.ColIndex("field1")>(records, [](const auto& rec) { return rec.field1; });
+  // r.FillColumn<r.ColIndex("field2")>(val2);
+  //
+  // Every column must be appended exactly once, with one value per record.
+  template <const DataTableSchema* schema>
+  class ColumnarRecordBuilder {
+   public:
+    ColumnarRecordBuilder(DataTable* data_table, types::TabletIDView tablet_id,
+                          absl::Span<const uint64_t> times)
+        : tablet_(*data_table->GetTablet(tablet_id)) {
+      static_assert(schema->tabletized());
+      tablet_id_ = tablet_id;
+      Init(times);
+    }
+
+    ColumnarRecordBuilder(DataTable* data_table, absl::Span<const uint64_t> times)
+        : tablet_(*data_table->GetTablet("")) {
+      static_assert(!schema->tabletized());
+      Init(times);
+    }
+
+    // Convenience constructor for a batch of records that all share the same time.
+    ColumnarRecordBuilder(DataTable* data_table, size_t num_records, uint64_t time)
+        : tablet_(*data_table->GetTablet("")) {
+      static_assert(!schema->tabletized());
+      num_records_ = num_records;
+      start_row_ = tablet_.times.size();
+      if (num_records > 0) {
+        tablet_.AppendTime(time);
+        tablet_.times.resize(start_row_ + num_records, time);
+      }
+      DCHECK_EQ(schema->elements().size(), tablet_.records.size());
+    }
+
+    // For convenience, a wrapper around ColIndex() in the DataTableSchema class.
+    constexpr uint32_t ColIndex(std::string_view name) { return schema->ColIndex(name); }
+
+    // Appends one value per record, taken from a container of values convertible to the column
+    // type. Strings larger than max_string_bytes size will be truncated before being appended.
+    template <const size_t TIndex, typename TContainer>
+    void AppendColumn(const TContainer& vals, const size_t max_string_bytes = 1024) {
+      AppendColumn<TIndex>(
+          vals, [](const auto& val) -> const auto& { return val; }, max_string_bytes);
+    }
+
+    // Appends fn(record) for every record in a container, e.g. to project a field out of a
+    // vector of structs without first copying it into a vector of its own.
+    template <const size_t TIndex, typename TContainer, typename TFn,
+              typename = std::enable_if_t<
+                  std::is_invocable_v<TFn, const typename TContainer::value_type&>>>
+    void AppendColumn(const TContainer& records, TFn&& fn, const size_t max_string_bytes = 1024) {
+      using TDataType =
+          typename types::DataTypeTraits<schema->elements()[TIndex].type()>::value_type;
+
+      DCHECK_EQ(static_cast<size_t>(std::size(records)), num_records_) << absl::Substitute(
+          "Wrong number of values for column $0 (name=$1)", TIndex, schema->ColName(TIndex));
+
+      if constexpr (std::is_same_v<TDataType, types::StringValue>) {
+        if (types::StringColumnWrapper* col = StartStringColumn<TIndex>(); col != nullptr) {
+          auto iter = std::begin(records);
+          for (size_t i = 0; i < num_records_; ++i) {
+            if (iter != std::end(records)) {
+              AppendString(fn(*iter++), max_string_bytes, col);
+            } else {
+              col->Append("");
+            }
+          }
+          return;
+        }
+      }
+
+      TDataType* out = StartColumn<TIndex>();
+      auto iter = std::begin(records);
+      for (size_t i = 0; i < num_records_ && iter != std::end(records); ++i, ++iter) {
+        Store(fn(*iter), max_string_bytes, &out[i]);
+      }
+
+      if constexpr (TIndex == schema->tabletization_key()) {
+        // This will break if val is ever StringValue (string tabletization keys are not supported).
+        for (size_t i = 0; i < num_records_; ++i) {
+          DCHECK(std::to_string(out[i].val) == tablet_id_);
+        }
+      }
+    }
+
+    // Appends the same value to every record, e.g. for a time column shared by the whole batch.
+    template <const size_t TIndex>
+    void FillColumn(
+        const typename types::DataTypeTraits<schema->elements()[TIndex].type()>::value_type& val,
+        const size_t max_string_bytes = 1024) {
+      using TDataType =
+          typename types::DataTypeTraits<schema->elements()[TIndex].type()>::value_type;
+
+      if constexpr (std::is_same_v<TDataType, types::StringValue>) {
+        if (types::StringColumnWrapper* col = StartStringColumn<TIndex>(); col != nullptr) {
+          for (size_t i = 0; i < num_records_; ++i) {
+            AppendString(val, max_string_bytes, col);
+          }
+          return;
+        }
+      }
+
+      TDataType* out = StartColumn<TIndex>();
+      if (num_records_ == 0) {
+        return;
+      }
+      Store(val, max_string_bytes, out);
+      std::fill(out + 1, out + num_records_, *out);
+
+      if constexpr (TIndex == schema->tabletization_key()) {
+        DCHECK(std::to_string(out->val) == tablet_id_);
+      }
+    }
+
+    ~ColumnarRecordBuilder() {
+      DCHECK(signature_.all()) << absl::Substitute(
+          "Must call AppendColumn() on all columns. Table name = $0, Column unfilled = [$1]",
+          schema->name(), absl::StrJoin(UnfilledColNames(), ","));
+    }
+
+    std::vector<std::string_view> UnfilledColNames() const {
+      std::vector<std::string_view> res;
+      for (size_t i = 0; i < signature_.size(); ++i) {
+        if (!signature_.test(i)) {
+          res.push_back(schema->ColName(i));
+        }
+      }
+      return res;
+    }
+
+   private:
+    void Init(absl::Span<const uint64_t> times) {
+      DCHECK_EQ(schema->elements().size(), tablet_.records.size());
+      num_records_ = times.size();
+      start_row_ = tablet_.times.size();
+      tablet_.times.reserve(start_row_ + num_records_);
+      for (uint64_t time : times) {
+        tablet_.AppendTime(time);
+      }
+    }
+
+    template <const size_t TIndex>
+    void MarkFilled() {
+      DCHECK(!signature_[TIndex]) << absl::Substitute(
+          "Attempt to AppendColumn() to column $0 (name=$1) multiple times", TIndex,
+          schema->ColName(TIndex));
+      signature_.set(TIndex);
+      DCHECK_EQ(tablet_.records[TIndex]->Size(), start_row_);
+    }
+
+    // Grows the column by the size of the batch, and returns a pointer to the first new value.
+    template <const size_t TIndex>
+    auto* StartColumn() {
+      using TDataType =
+          typename types::DataTypeTraits<schema->elements()[TIndex].type()>::value_type;
+
+      MarkFilled<TIndex>();
+      auto* col = static_cast<types::ColumnWrapperTmpl<TDataType>*>(tablet_.records[TIndex].get());
+      col->Resize(start_row_ + num_records_);
+      return col->UnsafeRawData() + start_row_;
+    }
+
+    // Returns nullptr if the column is not a StringColumnWrapper, in which case the caller must
+    // fall back to StartColumn(). Contiguous strings cannot be assigned in place after a resize,
+    // so they are appended instead.
+    template <const size_t TIndex>
+    types::StringColumnWrapper* StartStringColumn() {
+      types::StringColumnWrapper* col = tablet_.records[TIndex]->AsStringColumn();
+      if (col != nullptr) {
+        MarkFilled<TIndex>();
+        col->Reserve(start_row_ + num_records_);
+      }
+      return col;
+    }
+
+    template <typename TValue>
+    void AppendString(const TValue& val, size_t max_string_bytes,
+                      types::StringColumnWrapper* col) const {
+      std::string_view str(val);
+      if (str.size() > max_string_bytes) {
+        std::string truncated(str.substr(0, max_string_bytes));
+        truncated.append(kTruncatedMsg);
+        col->Append(truncated);
+        return;
+      }
+      col->Append(str);
+    }
+
+    template <typename TDataType, typename TValue>
+    void Store(TValue&& val, size_t max_string_bytes, TDataType* out) const {
+      if constexpr (std::is_same_v<TDataType, types::StringValue>) {
+        std::string_view str(val);
+        if (str.size() > max_string_bytes) {
+          out->assign(str.data(), max_string_bytes);
+          out->append(kTruncatedMsg);
+          return;
+        }
+        out->assign(str.data(), str.size());
+      } else {
+        *out = TDataType(std::forward<TValue>(val));
+      }
     }
 
     Tablet& tablet_;
     std::bitset<schema->elements().size()> signature_;
     types::TabletIDView tablet_id_ = "";
+    size_t num_records_ = 0;
+    size_t start_row_ = 0;
   };
 
   // DynamicRecordBuilder is used to build records into the DataTable.
@@ -247,7 +512,7 @@ class DataTable : public NotCopyable {
    private:
     void Init(uint64_t time) {
       DCHECK_EQ(schema_.elements().size(), tablet_.records.size());
-      tablet_.times.push_back(time);
+      tablet_.AppendTime(time);
       LOG_IF(DFATAL, schema_.elements().size() > kMaxSupportedColumns) << absl::Substitute(
           "Tables with more than $0 columns are not supported.", kMaxSupportedColumns);
     }
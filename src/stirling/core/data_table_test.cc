@@ -314,6 +314,113 @@ TEST_F(DataTableTest, Carryover) {
   }
 }
 
+// Same as above, but with records appended in time order, which ConsumeRecords() handles without
+// sorting.
+TEST_F(DataTableTest, InOrderCarryover) {
+  auto append = [this](int time, int x, std::string s) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), time);
+    r.Append<r.ColIndex("time_")>(time);
+    r.Append<r.ColIndex("x")>(x);
+    r.Append<r.ColIndex("s")>(std::move(s));
+  };
+
+  // Times 30 and 40 are held back by the cutoff.
+  {
+    append(0, 0, "a");
+    append(10, 1, "b");
+    append(20, 2, "c");
+    append(30, 3, "d");
+    append(40, 4, "e");
+
+    data_table_->SetConsumeRecordsCutoffTime(20);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 3);
+    ASSERT_EQ(rb[2]->Size(), 3);
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 0);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(1), 1);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(2), "c");
+  }
+
+  // The carried over records come out before the new ones. Time 15 arrives too late.
+  {
+    append(15, 5, "f");
+    append(50, 6, "g");
+
+    data_table_->SetConsumeRecordsCutoffTime(100);
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 3);
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(0), 30);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(0), "d");
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(1), 40);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(1), "e");
+    EXPECT_EQ(rb[0]->Get<types::Time64NSValue>(2), 50);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(2), 6);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(2), "g");
+  }
+
+  // Records that all arrive in order and before the cutoff are all pushed.
+  {
+    append(60, 7, "h");
+    append(60, 8, "i");
+    append(70, 9, "j");
+
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 3);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 7);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(1), 8);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(2), "j");
+  }
+
+  EXPECT_TRUE(data_table_->ConsumeRecords().empty());
+}
+
+// Large in-order batches are handed out without copying the columns.
+TEST_F(DataTableTest, InOrderLargeBatch) {
+  constexpr int kNumRecords = 1000;
+  for (int i = 0; i < kNumRecords; ++i) {
+    DataTable::RecordBuilder<&kSchema> r(data_table_.get(), i);
+    r.Append<r.ColIndex("time_")>(i);
+    r.Append<r.ColIndex("x")>(i);
+    r.Append<r.ColIndex("s")>(std::to_string(i));
+  }
+
+  data_table_->SetConsumeRecordsCutoffTime(899);
+  {
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 900);
+    ASSERT_EQ(rb[2]->Size(), 900);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 0);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(899), 899);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(899), "899");
+  }
+
+  data_table_->SetConsumeRecordsCutoffTime(kNumRecords);
+  {
+    std::vector<TaggedRecordBatch> tablets = data_table_->ConsumeRecords();
+    ASSERT_EQ(tablets.size(), 1);
+    types::ColumnWrapperRecordBatch& rb = tablets[0].records;
+
+    ASSERT_EQ(rb[0]->Size(), 100);
+    EXPECT_EQ(rb[1]->Get<types::Int64Value>(0), 900);
+    EXPECT_EQ(rb[2]->Get<types::StringValue>(99), "999");
+  }
+}
+
 class DataTableStressTest : public ::testing::Test {
  private:
   std::default_random_engine rng_;
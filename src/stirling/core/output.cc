@@ -79,8 +79,7 @@ std::string ToString(const stirlingpb::TableSchema& schema,
         absl::StrAppend(&out, val);
       } break;
       case DataType::STRING: {
-        const auto& val = col->Get<StringValue>(index);
-        absl::StrAppend(&out, val);
+        absl::StrAppend(&out, col->GetView(index));
       } break;
       case DataType::UINT128: {
         const auto& val = col->Get<UInt128Value>(index);
@@ -103,6 +103,152 @@ TEST(RecordBuilder, UnfilledColNames) {
   EXPECT_THAT(r.UnfilledColNames(), IsEmpty());
 }
 
+TEST(ColumnarRecordBuilder, AppendColumns) {
+  DataTable data_table(/*id*/ 0, kTableSchema);
+
+  struct Record {
+    int64_t a;
+    std::string b;
+  };
+  std::vector<Record> records = {{1, "foo"}, {2, "bar"}, {3, "baz"}};
+  std::vector<uint64_t> times = {10, 20, 30};
+
+  {
+    DataTable::ColumnarRecordBuilder<&kTableSchema> r(&data_table, times);
+    r.AppendColumn<r.ColIndex("a")>(records, [](const Record& rec) { return rec.a; });
+    r.AppendColumn<r.ColIndex("b")>(
+        records, [](const Record& rec) -> const std::string& { return rec.b; });
+    r.FillColumn<r.ColIndex("c")>("const");
+  }
+  {
+    // Batches can be mixed with records appended one at a time.
+    DataTable::RecordBuilder<&kTableSchema> r(&data_table, 40);
+    r.Append<r.ColIndex("a")>(4);
+    r.Append<r.ColIndex("b")>("qux");
+    r.Append<r.ColIndex("c")>("single");
+  }
+
+  std::vector<TaggedRecordBatch> tablets = data_table.ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  types::ColumnWrapperRecordBatch& record_batch = tablets[0].records;
+
+  ASSERT_THAT(record_batch, RecordBatchSizeIs(4));
+  EXPECT_EQ(record_batch[0]->Get<types::Int64Value>(0), 1);
+  EXPECT_EQ(record_batch[0]->Get<types::Int64Value>(2), 3);
+  EXPECT_EQ(record_batch[0]->Get<types::Int64Value>(3), 4);
+  EXPECT_EQ(record_batch[1]->Get<types::StringValue>(1), "bar");
+  EXPECT_EQ(record_batch[1]->Get<types::StringValue>(3), "qux");
+  EXPECT_EQ(record_batch[2]->Get<types::StringValue>(0), "const");
+  EXPECT_EQ(record_batch[2]->Get<types::StringValue>(2), "const");
+  EXPECT_EQ(record_batch[2]->Get<types::StringValue>(3), "single");
+}
+
+TEST(ColumnarRecordBuilder, SharedTime) {
+  DataTable data_table(/*id*/ 0, kTableSchema);
+
+  std::vector<int64_t> a_vals = {1, 2};
+  std::vector<std::string_view> b_vals = {"foo", "bar"};
+
+  {
+    DataTable::ColumnarRecordBuilder<&kTableSchema> r(&data_table, a_vals.size(), /*time*/ 10);
+    r.AppendColumn<r.ColIndex("a")>(a_vals);
+    r.AppendColumn<r.ColIndex("b")>(b_vals);
+    r.AppendColumn<r.ColIndex("c")>(b_vals);
+  }
+
+  std::vector<TaggedRecordBatch> tablets = data_table.ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  types::ColumnWrapperRecordBatch& record_batch = tablets[0].records;
+
+  ASSERT_THAT(record_batch, RecordBatchSizeIs(2));
+  EXPECT_EQ(record_batch[0]->Get<types::Int64Value>(1), 2);
+  EXPECT_EQ(record_batch[2]->Get<types::StringValue>(0), "foo");
+}
+
+TEST(ColumnarRecordBuilder, StringMaxSize) {
+  DataTable data_table(/*id*/ 0, kTableSchema);
+
+  constexpr size_t kMaxStringBytes = 512;
+
+  std::string kLargeString(kMaxStringBytes + 100, 'c');
+  std::string kExpectedString(kMaxStringBytes, 'c');
+
+  {
+    DataTable::ColumnarRecordBuilder<&kTableSchema> r(&data_table, /*num_records*/ 2, /*time*/ 0);
+    r.AppendColumn<r.ColIndex("a")>(std::vector<int64_t>{1, 2});
+    r.AppendColumn<r.ColIndex("b")>(std::vector<std::string>{"foo", kLargeString},
+                                    kMaxStringBytes);
+    r.FillColumn<r.ColIndex("c")>(kLargeString, kMaxStringBytes);
+  }
+
+  std::vector<TaggedRecordBatch> tablets = data_table.ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  types::ColumnWrapperRecordBatch& record_batch = tablets[0].records;
+
+  ASSERT_THAT(record_batch, RecordBatchSizeIs(2));
+  EXPECT_EQ(record_batch[1]->Get<types::StringValue>(0), "foo");
+  EXPECT_THAT(record_batch[1]->Get<types::StringValue>(1), StartsWith(kExpectedString));
+  EXPECT_THAT(record_batch[1]->Get<types::StringValue>(1), EndsWith("[TRUNCATED]"));
+  EXPECT_THAT(record_batch[2]->Get<types::StringValue>(1), EndsWith("[TRUNCATED]"));
+}
+
+TEST(ColumnarRecordBuilder, MissingColumn) {
+  DataTable data_table(/*id*/ 0, kTableSchema);
+
+  auto r_ptr = std::make_unique<DataTable::ColumnarRecordBuilder<&kTableSchema>>(
+      &data_table, /*num_records*/ 1, /*time*/ 0);
+  r_ptr->FillColumn<0>(types::Int64Value(1));
+  r_ptr->FillColumn<2>(types::StringValue("bar"));
+  EXPECT_DEBUG_DEATH(r_ptr.reset(), "");
+
+  // See RecordBuilder.MissingColumn.
+#if DCHECK_IS_ON()
+  r_ptr->FillColumn<1>(types::StringValue("foo"));
+#endif
+}
+
+TEST(ColumnarRecordBuilder, WrongNumberOfValues) {
+  DataTable data_table(/*id*/ 0, kTableSchema);
+
+  DataTable::ColumnarRecordBuilder<&kTableSchema> r(&data_table, /*num_records*/ 2, /*time*/ 0);
+  EXPECT_DEBUG_DEATH(r.AppendColumn<r.ColIndex("a")>(std::vector<int64_t>{1, 2, 3}), "");
+  r.FillColumn<r.ColIndex("a")>(1);
+  r.FillColumn<r.ColIndex("b")>("foo");
+  r.FillColumn<r.ColIndex("c")>("bar");
+}
+
+TEST(ColumnarRecordBuilder, ContiguousStringColumns) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_contiguous_string_columns, true);
+  DataTable data_table(/*id*/ 0, kTableSchema);
+
+  std::string kLargeString(2000, 'c');
+
+  {
+    DataTable::ColumnarRecordBuilder<&kTableSchema> r(&data_table, /*num_records*/ 2, /*time*/ 0);
+    r.AppendColumn<r.ColIndex("a")>(std::vector<int64_t>{1, 2});
+    r.AppendColumn<r.ColIndex("b")>(std::vector<std::string>{"foo", kLargeString});
+    r.FillColumn<r.ColIndex("c")>("const");
+  }
+  {
+    DataTable::RecordBuilder<&kTableSchema> r(&data_table, 1);
+    r.Append<r.ColIndex("a")>(3);
+    r.Append<r.ColIndex("b")>("bar");
+    r.Append<r.ColIndex("c")>("single");
+  }
+
+  std::vector<TaggedRecordBatch> tablets = data_table.ConsumeRecords();
+  ASSERT_EQ(tablets.size(), 1);
+  types::ColumnWrapperRecordBatch& record_batch = tablets[0].records;
+
+  ASSERT_THAT(record_batch, RecordBatchSizeIs(3));
+  ASSERT_NE(record_batch[1]->AsStringColumn(), nullptr);
+  EXPECT_EQ(record_batch[1]->GetView(0), "foo");
+  EXPECT_THAT(std::string(record_batch[1]->GetView(1)), EndsWith("[TRUNCATED]"));
+  EXPECT_EQ(record_batch[1]->GetView(2), "bar");
+  EXPECT_EQ(record_batch[2]->GetView(1), "const");
+  EXPECT_EQ(record_batch[2]->GetView(2), "single");
+}
+
 TEST(DynamicRecordBuilder, StringMaxSize) {
   DataTable data_table(/*id*/ 0, kTableSchema);
 
@@ -25,6 +25,8 @@
 
 #include <absl/container/flat_hash_set.h>
 #include <algorithm>
+#include <tuple>
+#include <utility>
 
 #include <llvm/DebugInfo/DIContext.h>
 #include <llvm/Object/ObjectFile.h>
@@ -33,6 +35,7 @@
 #include "src/stirling/obj_tools/abi_model.h"
 #include "src/stirling/obj_tools/dwarf_utils.h"
 #include "src/stirling/obj_tools/init.h"
+#include "src/stirling/obj_tools/utils.h"
 
 namespace px {
 namespace stirling {
@@ -186,70 +189,124 @@ Status DwarfReader::DetectSourceLanguage() {
       "any compilation unit.");
 }
 
-void DwarfReader::IndexDIEs(
-    const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt) {
-  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
+namespace {
 
-  // Map from DW_AT_specification to DIE. Only DW_TAG_subprogram can have this attribute.
-  // Also only applies to CPP binaries.
-  absl::flat_hash_map<uint64_t, DWARFDie> fn_spec_offsets;
+// Compile units are indexed by multiple threads, each taking a shard of at least this many units.
+constexpr size_t kMinUnitsPerShard = 16;
 
-  DWARFContext::unit_iterator_range units = dwarf_context_->normal_units();
-  for (const std::unique_ptr<llvm::DWARFUnit>& unit : units) {
-    for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
-      DWARFDie die = {unit.get(), &entry};
+// The index entries of one compile unit, in DIE order.
+struct UnitIndexEntries {
+  std::vector<std::tuple<std::string, llvm::dwarf::Tag, DWARFDie>> dies;
 
-      if (die.isSubprogramDIE()) {
-        auto spec_or =
-            AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
-                              "Could not find attribute DW_AT_specification");
-        if (spec_or.ok()) {
-          fn_spec_offsets[spec_or.ValueOrDie()] = die;
-        }
-      }
+  // DW_AT_specification offset and the DW_TAG_subprogram DIE that has it.
+  std::vector<std::pair<uint64_t, DWARFDie>> fn_specs;
+};
 
-      // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
-      // index the function DIE. That removes the need of using manually-assembled names (through
-      // parent DIE).
+void IndexUnitDIEs(
+    llvm::DWARFUnit* unit,
+    const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt,
+    UnitIndexEntries* unit_entries) {
+  // A DIE's short name may be inherited, through DW_AT_specification or DW_AT_abstract_origin,
+  // from a DIE in another unit; those DIEs were extracted by the first pass of IndexDIEs().
+  // Parents, on the other hand, are always in the same unit as their children, so the qualified
+  // names can be assembled per unit.
+  absl::flat_hash_map<const llvm::DWARFDebugInfoEntry*, std::string> dwarf_entry_names;
 
-      auto name = std::string(GetShortName(die));
+  for (const llvm::DWARFDebugInfoEntry& entry : unit->dies()) {
+    DWARFDie die = {unit, &entry};
 
-      if (name.empty()) {
-        continue;
+    // Only DW_TAG_subprogram can have this attribute. Also only applies to CPP binaries.
+    if (die.isSubprogramDIE()) {
+      auto spec_or =
+          AdaptLLVMOptional(llvm::dwarf::toReference(die.find(llvm::dwarf::DW_AT_specification)),
+                            "Could not find attribute DW_AT_specification");
+      if (spec_or.ok()) {
+        unit_entries->fn_specs.emplace_back(spec_or.ValueOrDie(), die);
       }
+    }
 
-      // Only check matching if patterns are provided.
-      if (symbol_search_patterns_opt.has_value() &&
-          !MatchesSymbolAny(name, symbol_search_patterns_opt.value())) {
-        continue;
-      }
+    // TODO(oazizi/yzhao): Change to use the demangled name of DW_AT_linkage_name as the key to
+    // index the function DIE. That removes the need of using manually-assembled names (through
+    // parent DIE).
 
-      llvm::dwarf::Tag tag = die.getTag();
+    auto name = std::string(GetShortName(die));
 
-      if (IsIndexedType(tag) ||
-          // Namespace entry is processed here so that the name components can be generated.
-          IsNamespace(tag)) {
-        llvm::DWARFDie parent_die = die.getParent();
+    if (name.empty()) {
+      continue;
+    }
+
+    // Only check matching if patterns are provided.
+    if (symbol_search_patterns_opt.has_value() &&
+        !MatchesSymbolAny(name, symbol_search_patterns_opt.value())) {
+      continue;
+    }
 
-        if (parent_die.isValid()) {
-          const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
+    llvm::dwarf::Tag tag = die.getTag();
 
-          if (entry != nullptr) {
-            auto iter = dwarf_entry_names.find(entry);
-            if (iter != dwarf_entry_names.end()) {
-              std::string_view parent_name = iter->second;
-              name = absl::StrCat(parent_name, "::", name);
-            }
+    if (IsIndexedType(tag) ||
+        // Namespace entry is processed here so that the name components can be generated.
+        IsNamespace(tag)) {
+      llvm::DWARFDie parent_die = die.getParent();
+
+      if (parent_die.isValid()) {
+        const llvm::DWARFDebugInfoEntry* entry = parent_die.getDebugInfoEntry();
+
+        if (entry != nullptr) {
+          auto iter = dwarf_entry_names.find(entry);
+          if (iter != dwarf_entry_names.end()) {
+            std::string_view parent_name = iter->second;
+            name = absl::StrCat(parent_name, "::", name);
           }
-          dwarf_entry_names[die.getDebugInfoEntry()] = name;
         }
+        dwarf_entry_names[die.getDebugInfoEntry()] = name;
+      }
 
-        if (IsIndexedType(tag)) {
-          InsertToDIEMap(std::move(name), tag, die);
-        }
+      if (IsIndexedType(tag)) {
+        unit_entries->dies.emplace_back(std::move(name), tag, die);
       }
     }
   }
+}
+
+}  // namespace
+
+void DwarfReader::IndexDIEs(
+    const std::optional<std::vector<SymbolSearchPattern>>& symbol_search_patterns_opt) {
+  std::vector<llvm::DWARFUnit*> units;
+  for (const std::unique_ptr<llvm::DWARFUnit>& unit : dwarf_context_->normal_units()) {
+    // Parsing the unit DIE also parses the unit's abbreviations, which live in a table that is
+    // shared by all units and is not thread-safe. So do it before going multi-threaded.
+    unit->getUnitDIE(/*ExtractUnitDIEOnly*/ true);
+    units.push_back(unit.get());
+  }
+
+  // Large binaries have thousands of compile units, which are indexed in parallel, in two passes.
+  // The first pass extracts the DIEs of each unit. The second pass collects the index entries. It
+  // only reads DIEs, including those of other units that short names are inherited from, so all
+  // units must be extracted before it starts.
+  const size_t num_shards = NumShards(units.size(), kMinUnitsPerShard);
+  RunSharded(units.size(), num_shards, [&units](size_t /*shard*/, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      units[i]->dies();
+    }
+  });
+  std::vector<UnitIndexEntries> unit_entries(units.size());
+  RunSharded(units.size(), num_shards, [&](size_t /*shard*/, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      IndexUnitDIEs(units[i], symbol_search_patterns_opt, &unit_entries[i]);
+    }
+  });
+
+  // Merge in unit order, so that the index does not depend on the number of threads.
+  absl::flat_hash_map<uint64_t, DWARFDie> fn_spec_offsets;
+  for (UnitIndexEntries& entries : unit_entries) {
+    for (const auto& [offset, die] : entries.fn_specs) {
+      fn_spec_offsets[offset] = die;
+    }
+    for (auto& [name, tag, die] : entries.dies) {
+      InsertToDIEMap(std::move(name), tag, die);
+    }
+  }
 
   auto& fn_dies = die_map_[llvm::dwarf::DW_TAG_subprogram];
 
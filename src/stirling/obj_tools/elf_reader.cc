@@ -24,8 +24,11 @@
 #include <llvm/Support/TargetSelect.h>
 
 #include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_cat.h>
 #include <set>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "src/common/base/byte_utils.h"
 #include "src/common/base/utils.h"
@@ -44,8 +47,107 @@ struct LowercaseHex {
   static inline constexpr int kSizePerByte = 2;
   static inline constexpr bool kKeepPrintableChars = false;
 };
+
+constexpr std::string_view kGNUBuildIDSection = ".note.gnu.build-id";
+constexpr std::string_view kGoBuildIDSection = ".note.go.buildid";
+
+// Returns the "desc" field of the (first) note in an ELF note section.
+std::string_view NoteDesc(ELFIO::section* psec) {
+  // Structure of a note section:
+  //    namesz :   32-bit, size of "name" field
+  //    descsz :   32-bit, size of "desc" field
+  //    type   :   32-bit, vendor specific "type"
+  //    name   :   "namesz" bytes, null-terminated string
+  //    desc   :   "descsz" bytes, binary data
+  constexpr size_t kHeaderSize = 3 * sizeof(int32_t);
+  if (psec->get_data() == nullptr || psec->get_size() < kHeaderSize) {
+    return {};
+  }
+  int32_t name_size =
+      utils::LEndianBytesToInt<int32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
+  int32_t desc_size = utils::LEndianBytesToInt<int32_t>(
+      std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
+
+  if (name_size < 0 || desc_size < 0) {
+    return {};
+  }
+
+  // The name is padded to a 4-byte boundary. GNU build-id notes have a 4-byte name ("GNU\0"),
+  // so the padding only matters for other notes, like the Go build ID ("Go\0\0").
+  const size_t desc_pos = kHeaderSize + SnapUpToMultiple<int32_t>(name_size, 4);
+  if (desc_pos + desc_size > psec->get_size()) {
+    return {};
+  }
+  return std::string_view(psec->get_data() + desc_pos, desc_size);
+}
+
+// The symbol tables of large binaries are scanned by multiple threads, each taking a shard of at
+// least this many symbols.
+constexpr size_t kMinSymbolsPerShard = 64 * 1024;
+
+struct ElfSymbol {
+  std::string name;
+  ELFIO::Elf64_Addr addr = 0;
+  ELFIO::Elf_Xword size = 0;
+  unsigned char bind = 0;
+  unsigned char type = ELFIO::STT_NOTYPE;
+  ELFIO::Elf_Half section_index;
+  unsigned char other;
+};
+
+// Calls fn(symbol, &output) on the symbols of the symbol table, where output is the output of the
+// shard that the symbol belongs to. A shard stops early if fn returns false.
+// Shards are contiguous, so concatenating their outputs preserves the symbol table order.
+template <typename TShardOutput, typename TFn>
+std::vector<TShardOutput> ScanSymbols(ELFIO::elfio* elf, ELFIO::section* symtab_section, TFn fn) {
+  // Section data may be loaded lazily, so load it before the section is shared across threads.
+  symtab_section->get_data();
+  if (symtab_section->get_link() < elf->sections.size()) {
+    elf->sections[symtab_section->get_link()]->get_data();
+  }
+
+  const ELFIO::symbol_section_accessor symbols(*elf, symtab_section);
+  const size_t num_symbols = symbols.get_symbols_num();
+
+  std::vector<TShardOutput> outputs(NumShards(num_symbols, kMinSymbolsPerShard));
+  RunSharded(num_symbols, outputs.size(), [&](size_t shard, size_t begin, size_t end) {
+    for (size_t j = begin; j < end; ++j) {
+      ElfSymbol symbol;
+      symbols.get_symbol(j, symbol.name, symbol.addr, symbol.size, symbol.bind, symbol.type,
+                         symbol.section_index, symbol.other);
+      if (!fn(std::move(symbol), &outputs[shard])) {
+        break;
+      }
+    }
+  });
+  return outputs;
+}
+
 }  // namespace
 
+StatusOr<std::string> ElfReader::BuildID() {
+  StatusOr<ELFIO::section*> gnu_section = SectionWithName(kGNUBuildIDSection);
+  if (gnu_section.ok()) {
+    std::string_view desc = NoteDesc(gnu_section.ValueOrDie());
+    if (!desc.empty()) {
+      return BytesToString<LowercaseHex>(desc);
+    }
+  }
+
+  // Go binaries that are not linked with an external linker have no GNU build-id,
+  // but carry their own build ID, which is a printable string.
+  StatusOr<ELFIO::section*> go_section = SectionWithName(kGoBuildIDSection);
+  if (go_section.ok()) {
+    std::string_view desc = NoteDesc(go_section.ValueOrDie());
+    desc = desc.substr(0, desc.find('\0'));
+    if (!desc.empty()) {
+      return absl::StrCat("go:", desc);
+    }
+  }
+
+  return error::NotFound("Binary $0 has no build-id.", binary_path_);
+}
+
 Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir) {
   std::string build_id;
   std::string debug_link;
@@ -65,22 +167,8 @@ Status ElfReader::LocateDebugSymbols(const std::filesystem::path& debug_file_dir
     // For more details: https://sourceware.org/gdb/onlinedocs/gdb/Separate-Debug-Files.html
 
     // Method 1: build-id.
-    if (psec->get_name() == ".note.gnu.build-id") {
-      // Structure of this section:
-      //    namesz :   32-bit, size of "name" field
-      //    descsz :   32-bit, size of "desc" field
-      //    type   :   32-bit, vendor specific "type"
-      //    name   :   "namesz" bytes, null-terminated string
-      //    desc   :   "descsz" bytes, binary data
-      int32_t name_size =
-          utils::LEndianBytesToInt<int32_t>(std::string_view(psec->get_data(), sizeof(int32_t)));
-      int32_t desc_size = utils::LEndianBytesToInt<int32_t>(
-          std::string_view(psec->get_data() + sizeof(int32_t), sizeof(int32_t)));
-
-      int32_t desc_pos = 3 * sizeof(int32_t) + name_size;
-      std::string_view desc = std::string_view(psec->get_data() + desc_pos, desc_size);
-
-      build_id = BytesToString<LowercaseHex>(desc);
+    if (psec->get_name() == kGNUBuildIDSection) {
+      build_id = BytesToString<LowercaseHex>(NoteDesc(psec));
       VLOG(1) << absl::Substitute("Found build-id: $0", build_id);
     }
 
@@ -250,32 +338,29 @@ StatusOr<std::vector<ElfReader::SymbolInfo>> ElfReader::SearchSymbols(
     bool stop_at_first_match) {
   PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
 
-  std::vector<SymbolInfo> symbol_infos;
-
-  // Scan all symbols inside the symbol table.
-  const ELFIO::symbol_section_accessor symbols(elf_reader_, symtab_section);
-  for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-    std::string name;
-    ELFIO::Elf64_Addr addr = 0;
-    ELFIO::Elf_Xword size = 0;
-    unsigned char bind = 0;
-    unsigned char type = ELFIO::STT_NOTYPE;
-    ELFIO::Elf_Half section_index;
-    unsigned char other;
-    symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
-
-    if (symbol_type.has_value() && type != symbol_type.value()) {
-      continue;
-    }
+  // Scan all symbols inside the symbol table. With stop_at_first_match, each shard stops at its
+  // first match, and the match of the earliest shard is the first match overall.
+  std::vector<std::vector<SymbolInfo>> shard_symbol_infos = ScanSymbols<std::vector<SymbolInfo>>(
+      &elf_reader_, symtab_section, [&](ElfSymbol symbol, std::vector<SymbolInfo>* symbol_infos) {
+        if (symbol_type.has_value() && symbol.type != symbol_type.value()) {
+          return true;
+        }
 
-    if (!MatchesSymbol(name, {match_type, search_symbol})) {
-      continue;
-    }
+        if (!MatchesSymbol(symbol.name, {match_type, search_symbol})) {
+          return true;
+        }
 
-    symbol_infos.push_back({std::move(name), type, addr, size});
+        symbol_infos->push_back({std::move(symbol.name), symbol.type, symbol.addr, symbol.size});
+        return !stop_at_first_match;
+      });
 
-    if (stop_at_first_match) {
-      break;
+  std::vector<SymbolInfo> symbol_infos;
+  for (auto& shard : shard_symbol_infos) {
+    for (auto& symbol_info : shard) {
+      symbol_infos.push_back(std::move(symbol_info));
+      if (stop_at_first_match) {
+        return symbol_infos;
+      }
     }
   }
   return symbol_infos;
@@ -378,50 +463,36 @@ StatusOr<std::optional<std::string>> ElfReader::InstrAddrToSymbol(size_t sym_add
 StatusOr<std::unique_ptr<ElfReader::Symbolizer>> ElfReader::GetSymbolizer() {
   PX_ASSIGN_OR_RETURN(ELFIO::section * symtab_section, SymtabSection());
 
-  auto symbolizer = std::make_unique<ElfReader::Symbolizer>();
-
-  const ELFIO::symbol_section_accessor symbols(elf_reader_, symtab_section);
-  for (unsigned int j = 0; j < symbols.get_symbols_num(); ++j) {
-    // Call ELFIO to get symbol by index.
-    // ELFIO looks up the index and then populates name, addr, size, type, etc.
-    // We only care about the name and addr, but need to declare the other variables as well.
+  // Demangling dominates the cost, so it is done by the shards.
+  struct FuncSymbol {
+    uint64_t addr;
+    uint64_t size;
     std::string name;
-    ELFIO::Elf64_Addr addr = 0;
-    ELFIO::Elf_Xword size = 0;
-    unsigned char bind = 0;
-    unsigned char type = ELFIO::STT_NOTYPE;
-    ELFIO::Elf_Half section_index;
-    unsigned char other;
-    symbols.get_symbol(j, name, addr, size, bind, type, section_index, other);
-
-    if (type == ELFIO::STT_FUNC) {
-      symbolizer->AddEntry(addr, size, llvm::demangle(name));
+  };
+  std::vector<std::vector<FuncSymbol>> shard_func_symbols = ScanSymbols<std::vector<FuncSymbol>>(
+      &elf_reader_, symtab_section, [](ElfSymbol symbol, std::vector<FuncSymbol>* func_symbols) {
+        if (symbol.type == ELFIO::STT_FUNC) {
+          func_symbols->push_back({symbol.addr, symbol.size, llvm::demangle(symbol.name)});
+        }
+        return true;
+      });
+
+  SymbolIndex::Builder builder;
+  for (const auto& func_symbols : shard_func_symbols) {
+    for (const auto& func_symbol : func_symbols) {
+      builder.AddEntry(func_symbol.addr, func_symbol.size, func_symbol.name);
     }
   }
 
-  return symbolizer;
+  return std::make_unique<ElfReader::Symbolizer>(builder.Build());
 }
 
-void ElfReader::Symbolizer::AddEntry(size_t addr, size_t size, std::string name) {
-  symbols_.emplace(addr, SymbolAddrInfo{size, std::move(name)});
-}
-
-std::string_view ElfReader::Symbolizer::Lookup(size_t addr) const {
+std::string_view ElfReader::Symbolizer::Lookup(uintptr_t addr) const {
   static std::string symbol_str;
 
-  // Find the first symbol for which the address_range_start > addr.
-  auto iter = symbols_.upper_bound(addr);
-
-  if (iter == symbols_.begin() || symbols_.empty()) {
-    symbol_str = absl::StrFormat("0x%016llx", addr);
-    return symbol_str;
-  }
-
-  // std::upper_bound will make us overshoot our potential match,
-  // so go back by one, and check if it is indeed a match.
-  --iter;
-  if (addr >= iter->first && addr < iter->first + iter->second.size) {
-    return iter->second.name;
+  std::optional<SymbolIndex::Symbol> symbol = index_->Lookup(addr);
+  if (symbol.has_value()) {
+    return symbol->name;
   }
 
   // Couldn't find the address.
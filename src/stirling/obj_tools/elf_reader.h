@@ -21,14 +21,15 @@
 #include <filesystem>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include <absl/container/btree_map.h>
 #include <absl/container/flat_hash_map.h>
 
 #include <elfio/elfio.hpp>
 
 #include "src/common/base/base.h"
+#include "src/stirling/obj_tools/symbol_index.h"
 #include "src/stirling/obj_tools/utils.h"
 
 namespace px {
@@ -125,27 +126,23 @@ class ElfReader {
 
   class Symbolizer {
    public:
-    /**
-     * Associate the address range [addr, addr+size] with the provided symbol name.
-     * No checking is performed for overlapping regions, which will result in undefined behavior.
-     */
-    void AddEntry(uintptr_t addr, size_t size, std::string name);
+    explicit Symbolizer(std::unique_ptr<SymbolIndex> index) : index_(std::move(index)) {}
 
     /**
      * Lookup the symbol for the specified address.
      */
     std::string_view Lookup(uintptr_t addr) const;
 
-   private:
-    struct SymbolAddrInfo {
-      size_t size;
-      std::string name;
-    };
+    const SymbolIndex& index() const { return *index_; }
 
-    // Key is an address.
-    absl::btree_map<uintptr_t, SymbolAddrInfo> symbols_;
+   private:
+    std::unique_ptr<SymbolIndex> index_;
   };
 
+  /**
+   * Returns a symbolizer for the function symbols of the binary, with demangled names.
+   * The symbol table of large binaries is processed by multiple threads.
+   */
   StatusOr<std::unique_ptr<Symbolizer>> GetSymbolizer();
 
   /**
@@ -169,6 +166,12 @@ class ElfReader {
    */
   ELFIO::Elf_Half ELFType();
 
+  /**
+   * Returns an identifier of the binary's contents: the GNU build-id as a hex string if present,
+   * otherwise the Go build ID prefixed with "go:". Returns NotFound if the binary has neither.
+   */
+  StatusOr<std::string> BuildID();
+
  private:
   ElfReader() = default;
 
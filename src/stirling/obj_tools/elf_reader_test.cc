@@ -195,6 +195,20 @@ TEST(ElfReaderTest, ExternalDebugSymbolsBuildID) {
                      ElementsAre(SymbolNameIs("CanYouFindThis")));
 }
 
+TEST(ElfReaderTest, BuildID) {
+  const std::string stripped_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/stripped_test_exe");
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<ElfReader> elf_reader, ElfReader::Create(stripped_bin));
+  // Matches the debug symbols file in testdata/cc/usr/lib/debug/.build-id.
+  EXPECT_OK_AND_EQ(elf_reader->BuildID(), "7deb0e3f89deba61");
+
+  const std::string go_bin =
+      px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/go/test_go_1_19_binary");
+  ASSERT_OK_AND_ASSIGN(elf_reader, ElfReader::Create(go_bin));
+  ASSERT_OK_AND_ASSIGN(std::string go_build_id, elf_reader->BuildID());
+  EXPECT_FALSE(go_build_id.empty());
+}
+
 TEST(ElfReaderTest, ExternalDebugSymbolsDebugLink) {
   const std::string stripped_bin =
       px::testing::BazelRunfilePath("src/stirling/obj_tools/testdata/cc/test_exe_debuglink");
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/obj_tools/symbol_index.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+namespace {
+
+constexpr char kMagic[8] = {'P', 'X', 'S', 'Y', 'M', 'I', 'D', 'X'};
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t entry_size;
+  uint64_t num_entries;
+  uint64_t names_size;
+};
+static_assert(sizeof(FileHeader) % alignof(uint64_t) == 0);
+
+}  // namespace
+
+void SymbolIndex::Builder::AddEntry(uint64_t addr, uint64_t size, std::string_view name) {
+  auto [iter, inserted] = name_offsets_.try_emplace(name, names_.size());
+  if (inserted) {
+    DCHECK_LE(names_.size() + name.size(), std::numeric_limits<uint32_t>::max());
+    names_.append(name);
+  }
+  entries_.push_back(Entry{addr, size, iter->second, static_cast<uint32_t>(name.size())});
+}
+
+std::unique_ptr<SymbolIndex> SymbolIndex::Builder::Build() {
+  // Stable, so that the first of several entries at the same address stays first.
+  std::stable_sort(entries_.begin(), entries_.end(),
+                   [](const Entry& a, const Entry& b) { return a.addr < b.addr; });
+
+  auto index = std::unique_ptr<SymbolIndex>(new SymbolIndex());
+  index->owned_entries_ = std::move(entries_);
+  index->owned_names_ = std::move(names_);
+  index->entries_ = index->owned_entries_.data();
+  index->num_entries_ = index->owned_entries_.size();
+  index->names_ = index->owned_names_;
+
+  entries_.clear();
+  names_.clear();
+  name_offsets_.clear();
+  return index;
+}
+
+StatusOr<std::unique_ptr<SymbolIndex>> SymbolIndex::Open(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return error::Internal("Failed to open symbol index $0. errno $1.", path.string(), errno);
+  }
+  struct stat statbuf;
+  if (fstat(fd, &statbuf) == -1) {
+    close(fd);
+    return error::Internal("Failed to stat symbol index $0. errno $1.", path.string(), errno);
+  }
+  const size_t file_size = statbuf.st_size;
+  if (file_size < sizeof(FileHeader)) {
+    close(fd);
+    return error::Internal("Symbol index $0 is truncated.", path.string());
+  }
+  void* addr = mmap(/*addr*/ nullptr, file_size, PROT_READ, MAP_PRIVATE, fd, /*offset*/ 0);
+  // The mapping remains valid after the file descriptor is closed.
+  close(fd);
+  if (addr == MAP_FAILED) {
+    return error::Internal("Failed to map symbol index $0. errno $1.", path.string(), errno);
+  }
+
+  // From here on, the destructor unmaps the file.
+  auto index = std::unique_ptr<SymbolIndex>(new SymbolIndex());
+  index->mapped_addr_ = addr;
+  index->mapped_size_ = file_size;
+
+  const auto* header = static_cast<const FileHeader*>(addr);
+  if (std::memcmp(header->magic, kMagic, sizeof(kMagic)) != 0 || header->version != kVersion ||
+      header->entry_size != sizeof(Entry)) {
+    return error::Internal("Symbol index $0 has an unsupported format.", path.string());
+  }
+  const size_t max_entries = (file_size - sizeof(FileHeader)) / sizeof(Entry);
+  if (header->num_entries > max_entries ||
+      header->names_size !=
+          file_size - sizeof(FileHeader) - header->num_entries * sizeof(Entry)) {
+    return error::Internal("Symbol index $0 is truncated.", path.string());
+  }
+
+  const char* data = static_cast<const char*>(addr) + sizeof(FileHeader);
+  index->entries_ = reinterpret_cast<const Entry*>(data);
+  index->num_entries_ = header->num_entries;
+  index->names_ =
+      std::string_view(data + header->num_entries * sizeof(Entry), header->names_size);
+
+  // Lookups rely on these invariants, so a corrupt file must be rejected rather than trusted.
+  for (size_t i = 0; i < index->num_entries_; ++i) {
+    const Entry& e = index->entries_[i];
+    if (i > 0 && e.addr < index->entries_[i - 1].addr) {
+      return error::Internal("Symbol index $0 is not sorted.", path.string());
+    }
+    if (uint64_t{e.name_offset} + e.name_size > index->names_.size()) {
+      return error::Internal("Symbol index $0 has out-of-bounds names.", path.string());
+    }
+  }
+
+  return index;
+}
+
+SymbolIndex::~SymbolIndex() {
+  if (mapped_addr_ != nullptr) {
+    munmap(mapped_addr_, mapped_size_);
+  }
+}
+
+Status SymbolIndex::Save(const std::filesystem::path& path) const {
+  FileHeader header = {};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.entry_size = sizeof(Entry);
+  header.num_entries = num_entries_;
+  header.names_size = names_.size();
+
+  std::filesystem::path tmp_path = path;
+  tmp_path += ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries_), num_entries_ * sizeof(Entry));
+    out.write(names_.data(), names_.size());
+    if (!out) {
+      return error::Internal("Failed to write symbol index $0.", tmp_path.string());
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Failed to rename $0 to $1: $2", tmp_path.string(), path.string(),
+                           ec.message());
+  }
+  return Status::OK();
+}
+
+std::optional<SymbolIndex::Symbol> SymbolIndex::Lookup(uint64_t addr) const {
+  const Entry* begin = entries_;
+  const Entry* end = entries_ + num_entries_;
+
+  // Find the first entry that starts after addr; the candidate is the one before it.
+  const Entry* iter = std::upper_bound(begin, end, addr,
+                                       [](uint64_t a, const Entry& e) { return a < e.addr; });
+  if (iter == begin) {
+    return std::nullopt;
+  }
+  --iter;
+
+  // Of several entries at the same address, the first one added wins.
+  const uint64_t start = iter->addr;
+  iter = std::lower_bound(begin, iter, start,
+                          [](const Entry& e, uint64_t a) { return e.addr < a; });
+
+  if (addr - start >= iter->size) {
+    return std::nullopt;
+  }
+  return symbol(iter - begin);
+}
+
+SymbolIndex::Symbol SymbolIndex::symbol(size_t i) const {
+  DCHECK_LT(i, num_entries_);
+  const Entry& e = entries_[i];
+  return Symbol{e.addr, e.size, names_.substr(e.name_offset, e.name_size)};
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
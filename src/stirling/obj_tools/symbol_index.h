@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+/**
+ * A compact, immutable map from address ranges to symbol names.
+ *
+ * Entries are kept in a flat array sorted by address, and names are interned into a single
+ * string table, so an index costs 24 bytes per symbol plus one copy of each distinct name.
+ * The in-memory layout is also the file layout: an index can be saved once, and later opened
+ * with mmap() without parsing, by any number of processes.
+ */
+class SymbolIndex : public NotCopyMoveable {
+ public:
+  struct Symbol {
+    uint64_t addr;
+    uint64_t size;
+    std::string_view name;
+  };
+
+ private:
+  // Layout of an entry, both in memory and on disk.
+  struct Entry {
+    uint64_t addr;
+    uint64_t size;
+    uint32_t name_offset;
+    uint32_t name_size;
+  };
+  static_assert(sizeof(Entry) == 24);
+
+ public:
+  class Builder {
+   public:
+    /**
+     * Associates the address range [addr, addr+size) with the provided symbol name.
+     * If several entries start at the same address, lookups resolve to the first one added.
+     */
+    void AddEntry(uint64_t addr, uint64_t size, std::string_view name);
+
+    std::unique_ptr<SymbolIndex> Build();
+
+   private:
+    std::vector<Entry> entries_;
+    std::string names_;
+    // Offset into names_ of each distinct name.
+    absl::flat_hash_map<std::string, uint32_t> name_offsets_;
+  };
+
+  /**
+   * Maps an index previously written by Save(). The file must not be modified while it is open.
+   */
+  static StatusOr<std::unique_ptr<SymbolIndex>> Open(const std::filesystem::path& path);
+
+  ~SymbolIndex();
+
+  /**
+   * Writes the index to a file. The file is replaced atomically.
+   */
+  Status Save(const std::filesystem::path& path) const;
+
+  /**
+   * Returns the symbol whose address range contains addr, if any.
+   */
+  std::optional<Symbol> Lookup(uint64_t addr) const;
+
+  size_t size() const { return num_entries_; }
+  Symbol symbol(size_t i) const;
+
+ private:
+  SymbolIndex() = default;
+
+  // Storage for an index built in memory.
+  std::vector<Entry> owned_entries_;
+  std::string owned_names_;
+
+  // Storage for an index opened from a file.
+  void* mapped_addr_ = nullptr;
+  size_t mapped_size_ = 0;
+
+  // Views into one of the above.
+  const Entry* entries_ = nullptr;
+  size_t num_entries_ = 0;
+  std::string_view names_;
+};
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,117 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/obj_tools/symbol_index.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "src/common/base/file.h"
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace obj_tools {
+
+using ::px::testing::TempDir;
+
+std::string LookupName(const SymbolIndex& index, uint64_t addr) {
+  std::optional<SymbolIndex::Symbol> symbol = index.Lookup(addr);
+  return symbol.has_value() ? std::string(symbol->name) : "";
+}
+
+std::unique_ptr<SymbolIndex> BuildTestIndex() {
+  SymbolIndex::Builder builder;
+  // Added out of order on purpose.
+  builder.AddEntry(0x3000, 0x10, "baz");
+  builder.AddEntry(0x1000, 0x100, "foo");
+  builder.AddEntry(0x2000, 0x80, "bar");
+  builder.AddEntry(0x2000, 0x40, "bar_alias");
+  builder.AddEntry(0x4000, 0x20, "foo");
+  return builder.Build();
+}
+
+TEST(SymbolIndexTest, Lookup) {
+  std::unique_ptr<SymbolIndex> index = BuildTestIndex();
+  ASSERT_EQ(index->size(), 5);
+
+  EXPECT_EQ(LookupName(*index, 0x0fff), "");
+  EXPECT_EQ(LookupName(*index, 0x1000), "foo");
+  EXPECT_EQ(LookupName(*index, 0x10ff), "foo");
+  EXPECT_EQ(LookupName(*index, 0x1100), "");
+  // The first entry added at an address wins.
+  EXPECT_EQ(LookupName(*index, 0x2000), "bar");
+  EXPECT_EQ(LookupName(*index, 0x207f), "bar");
+  EXPECT_EQ(LookupName(*index, 0x3008), "baz");
+  EXPECT_EQ(LookupName(*index, 0x4010), "foo");
+  EXPECT_EQ(LookupName(*index, 0x4020), "");
+
+  // Entries are sorted by address.
+  EXPECT_EQ(index->symbol(0).addr, 0x1000);
+  EXPECT_EQ(index->symbol(4).addr, 0x4000);
+}
+
+TEST(SymbolIndexTest, SaveAndOpen) {
+  TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "index";
+
+  ASSERT_OK(BuildTestIndex()->Save(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<SymbolIndex> index, SymbolIndex::Open(path));
+
+  ASSERT_EQ(index->size(), 5);
+  EXPECT_EQ(LookupName(*index, 0x1080), "foo");
+  EXPECT_EQ(LookupName(*index, 0x2010), "bar");
+  EXPECT_EQ(LookupName(*index, 0x3008), "baz");
+  EXPECT_EQ(LookupName(*index, 0x4010), "foo");
+  EXPECT_EQ(LookupName(*index, 0x5000), "");
+}
+
+TEST(SymbolIndexTest, EmptyIndex) {
+  TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "index";
+
+  ASSERT_OK(SymbolIndex::Builder().Build()->Save(path));
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<SymbolIndex> index, SymbolIndex::Open(path));
+  EXPECT_EQ(index->size(), 0);
+  EXPECT_EQ(LookupName(*index, 0x1000), "");
+}
+
+TEST(SymbolIndexTest, RejectsCorruptFiles) {
+  TempDir tmp_dir;
+  const std::filesystem::path path = tmp_dir.path() / "index";
+  ASSERT_OK(BuildTestIndex()->Save(path));
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(path.string(), std::ios::binary));
+
+  // Truncated.
+  ASSERT_OK(WriteFileFromString(path.string(), contents.substr(0, contents.size() - 1),
+                                std::ios::binary));
+  EXPECT_NOT_OK(SymbolIndex::Open(path));
+
+  // Not an index.
+  ASSERT_OK(
+      WriteFileFromString(path.string(), std::string(contents.size(), 'x'), std::ios::binary));
+  EXPECT_NOT_OK(SymbolIndex::Open(path));
+
+  EXPECT_NOT_OK(SymbolIndex::Open(tmp_dir.path() / "missing"));
+}
+
+}  // namespace obj_tools
+}  // namespace stirling
+}  // namespace px
@@ -17,7 +17,22 @@
  */
 
 #include "src/stirling/obj_tools/utils.h"
+#include <absl/strings/ascii.h>
 #include <absl/strings/match.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_split.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+
+#include "src/common/base/base.h"
+
+DEFINE_uint32(stirling_obj_tools_max_threads,
+              gflags::Uint32FromEnv("PL_STIRLING_OBJ_TOOLS_MAX_THREADS", 4),
+              "The maximum number of threads used to index a single binary. The number of "
+              "threads is further limited by the CPU affinity mask and cgroup CPU quota.");
 
 namespace px {
 namespace stirling {
@@ -48,6 +63,82 @@ bool MatchesSymbolAny(std::string_view symbol_name,
   return false;
 }
 
+namespace {
+
+// Returns ceil(quota / period) for the cgroup CPU quota of this process, or 0 if there is none.
+size_t CgroupCPUQuota() {
+  // cgroup v2: "<quota> <period>", where quota is "max" if unlimited.
+  StatusOr<std::string> cpu_max = ReadFileToString("/sys/fs/cgroup/cpu.max");
+  if (cpu_max.ok()) {
+    std::vector<std::string_view> fields =
+        absl::StrSplit(absl::StripAsciiWhitespace(cpu_max.ValueOrDie()), ' ');
+    int64_t quota = 0;
+    int64_t period = 0;
+    if (fields.size() == 2 && absl::SimpleAtoi(fields[0], &quota) &&
+        absl::SimpleAtoi(fields[1], &period) && quota > 0 && period > 0) {
+      return (quota + period - 1) / period;
+    }
+    return 0;
+  }
+
+  // cgroup v1: the quota is -1 if unlimited.
+  StatusOr<std::string> quota_str = ReadFileToString("/sys/fs/cgroup/cpu/cpu.cfs_quota_us");
+  StatusOr<std::string> period_str = ReadFileToString("/sys/fs/cgroup/cpu/cpu.cfs_period_us");
+  int64_t quota = 0;
+  int64_t period = 0;
+  if (quota_str.ok() && period_str.ok() &&
+      absl::SimpleAtoi(absl::StripAsciiWhitespace(quota_str.ValueOrDie()), &quota) &&
+      absl::SimpleAtoi(absl::StripAsciiWhitespace(period_str.ValueOrDie()), &period) &&
+      quota > 0 && period > 0) {
+    return (quota + period - 1) / period;
+  }
+  return 0;
+}
+
+}  // namespace
+
+size_t AvailableCPUs() {
+  size_t num_cpus = std::max(1U, std::thread::hardware_concurrency());
+
+  cpu_set_t cpu_set;
+  CPU_ZERO(&cpu_set);
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+    num_cpus = std::min<size_t>(num_cpus, std::max(1, CPU_COUNT(&cpu_set)));
+  }
+
+  // The quota can't change while this process runs, so it's only read once.
+  static const size_t kCgroupCPUQuota = CgroupCPUQuota();
+  if (kCgroupCPUQuota > 0) {
+    num_cpus = std::min(num_cpus, kCgroupCPUQuota);
+  }
+  return num_cpus;
+}
+
+size_t NumShards(size_t n, size_t min_shard_size) {
+  const size_t max_shards =
+      std::clamp<size_t>(FLAGS_stirling_obj_tools_max_threads, 1, AvailableCPUs());
+  return std::clamp<size_t>(n / std::max<size_t>(min_shard_size, 1), 1, max_shards);
+}
+
+void RunSharded(size_t n, size_t num_shards,
+                const std::function<void(size_t shard, size_t begin, size_t end)>& fn) {
+  num_shards = std::max<size_t>(num_shards, 1);
+  const size_t shard_size = (n + num_shards - 1) / num_shards;
+
+  std::vector<std::thread> threads;
+  for (size_t shard = 1; shard < num_shards; ++shard) {
+    const size_t begin = std::min(n, shard * shard_size);
+    const size_t end = std::min(n, begin + shard_size);
+    threads.emplace_back(fn, shard, begin, end);
+  }
+  // The first shard runs on the calling thread.
+  fn(0, 0, std::min(n, shard_size));
+
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
 }  // namespace obj_tools
 }  // namespace stirling
 }  // namespace px
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string_view>
 #include <vector>
 
@@ -52,6 +53,21 @@ bool MatchesSymbol(std::string_view symbol_name, const SymbolSearchPattern& sear
 bool MatchesSymbolAny(std::string_view symbol_name,
                       const std::vector<SymbolSearchPattern>& search_patterns);
 
+// Returns the number of CPUs this process can run on, taking into account its CPU affinity mask
+// and its cgroup CPU quota.
+size_t AvailableCPUs();
+
+// Returns the number of shards in which to split n items of work, such that each shard has at
+// least min_shard_size items. There are no more shards than AvailableCPUs(), nor than
+// --stirling_obj_tools_max_threads.
+size_t NumShards(size_t n, size_t min_shard_size);
+
+// Splits [0, n) into num_shards contiguous ranges, and calls fn(shard, begin, end) for each of
+// them, each on its own thread. Returns once all calls have returned.
+// Used to parallelize indexing of large binaries.
+void RunSharded(size_t n, size_t num_shards,
+                const std::function<void(size_t shard, size_t begin, size_t end)>& fn);
+
 }  // namespace obj_tools
 }  // namespace stirling
 }  // namespace px
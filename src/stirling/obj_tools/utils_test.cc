@@ -18,8 +18,15 @@
 
 #include "src/stirling/obj_tools/utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "src/common/testing/testing.h"
 
+DECLARE_uint32(stirling_obj_tools_max_threads);
+
 namespace px {
 namespace stirling {
 namespace obj_tools {
@@ -46,6 +53,39 @@ TEST(MatchesSymbolAnyTest, AsExpected) {
                                           SymbolSearchPattern{SymbolMatchType::kSubstr, "test"}}));
 }
 
+TEST(RunShardedTest, CoversAllItemsOnce) {
+  for (size_t num_shards : {1, 3, 8, 20}) {
+    std::vector<std::atomic<int>> visits(17);
+    RunSharded(visits.size(), num_shards, [&](size_t shard, size_t begin, size_t end) {
+      EXPECT_LT(shard, num_shards);
+      EXPECT_LE(begin, end);
+      for (size_t i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+    for (const auto& v : visits) {
+      EXPECT_EQ(v, 1);
+    }
+  }
+}
+
+TEST(NumShardsTest, AsExpected) {
+  EXPECT_EQ(NumShards(0, 100), 1);
+  EXPECT_EQ(NumShards(150, 100), 1);
+  EXPECT_GE(NumShards(1000000, 100), 1);
+  EXPECT_LE(NumShards(1000000, 100), AvailableCPUs());
+}
+
+TEST(NumShardsTest, CappedByFlag) {
+  PX_SET_FOR_SCOPE(FLAGS_stirling_obj_tools_max_threads, 1);
+  EXPECT_EQ(NumShards(1000000, 100), 1);
+}
+
+TEST(AvailableCPUsTest, Bounds) {
+  EXPECT_GE(AvailableCPUs(), 1);
+  EXPECT_LE(AvailableCPUs(), std::max(1U, std::thread::hardware_concurrency()));
+}
+
 }  // namespace obj_tools
 }  // namespace stirling
 }  // namespace px
@@ -64,7 +64,7 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
     }
 
     ProcParser::NetworkStats stats;
-    auto s = GetNetworkStatsForPod(*proc_parser_, *pod_info, k8s_md, &stats);
+    auto s = GetNetworkStatsForPod(proc_stat_reader_.get(), *pod_info, k8s_md, &stats);
 
     if (!s.ok()) {
       VLOG(1) << absl::StrCat("Failed to get Pod network stats: ", s.msg());
@@ -84,9 +84,11 @@ void NetworkStatsConnector::TransferNetworkStatsTable(ConnectorContext* ctx,
     r.Append<r.ColIndex("tx_errors")>(stats.tx_errs);
     r.Append<r.ColIndex("tx_drops")>(stats.tx_drops);
   }
+
+  proc_stat_reader_->EndIteration();
 }
 
-Status NetworkStatsConnector::GetNetworkStatsForPod(const system::ProcParser& proc_parser,
+Status NetworkStatsConnector::GetNetworkStatsForPod(system::ProcStatReader* proc_stat_reader,
                                                     const md::PodInfo& pod_info,
                                                     const md::K8sMetadataState& k8s_metadata_state,
                                                     system::ProcParser::NetworkStats* stats) {
@@ -118,9 +120,12 @@ Status NetworkStatsConnector::GetNetworkStatsForPod(const system::ProcParser& pr
                          container_info->active_upids().end(), md::UPIDStartTSCompare()));
 
     for (const auto& upid : container_info->active_upids()) {
-      auto s = proc_parser.ParseProcPIDNetDev(upid.pid(), stats);
+      // Parse into a fresh struct, so that a partially parsed file does not leak into the stats.
+      system::ProcParser::NetworkStats pid_stats;
+      auto s = proc_stat_reader->ReadNetDev(upid.pid(), &pid_stats);
       if (s.ok()) {
         // Since we just need to read one pid, we can bail on the first successful read.
+        *stats = pid_stats;
         return s;
       }
       VLOG(1) << absl::Substitute("Failed to read network stats for pod=$0, using upid=$1",
@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_stat_reader.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/core/canonical_types.h"
@@ -58,18 +59,18 @@ class NetworkStatsConnector : public SourceConnector {
  protected:
   explicit NetworkStatsConnector(std::string_view source_name)
       : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>();
+    proc_stat_reader_ = std::make_unique<system::ProcStatReader>();
   }
 
  private:
   void TransferNetworkStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  static Status GetNetworkStatsForPod(const system::ProcParser& proc_parser,
+  static Status GetNetworkStatsForPod(system::ProcStatReader* proc_stat_reader,
                                       const md::PodInfo& pod_info,
                                       const md::K8sMetadataState& k8s_metadata_state,
                                       system::ProcParser::NetworkStats* stats);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  std::unique_ptr<system::ProcStatReader> proc_stat_reader_;
 };
 
 }  // namespace stirling
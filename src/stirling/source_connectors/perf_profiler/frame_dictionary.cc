@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <utility>
+
+#include <absl/strings/str_split.h>
+
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
+
+namespace px {
+namespace stirling {
+
+std::vector<uint64_t> FrameDictionary::Intern(std::string_view folded_stack_trace) {
+  std::vector<uint64_t> frame_ids;
+  for (std::string_view symbol :
+       absl::StrSplit(folded_stack_trace, kFrameSeparator, absl::SkipEmpty())) {
+    frame_ids.push_back(Lookup(symbol));
+  }
+  return frame_ids;
+}
+
+uint64_t FrameDictionary::Lookup(std::string_view symbol) {
+  // Case 1: Frame is in the current set. Just return it.
+  const auto it = frame_ids_.find(symbol);
+  if (it != frame_ids_.end()) {
+    return it->second;
+  }
+
+  // Case 2: Frame is in the previous set. Move it to the current set, and publish it again.
+  const auto it2 = prev_frame_ids_.find(symbol);
+  if (it2 != prev_frame_ids_.end()) {
+    const uint64_t frame_id = it2->second;
+    frame_ids_.emplace(symbol, frame_id);
+    prev_frame_ids_.erase(it2);
+    new_frames_.emplace_back(frame_id, std::string(symbol));
+    return frame_id;
+  }
+
+  // Case 3: Frame is not in the current nor the previous set. Create a new ID.
+  const uint64_t frame_id = ++next_frame_id_;
+  frame_ids_.emplace(symbol, frame_id);
+  new_frames_.emplace_back(frame_id, std::string(symbol));
+  return frame_id;
+}
+
+std::vector<std::pair<uint64_t, std::string>> FrameDictionary::ConsumeNewFrames() {
+  std::vector<std::pair<uint64_t, std::string>> new_frames = std::move(new_frames_);
+  new_frames_.clear();
+  return new_frames;
+}
+
+void FrameDictionary::AgeTick() {
+  prev_frame_ids_ = std::move(frame_ids_);
+  frame_ids_.clear();
+}
+
+}  // namespace stirling
+}  // namespace px
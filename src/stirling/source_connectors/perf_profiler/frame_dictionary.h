@@ -0,0 +1,73 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+namespace px {
+namespace stirling {
+
+// The FrameDictionary interns the symbols (frames) of folded stack traces into integer frame IDs.
+// Deep stacks from the same process share most of their frames, so publishing each symbol once,
+// and each stack trace as a list of frame IDs, is much more compact than re-publishing the full
+// folded string on every push.
+//
+// Like the StackTraceIDCache, the dictionary is aged in two generations to bound its memory,
+// and frame IDs are never reused: a consumer may keep the most recent symbol seen for each ID.
+// IDs are only unique within one dictionary, i.e. one agent; the published frames carry the
+// agent's ASID so that consumers can tell apart frames of different agents.
+// A frame that is kept alive across an AgeTick() is queued for publishing again, so that the
+// dictionary table always has a recent row for each live frame, even after older rows have
+// expired out of the table store.
+class FrameDictionary {
+ public:
+  // Separator between symbols in a folded stack trace.
+  static constexpr char kFrameSeparator = ';';
+
+  // Returns the frame ID of each symbol in the folded stack trace, in order.
+  std::vector<uint64_t> Intern(std::string_view folded_stack_trace);
+
+  // Returns the frame ID of a single symbol.
+  uint64_t Lookup(std::string_view symbol);
+
+  // Returns the frames that were assigned or refreshed since the previous call.
+  std::vector<std::pair<uint64_t, std::string>> ConsumeNewFrames();
+
+  void AgeTick();
+
+  size_t size() const { return frame_ids_.size() + prev_frame_ids_.size(); }
+
+ private:
+  absl::flat_hash_map<std::string, uint64_t> frame_ids_;
+  absl::flat_hash_map<std::string, uint64_t> prev_frame_ids_;
+
+  std::vector<std::pair<uint64_t, std::string>> new_frames_;
+
+  // Tracks the next frame-id to be assigned; incremented by 1 for each such assignment.
+  uint64_t next_frame_id_ = 0;
+};
+
+}  // namespace stirling
+}  // namespace px
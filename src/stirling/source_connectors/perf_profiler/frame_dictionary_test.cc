@@ -0,0 +1,78 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+TEST(FrameDictionary, InternSharesFrames) {
+  FrameDictionary frames;
+
+  const std::vector<uint64_t> ids1 = frames.Intern("main;foo;bar");
+  const std::vector<uint64_t> ids2 = frames.Intern("main;foo;baz");
+
+  ASSERT_EQ(ids1.size(), 3);
+  ASSERT_EQ(ids2.size(), 3);
+  EXPECT_EQ(ids1[0], ids2[0]);
+  EXPECT_EQ(ids1[1], ids2[1]);
+  EXPECT_NE(ids1[2], ids2[2]);
+  EXPECT_EQ(frames.size(), 4);
+
+  // Each distinct symbol is published exactly once.
+  EXPECT_THAT(frames.ConsumeNewFrames(),
+              ElementsAre(Pair(ids1[0], "main"), Pair(ids1[1], "foo"), Pair(ids1[2], "bar"),
+                          Pair(ids2[2], "baz")));
+  EXPECT_THAT(frames.ConsumeNewFrames(), IsEmpty());
+
+  EXPECT_EQ(frames.Intern("main;foo;bar"), ids1);
+  EXPECT_THAT(frames.ConsumeNewFrames(), IsEmpty());
+}
+
+TEST(FrameDictionary, Aging) {
+  FrameDictionary frames;
+
+  const uint64_t main_id = frames.Lookup("main");
+  const uint64_t foo_id = frames.Lookup("foo");
+  frames.ConsumeNewFrames();
+
+  frames.AgeTick();
+
+  // Maintain IDs across one generation, and publish the surviving frames again.
+  EXPECT_EQ(frames.Lookup("main"), main_id);
+  EXPECT_THAT(frames.ConsumeNewFrames(), ElementsAre(Pair(main_id, "main")));
+
+  frames.AgeTick();
+  frames.AgeTick();
+
+  // Expect new IDs if too many generations have passed since last use.
+  EXPECT_NE(frames.Lookup("main"), main_id);
+  EXPECT_NE(frames.Lookup("foo"), foo_id);
+  EXPECT_EQ(frames.size(), 2);
+}
+
+}  // namespace stirling
+}  // namespace px
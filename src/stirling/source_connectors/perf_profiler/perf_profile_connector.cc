@@ -33,6 +33,13 @@ OBJ_STRVIEW(profiler_bcc_script, profiler);
 DEFINE_string(stirling_profiler_symbolizer, "bcc",
               "Choice of which symbolizer to use. Options: bcc, elf");
 DEFINE_bool(stirling_profiler_cache_symbols, true, "Whether to cache symbols");
+DEFINE_bool(stirling_profiler_async_symbolization, true,
+            "If true, symbolize stack traces on a background thread, instead of on the Stirling "
+            "thread. Stack traces are published once symbolized, with their collection time.");
+DEFINE_bool(stirling_profiler_interned_stack_traces, false,
+            "If true, publish stack traces as interned frames to the stack_trace_frames.beta and "
+            "stack_frames.beta tables, and leave the stack_trace column of stack_traces.beta empty. "
+            "Use px.fold_stack_trace to reassemble the folded stack traces.");
 DEFINE_uint32(stirling_profiler_log_period_minutes, 10,
               "Number of minutes between profiler stats log printouts.");
 DEFINE_uint32(stirling_profiler_table_update_period_seconds,
@@ -170,10 +177,17 @@ Status PerfProfileConnector::InitImpl() {
     PX_ASSIGN_OR_RETURN(k_symbolizer_, CachingSymbolizer::Create(std::move(k_symbolizer_)));
   }
 
+  if (FLAGS_stirling_profiler_async_symbolization) {
+    symbolization_worker_ = std::make_unique<SymbolizationWorker>(kMaxPendingSymbolizationJobs);
+  }
+
   return Status::OK();
 }
 
 Status PerfProfileConnector::StopImpl() {
+  // Stop symbolizing before tearing anything down; the pending jobs are discarded.
+  symbolization_worker_.reset();
+
   // Must call Close() after attach_uprobes_thread_ has joined,
   // otherwise the two threads will cause concurrent accesses to BCC,
   // that will cause races and undefined behavior.
@@ -219,39 +233,41 @@ void PerfProfileConnector::CleanupSymbolizers(const absl::flat_hash_set<md::UPID
   }
 }
 
-PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces(
+PerfProfileConnector::RawStackTraces PerfProfileConnector::SnapshotStackTraces(
     ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces) {
-  // TODO(jps): switch from using get_table_offline() to directly stepping through
-  // the histogram data structure. Inline populating our own data structures with this.
-  // Avoid an unnecessary copy of the information in local stack_trace_keys_and_counts.
-  StackTraceHisto symbolic_histogram;
-  uint64_t cum_sum_count = 0;
+  RawStackTraces raw;
+  raw.timestamp_ns = AdjustedSteadyClockNowNS();
+  raw.asid = ctx->GetASID();
+  raw.keys.reserve(raw_histo_data_.size());
 
-  const uint32_t asid = ctx->GetASID();
   const absl::flat_hash_set<md::UPID>& upids_for_symbolization = ctx->GetUPIDs();
 
-  // Cause symbolizers to perform any necessary updates before we put them to work.
-  u_symbolizer_->IterationPreTick();
-  k_symbolizer_->IterationPreTick();
-
-  // Create a new stringifier for this iteration of the continuous perf profiler.
-  Stringifier stringifier(u_symbolizer_.get(), k_symbolizer_.get(), stack_traces);
-
   absl::flat_hash_set<int> k_stack_ids_to_remove;
 
-  for (const auto& stack_trace_key : raw_histo_data_) {
-    std::string stack_trace_str;
+  // Clear the stack-traces map as we go along here; this has lower overhead
+  // compared to first reading the stack-traces map, then using clear_table_non_atomic().
+  constexpr bool kClearStackId = true;
+  auto copy_stack_addrs = [&raw, stack_traces](int stack_id) {
+    if (stack_id < 0) {
+      return;
+    }
+    auto [iter, inserted] = raw.stack_addrs.try_emplace(stack_id);
+    if (inserted) {
+      iter->second = stack_traces->get_stack_addr(stack_id, kClearStackId);
+    }
+  };
 
-    const md::UPID upid(asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
+  for (const auto& stack_trace_key : raw_histo_data_) {
+    const md::UPID upid(raw.asid, stack_trace_key.upid.pid,
+                        stack_trace_key.upid.start_time_ticks);
     const bool symbolize = upids_for_symbolization.contains(upid);
 
     if (symbolize) {
-      // The stringifier clears stack-ids out of the stack traces table when it
-      // first encounters them. If a stack-id is reused by a different stack-trace-key,
-      // the stringifier returns its memoized stack trace string. Because the stack-ids
-      // are not stable across profiler iterations, we create and destroy a stringifer
-      // on each profiler iteration.
-      stack_trace_str = stringifier.FoldedStackTraceString(stack_trace_key);
+      // Copy the addresses out of the BPF stack traces table, which is reused by BPF once this
+      // iteration is complete. The addresses are symbolized later, possibly on another thread.
+      // A stack-id can be shared by several stack-trace-keys, so each is copied only once.
+      copy_stack_addrs(stack_trace_key.user_stack_id);
+      copy_stack_addrs(stack_trace_key.kernel_stack_id);
     } else {
       // If we do not stringifiy this stack trace, we still need to clear
       // its entry from the stack traces table. It is safe to do so immediately
@@ -264,17 +280,62 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
       if (stack_trace_key.kernel_stack_id >= 0) {
         k_stack_ids_to_remove.insert(stack_trace_key.kernel_stack_id);
       }
+    }
+
+    raw.keys.emplace_back(stack_trace_key, symbolize);
+  }
+
+  // Clear any kernel stack-ids, that were potentially not already cleared,
+  // out of the stack traces table.
+  for (const int k_stack_id : k_stack_ids_to_remove) {
+    if (!raw.stack_addrs.contains(k_stack_id)) {
+      stack_traces->clear_stack_id(k_stack_id);
+    }
+  }
+
+  raw_histo_data_.clear();
+
+  return raw;
+}
+
+PerfProfileConnector::SymbolizedStackTraces PerfProfileConnector::SymbolizeStackTraces(
+    const RawStackTraces& raw) {
+  SymbolizedStackTraces symbolized;
+  symbolized.timestamp_ns = raw.timestamp_ns;
+  symbolized.asid = raw.asid;
+
+  // Cause symbolizers to perform any necessary updates before we put them to work.
+  u_symbolizer_->IterationPreTick();
+  k_symbolizer_->IterationPreTick();
+
+  // Create a new stringifier for this iteration of the continuous perf profiler.
+  // The stringifier memoizes its stack trace string per stack-id. Because the stack-ids
+  // are not stable across profiler iterations, we create and destroy a stringifer
+  // on each profiler iteration.
+  Stringifier stringifier(u_symbolizer_.get(), k_symbolizer_.get(), [&raw](int stack_id) {
+    const auto iter = raw.stack_addrs.find(stack_id);
+    return iter != raw.stack_addrs.end() ? iter->second : std::vector<uintptr_t>{};
+  });
+
+  for (const auto& [stack_trace_key, symbolize] : raw.keys) {
+    std::string stack_trace_str;
+
+    const md::UPID upid(raw.asid, stack_trace_key.upid.pid, stack_trace_key.upid.start_time_ticks);
+
+    if (symbolize) {
+      stack_trace_str = stringifier.FoldedStackTraceString(stack_trace_key);
+    } else {
       stack_trace_str = std::string(profiler::kNotSymbolizedMessage);
     }
 
     profiler::SymbolicStackTrace symbolic_stack_trace = {upid, std::move(stack_trace_str)};
 
-    ++symbolic_histogram[symbolic_stack_trace];
-    ++cum_sum_count;
+    ++symbolized.histo[symbolic_stack_trace];
+    ++symbolized.cum_sum_count;
 
     // TODO(jps): If we see a perf. issue with having two maps keyed by symbolic-stack-trace,
     // refactor such that creating/finding symoblic-stack-trace-id and count aggregation
-    // are both done here, in AggregateStackTraces().
+    // are both done here, in SymbolizeStackTraces().
     // One possible implementation:
     // make the histogram a map from "symbolic-track-trace" => "count & stack-trace-id"
     // e.g.:
@@ -284,52 +345,130 @@ PerfProfileConnector::StackTraceHisto PerfProfileConnector::AggregateStackTraces
     // alternate impl. is a map from "stack-trace-id" => "count & symbolic-stack-trace"
   }
 
-  // Clear any kernel stack-ids, that were potentially not already cleared,
-  // out of the stack traces table.
-  for (const int k_stack_id : k_stack_ids_to_remove) {
-    stack_traces->clear_stack_id(k_stack_id);
+  VLOG(1) << "PerfProfileConnector::SymbolizeStackTraces(): cum_sum_count: "
+          << symbolized.cum_sum_count;
+  return symbolized;
+}
+
+void PerfProfileConnector::RunSymbolizationJob(const RawStackTraces& raw) {
+  SymbolizedStackTraces symbolized = SymbolizeStackTraces(raw);
+
+  CleanupSymbolizers(raw.deleted_upids);
+  if (raw.log_symbolizer_stats) {
+    PrintSymbolizerStats();
   }
 
-  raw_histo_data_.clear();
+  std::lock_guard<std::mutex> lock(symbolized_stack_traces_mutex_);
+  symbolized_stack_traces_.push_back(std::move(symbolized));
+}
+
+void PerfProfileConnector::SubmitSymbolizationJob(RawStackTraces raw) {
+  // Carry over the clean-up of processes from any batch that was dropped.
+  raw.deleted_upids.insert(pending_deleted_upids_.begin(), pending_deleted_upids_.end());
+  pending_deleted_upids_.clear();
+
+  if (symbolization_worker_ == nullptr) {
+    RunSymbolizationJob(raw);
+    return;
+  }
 
-  VLOG(1) << "PerfProfileConnector::AggregateStackTraces(): cum_sum_count: " << cum_sum_count;
-  stats_.Increment(StatKey::kCumulativeSumOfAllStackTraces, cum_sum_count);
-  return symbolic_histogram;
+  // The job owns its batch; it is shared so that the job remains copyable.
+  auto raw_ptr = std::make_shared<const RawStackTraces>(std::move(raw));
+  if (!symbolization_worker_->Submit([this, raw_ptr] { RunSymbolizationJob(*raw_ptr); })) {
+    // Symbolization is falling behind. Drop this batch, rather than grow the backlog.
+    stats_.Increment(StatKey::kSymbolizationBacklogDrop, raw_ptr->keys.size());
+    pending_deleted_upids_ = raw_ptr->deleted_upids;
+  }
 }
 
-void PerfProfileConnector::CreateRecords(ebpf::BPFStackTable* stack_traces, ConnectorContext* ctx,
+void PerfProfileConnector::CreateRecords(const SymbolizedStackTraces& symbolized,
                                          DataTable* data_table) {
   constexpr size_t kMaxSymbolSize = 512;
   constexpr size_t kMaxStackDepth = 64;
   constexpr size_t kMaxStackTraceSize = kMaxStackDepth * kMaxSymbolSize;
 
-  const uint64_t timestamp_ns = AdjustedSteadyClockNowNS();
+  // Records carry the time at which the stack traces were collected,
+  // not the (possibly later) time at which they were symbolized.
+  const uint64_t timestamp_ns = symbolized.timestamp_ns;
 
   // Stack traces from kernel/BPF are ordered lists of instruction pointers (addresses).
-  // AggregateStackTraces() will collapse some of those into identical symbolic stack traces;
+  // SymbolizeStackTraces() will collapse some of those into identical symbolic stack traces;
   // for example, consider the following two stack traces from BPF:
   // p0, p1, p2 => main;qux;baz   # both p2 & p3 point into baz.
   // p0, p1, p3 => main;qux;baz
 
-  StackTraceHisto stack_trace_histogram = AggregateStackTraces(ctx, stack_traces);
+  const bool interned = FLAGS_stirling_profiler_interned_stack_traces;
 
-  constexpr auto age_tick_period = std::chrono::minutes(5);
-  if (sampling_freq_mgr_.count() % (age_tick_period / sampling_period_) == 0) {
-    stack_trace_ids_.AgeTick();
-  }
-
-  for (const auto& [key, count] : stack_trace_histogram) {
+  for (const auto& [key, count] : symbolized.histo) {
     DataTable::RecordBuilder<&kStackTraceTable> r(data_table, timestamp_ns);
 
+    bool new_in_generation;
+    const uint64_t stack_trace_id = stack_trace_ids_.Lookup(key, &new_in_generation);
+
     r.Append<r.ColIndex("time_")>(timestamp_ns);
     r.Append<r.ColIndex("upid")>(key.upid.value());
-    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_ids_.Lookup(key));
-    r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
+    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
+    if (interned) {
+      // The folded string is reassembled from the interned tables on demand.
+      r.Append<r.ColIndex("stack_trace")>("");
+    } else {
+      r.Append<r.ColIndex("stack_trace")>(key.stack_trace_str, kMaxStackTraceSize);
+    }
     r.Append<r.ColIndex("count")>(count);
+
+    if (interned && new_in_generation) {
+      AppendInternedStackTrace(key, stack_trace_id, timestamp_ns);
+    }
+  }
+
+  if (interned) {
+    AppendNewFrames(timestamp_ns, symbolized.asid);
+  }
+}
+
+void PerfProfileConnector::AppendInternedStackTrace(const profiler::SymbolicStackTrace& stack_trace,
+                                                    uint64_t stack_trace_id,
+                                                    uint64_t timestamp_ns) {
+  // Frames are interned even when the table is not subscribed to, so that the frame
+  // dictionary stays consistent with the stack traces that have been published.
+  const std::vector<uint64_t> frame_ids = frame_dictionary_.Intern(stack_trace.stack_trace_str);
+
+  DataTable* data_table = data_tables_[kStackTraceFramesTableNum];
+  if (data_table == nullptr) {
+    return;
+  }
+
+  for (size_t depth = 0; depth < frame_ids.size(); ++depth) {
+    DataTable::RecordBuilder<&kStackTraceFramesTable> r(data_table, timestamp_ns);
+    r.Append<r.ColIndex("time_")>(timestamp_ns);
+    r.Append<r.ColIndex("upid")>(stack_trace.upid.value());
+    r.Append<r.ColIndex("stack_trace_id")>(stack_trace_id);
+    r.Append<r.ColIndex("depth")>(depth);
+    r.Append<r.ColIndex("frame_id")>(frame_ids[depth]);
+  }
+}
+
+void PerfProfileConnector::AppendNewFrames(uint64_t timestamp_ns, uint32_t asid) {
+  constexpr size_t kMaxSymbolSize = 512;
+
+  const std::vector<std::pair<uint64_t, std::string>> new_frames =
+      frame_dictionary_.ConsumeNewFrames();
+
+  DataTable* data_table = data_tables_[kStackFramesTableNum];
+  if (data_table == nullptr) {
+    return;
+  }
+
+  for (const auto& [frame_id, frame] : new_frames) {
+    DataTable::RecordBuilder<&kStackFramesTable> r(data_table, timestamp_ns);
+    r.Append<r.ColIndex("time_")>(timestamp_ns);
+    r.Append<r.ColIndex("asid")>(asid);
+    r.Append<r.ColIndex("frame_id")>(frame_id);
+    r.Append<r.ColIndex("frame")>(frame, kMaxSymbolSize);
   }
 }
 
-void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table) {
+void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx) {
   // Choose the maps to consume.
   const bool using_map_set_a = transfer_count_ % 2 == 0;
   auto& stack_traces = using_map_set_a ? stack_traces_a_ : stack_traces_b_;
@@ -347,27 +486,57 @@ void PerfProfileConnector::ProcessBPFStackTraces(ConnectorContext* ctx, DataTabl
   const ebpf::StatusTuple s = profiler_state_->update_value(kTransferCountIdx, transfer_count_);
   LOG_IF(ERROR, !s.ok()) << "Error writing transfer_count_";
 
-  // Read BPF stack traces & histogram, build records, incorporate records to data table.
-  CreateRecords(stack_traces.get(), ctx, data_table);
+  // Copy the BPF stack traces & histogram out of the maps. Symbolization is deferred,
+  // so that it does not hold up the Stirling thread.
+  RawStackTraces raw = SnapshotStackTraces(ctx, stack_traces.get());
 
   // Now that we've consumed the data, reset the sample count in BPF.
   profiler_state_->update_value(sample_count_idx, 0);
+
+  // Clean-up the symbolizers so we don't leak memory. The clean-up touches the symbolizers,
+  // so it is done by the symbolization job, after this batch has been symbolized.
+  proc_tracker_.Update(ctx->GetUPIDs());
+  raw.deleted_upids = proc_tracker_.deleted_upids();
+  raw.log_symbolizer_stats = sampling_freq_mgr_.count() % stats_log_interval_ == 0;
+
+  SubmitSymbolizationJob(std::move(raw));
+}
+
+void PerfProfileConnector::PublishSymbolizedStackTraces(DataTable* data_table) {
+  std::deque<SymbolizedStackTraces> symbolized_stack_traces;
+  {
+    std::lock_guard<std::mutex> lock(symbolized_stack_traces_mutex_);
+    symbolized_stack_traces.swap(symbolized_stack_traces_);
+  }
+
+  for (const auto& symbolized : symbolized_stack_traces) {
+    CreateRecords(symbolized, data_table);
+    stats_.Increment(StatKey::kCumulativeSumOfAllStackTraces, symbolized.cum_sum_count);
+  }
 }
 
 void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx) {
-  DCHECK_EQ(data_tables_.size(), 1U);
+  DCHECK_EQ(data_tables_.size(), kTables.size());
 
-  auto* data_table = data_tables_[0];
+  auto* data_table = data_tables_[kPerfProfileTableNum];
 
   if (data_table == nullptr) {
     return;
   }
 
-  ProcessBPFStackTraces(ctx, data_table);
+  constexpr auto age_tick_period = std::chrono::minutes(5);
+  if (sampling_freq_mgr_.count() % (age_tick_period / sampling_period_) == 0) {
+    stack_trace_ids_.AgeTick();
+    if (FLAGS_stirling_profiler_interned_stack_traces) {
+      frame_dictionary_.AgeTick();
+    }
+  }
 
-  // Cleanup the symbolizer so we don't leak memory.
-  proc_tracker_.Update(ctx->GetUPIDs());
-  CleanupSymbolizers(proc_tracker_.deleted_upids());
+  ProcessBPFStackTraces(ctx);
+
+  // Publish the stack traces that have been symbolized since the previous iteration.
+  // Without a symbolization worker, this includes the stack traces collected just above.
+  PublishSymbolizedStackTraces(data_table);
 
   stats_.Increment(StatKey::kBPFMapSwitchoverEvent, 1);
 
@@ -378,6 +547,9 @@ void PerfProfileConnector::TransferDataImpl(ConnectorContext* ctx) {
 
 void PerfProfileConnector::PrintStats() const {
   LOG(INFO) << "PerfProfileConnector statistics: " << stats_.Print();
+}
+
+void PerfProfileConnector::PrintSymbolizerStats() const {
   if (FLAGS_stirling_profiler_cache_symbols) {
     auto u_symbolizer = static_cast<CachingSymbolizer*>(u_symbolizer_.get());
     auto k_symbolizer = static_cast<CachingSymbolizer*>(k_symbolizer_.get());
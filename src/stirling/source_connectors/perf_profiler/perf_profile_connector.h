@@ -18,7 +18,9 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -28,10 +30,12 @@
 #include "src/stirling/core/source_connector.h"
 #include "src/stirling/core/types.h"
 #include "src/stirling/source_connectors/perf_profiler/bcc_bpf_intf/stack_event.h"
+#include "src/stirling/source_connectors/perf_profiler/frame_dictionary.h"
 #include "src/stirling/source_connectors/perf_profiler/shared/types.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_trace_id_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/stack_traces_table.h"
 #include "src/stirling/source_connectors/perf_profiler/stringifier.h"
+#include "src/stirling/source_connectors/perf_profiler/symbolization_worker.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/bcc_symbolizer.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/caching_symbolizer.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
@@ -48,8 +52,11 @@ static constexpr std::string_view kNotSymbolizedMessage = "<not symbolized>";
 class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrapper {
  public:
   static constexpr std::string_view kName = "perf_profiler";
-  static constexpr auto kTables = MakeArray(kStackTraceTable);
+  static constexpr auto kTables =
+      MakeArray(kStackTraceTable, kStackTraceFramesTable, kStackFramesTable);
   static constexpr uint32_t kPerfProfileTableNum = TableNum(kTables, kStackTraceTable);
+  static constexpr uint32_t kStackTraceFramesTableNum = TableNum(kTables, kStackTraceFramesTable);
+  static constexpr uint32_t kStackFramesTableNum = TableNum(kTables, kStackFramesTable);
 
   static std::unique_ptr<PerfProfileConnector> Create(std::string_view name) {
     return std::unique_ptr<PerfProfileConnector>(new PerfProfileConnector(name));
@@ -68,6 +75,7 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
     kBPFMapSwitchoverEvent,
     kCumulativeSumOfAllStackTraces,
     kLossHistoEvent,
+    kSymbolizationBacklogDrop,
   };
 
   utils::StatCounter<StatKey> stats() const { return stats_; }
@@ -88,19 +96,64 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // RawHistoData: a list of stack trace keys that will need to be histogrammed.
   using RawHistoData = std::vector<stack_trace_key_t>;
 
+  // The stack traces of one profiler iteration, copied out of the BPF maps so that they can be
+  // symbolized after the maps have been handed back to BPF.
+  struct RawStackTraces {
+    uint64_t timestamp_ns = 0;
+    uint32_t asid = 0;
+
+    // The stack trace keys of the histogram, and whether each of them is to be symbolized.
+    std::vector<std::pair<stack_trace_key_t, bool>> keys;
+
+    // The addresses of the stack-ids referenced by the keys to be symbolized.
+    absl::flat_hash_map<int, std::vector<uintptr_t>> stack_addrs;
+
+    // Processes whose symbolizer state is cleaned up once this batch is symbolized.
+    absl::flat_hash_set<md::UPID> deleted_upids;
+
+    bool log_symbolizer_stats = false;
+  };
+
+  struct SymbolizedStackTraces {
+    uint64_t timestamp_ns = 0;
+    uint32_t asid = 0;
+    StackTraceHisto histo;
+    uint64_t cum_sum_count = 0;
+  };
+
+  // Upper bound on the number of batches queued for symbolization, beyond which batches are
+  // dropped. With the default 30s push period, this is two minutes of profiles.
+  static constexpr size_t kMaxPendingSymbolizationJobs = 4;
+
   explicit PerfProfileConnector(std::string_view source_name);
 
-  void ProcessBPFStackTraces(ConnectorContext* ctx, DataTable* data_table);
+  void ProcessBPFStackTraces(ConnectorContext* ctx);
+
+  // Copies the stack traces of this iteration out of the BPF data structures.
+  RawStackTraces SnapshotStackTraces(ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces);
+
+  // Converts the stack traces to symbolic stack traces. Must only be called from the
+  // symbolization job, which has exclusive use of the symbolizers.
+  SymbolizedStackTraces SymbolizeStackTraces(const RawStackTraces& raw);
+
+  // Symbolizes a batch on the symbolization worker, or inline if there is no worker.
+  void SubmitSymbolizationJob(RawStackTraces raw);
+  void RunSymbolizationJob(const RawStackTraces& raw);
 
-  // Read BPF data structures, build & incorporate records to the table.
-  void CreateRecords(ebpf::BPFStackTable* stack_traces, ConnectorContext* ctx,
-                     DataTable* data_table);
+  // Builds & incorporates records of the symbolized stack traces into the table.
+  void PublishSymbolizedStackTraces(DataTable* data_table);
+  void CreateRecords(const SymbolizedStackTraces& symbolized, DataTable* data_table);
 
-  StackTraceHisto AggregateStackTraces(ConnectorContext* ctx, ebpf::BPFStackTable* stack_traces);
+  // Publishes the frames of a stack trace, and any newly interned frame symbols,
+  // to the interned stack trace tables.
+  void AppendInternedStackTrace(const profiler::SymbolicStackTrace& stack_trace,
+                                uint64_t stack_trace_id, uint64_t timestamp_ns);
+  void AppendNewFrames(uint64_t timestamp_ns, uint32_t asid);
 
   void CleanupSymbolizers(const absl::flat_hash_set<md::UPID>& deleted_upids);
 
   void PrintStats() const;
+  void PrintSymbolizerStats() const;
 
   // data structures shared with BPF:
   std::unique_ptr<ebpf::BPFStackTable> stack_traces_a_;
@@ -114,6 +167,9 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // Tracks unique stack trace ids, for the lifetime of Stirling:
   StackTraceIDCache stack_trace_ids_;
 
+  // Interns the frames of the stack traces, when publishing interned stack traces.
+  FrameDictionary frame_dictionary_;
+
   // The raw histogram from BPF; it is populated on each iteration by a call to PollPerfBuffer().
   RawHistoData raw_histo_data_;
 
@@ -125,6 +181,18 @@ class PerfProfileConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // TODO(oazizi): Investigate ways of sharing across source_connectors.
   ProcTracker proc_tracker_;
 
+  // Clean-up of processes whose batch was dropped, carried over to the next batch.
+  absl::flat_hash_set<md::UPID> pending_deleted_upids_;
+
+  // Batches symbolized by the symbolization job, waiting to be published by the Stirling thread.
+  // Guarded by symbolized_stack_traces_mutex_.
+  std::mutex symbolized_stack_traces_mutex_;
+  std::deque<SymbolizedStackTraces> symbolized_stack_traces_;
+
+  // Runs the symbolization jobs off the Stirling thread. Declared after the symbolizers and the
+  // symbolized batches, so that it is destroyed (and its thread joined) before them.
+  std::unique_ptr<SymbolizationWorker> symbolization_worker_;
+
   static void HandleHistoEvent(void* cb_cookie, void* data, int /*data_size*/);
   static void HandleHistoLoss(void* cb_cookie, uint64_t lost);
 
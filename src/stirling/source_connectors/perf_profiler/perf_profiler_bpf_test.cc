@@ -44,6 +44,7 @@ DECLARE_bool(stirling_profiler_java_symbols);
 DECLARE_string(stirling_profiler_java_agent_libs);
 DECLARE_uint32(stirling_profiler_table_update_period_seconds);
 DECLARE_uint32(stirling_profiler_stack_trace_sample_period_ms);
+DECLARE_bool(stirling_profiler_async_symbolization);
 
 namespace px {
 namespace stirling {
@@ -221,10 +222,13 @@ class PerfProfileBPFTest : public ::testing::TestWithParam<std::filesystem::path
     FLAGS_number_attach_attempts_per_iteration = kNumSubProcs;
     FLAGS_stirling_profiler_table_update_period_seconds = 5;
     FLAGS_stirling_profiler_stack_trace_sample_period_ms = 7;
+    // Symbolize inline, so that each TransferData() publishes the samples it collects.
+    FLAGS_stirling_profiler_async_symbolization = false;
 
     source_ = PerfProfileConnector::Create("perf_profile_connector");
     ASSERT_OK(source_->Init());
-    source_->set_data_tables({&data_table_});
+    // The interned stack trace tables are not subscribed to.
+    source_->set_data_tables({&data_table_, nullptr, nullptr});
 
     // Immediately start the transfer data thread to continue draining perf buffers,
     // i.e. to prevent dropping perf buffer entries.
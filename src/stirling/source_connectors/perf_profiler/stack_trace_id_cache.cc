@@ -25,6 +25,14 @@ namespace stirling {
 // TODO(jps): Add profiler namespace for all profiler code.
 
 uint64_t StackTraceIDCache::Lookup(const profiler::SymbolicStackTrace& stack_trace) {
+  bool new_in_generation;
+  return Lookup(stack_trace, &new_in_generation);
+}
+
+uint64_t StackTraceIDCache::Lookup(const profiler::SymbolicStackTrace& stack_trace,
+                                   bool* new_in_generation) {
+  *new_in_generation = false;
+
   // Case 1: Stack trace ID is in the current set. Just return it.
   const auto it = stack_trace_ids_.find(stack_trace);
   if (it != stack_trace_ids_.end()) {
@@ -37,12 +45,14 @@ uint64_t StackTraceIDCache::Lookup(const profiler::SymbolicStackTrace& stack_tra
   if (it2 != prev_stack_trace_ids_.end()) {
     const uint64_t stack_trace_id = it2->second;
     stack_trace_ids_[stack_trace] = stack_trace_id;
+    *new_in_generation = true;
     return stack_trace_id;
   }
 
   // Case 3: Stack trace ID is not in the current nor the previous set. Create a new ID.
   const uint64_t stack_trace_id = ++next_stack_trace_id_;
   stack_trace_ids_[stack_trace] = stack_trace_id;
+  *new_in_generation = true;
   return stack_trace_id;
 }
 
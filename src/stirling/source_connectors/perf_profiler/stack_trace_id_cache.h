@@ -47,6 +47,10 @@ namespace stirling {
 class StackTraceIDCache {
  public:
   uint64_t Lookup(const profiler::SymbolicStackTrace& stack_trace);
+
+  // Same as above, but also reports whether the stack trace was not yet in the current generation,
+  // i.e. whether its ID was just assigned or carried over from the previous generation.
+  uint64_t Lookup(const profiler::SymbolicStackTrace& stack_trace, bool* new_in_generation);
   void AgeTick();
 
  private:
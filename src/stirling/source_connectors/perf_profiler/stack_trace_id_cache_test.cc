@@ -51,5 +51,23 @@ TEST(StackTraceIDCache, Basic) {
   EXPECT_NE(stack_trace_ids.Lookup(kStackTrace2), id2);
 }
 
+TEST(StackTraceIDCache, NewInGeneration) {
+  StackTraceIDCache stack_trace_ids;
+
+  const md::UPID kUPID(1, 1, 1);
+  const profiler::SymbolicStackTrace kStackTrace{kUPID, "a();b();c();"};
+
+  bool new_in_generation;
+  const uint64_t id = stack_trace_ids.Lookup(kStackTrace, &new_in_generation);
+  EXPECT_TRUE(new_in_generation);
+  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace, &new_in_generation), id);
+  EXPECT_FALSE(new_in_generation);
+
+  // Carrying an ID over to a new generation reports it again.
+  stack_trace_ids.AgeTick();
+  EXPECT_EQ(stack_trace_ids.Lookup(kStackTrace, &new_in_generation), id);
+  EXPECT_TRUE(new_in_generation);
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -38,7 +38,8 @@ static constexpr DataElement kElements[] = {
     {"stack_trace",
      "A stack trace within the sampled process, in folded format. "
      "The call stack symbols are separated by semicolons. "
-     "If symbols cannot be resolved, addresses are populated instead.",
+     "If symbols cannot be resolved, addresses are populated instead. "
+     "Empty if the profiler publishes interned stack traces; see `stack_trace_frames.beta`.",
      types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
     {"count",
      "Number of times the stack trace has been sampled.",
@@ -60,5 +61,53 @@ constexpr int kStackTraceStackTraceIDIdx = kStackTraceTable.ColIndex("stack_trac
 constexpr int kStackTraceStackTraceStrIdx = kStackTraceTable.ColIndex("stack_trace");
 constexpr int kStackTraceCountIdx = kStackTraceTable.ColIndex("count");
 
+// The interned representation of stack traces: each stack trace is published as one row per
+// frame, referring to a dictionary of frame symbols. Rows are only published when a stack trace
+// ID or frame ID is first assigned, or carried over to a new generation of the ID caches.
+
+// clang-format off
+static constexpr DataElement kStackTraceFramesElements[] = {
+    canonical_data_elements::kTime,
+    canonical_data_elements::kUPID,
+    {"stack_trace_id",
+     "The stack trace that this frame belongs to; see `stack_traces.beta`.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"depth",
+     "The position of the frame in the stack trace, starting from 0 at the root.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"frame_id",
+     "The interned frame; its symbol is in `stack_frames.beta`, under the agent of the UPID.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+
+constexpr auto kStackTraceFramesTable = DataTableSchema(
+        "stack_trace_frames.beta",
+        "The frames of the sampled stack traces, as interned frame IDs.",
+        kStackTraceFramesElements
+);
+
+static constexpr DataElement kStackFramesElements[] = {
+    canonical_data_elements::kTime,
+    {"asid",
+     "The ID of the agent that interned the frame. Frame IDs are assigned per agent, "
+     "so frames are identified by (asid, frame_id); see `px.upid_to_asid()`.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"frame_id",
+     "An identifier of an interned stack frame, unique within the agent.",
+     types::DataType::INT64, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+    {"frame",
+     "The symbol of the stack frame, or its address if the symbol cannot be resolved.",
+     types::DataType::STRING, types::SemanticType::ST_NONE, types::PatternType::GENERAL},
+};
+
+constexpr auto kStackFramesTable = DataTableSchema(
+        "stack_frames.beta",
+        "Dictionary of the interned stack frames referenced by `stack_trace_frames.beta`.",
+        kStackFramesElements
+);
+// clang-format on
+DEFINE_PRINT_TABLE(StackTraceFrames)
+DEFINE_PRINT_TABLE(StackFrames)
+
 }  // namespace stirling
 }  // namespace px
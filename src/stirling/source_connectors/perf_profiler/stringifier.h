@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -51,6 +52,9 @@ namespace stirling {
 // of the continuous perf. profiler.
 class Stringifier {
  public:
+  // Provides the addresses of a stack trace, given its stack-id.
+  using StackAddrsFn = std::function<std::vector<uintptr_t>(int stack_id)>;
+
   /**
    * Construct a stack trace stringifier.
    *
@@ -61,6 +65,12 @@ class Stringifier {
   Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer,
               ebpf::BPFStackTable* stack_traces);
 
+  /**
+   * Construct a stack trace stringifier that reads stack trace addresses from a function,
+   * e.g. from a snapshot of the BPF stack traces that is symbolized off the Stirling thread.
+   */
+  Stringifier(Symbolizer* u_symbolizer, Symbolizer* k_symbolizer, StackAddrsFn stack_addrs_fn);
+
   // Returns a folded stack trace string based on the stack trace histogram key.
   // The key contains both a user & kernel stack-trace-id, which are subsequently
   // passed into FindOrBuildStackTraceString().
@@ -81,12 +91,12 @@ class Stringifier {
   Symbolizer* const u_symbolizer_;
   Symbolizer* const k_symbolizer_;
 
-  // The shared BPF stack trace table provides a stack trace, as a list of addresses,
-  // based on the stack-trace-id (an integer). When read, a given stack trace is consumed by
+  // Provides a stack trace, as a list of addresses, based on the stack-trace-id (an integer).
+  // When reading the shared BPF stack trace table, a given stack trace is consumed by
   // a destructive read, i.e. such that the BPF stack trace table does not need
   // to be explicitly cleared (by re-iterating the histogram) after an iteration
   // of the continuous perf. profiler is completed.
-  ebpf::BPFStackTable* const stack_traces_;
+  const StackAddrsFn stack_addrs_fn_;
 };
 
 }  // namespace stirling
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/shared_symbol_cache.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "src/common/base/base.h"
+
+namespace px {
+namespace stirling {
+
+SymbolCache* SharedSymbolCache::Acquire(const ObjectKey& key) {
+  std::unique_ptr<Entry>& entry = objects_[key];
+  if (entry == nullptr) {
+    entry = std::make_unique<Entry>();
+  }
+  ++entry->ref_count;
+  return &entry->cache;
+}
+
+void SharedSymbolCache::Release(const ObjectKey& key) {
+  auto iter = objects_.find(key);
+  if (iter == objects_.end()) {
+    DCHECK(false) << absl::Substitute("Releasing unknown object dev=$0 inode=$1", key.dev,
+                                      key.inode);
+    return;
+  }
+  if (--iter->second->ref_count == 0) {
+    objects_.erase(iter);
+  }
+}
+
+size_t SharedSymbolCache::PerformEvictions() {
+  size_t evict_count = 0;
+  for (auto& [key, entry] : objects_) {
+    evict_count += entry->cache.PerformEvictions();
+  }
+  return evict_count;
+}
+
+size_t SharedSymbolCache::active_entries() const {
+  size_t n = 0;
+  for (const auto& [key, entry] : objects_) {
+    n += entry->cache.active_entries();
+  }
+  return n;
+}
+
+size_t SharedSymbolCache::total_entries() const {
+  size_t n = 0;
+  for (const auto& [key, entry] : objects_) {
+    n += entry->cache.total_entries();
+  }
+  return n;
+}
+
+ProcessObjectMappings::ProcessObjectMappings(
+    const std::vector<system::ProcParser::ProcessSMaps>& maps, SharedSymbolCache* shared_cache)
+    : shared_cache_(shared_cache) {
+  for (const auto& map : maps) {
+    // Only executable mappings backed by a file hold code that can be shared across processes.
+    // Anonymous mappings (inode 0) include JIT code, whose symbols are process specific.
+    const bool executable = map.permissions.size() >= 3 && map.permissions[2] == 'x';
+    if (!executable || map.inode == 0) {
+      continue;
+    }
+    const uint64_t file_offset = std::strtoull(map.offset.c_str(), nullptr, 16);
+    ObjectKey key{map.dev, map.inode};
+    SymbolCache* cache = shared_cache_->Acquire(key);
+    mappings_.push_back(Mapping{map.vmem_start, map.vmem_end, file_offset, std::move(key), cache});
+  }
+
+  std::sort(mappings_.begin(), mappings_.end(),
+            [](const Mapping& a, const Mapping& b) { return a.vmem_start < b.vmem_start; });
+}
+
+ProcessObjectMappings::~ProcessObjectMappings() {
+  for (const auto& mapping : mappings_) {
+    shared_cache_->Release(mapping.key);
+  }
+}
+
+const ProcessObjectMappings::Mapping* ProcessObjectMappings::Find(uintptr_t addr) const {
+  // Find the last mapping that starts at or before addr.
+  auto iter = std::upper_bound(mappings_.begin(), mappings_.end(), addr,
+                               [](uintptr_t a, const Mapping& m) { return a < m.vmem_start; });
+  if (iter == mappings_.begin()) {
+    return nullptr;
+  }
+  --iter;
+  if (addr >= iter->vmem_end) {
+    return nullptr;
+  }
+  return &*iter;
+}
+
+}  // namespace stirling
+}  // namespace px
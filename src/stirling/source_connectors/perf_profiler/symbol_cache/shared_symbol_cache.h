@@ -0,0 +1,124 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/system/proc_parser.h"
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_cache.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * Identifies a mapped object file on the node, by the device and inode it lives on.
+ * Processes that map the same file (e.g. replicas of one container image) share the same key.
+ */
+struct ObjectKey {
+  std::string dev;
+  uint64_t inode;
+
+  bool operator==(const ObjectKey& rhs) const { return dev == rhs.dev && inode == rhs.inode; }
+
+  template <typename H>
+  friend H AbslHashValue(H h, const ObjectKey& key) {
+    return H::combine(std::move(h), key.dev, key.inode);
+  }
+};
+
+/**
+ * A node-wide set of symbol caches, one per object file, keyed by file offset.
+ *
+ * Symbols of an object file depend only on the file, not on where a process mapped it,
+ * so all processes mapping the same file share one cache.
+ * Each cache is reference counted by the processes using it, and freed with the last of them.
+ */
+class SharedSymbolCache {
+ public:
+  /**
+   * Returns the cache for the object, taking a reference on it.
+   */
+  SymbolCache* Acquire(const ObjectKey& key);
+
+  /**
+   * Drops a reference taken by Acquire(). The cache is freed once no references remain.
+   */
+  void Release(const ObjectKey& key);
+
+  size_t PerformEvictions();
+
+  size_t num_objects() const { return objects_.size(); }
+  size_t active_entries() const;
+  size_t total_entries() const;
+
+ private:
+  struct Entry {
+    SymbolCache cache;
+    int ref_count = 0;
+  };
+
+  // Entries are heap allocated so that the SymbolCache pointers handed out remain stable.
+  absl::flat_hash_map<ObjectKey, std::unique_ptr<Entry>> objects_;
+};
+
+/**
+ * The executable file-backed mappings of one process, each pointing to the shared cache of its
+ * object file. Translates virtual addresses into (object cache, file offset) pairs.
+ *
+ * Holds references in the SharedSymbolCache for as long as it lives.
+ */
+class ProcessObjectMappings {
+ public:
+  struct Mapping {
+    uint64_t vmem_start;
+    uint64_t vmem_end;
+    uint64_t file_offset;
+    ObjectKey key;
+    SymbolCache* cache;
+  };
+
+  ProcessObjectMappings(const std::vector<system::ProcParser::ProcessSMaps>& maps,
+                        SharedSymbolCache* shared_cache);
+  ~ProcessObjectMappings();
+
+  ProcessObjectMappings(const ProcessObjectMappings&) = delete;
+  ProcessObjectMappings& operator=(const ProcessObjectMappings&) = delete;
+
+  /**
+   * Returns the mapping containing addr, or nullptr if addr is not in a file-backed executable
+   * mapping (e.g. JIT code or the kernel).
+   */
+  const Mapping* Find(uintptr_t addr) const;
+
+  size_t size() const { return mappings_.size(); }
+
+ private:
+  SharedSymbolCache* shared_cache_;
+
+  // Sorted by vmem_start.
+  std::vector<Mapping> mappings_;
+};
+
+}  // namespace stirling
+}  // namespace px
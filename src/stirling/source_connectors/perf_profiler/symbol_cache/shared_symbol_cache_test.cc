@@ -0,0 +1,116 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/shared_symbol_cache.h"
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using system::ProcParser;
+
+namespace {
+
+ProcParser::ProcessSMaps MakeMap(uint64_t start, uint64_t end, std::string perms,
+                                 std::string offset, uint64_t inode) {
+  ProcParser::ProcessSMaps map;
+  map.vmem_start = start;
+  map.vmem_end = end;
+  map.permissions = std::move(perms);
+  map.offset = std::move(offset);
+  map.dev = "103:02";
+  map.inode = inode;
+  return map;
+}
+
+std::string_view SymbolizationFn(const uintptr_t addr) {
+  static std::string s;
+  s = absl::Substitute("$0", addr);
+  return s;
+}
+
+}  // namespace
+
+TEST(ProcessObjectMappingsTest, FindsExecutableFileMappings) {
+  SharedSymbolCache shared_cache;
+  std::vector<ProcParser::ProcessSMaps> maps = {
+      MakeMap(0x1000, 0x2000, "r--p", "00000000", 42),
+      MakeMap(0x2000, 0x5000, "r-xp", "00001000", 42),
+      // Anonymous executable memory, e.g. JIT code.
+      MakeMap(0x8000, 0x9000, "rwxp", "00000000", 0),
+      MakeMap(0x6000, 0x7000, "r-xp", "00002000", 43),
+  };
+
+  ProcessObjectMappings mappings(maps, &shared_cache);
+  EXPECT_EQ(mappings.size(), 2);
+  EXPECT_EQ(shared_cache.num_objects(), 2);
+
+  const ProcessObjectMappings::Mapping* m = mappings.Find(0x2010);
+  ASSERT_NE(m, nullptr);
+  EXPECT_EQ(m->key.inode, 42);
+  EXPECT_EQ(0x2010 - m->vmem_start + m->file_offset, 0x1010);
+
+  m = mappings.Find(0x6fff);
+  ASSERT_NE(m, nullptr);
+  EXPECT_EQ(m->key.inode, 43);
+
+  EXPECT_EQ(mappings.Find(0x1500), nullptr);
+  EXPECT_EQ(mappings.Find(0x5000), nullptr);
+  EXPECT_EQ(mappings.Find(0x8500), nullptr);
+  EXPECT_EQ(mappings.Find(0x500), nullptr);
+}
+
+TEST(SharedSymbolCacheTest, ProcessesShareObjectCaches) {
+  SharedSymbolCache shared_cache;
+
+  // Two replicas of the same binary, mapped at different addresses.
+  auto mappings1 = std::make_unique<ProcessObjectMappings>(
+      std::vector<ProcParser::ProcessSMaps>{MakeMap(0x10000, 0x20000, "r-xp", "00001000", 42)},
+      &shared_cache);
+  auto mappings2 = std::make_unique<ProcessObjectMappings>(
+      std::vector<ProcParser::ProcessSMaps>{MakeMap(0x70000, 0x80000, "r-xp", "00001000", 42)},
+      &shared_cache);
+  EXPECT_EQ(shared_cache.num_objects(), 1);
+
+  const auto* m1 = mappings1->Find(0x10100);
+  const auto* m2 = mappings2->Find(0x70100);
+  ASSERT_NE(m1, nullptr);
+  ASSERT_NE(m2, nullptr);
+  EXPECT_EQ(m1->cache, m2->cache);
+
+  EXPECT_EQ(m1->cache->Find(0x1100), std::nullopt);
+  m1->cache->Insert(0x1100, std::string(SymbolizationFn(0x10100)));
+  std::optional<std::string_view> symbol = m2->cache->Find(0x1100);
+  ASSERT_TRUE(symbol.has_value());
+  EXPECT_EQ(symbol.value(), absl::StrCat(0x10100));
+  EXPECT_EQ(shared_cache.total_entries(), 1);
+
+  // The cache lives until the last process using it goes away.
+  mappings1.reset();
+  EXPECT_EQ(shared_cache.num_objects(), 1);
+  mappings2.reset();
+  EXPECT_EQ(shared_cache.num_objects(), 0);
+}
+
+}  // namespace stirling
+}  // namespace px
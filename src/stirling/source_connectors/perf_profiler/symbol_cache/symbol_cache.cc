@@ -23,24 +23,43 @@
 namespace px {
 namespace stirling {
 
-SymbolCache::Symbol::Symbol(profiler::SymbolizerFn symbolizer_fn, const uintptr_t addr)
+SymbolCache::Symbol::Symbol(const profiler::SymbolizerFn& symbolizer_fn, const uintptr_t addr)
     : symbol_(symbolizer_fn(addr)) {}
 
-SymbolCache::LookupResult SymbolCache::Lookup(const uintptr_t addr) {
+std::optional<std::string_view> SymbolCache::Find(const uintptr_t key) {
   // Check old cache first, and move result to new cache if we have a hit.
-  const auto prev_cache_iter = prev_cache_.find(addr);
+  const auto prev_cache_iter = prev_cache_.find(key);
   if (prev_cache_iter != prev_cache_.end()) {
     // Move to new cache.
     auto [curr_cache_iter, inserted] =
-        cache_.try_emplace(addr, std::move(prev_cache_iter->second.symbol_));
+        cache_.try_emplace(key, std::move(prev_cache_iter->second.symbol_));
     DCHECK(inserted);
     prev_cache_.erase(prev_cache_iter);
-    return SymbolCache::LookupResult{curr_cache_iter->second.symbol_, true};
+    return curr_cache_iter->second.symbol_;
+  }
+
+  const auto iter = cache_.find(key);
+  if (iter != cache_.end()) {
+    return iter->second.symbol_;
+  }
+  return std::nullopt;
+}
+
+std::string_view SymbolCache::Insert(const uintptr_t key, std::string symbol) {
+  const auto [iter, inserted] = cache_.insert_or_assign(key, Symbol(std::move(symbol)));
+  return iter->second.symbol_;
+}
+
+SymbolCache::LookupResult SymbolCache::Lookup(const uintptr_t addr) {
+  const std::optional<std::string_view> symbol = Find(addr);
+  if (symbol.has_value()) {
+    return SymbolCache::LookupResult{symbol.value(), true};
   }
 
-  // If not in old cache, try the new cache (with automatic insertion if required).
+  // Not cached: symbolize and insert.
   const auto [iter, inserted] = cache_.try_emplace(addr, symbolizer_fn_, addr);
-  return SymbolCache::LookupResult{iter->second.symbol_, !inserted};
+  DCHECK(inserted);
+  return SymbolCache::LookupResult{iter->second.symbol_, false};
 }
 
 size_t SymbolCache::PerformEvictions() {
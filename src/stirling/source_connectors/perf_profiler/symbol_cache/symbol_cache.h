@@ -19,6 +19,7 @@
 #pragma once
 
 #include <functional>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -31,6 +32,7 @@ namespace stirling {
 
 class SymbolCache {
  public:
+  SymbolCache() = default;
   explicit SymbolCache(profiler::SymbolizerFn symbolizer_fn) : symbolizer_fn_(symbolizer_fn) {}
 
   struct LookupResult {
@@ -40,12 +42,25 @@ class SymbolCache {
 
   LookupResult Lookup(const uintptr_t addr);
 
+  /**
+   * Returns the symbol cached under key, without symbolizing on a miss.
+   * Used with Insert() when entries are keyed by something other than the address, for example
+   * by the file offset of the address in a shared object.
+   */
+  std::optional<std::string_view> Find(const uintptr_t key);
+
+  /**
+   * Caches symbol under key, and returns a view of the cached copy.
+   */
+  std::string_view Insert(const uintptr_t key, std::string symbol);
+
   size_t PerformEvictions();
 
   size_t active_entries() const { return cache_.size(); }
   size_t total_entries() const { return cache_.size() + prev_cache_.size(); }
 
   void set_symbolizer_fn(profiler::SymbolizerFn symbolizer_fn) { symbolizer_fn_ = symbolizer_fn; }
+  const profiler::SymbolizerFn& symbolizer_fn() const { return symbolizer_fn_; }
 
  private:
   /**
@@ -56,7 +71,7 @@ class SymbolCache {
    */
   class Symbol {
    public:
-    Symbol(profiler::SymbolizerFn symbolizer_fn, const uintptr_t addr);
+    Symbol(const profiler::SymbolizerFn& symbolizer_fn, const uintptr_t addr);
 
     // A move constructor that takes consumes a string.
     explicit Symbol(std::string&& symbol_str) : symbol_(std::move(symbol_str)) {}
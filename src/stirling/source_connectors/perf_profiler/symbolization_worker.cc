@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/perf_profiler/symbolization_worker.h"
+
+#include <utility>
+
+namespace px {
+namespace stirling {
+
+SymbolizationWorker::SymbolizationWorker(size_t max_pending_jobs)
+    : max_pending_jobs_(max_pending_jobs), thread_(&SymbolizationWorker::Run, this) {}
+
+SymbolizationWorker::~SymbolizationWorker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+    jobs_.clear();
+  }
+  job_available_.notify_one();
+  thread_.join();
+}
+
+bool SymbolizationWorker::Submit(Job job) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (jobs_.size() + (job_running_ ? 1 : 0) >= max_pending_jobs_) {
+      return false;
+    }
+    jobs_.push_back(std::move(job));
+  }
+  job_available_.notify_one();
+  return true;
+}
+
+void SymbolizationWorker::Drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_done_.wait(lock, [this] { return jobs_.empty() && !job_running_; });
+}
+
+size_t SymbolizationWorker::num_pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return jobs_.size() + (job_running_ ? 1 : 0);
+}
+
+void SymbolizationWorker::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    job_available_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+    if (stop_) {
+      break;
+    }
+
+    Job job = std::move(jobs_.front());
+    jobs_.pop_front();
+    job_running_ = true;
+
+    lock.unlock();
+    job();
+    lock.lock();
+
+    job_running_ = false;
+    job_done_.notify_all();
+  }
+  job_done_.notify_all();
+}
+
+}  // namespace stirling
+}  // namespace px
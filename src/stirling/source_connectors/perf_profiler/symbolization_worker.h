@@ -0,0 +1,79 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "src/common/base/mixins.h"
+
+namespace px {
+namespace stirling {
+
+// SymbolizationWorker runs symbolization jobs, in order, on a dedicated background thread.
+// It lets the perf profiler hand off the (potentially slow) symbolization of a batch of
+// stack traces, so that a burst of new addresses does not stall the Stirling core thread,
+// and with it, every other source connector.
+//
+// Jobs run one at a time, in submission order: the symbolizers and their caches are not
+// thread-safe, so all accesses to them must be serialized on the worker thread.
+//
+// The number of pending jobs is bounded; Submit() rejects jobs rather than grow the backlog
+// if symbolization cannot keep up.
+class SymbolizationWorker : NotCopyMoveable {
+ public:
+  using Job = std::function<void()>;
+
+  explicit SymbolizationWorker(size_t max_pending_jobs);
+
+  // Waits for the running job to complete. Pending jobs are discarded.
+  ~SymbolizationWorker();
+
+  // Queues a job. Returns false, without queuing it, if max_pending_jobs are already pending.
+  bool Submit(Job job);
+
+  // Blocks until all submitted jobs have completed.
+  void Drain();
+
+  // The number of jobs that are queued or running.
+  size_t num_pending() const;
+
+ private:
+  void Run();
+
+  const size_t max_pending_jobs_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable job_available_;
+  std::condition_variable job_done_;
+
+  // Guarded by mutex_.
+  std::deque<Job> jobs_;
+  bool job_running_ = false;
+  bool stop_ = false;
+
+  std::thread thread_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <future>
+#include <vector>
+
+#include "src/stirling/source_connectors/perf_profiler/symbolization_worker.h"
+
+namespace px {
+namespace stirling {
+
+TEST(SymbolizationWorker, RunsJobsInOrder) {
+  SymbolizationWorker worker(/*max_pending_jobs*/ 16);
+
+  std::vector<int> order;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(worker.Submit([&order, i] { order.push_back(i); }));
+  }
+  worker.Drain();
+
+  EXPECT_EQ(order, std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+  EXPECT_EQ(worker.num_pending(), 0);
+}
+
+TEST(SymbolizationWorker, RejectsJobsWhenBacklogIsFull) {
+  SymbolizationWorker worker(/*max_pending_jobs*/ 2);
+
+  // Block the worker thread until the test releases it.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::atomic<int> num_run = 0;
+
+  ASSERT_TRUE(worker.Submit([released, &num_run] {
+    released.wait();
+    ++num_run;
+  }));
+  ASSERT_TRUE(worker.Submit([&num_run] { ++num_run; }));
+  EXPECT_FALSE(worker.Submit([&num_run] { ++num_run; }));
+  EXPECT_EQ(worker.num_pending(), 2);
+
+  release.set_value();
+  worker.Drain();
+
+  EXPECT_EQ(num_run, 2);
+  EXPECT_TRUE(worker.Submit([&num_run] { ++num_run; }));
+  worker.Drain();
+  EXPECT_EQ(num_run, 3);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
@@ -37,6 +38,12 @@ class BCCSymbolizer : public Symbolizer, public NotCopyMoveable {
   void DeleteUPID(const struct upid_t& upid) override;
   bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
 
+  // BCC resolves each address relative to the module that contains it.
+  bool ResolvesObjectSymbols(const struct upid_t& /*upid*/,
+                             std::string_view /*object_path*/) override {
+    return true;
+  }
+
  private:
   BCCSymbolizer() = default;
   bpf_tools::BCCSymbolizer bcc_symbolizer_;
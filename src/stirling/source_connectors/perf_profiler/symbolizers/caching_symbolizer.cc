@@ -16,7 +16,11 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <algorithm>
+#include <optional>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <absl/functional/bind_front.h>
 
@@ -25,6 +29,8 @@
 DEFINE_uint64(
     stirling_profiler_cache_eviction_threshold, 1000,
     "Number of symbols in the current generation of the cache that triggers an eviction.");
+DEFINE_bool(stirling_profiler_shared_symbol_cache, true,
+            "If true, processes that map the same object file share cached symbols.");
 
 namespace px {
 namespace stirling {
@@ -39,6 +45,25 @@ StatusOr<std::unique_ptr<Symbolizer>> CachingSymbolizer::Create(
 
 void CachingSymbolizer::IterationPreTick() { symbolizer_->IterationPreTick(); }
 
+std::unique_ptr<ProcessObjectMappings> CachingSymbolizer::CreateObjectMappings(
+    const struct upid_t& upid, std::vector<system::ProcParser::ProcessSMaps> maps) {
+  // Objects whose symbols depend on the process (e.g. shared libraries for a symbolizer that only
+  // reads the main executable) stay out of the shared cache.
+  maps.erase(std::remove_if(maps.begin(), maps.end(),
+                            [&](const system::ProcParser::ProcessSMaps& map) {
+                              return !symbolizer_->ResolvesObjectSymbols(upid, map.pathname);
+                            }),
+             maps.end());
+  return std::make_unique<ProcessObjectMappings>(maps, &shared_symbol_cache_);
+}
+
+void CachingSymbolizer::testing_set_object_mappings(
+    const struct upid_t& upid, const std::vector<system::ProcParser::ProcessSMaps>& maps) {
+  auto iter = symbol_caches_.find(upid);
+  DCHECK(iter != symbol_caches_.end());
+  iter->second->object_mappings = CreateObjectMappings(upid, maps);
+}
+
 profiler::SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& upid) {
   if (symbolizer_->Uncacheable(upid)) {
     // NB: the normal cache eviction process will eventually zero out the memory used
@@ -53,12 +78,19 @@ profiler::SymbolizerFn CachingSymbolizer::GetSymbolizerFn(const struct upid_t& u
   auto symbolizer_fn = symbolizer_->GetSymbolizerFn(upid);
 
   if (inserted) {
-    iter->second = std::make_unique<SymbolCache>(symbolizer_fn);
+    iter->second = std::make_unique<UPIDSymbolCache>(symbolizer_fn);
+    const system::ProcParser proc_parser;
+    std::vector<system::ProcParser::ProcessSMaps> maps;
+    // Reading the maps fails for the kernel "process", and for processes that have exited.
+    if (FLAGS_stirling_profiler_shared_symbol_cache &&
+        proc_parser.ParseProcPIDMaps(upid.pid, &maps).ok()) {
+      iter->second->object_mappings = CreateObjectMappings(upid, std::move(maps));
+    }
   }
   auto& cache = iter->second;
 
   // TODO(jps): Remove this extra 'set_symbolizer_fn()' when we deprecate agent rate limiting.
-  cache->set_symbolizer_fn(symbolizer_fn);
+  cache->private_cache.set_symbolizer_fn(symbolizer_fn);
 
   auto fn = absl::bind_front(&CachingSymbolizer::Symbolize, this, cache.get());
   return fn;
@@ -77,38 +109,67 @@ size_t CachingSymbolizer::PerformEvictions() {
     return 0;
   }
 
-  size_t active_entries = 0;
+  size_t active_entries = shared_symbol_cache_.active_entries();
   for (const auto& sym_cache : symbol_caches_) {
-    active_entries += sym_cache.second->active_entries();
+    active_entries += sym_cache.second->private_cache.active_entries();
   }
 
   size_t evict_count = 0;
   if (active_entries > FLAGS_stirling_profiler_cache_eviction_threshold) {
+    evict_count += shared_symbol_cache_.PerformEvictions();
     for (const auto& sym_cache : symbol_caches_) {
-      evict_count += sym_cache.second->PerformEvictions();
+      evict_count += sym_cache.second->private_cache.PerformEvictions();
     }
   }
 
   return evict_count;
 }
 
-std::string_view CachingSymbolizer::Symbolize(SymbolCache* symbol_cache, const uintptr_t addr) {
+std::string_view CachingSymbolizer::Symbolize(UPIDSymbolCache* symbol_cache,
+                                              const uintptr_t addr) {
   ++stat_accesses_;
 
-  const SymbolCache::LookupResult result = symbol_cache->Lookup(addr);
+  const ProcessObjectMappings::Mapping* mapping = nullptr;
+  if (symbol_cache->object_mappings != nullptr) {
+    mapping = symbol_cache->object_mappings->Find(addr);
+  }
+
+  SymbolCache* shared_cache = nullptr;
+  uintptr_t file_offset = 0;
+  if (mapping != nullptr) {
+    shared_cache = mapping->cache;
+    file_offset = addr - mapping->vmem_start + mapping->file_offset;
+    const std::optional<std::string_view> symbol = shared_cache->Find(file_offset);
+    if (symbol.has_value()) {
+      ++stat_hits_;
+      return symbol.value();
+    }
+  }
 
-  if (result.hit) {
+  SymbolCache& private_cache = symbol_cache->private_cache;
+  const std::optional<std::string_view> symbol = private_cache.Find(addr);
+  if (symbol.has_value()) {
     ++stat_hits_;
+    return symbol.value();
+  }
+
+  // The symbolizer may return a view into a buffer that the next call overwrites: copy it now.
+  std::string symbol_str(private_cache.symbolizer_fn()(addr));
+
+  // Unresolved symbols embed the virtual address (or depend on how this process mapped the
+  // object), so they must not be served to other processes mapping the same object.
+  if (shared_cache != nullptr && !IsUnresolvedSymbol(symbol_str)) {
+    return shared_cache->Insert(file_offset, std::move(symbol_str));
   }
-  return result.symbol;
+  return private_cache.Insert(addr, std::move(symbol_str));
 }
 
 uint64_t CachingSymbolizer::GetNumberOfSymbolsCached() const {
   uint64_t n = 0;
   for (const auto& [upid, symbol_cache] : symbol_caches_) {
-    n += symbol_cache->total_entries();
+    n += symbol_cache->private_cache.total_entries();
   }
-  return n;
+  return n + shared_symbol_cache_.total_entries();
 }
 
 }  // namespace stirling
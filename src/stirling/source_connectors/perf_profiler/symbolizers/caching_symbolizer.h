@@ -19,17 +19,27 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
+#include <vector>
 
+#include "src/stirling/source_connectors/perf_profiler/symbol_cache/shared_symbol_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/symbol_cache/symbol_cache.h"
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/symbolizer.h"
 
 DECLARE_uint64(stirling_profiler_cache_eviction_threshold);
+DECLARE_bool(stirling_profiler_shared_symbol_cache);
 
 namespace px {
 namespace stirling {
 
 /**
  * A class that takes another symbolizer and adds a cache to it.
+ *
+ * Addresses in file-backed executable mappings are cached by (object file, file offset) in a
+ * SharedSymbolCache, so processes running the same binary share their symbols.
+ * Only symbols that the inner symbolizer resolved relative to the object are shared; unresolved
+ * address fallbacks, objects the inner symbolizer cannot resolve on their own, JIT code, and
+ * objects mapped after the process was first seen are cached per process.
  */
 class CachingSymbolizer : public Symbolizer {
  public:
@@ -45,15 +55,37 @@ class CachingSymbolizer : public Symbolizer {
   int64_t stat_hits() const { return stat_hits_; }
   uint64_t GetNumberOfSymbolsCached() const;
   bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
+  bool ResolvesObjectSymbols(const struct upid_t& upid, std::string_view object_path) override {
+    return symbolizer_->ResolvesObjectSymbols(upid, object_path);
+  }
+
+  // Replaces the object mappings read from /proc/<pid>/maps when GetSymbolizerFn(upid) first ran.
+  void testing_set_object_mappings(const struct upid_t& upid,
+                                   const std::vector<system::ProcParser::ProcessSMaps>& maps);
 
  private:
   CachingSymbolizer() = default;
 
-  std::string_view Symbolize(SymbolCache* symbol_cache, const uintptr_t addr);
+  struct UPIDSymbolCache {
+    // Caches symbols of addresses not covered by object_mappings, and unresolved symbols.
+    SymbolCache private_cache;
+    // Null if the shared cache is disabled, or the process mappings could not be read.
+    std::unique_ptr<ProcessObjectMappings> object_mappings;
+
+    explicit UPIDSymbolCache(profiler::SymbolizerFn symbolizer_fn)
+        : private_cache(std::move(symbolizer_fn)) {}
+  };
+
+  std::unique_ptr<ProcessObjectMappings> CreateObjectMappings(
+      const struct upid_t& upid, std::vector<system::ProcParser::ProcessSMaps> maps);
+  std::string_view Symbolize(UPIDSymbolCache* symbol_cache, const uintptr_t addr);
 
   std::unique_ptr<Symbolizer> symbolizer_;
 
-  absl::flat_hash_map<struct upid_t, std::unique_ptr<SymbolCache>> symbol_caches_;
+  // Declared before symbol_caches_, so that it outlives the object mappings referencing it.
+  SharedSymbolCache shared_symbol_cache_;
+
+  absl::flat_hash_map<struct upid_t, std::unique_ptr<UPIDSymbolCache>> symbol_caches_;
 
   int64_t stat_accesses_ = 0;
   int64_t stat_hits_ = 0;
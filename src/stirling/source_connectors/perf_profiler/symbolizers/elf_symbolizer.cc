@@ -16,10 +16,14 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <filesystem>
 #include <memory>
+#include <optional>
+#include <string>
 #include <utility>
 
 #include <absl/functional/bind_front.h>
+#include <absl/strings/str_replace.h>
 
 #include "src/common/base/base.h"
 #include "src/common/system/proc_pid_path.h"
@@ -28,7 +32,12 @@
 #include "src/stirling/source_connectors/perf_profiler/symbolizers/elf_symbolizer.h"
 #include "src/stirling/utils/proc_path_tools.h"
 
+DEFINE_string(stirling_profiler_symbol_index_dir, "",
+              "If set, the symbol indexes of binaries are saved to this directory, keyed by "
+              "build-id, and memory mapped rather than rebuilt when the binary is seen again.");
+
 using ::px::stirling::obj_tools::ElfReader;
+using ::px::stirling::obj_tools::SymbolIndex;
 using ::px::system::ProcPidRootPath;
 
 namespace px {
@@ -42,6 +51,43 @@ StatusOr<std::unique_ptr<Symbolizer>> ElfSymbolizer::Create() {
 
 void ElfSymbolizer::DeleteUPID(const struct upid_t& upid) { symbolizers_.erase(upid); }
 
+namespace {
+
+// Returns the path at which the symbol index of the binary is saved, if the binary has a build-id.
+std::optional<std::filesystem::path> SymbolIndexPath(ElfReader* elf_reader) {
+  if (FLAGS_stirling_profiler_symbol_index_dir.empty()) {
+    return std::nullopt;
+  }
+  StatusOr<std::string> build_id = elf_reader->BuildID();
+  if (!build_id.ok()) {
+    return std::nullopt;
+  }
+  // Go build IDs contain slashes.
+  std::string file_name = absl::StrReplaceAll(build_id.ValueOrDie(), {{"/", "_"}});
+  return std::filesystem::path(FLAGS_stirling_profiler_symbol_index_dir) / (file_name + ".symidx");
+}
+
+StatusOr<std::unique_ptr<ElfReader::Symbolizer>> GetBinarySymbolizer(ElfReader* elf_reader) {
+  std::optional<std::filesystem::path> index_path = SymbolIndexPath(elf_reader);
+  if (index_path.has_value() && std::filesystem::exists(index_path.value())) {
+    StatusOr<std::unique_ptr<SymbolIndex>> index = SymbolIndex::Open(index_path.value());
+    if (index.ok()) {
+      return std::make_unique<ElfReader::Symbolizer>(index.ConsumeValueOrDie());
+    }
+    VLOG(1) << absl::Substitute("Rebuilding symbol index $0: $1", index_path->string(),
+                                index.msg());
+  }
+
+  PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
+  if (index_path.has_value()) {
+    Status s = symbolizer->index().Save(index_path.value());
+    LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to save symbol index: $0", s.msg());
+  }
+  return symbolizer;
+}
+
+}  // namespace
+
 StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>> CreateUPIDSymbolizer(
     const struct upid_t& upid) {
   const pid_t pid = upid.pid;
@@ -49,7 +95,7 @@ StatusOr<std::unique_ptr<ElfSymbolizer::SymbolizerWithConverter>> CreateUPIDSymb
   PX_ASSIGN_OR_RETURN(const auto proc_exe, proc_parser.GetExePath(pid));
   PX_ASSIGN_OR_RETURN(auto elf_reader, ElfReader::Create(ProcPidRootPath(pid, proc_exe.string())));
 
-  PX_ASSIGN_OR_RETURN(auto symbolizer, elf_reader->GetSymbolizer());
+  PX_ASSIGN_OR_RETURN(auto symbolizer, GetBinarySymbolizer(elf_reader.get()));
   PX_ASSIGN_OR_RETURN(auto converter,
                       obj_tools::ElfAddressConverter::Create(elf_reader.get(), pid));
   return std::make_unique<ElfSymbolizer::SymbolizerWithConverter>(std::move(symbolizer),
@@ -85,6 +131,13 @@ profiler::SymbolizerFn ElfSymbolizer::GetSymbolizerFn(const struct upid_t& upid)
                           symbolizer_with_converter.get());
 }
 
+bool ElfSymbolizer::ResolvesObjectSymbols(const struct upid_t& upid,
+                                          std::string_view object_path) {
+  const system::ProcParser proc_parser;
+  StatusOr<std::filesystem::path> proc_exe = proc_parser.GetExePath(upid.pid);
+  return proc_exe.ok() && proc_exe.ValueOrDie().string() == object_path;
+}
+
 std::string_view ElfSymbolizer::SymbolizerWithConverter::Lookup(uint64_t virtual_addr) const {
   auto binary_addr = converter_->VirtualAddrToBinaryAddr(virtual_addr);
   return symbolizer_->Lookup(binary_addr);
@@ -19,6 +19,7 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 #include <utility>
 
 #include "src/stirling/obj_tools/address_converter.h"
@@ -39,6 +40,10 @@ class ElfSymbolizer : public Symbolizer, public NotCopyMoveable {
   void DeleteUPID(const struct upid_t& upid) override;
   bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
 
+  // Only the main executable is symbolized; addresses in shared libraries are translated with the
+  // executable's address converter, and their symbols are meaningless outside this process.
+  bool ResolvesObjectSymbols(const struct upid_t& upid, std::string_view object_path) override;
+
   class SymbolizerWithConverter {
    public:
     SymbolizerWithConverter(std::unique_ptr<obj_tools::ElfReader::Symbolizer> symbolizer,
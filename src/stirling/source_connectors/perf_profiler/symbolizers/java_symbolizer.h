@@ -20,6 +20,7 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "src/stirling/source_connectors/perf_profiler/java/attach.h"
@@ -75,6 +76,11 @@ class JavaSymbolizer : public Symbolizer {
   void DeleteUPID(const struct upid_t& upid) override;
   bool Uncacheable(const struct upid_t& upid) override;
 
+  // Java symbols come from anonymous (JIT) mappings, so object symbols are the native ones.
+  bool ResolvesObjectSymbols(const struct upid_t& upid, std::string_view object_path) override {
+    return native_symbolizer_->ResolvesObjectSymbols(upid, object_path);
+  }
+
  private:
   JavaSymbolizer() = delete;
   explicit JavaSymbolizer(std::string&& agent_libs);
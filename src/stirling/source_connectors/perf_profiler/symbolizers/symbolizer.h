@@ -20,8 +20,11 @@
 
 #include <memory>
 #include <string>
+#include <string_view>
 #include <utility>
 
+#include <absl/strings/match.h>
+
 #include "src/stirling/bpf_tools/bcc_symbolizer.h"
 #include "src/stirling/bpf_tools/bcc_wrapper.h"
 #include "src/stirling/obj_tools/elf_reader.h"
@@ -63,7 +66,23 @@ class Symbolizer : public NotCopyable {
    * Indicates that underlying symbols cannot be cached because they are subject to change.
    */
   virtual bool Uncacheable(const struct upid_t& upid) = 0;
+
+  /**
+   * Indicates that the symbols this symbolizer returns for addresses in the object mapped from
+   * object_path (as named in /proc/<pid>/maps) depend only on the object, and not on the process
+   * or where it mapped the object. Only such symbols may be shared across processes.
+   */
+  virtual bool ResolvesObjectSymbols(const struct upid_t& upid, std::string_view object_path) = 0;
 };
 
+/**
+ * Returns true if symbol is a fallback for an address that could not be resolved,
+ * e.g. "0x00007f0012345678" or "[m] /lib/libc.so.6 + 0x00001234".
+ * Fallbacks typically embed the virtual address, so they are specific to one process.
+ */
+inline bool IsUnresolvedSymbol(std::string_view symbol) {
+  return absl::StartsWith(symbol, "0x") || absl::StartsWith(symbol, "[m] ");
+}
+
 }  // namespace stirling
 }  // namespace px
@@ -21,6 +21,10 @@
 #include <gtest/gtest.h>
 
 #include <set>
+#include <utility>
+
+#include <absl/functional/bind_front.h>
+#include <absl/strings/str_format.h>
 
 #include "src/common/exec/subprocess.h"
 #include "src/common/fs/fs_wrapper.h"
@@ -470,6 +474,107 @@ TEST_F(BCCSymbolizerTest, Caching) {
   }
 }
 
+namespace {
+
+constexpr std::string_view kProcessSpecificObject = "/lib/process_specific.so";
+
+// Resolves the addresses it was told about, and otherwise falls back to the address in hex,
+// like the real symbolizers. Symbols in kProcessSpecificObject are not object relative.
+class FakeSymbolizer : public Symbolizer {
+ public:
+  profiler::SymbolizerFn GetSymbolizerFn(const struct upid_t& upid) override {
+    return absl::bind_front(&FakeSymbolizer::Symbolize, this, upid.pid);
+  }
+  void IterationPreTick() override {}
+  void DeleteUPID(const struct upid_t& /*upid*/) override {}
+  bool Uncacheable(const struct upid_t& /*upid*/) override { return false; }
+  bool ResolvesObjectSymbols(const struct upid_t& /*upid*/,
+                             std::string_view object_path) override {
+    return object_path != kProcessSpecificObject;
+  }
+
+  void AddSymbol(uint32_t pid, uintptr_t addr, std::string symbol) {
+    symbols_[{pid, addr}] = std::move(symbol);
+  }
+
+ private:
+  std::string_view Symbolize(uint32_t pid, uintptr_t addr) {
+    auto iter = symbols_.find(std::make_pair(pid, addr));
+    if (iter != symbols_.end()) {
+      return iter->second;
+    }
+    fallback_ = absl::StrFormat("0x%016llx", addr);
+    return fallback_;
+  }
+
+  absl::flat_hash_map<std::pair<uint32_t, uintptr_t>, std::string> symbols_;
+  std::string fallback_;
+};
+
+system::ProcParser::ProcessSMaps MakeObjectMap(uint64_t start, uint64_t end, uint64_t inode,
+                                               std::string pathname) {
+  system::ProcParser::ProcessSMaps map;
+  map.vmem_start = start;
+  map.vmem_end = end;
+  map.permissions = "r-xp";
+  map.offset = "00001000";
+  map.dev = "103:02";
+  map.inode = inode;
+  map.pathname = std::move(pathname);
+  return map;
+}
+
+}  // namespace
+
+// Two processes map the same objects at different addresses. Only symbols resolved relative to
+// the object are shared; address fallbacks and process-specific symbols stay per process.
+TEST(CachingSymbolizerTest, SharesOnlyObjectRelativeSymbols) {
+  auto fake_symbolizer_uptr = std::make_unique<FakeSymbolizer>();
+  FakeSymbolizer& fake_symbolizer = *fake_symbolizer_uptr;
+  ASSERT_OK_AND_ASSIGN(std::unique_ptr<Symbolizer> symbolizer_uptr,
+                       CachingSymbolizer::Create(std::move(fake_symbolizer_uptr)));
+  CachingSymbolizer& symbolizer = *static_cast<CachingSymbolizer*>(symbolizer_uptr.get());
+
+  // PIDs beyond pid_max, so that no /proc/<pid>/maps is found for them.
+  const struct upid_t upid1 = {.pid = 1U << 30, .start_time_ticks = 0};
+  const struct upid_t upid2 = {.pid = (1U << 30) + 1, .start_time_ticks = 0};
+  auto symbolize1 = symbolizer.GetSymbolizerFn(upid1);
+  auto symbolize2 = symbolizer.GetSymbolizerFn(upid2);
+  symbolizer.testing_set_object_mappings(
+      upid1, {MakeObjectMap(0x10000, 0x20000, 42, "/lib/libfoo.so"),
+              MakeObjectMap(0x30000, 0x40000, 43, std::string(kProcessSpecificObject))});
+  symbolizer.testing_set_object_mappings(
+      upid2, {MakeObjectMap(0x70000, 0x80000, 42, "/lib/libfoo.so"),
+              MakeObjectMap(0x30000, 0x40000, 43, std::string(kProcessSpecificObject))});
+
+  fake_symbolizer.AddSymbol(upid1.pid, 0x10100, "foo()");
+  fake_symbolizer.AddSymbol(upid2.pid, 0x70100, "foo()");
+  fake_symbolizer.AddSymbol(upid1.pid, 0x30100, "bar() in process 1");
+  fake_symbolizer.AddSymbol(upid2.pid, 0x30100, "bar() in process 2");
+
+  // A resolved symbol is shared by the other process.
+  EXPECT_EQ(symbolize1(0x10100), "foo()");
+  EXPECT_EQ(symbolizer.stat_hits(), 0);
+  EXPECT_EQ(symbolize2(0x70100), "foo()");
+  EXPECT_EQ(symbolizer.stat_hits(), 1);
+
+  // The same file offset is unresolved: each process gets its own fallback.
+  EXPECT_EQ(symbolize1(0x10200), "0x0000000000010200");
+  EXPECT_EQ(symbolizer.stat_hits(), 1);
+  EXPECT_EQ(symbolize2(0x70200), "0x0000000000070200");
+  EXPECT_EQ(symbolizer.stat_hits(), 1);
+  EXPECT_EQ(symbolize1(0x10200), "0x0000000000010200");
+  EXPECT_EQ(symbolizer.stat_hits(), 2);
+
+  // Symbols of an object the symbolizer does not resolve on its own are not shared.
+  EXPECT_EQ(symbolize1(0x30100), "bar() in process 1");
+  EXPECT_EQ(symbolize2(0x30100), "bar() in process 2");
+  EXPECT_EQ(symbolizer.stat_hits(), 2);
+
+  EXPECT_EQ(symbolizer.stat_accesses(), 7);
+  EXPECT_EQ(symbolizer.GetNumberOfSymbolsCached(), 5);
+}
+
 // Expect that upids for Java processes (that we attempt to symbolize) are inserted to global set.
 TEST_F(BCCSymbolizerTest, JavaProcessBeingTracked) {
   PX_SET_FOR_SCOPE(FLAGS_stirling_profiler_java_agent_libs, GetAgentLibsFlagValueForTesting());
@@ -137,7 +137,7 @@ void ProcExitConnector::TransferDataImpl(ConnectorContext* ctx) {
 
 void ProcExitConnector::UpdateCrashedJavaProcCounters(
     uint32_t asid, const proc_exit_event_t& event,
-    const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& upid_pid_info_map) {
+    const absl::flat_hash_map<md::UPID, md::PIDInfoSPtr>& upid_pid_info_map) {
   const uint8_t exit_signal = GetExitSignal(event.exit_code);
 
   const bool is_sig_abrt = exit_signal == SIGABRT;
@@ -18,15 +18,27 @@
 
 #include "src/stirling/source_connectors/process_stats/process_stats_connector.h"
 
+#include <sys/resource.h>
+
+#include <algorithm>
 #include <chrono>
 #include <filesystem>
 #include <iostream>
 #include <string>
+#include <vector>
+
+#include <absl/container/flat_hash_map.h>
 
 #include "src/common/base/base.h"
 #include "src/common/system/proc_parser.h"
 #include "src/shared/metadata/metadata.h"
 
+DEFINE_uint32(stirling_process_stats_threads, 1,
+              "The number of threads across which process stats are read from /proc.");
+DEFINE_uint32(stirling_process_stats_max_open_files, 2048,
+              "The maximum number of /proc files that process stats keeps open between samples. "
+              "Further limited to a quarter of the process's file descriptor limit.");
+
 namespace px {
 namespace stirling {
 
@@ -35,6 +47,17 @@ using system::ProcParser;
 Status ProcessStatsConnector::InitImpl() {
   sampling_freq_mgr_.set_period(kSamplingPeriod);
   push_freq_mgr_.set_period(kPushPeriod);
+
+  size_t max_open_files = FLAGS_stirling_process_stats_max_open_files;
+  struct rlimit nofile_limit;
+  if (getrlimit(RLIMIT_NOFILE, &nofile_limit) == 0 && nofile_limit.rlim_cur != RLIM_INFINITY) {
+    // The rest of Stirling needs descriptors too (perf buffers, BPF maps, sockets), so the cached
+    // /proc files may only take a fraction of them.
+    max_open_files = std::min<size_t>(max_open_files, nofile_limit.rlim_cur / 4);
+  }
+  proc_stat_reader_ = std::make_unique<system::ProcStatReader>(system::ProcStatReader::Options{
+      .max_open_files = max_open_files,
+      .num_threads = FLAGS_stirling_process_stats_threads});
   return Status::OK();
 }
 
@@ -42,56 +65,83 @@ Status ProcessStatsConnector::StopImpl() { return Status::OK(); }
 
 void ProcessStatsConnector::TransferProcessStatsTable(ConnectorContext* ctx,
                                                       DataTable* data_table) {
-  const absl::flat_hash_map<md::UPID, md::PIDInfoUPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
+  const absl::flat_hash_map<md::UPID, md::PIDInfoSPtr>& pid_info_by_upid = ctx->GetPIDInfoMap();
 
   int64_t timestamp = AdjustedSteadyClockNowNS();
 
+  std::vector<md::UPID> upids;
+  std::vector<int32_t> pids;
+  // Index into upids and pids of the UPID chosen for each PID.
+  absl::flat_hash_map<int32_t, size_t> pid_idx;
   for (const auto& [upid, pid_info] : pid_info_by_upid) {
     // TODO(zasgar): Fix condition for dead pids after helper function is added.
     if (pid_info == nullptr || pid_info->stop_time_ns() > 0) {
       // PID has been stopped.
       continue;
     }
-
-    ProcParser::ProcessStats stats;
-    int32_t pid = upid.pid();
-    // TODO(zasgar): We should double check the process start time to make sure it still the same
-    // PID.
-    auto s1 =
-        proc_parser_->ParseProcPIDStat(pid, system::Config::GetInstance().PageSizeBytes(),
-                                       system::Config::GetInstance().KernelTickTimeNS(), &stats);
-    if (!s1.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch cpu stat info for PID ($0). Error=\"$1\" skipping.", pid, s1.msg());
+    // A stale UPID can share its PID with a live one, but the reader requires distinct PIDs.
+    // The process that currently has the PID is the one that started last.
+    auto [it, inserted] = pid_idx.try_emplace(upid.pid(), upids.size());
+    if (!inserted) {
+      if (upid.start_ts() > upids[it->second].start_ts()) {
+        upids[it->second] = upid;
+      }
       continue;
     }
+    upids.push_back(upid);
+    pids.push_back(upid.pid());
+  }
 
-    auto s2 = proc_parser_->ParseProcPIDStatIO(pid, &stats);
-    if (!s2.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to fetch IO stat info for PID ($0). Error=\"$1\" skipping.", pid, s2.msg());
+  // TODO(zasgar): We should double check the process start time to make sure it still the same
+  // PID.
+  std::vector<ProcParser::ProcessStats> all_stats;
+  std::vector<Status> statuses = proc_stat_reader_->ReadProcessStats(
+      pids, system::Config::GetInstance().PageSizeBytes(),
+      system::Config::GetInstance().KernelTickTimeNS(), &all_stats);
+  proc_stat_reader_->EndIteration();
+
+  struct UPIDStats {
+    md::UPID upid;
+    const ProcParser::ProcessStats* stats;
+  };
+  std::vector<UPIDStats> records;
+  records.reserve(upids.size());
+  for (size_t i = 0; i < upids.size(); ++i) {
+    if (!statuses[i].ok()) {
+      VLOG(1) << absl::Substitute("Failed to fetch stat info for PID ($0). Error=\"$1\" skipping.",
+                                  pids[i], statuses[i].msg());
       continue;
     }
-
-    DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, timestamp);
-    // TODO(oazizi): Enable version below, once rest of the agent supports tabletization.
-    //  DataTable::RecordBuilder<&kProcessStatsTable> r(data_table, upid.value(), timestamp);
-    r.Append<r.ColIndex("time_")>(timestamp);
-    // Tabletization key must also be appended as a column value.
-    // See note in RecordBuilder class.
-    r.Append<r.ColIndex("upid")>(upid.value());
-    r.Append<r.ColIndex("major_faults")>(stats.major_faults);
-    r.Append<r.ColIndex("minor_faults")>(stats.minor_faults);
-    r.Append<r.ColIndex("cpu_utime_ns")>(stats.utime_ns);
-    r.Append<r.ColIndex("cpu_ktime_ns")>(stats.ktime_ns);
-    r.Append<r.ColIndex("num_threads")>(stats.num_threads);
-    r.Append<r.ColIndex("vsize_bytes")>(stats.vsize_bytes);
-    r.Append<r.ColIndex("rss_bytes")>(stats.rss_bytes);
-    r.Append<r.ColIndex("rchar_bytes")>(stats.rchar_bytes);
-    r.Append<r.ColIndex("wchar_bytes")>(stats.wchar_bytes);
-    r.Append<r.ColIndex("read_bytes")>(stats.read_bytes);
-    r.Append<r.ColIndex("write_bytes")>(stats.write_bytes);
+    records.push_back({upids[i], &all_stats[i]});
   }
+
+  DataTable::ColumnarRecordBuilder<&kProcessStatsTable> r(data_table, records.size(), timestamp);
+  // TODO(oazizi): Tabletize by UPID, once rest of the agent supports tabletization.
+  r.FillColumn<r.ColIndex("time_")>(timestamp);
+  r.AppendColumn<r.ColIndex("upid")>(records,
+                                     [](const UPIDStats& rec) { return rec.upid.value(); });
+  r.AppendColumn<r.ColIndex("major_faults")>(
+      records, [](const UPIDStats& rec) { return rec.stats->major_faults; });
+  r.AppendColumn<r.ColIndex("minor_faults")>(
+      records, [](const UPIDStats& rec) { return rec.stats->minor_faults; });
+  r.AppendColumn<r.ColIndex("cpu_utime_ns")>(
+      records, [](const UPIDStats& rec) { return rec.stats->utime_ns; });
+  r.AppendColumn<r.ColIndex("cpu_ktime_ns")>(
+      records, [](const UPIDStats& rec) { return rec.stats->ktime_ns; });
+  r.AppendColumn<r.ColIndex("num_threads")>(
+      records, [](const UPIDStats& rec) { return rec.stats->num_threads; });
+  r.AppendColumn<r.ColIndex("vsize_bytes")>(
+      records, [](const UPIDStats& rec) { return rec.stats->vsize_bytes; });
+  r.AppendColumn<r.ColIndex("rss_bytes")>(
+      records, [](const UPIDStats& rec) { return rec.stats->rss_bytes; });
+  r.AppendColumn<r.ColIndex("rchar_bytes")>(
+      records, [](const UPIDStats& rec) { return rec.stats->rchar_bytes; });
+  r.AppendColumn<r.ColIndex("wchar_bytes")>(
+      records, [](const UPIDStats& rec) { return rec.stats->wchar_bytes; });
+  r.AppendColumn<r.ColIndex("read_bytes")>(
+      records, [](const UPIDStats& rec) { return rec.stats->read_bytes; });
+  r.AppendColumn<r.ColIndex("write_bytes")>(
+      records, [](const UPIDStats& rec) { return rec.stats->write_bytes; });
 }
 
 void ProcessStatsConnector::TransferDataImpl(ConnectorContext* ctx) {
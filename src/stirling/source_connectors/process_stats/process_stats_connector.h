@@ -25,6 +25,7 @@
 #include <vector>
 
 #include "src/common/base/base.h"
+#include "src/common/system/proc_stat_reader.h"
 #include "src/common/system/system.h"
 #include "src/shared/metadata/metadata.h"
 #include "src/stirling/core/canonical_types.h"
@@ -57,14 +58,12 @@ class ProcessStatsConnector : public SourceConnector {
 
  protected:
   explicit ProcessStatsConnector(std::string_view source_name)
-      : SourceConnector(source_name, kTables) {
-    proc_parser_ = std::make_unique<system::ProcParser>();
-  }
+      : SourceConnector(source_name, kTables) {}
 
  private:
   void TransferProcessStatsTable(ConnectorContext* ctx, DataTable* data_table);
 
-  std::unique_ptr<system::ProcParser> proc_parser_;
+  std::unique_ptr<system::ProcStatReader> proc_stat_reader_;
 };
 
 }  // namespace stirling
@@ -110,6 +110,21 @@ BPF_PERCPU_ARRAY(conn_stats_event_buffer_heap, struct conn_stats_event_t, 1);
 // number of arrays with only 1 element.
 BPF_PERCPU_ARRAY(control_values, int64_t, kNumControlValues);
 
+// Per-protocol sampling policy. See sampling_config_t for the semantics of each field.
+// Written by user-space; read by BPF.
+BPF_PERCPU_ARRAY(sampling_config_map, struct sampling_config_t, kNumProtocols);
+
+// Per-process override of the protocol drop rate, in parts per kSampleRateScale.
+// Written by user-space; read by BPF.
+// Key is {tgid, start_time_ticks}.
+BPF_HASH(upid_sampling_map, struct upid_t, uint32_t, 1024);
+
+// Token buckets enforcing sampling_config_t::bytes_per_sec. Only accessed from BPF.
+BPF_PERCPU_ARRAY(sampling_bucket_map, struct sampling_bucket_t, kNumProtocols);
+
+// Counters of the data dropped by the sampling policy, read by user-space for reporting.
+BPF_PERCPU_ARRAY(sampling_stats_map, struct sampling_stats_t, kNumProtocols);
+
 /***********************************************************
  * General helper functions
  ***********************************************************/
@@ -220,6 +235,111 @@ static __inline bool should_trace_protocol_data(const struct conn_info_t* conn_i
   return control & conn_info->role;
 }
 
+static __inline bool should_sample_conn(const struct conn_info_t* conn_info) {
+  uint32_t drop_rate = 0;
+
+  struct upid_t upid = {};
+  upid.tgid = conn_info->conn_id.upid.tgid;
+  upid.start_time_ticks = conn_info->conn_id.upid.start_time_ticks;
+  uint32_t* upid_drop_rate = upid_sampling_map.lookup(&upid);
+  if (upid_drop_rate != NULL) {
+    drop_rate = *upid_drop_rate;
+  } else {
+    uint32_t protocol = conn_info->protocol;
+    struct sampling_config_t* config = sampling_config_map.lookup(&protocol);
+    if (config != NULL) {
+      drop_rate = config->drop_rate;
+    }
+  }
+
+  if (drop_rate == 0) {
+    return true;
+  }
+  return conn_sample_bucket(&conn_info->conn_id) >= drop_rate;
+}
+
+// Refills the protocol's per-CPU token bucket, and returns it.
+// Returns NULL if the protocol has no byte budget.
+static __inline struct sampling_bucket_t* refill_byte_budget(uint32_t protocol) {
+  struct sampling_config_t* config = sampling_config_map.lookup(&protocol);
+  if (config == NULL || config->bytes_per_sec == 0) {
+    return NULL;
+  }
+
+  struct sampling_bucket_t* bucket = sampling_bucket_map.lookup(&protocol);
+  if (bucket == NULL) {
+    return NULL;
+  }
+
+  const uint64_t kNanosPerSec = 1000000000ULL;
+  uint64_t now = bpf_ktime_get_ns();
+  uint64_t elapsed_ns = now - bucket->last_refill_ns;
+  // The bucket holds at most one second worth of budget, so longer idle periods add nothing.
+  // Capping also keeps the multiplication below from overflowing.
+  if (elapsed_ns > kNanosPerSec) {
+    elapsed_ns = kNanosPerSec;
+  }
+  uint64_t refill = elapsed_ns * config->bytes_per_sec / kNanosPerSec;
+  if (refill > 0) {
+    bucket->tokens += refill;
+    if (bucket->tokens > config->bytes_per_sec) {
+      bucket->tokens = config->bytes_per_sec;
+    }
+    bucket->last_refill_ns = now;
+  }
+  return bucket;
+}
+
+// Returns true if new connections of the protocol may be sampled.
+static __inline bool has_byte_budget(uint32_t protocol) {
+  struct sampling_bucket_t* bucket = refill_byte_budget(protocol);
+  return bucket == NULL || bucket->tokens > 0;
+}
+
+// Takes bytes_count tokens from the protocol's per-CPU bucket, down to zero.
+static __inline void charge_byte_budget(uint32_t protocol, size_t bytes_count) {
+  struct sampling_bucket_t* bucket = refill_byte_budget(protocol);
+  if (bucket == NULL) {
+    return;
+  }
+  bucket->tokens = bucket->tokens > bytes_count ? bucket->tokens - bytes_count : 0;
+}
+
+// Applies the sampling policy to bytes_count bytes of data on the connection,
+// and accounts for whatever is dropped.
+//
+// Connections are sampled as a whole: the decision is made on the first data of the connection,
+// so a connection is never cut off mid-stream. The byte budget limits how many new connections
+// are sampled, while all the data of sampled connections is charged to it.
+static __inline bool apply_sampling_policy(struct conn_info_t* conn_info, size_t bytes_count) {
+  uint32_t protocol = conn_info->protocol;
+
+  if (conn_info->sampling_decision == kSamplingUndecided) {
+    if (!should_sample_conn(conn_info)) {
+      conn_info->sampling_decision = kSampledOutByRate;
+    } else if (!has_byte_budget(protocol)) {
+      conn_info->sampling_decision = kSampledOutByBudget;
+    } else {
+      conn_info->sampling_decision = kSampled;
+    }
+  }
+
+  if (conn_info->sampling_decision == kSampled) {
+    charge_byte_budget(protocol, bytes_count);
+    return true;
+  }
+
+  struct sampling_stats_t* stats = sampling_stats_map.lookup(&protocol);
+  if (stats != NULL) {
+    if (conn_info->sampling_decision == kSampledOutByRate) {
+      stats->sampled_out_bytes += bytes_count;
+    } else {
+      stats->budget_dropped_bytes += bytes_count;
+    }
+  }
+  return false;
+}
+
 static __inline bool is_stirling_tgid(const uint32_t tgid) {
   int idx = kStirlingTGIDIndex;
   int64_t* stirling_tgid = control_values.lookup(&idx);
@@ -638,7 +758,8 @@ static __inline void process_implicit_conn(struct pt_regs* ctx, uint64_t id,
 }
 
 static __inline bool should_send_data(uint32_t tgid, uint64_t conn_disabled_tsid,
-                                      bool force_trace_tgid, struct conn_info_t* conn_info) {
+                                      bool force_trace_tgid, struct conn_info_t* conn_info,
+                                      size_t bytes_count) {
   // Never trace stirling.
   if (is_stirling_tgid(tgid)) {
     return false;
@@ -649,8 +770,13 @@ static __inline bool should_send_data(uint32_t tgid, uint64_t conn_disabled_tsid
     return false;
   }
 
-  // Only trace data for protocols of interest, or if forced on.
-  return (force_trace_tgid || should_trace_protocol_data(conn_info));
+  // Forced tracing bypasses the protocol filter and the sampling policy.
+  if (force_trace_tgid) {
+    return true;
+  }
+
+  // Only trace data for protocols of interest, subject to the sampling policy.
+  return should_trace_protocol_data(conn_info) && apply_sampling_policy(conn_info, bytes_count);
 }
 
 static __inline void update_conn_stats(struct pt_regs* ctx, struct conn_info_t* conn_info,
@@ -745,7 +871,7 @@ static __inline void process_data(const bool vecs, struct pt_regs* ctx, uint64_t
       }
     }
 
-    if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info)) {
+    if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info, bytes_count)) {
       struct socket_data_event_t* event =
           fill_socket_data_event(args->source_fn, direction, conn_info);
       if (event == NULL) {
@@ -832,7 +958,7 @@ static __inline void process_syscall_sendfile(struct pt_regs* ctx, uint64_t id,
   uint64_t* conn_disabled_tsid_ptr = conn_disabled_map.lookup(&tgid_fd);
   uint64_t conn_disabled_tsid = (conn_disabled_tsid_ptr == NULL) ? 0 : *conn_disabled_tsid_ptr;
 
-  if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info)) {
+  if (should_send_data(tgid, conn_disabled_tsid, force_trace_tgid, conn_info, bytes_count)) {
     struct socket_data_event_t* event =
         fill_socket_data_event(kSyscallSendfile, kEgress, conn_info);
     if (event == NULL) {
@@ -28,6 +28,9 @@
 
 const char kControlMapName[] = "control_map";
 const char kControlValuesArrayName[] = "control_values";
+const char kSamplingConfigMapName[] = "sampling_config_map";
+const char kUPIDSamplingMapName[] = "upid_sampling_map";
+const char kSamplingStatsMapName[] = "sampling_stats_map";
 
 const int64_t kTraceAllTGIDs = -1;
 
@@ -41,6 +44,17 @@ union sockaddr_t {
   struct sockaddr_in6 in6;
 };
 
+// The sampling decision of a connection. Connections are sampled as a whole, so the decision is
+// made once, on the first data of the connection's protocol, and holds until the connection closes.
+enum sampling_decision_t {
+  kSamplingUndecided = 0,
+  kSampled,
+  // Sampled out by the sample rate of the connection's protocol or process.
+  kSampledOutByRate,
+  // Sampled out because the protocol's byte budget was exhausted when the connection started.
+  kSampledOutByBudget,
+};
+
 // This struct contains information collected when a connection is established,
 // via an accept() syscall.
 struct conn_info_t {
@@ -85,8 +99,53 @@ struct conn_info_t {
   size_t prev_count;
   char prev_buf[4];
   bool prepend_length_header;
+
+  // Whether the connection's data is traced, as decided by the sampling policy.
+  // See apply_sampling_policy().
+  enum sampling_decision_t sampling_decision;
+};
+
+// Sample rates are expressed in parts per kSampleRateScale.
+#define SAMPLE_RATE_SCALE 1000
+const uint32_t kSampleRateScale = SAMPLE_RATE_SCALE;
+
+// Per-protocol sampling policy, written by user-space and read by BPF.
+// The zero value traces everything, so protocols without a policy are unaffected.
+struct sampling_config_t {
+  // Fraction of connections, in parts per kSampleRateScale, whose data is not traced.
+  // Sampling is done per connection, so a traced connection never has sampling gaps.
+  uint32_t drop_rate;
+
+  // Maximum number of data bytes per second that each CPU sends to user-space for this protocol.
+  // The budget is only checked when a connection starts: connections are not sampled while the
+  // budget is exhausted, but the data of sampled connections is never dropped.
+  // Zero means unlimited.
+  uint64_t bytes_per_sec;
 };
 
+// Per-CPU token bucket used to enforce sampling_config_t::bytes_per_sec.
+struct sampling_bucket_t {
+  uint64_t tokens;
+  uint64_t last_refill_ns;
+};
+
+// Per-protocol counters of the data that was not sent to user-space because of sampling.
+struct sampling_stats_t {
+  // Data dropped because the connection was sampled out.
+  uint64_t sampled_out_bytes;
+  // Data dropped because the connection was sampled out by the protocol's byte budget.
+  uint64_t budget_dropped_bytes;
+};
+
+// Maps a connection to a bucket in [0, kSampleRateScale). A connection is traced if its bucket is
+// at or above the drop rate. Used by both BPF and user-space, so that both make the same decision.
+static inline uint32_t conn_sample_bucket(const struct conn_id_t* conn_id) {
+  uint64_t h = conn_id->tsid ^ ((uint64_t)conn_id->upid.tgid << 32) ^ (uint32_t)conn_id->fd;
+  // Fibonacci hashing spreads the low-entropy bits of the TSID across the upper word.
+  h *= 0x9E3779B97F4A7C15ULL;
+  return (uint32_t)(h >> 32) % SAMPLE_RATE_SCALE;
+}
+
 // This struct is a subset of conn_info_t. It is used to communicate connect/accept events.
 // See conn_info_t for descriptions of the members.
 struct conn_event_t {
@@ -166,6 +166,10 @@ void ConnTracker::AddDataEvent(std::unique_ptr<SocketDataEvent> event) {
     return;
   }
 
+  if (!ApplySamplingPolicy(event->msg.size(), event->attr.timestamp_ns)) {
+    return;
+  }
+
   switch (event->attr.direction) {
     case traffic_direction_t::kEgress: {
       send_data_.AddData(std::move(event));
@@ -269,6 +273,10 @@ void ConnTracker::AddHTTP2Header(std::unique_ptr<HTTP2HeaderEvent> hdr) {
     return;
   }
 
+  if (!ApplySamplingPolicy(hdr->name.size() + hdr->value.size(), hdr->attr.timestamp_ns)) {
+    return;
+  }
+
   UpdateTimestamps(hdr->attr.timestamp_ns);
 
   bool write_event = false;
@@ -346,6 +354,10 @@ void ConnTracker::AddHTTP2Data(std::unique_ptr<HTTP2DataEvent> data) {
     return;
   }
 
+  if (!ApplySamplingPolicy(data->payload.size(), data->attr.timestamp_ns)) {
+    return;
+  }
+
   UpdateTimestamps(data->attr.timestamp_ns);
 
   bool write_event = false;
@@ -421,6 +433,13 @@ void ConnTracker::Disable(std::string_view reason) {
   Reset();
 }
 
+bool ConnTracker::ApplySamplingPolicy(size_t num_bytes, uint64_t timestamp_ns) {
+  if (manager_ == nullptr) {
+    return true;
+  }
+  return manager_->ApplySamplingPolicy(this, num_bytes, timestamp_ns);
+}
+
 bool ConnTracker::AllEventsReceived() const {
   return close_info_.timestamp_ns != 0 &&
          stats_.Get(StatKey::kBytesSent) == close_info_.send_bytes &&
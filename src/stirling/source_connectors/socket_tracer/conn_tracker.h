@@ -36,6 +36,7 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.hpp"
 #include "src/stirling/source_connectors/socket_tracer/data_stream.h"
 #include "src/stirling/source_connectors/socket_tracer/fd_resolver.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/frame_arena.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/interface.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http2/http2_streams_container.h"
 #include "src/stirling/source_connectors/socket_tracer/socket_trace_bpf_tables.h"
@@ -251,6 +252,9 @@ class ConnTracker : NotCopyMoveable {
    * Processes the connection tracker, parsing raw events into frames,
    * and frames into record.
    *
+   * The records can be allocated from the frame arena of the tracker, so they must be consumed
+   * before the next call to Cleanup(), which may release the arena.
+   *
    * @tparam TRecordType the type of the entries to be parsed.
    * @return Vector of processed entries.
    */
@@ -318,6 +322,7 @@ class ConnTracker : NotCopyMoveable {
   endpoint_role_t role() const { return role_; }
   bool ssl() const { return ssl_; }
   ConnStatsTracker& conn_stats() { return conn_stats_; }
+  const protocols::FrameArena& frame_arena() const { return frame_arena_; }
 
   /**
    * Get remote IP endpoint of the connection.
@@ -540,6 +545,12 @@ class ConnTracker : NotCopyMoveable {
     } else {
       send_data_.CleanupFrames<TFrameType>(frame_size_limit_bytes, frame_expiry_timestamp);
       recv_data_.CleanupFrames<TFrameType>(frame_size_limit_bytes, frame_expiry_timestamp);
+
+      // Records have been appended by now, so once the frames are gone, nothing refers to the
+      // arena anymore, and all of it is freed at once.
+      if (send_data_.Frames<TFrameType>().empty() && recv_data_.Frames<TFrameType>().empty()) {
+        frame_arena_.Release();
+      }
     }
 
     auto* state = protocol_state<TStateType>();
@@ -589,6 +600,9 @@ class ConnTracker : NotCopyMoveable {
   void set_is_tracked_upid() { is_tracked_upid_ = true; }
   bool is_tracked_upid() const { return is_tracked_upid_; }
 
+  void set_sampled() { sampled_ = true; }
+  bool sampled() const { return sampled_; }
+
   template <typename TProtocolTraits>
   size_t MemUsage() const {
     using TFrameType = typename TProtocolTraits::frame_type;
@@ -641,6 +655,10 @@ class ConnTracker : NotCopyMoveable {
   // Called when any events were received for a connection.
   void CheckTracker();
 
+  // Applies the manager's sampling policy to incoming data.
+  // Returns false if the connection was sampled out, in which case the tracker is disabled.
+  bool ApplySamplingPolicy(size_t num_bytes, uint64_t timestamp_ns);
+
   void CheckProcForConnClose();
   void HandleInactivity();
   bool IsRemoteAddrInCluster(const std::vector<CIDRBlock>& cluster_cidrs);
@@ -651,6 +669,7 @@ class ConnTracker : NotCopyMoveable {
   template <typename TFrameType, typename TStateType>
   void DataStreamsToFrames() {
     auto state_ptr = protocol_state<TStateType>();
+    protocols::SetFrameResource(frame_arena_.resource(), state_ptr);
 
     DataStream* req_data_ptr = req_data();
     DCHECK_NE(req_data_ptr, nullptr);
@@ -681,6 +700,10 @@ class ConnTracker : NotCopyMoveable {
   // Used to disable ConnTrackers that are not part of the context.
   bool is_tracked_upid_ = false;
 
+  // Set once the sampling policy decided to trace this connection. Connections that are sampled
+  // out are disabled instead, so the decision is only made once per connection.
+  bool sampled_ = false;
+
   traffic_protocol_t protocol_ = kProtocolUnknown;
   endpoint_role_t role_ = kRoleUnknown;
   bool ssl_ = false;
@@ -690,6 +713,10 @@ class ConnTracker : NotCopyMoveable {
   uint64_t last_conn_stats_update_ = 0;
   bool final_conn_stats_reported_ = false;
 
+  // The memory that parsed frames are allocated from, for protocols that support it.
+  // Declared before the streams and the protocol state, so that it outlives their frames.
+  protocols::FrameArena frame_arena_;
+
   // The data collected by the stream, one per direction.
   DataStream send_data_;
   DataStream recv_data_;
@@ -489,6 +489,50 @@ TEST_F(ConnTrackerTest, MessagesErasedAfterExpiration) {
   EXPECT_THAT(tracker.req_frames<http::Message>(), IsEmpty());
 }
 
+// Tests that HTTP frames are allocated from the frame arena of the tracker, and that the arena is
+// released once all frames have been stitched and cleaned up.
+TEST_F(ConnTrackerTest, FrameArenaReleasedAfterCleanup) {
+  auto req0 = event_gen_.InitSendEvent<kProtocolHTTP>(kHTTPReq0);
+  auto resp0 = event_gen_.InitRecvEvent<kProtocolHTTP>(kHTTPResp0);
+  auto req1 = event_gen_.InitSendEvent<kProtocolHTTP>(kHTTPReq1);
+  auto resp1 = event_gen_.InitRecvEvent<kProtocolHTTP>(kHTTPResp1);
+
+  ConnTracker tracker;
+
+  int frame_size_limit_bytes = 10000;
+  int buffer_size_limit_bytes = 10000;
+  auto expiry_timestamp = now() - std::chrono::seconds(10000);
+
+  tracker.AddDataEvent(std::move(req0));
+  tracker.AddDataEvent(std::move(resp0));
+  tracker.AddDataEvent(std::move(req1));
+  std::vector<http::Record> records = tracker.ProcessToRecords<http::ProtocolTraits>();
+  ASSERT_THAT(records, SizeIs(1));
+  EXPECT_EQ(records[0].req.req_path, "/index.html");
+  EXPECT_EQ(records[0].resp.body, "pixie");
+  EXPECT_GT(tracker.frame_arena().bytes(), 0);
+  records.clear();
+
+  // The second request is still waiting for its response, so the arena is kept.
+  tracker.Cleanup<http::ProtocolTraits>(frame_size_limit_bytes, buffer_size_limit_bytes,
+                                        expiry_timestamp, expiry_timestamp);
+  EXPECT_THAT(tracker.req_frames<http::Message>(), SizeIs(1));
+  EXPECT_GT(tracker.frame_arena().bytes(), 0);
+
+  tracker.AddDataEvent(std::move(resp1));
+  records = tracker.ProcessToRecords<http::ProtocolTraits>();
+  ASSERT_THAT(records, SizeIs(1));
+  EXPECT_EQ(records[0].req.req_path, "/foo.html");
+  EXPECT_EQ(records[0].resp.body, "foo");
+  records.clear();
+
+  tracker.Cleanup<http::ProtocolTraits>(frame_size_limit_bytes, buffer_size_limit_bytes,
+                                        expiry_timestamp, expiry_timestamp);
+  EXPECT_THAT(tracker.req_frames<http::Message>(), IsEmpty());
+  EXPECT_THAT(tracker.resp_frames<http::Message>(), IsEmpty());
+  EXPECT_EQ(tracker.frame_arena().bytes(), 0);
+}
+
 // Tests that tracker state is kDisabled if the remote address is in the cluster's CIDR range.
 TEST_F(ConnTrackerTest, DisabledForIntraClusterRemoteEndpoint) {
   struct socket_control_event_t conn = event_gen_.InitConn();
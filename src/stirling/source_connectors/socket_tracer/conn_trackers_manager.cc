@@ -117,7 +117,14 @@ ConnTrackersManager::ConnTrackersManager()
       conn_tracker_destroyed_(BuildCounter("conn_tracker_destroyed",
                                            "Counter that tracks when a conn tracker is destroyed")),
       destroyed_gens_(BuildCounter(
-          "destroyed_gens", "Counter that tracks how many destroyed generations have occurred")) {}
+          "destroyed_gens", "Counter that tracks how many destroyed generations have occurred")),
+      conn_tracker_sampled_out_(BuildCounter(
+          "conn_tracker_sampled_out",
+          "Counter that tracks when a conn tracker is disabled by the sampling policy")),
+      conn_tracker_budget_sampled_out_(BuildCounter(
+          "conn_tracker_budget_sampled_out",
+          "Counter that tracks when a conn tracker is disabled because its protocol's byte budget "
+          "was exhausted")) {}
 
 ConnTracker& ConnTrackersManager::GetOrCreateConnTracker(struct conn_id_t conn_id) {
   const uint64_t conn_map_key = GetConnMapKey(conn_id.upid.pid, conn_id.fd);
@@ -159,6 +166,32 @@ StatusOr<const ConnTracker*> ConnTrackersManager::GetConnTracker(uint32_t pid, i
   return tracker_generations.GetActive();
 }
 
+bool ConnTrackersManager::ApplySamplingPolicy(ConnTracker* tracker, size_t num_bytes,
+                                              uint64_t timestamp_ns) {
+  traffic_protocol_t protocol = tracker->protocol();
+
+  // The decision is made on the first data of the connection, and holds for the rest of it,
+  // so sampled connections are traced without gaps.
+  if (!tracker->sampled()) {
+    if (!sampling_policy_.ShouldSample(tracker->conn_id(), protocol)) {
+      tracker->Disable("Sampled out by the sampling policy");
+      stats_.Increment(StatKey::kSampledOut);
+      conn_tracker_sampled_out_.Increment();
+      return false;
+    }
+    if (!sampling_policy_.HasByteBudget(protocol, timestamp_ns)) {
+      tracker->Disable("Sampled out because the protocol's byte budget is exhausted");
+      stats_.Increment(StatKey::kBudgetSampledOut);
+      conn_tracker_budget_sampled_out_.Increment();
+      return false;
+    }
+    tracker->set_sampled();
+  }
+
+  sampling_policy_.ChargeByteBudget(protocol, num_bytes, timestamp_ns);
+  return true;
+}
+
 void ConnTrackersManager::CleanupTrackers() {
   {
     auto iter = active_trackers_.begin();
@@ -30,6 +30,7 @@
 #include <prometheus/gauge.h>
 
 #include "src/stirling/source_connectors/socket_tracer/conn_tracker.h"
+#include "src/stirling/source_connectors/socket_tracer/sampling_policy.h"
 #include "src/stirling/utils/obj_pool.h"
 #include "src/stirling/utils/stat_counter.h"
 
@@ -98,6 +99,11 @@ class ConnTrackersManager {
     kCreated,
     kDestroyed,
     kDestroyedGens,
+
+    // Trackers disabled by the sampling policy.
+    kSampledOut,
+    // Trackers disabled because their protocol's byte budget was exhausted when they started.
+    kBudgetSampledOut,
   };
 
   ConnTrackersManager();
@@ -138,6 +144,23 @@ class ConnTrackersManager {
    */
   std::string StatsString() const;
 
+  /**
+   * The policy deciding which connections, and how much of their data, are traced.
+   * BPF enforces the same policy; see SocketTraceConnector::UpdateBPFSamplingPolicy().
+   */
+  ConnSamplingPolicy* sampling_policy() { return &sampling_policy_; }
+  const ConnSamplingPolicy& sampling_policy() const { return sampling_policy_; }
+
+  /**
+   * Applies the sampling policy to num_bytes of data arriving on the tracker at timestamp_ns.
+   * The first data of a tracker decides whether its connection is sampled; trackers of
+   * connections that are sampled out are disabled, which also stops BPF from sending their data.
+   * The data of sampled connections is charged to the byte budget, but never dropped.
+   *
+   * @return true if the data should be traced.
+   */
+  bool ApplySamplingPolicy(ConnTracker* tracker, size_t num_bytes, uint64_t timestamp_ns);
+
  private:
   // Simple consistency DCHECKs meant for enforcing invariants.
   void DebugChecks() const;
@@ -157,9 +180,13 @@ class ConnTrackersManager {
   utils::StatCounter<StatKey> stats_;
   utils::StatCounter<traffic_protocol_t> protocol_stats_;
 
+  ConnSamplingPolicy sampling_policy_;
+
   prometheus::Counter& conn_tracker_created_;
   prometheus::Counter& conn_tracker_destroyed_;
   prometheus::Counter& destroyed_gens_;
+  prometheus::Counter& conn_tracker_sampled_out_;
+  prometheus::Counter& conn_tracker_budget_sampled_out_;
 };
 
 }  // namespace stirling
@@ -112,6 +112,61 @@ TEST_F(ConnTrackersManagerTest, DebugInfo) {
   EXPECT_THAT(debug_info, HasSubstr("conn_tracker=conn_id=[upid=1:1 fd=1 gen=1]"));
 }
 
+TEST_F(ConnTrackersManagerTest, SamplingPolicy) {
+  struct conn_id_t conn_id = {};
+  conn_id.upid.pid = 1;
+  conn_id.upid.start_time_ticks = 1;
+  conn_id.fd = 1;
+  conn_id.tsid = 1;
+
+  ConnTracker& sampled_tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  sampled_tracker.SetProtocol(kProtocolHTTP, "for testing");
+  EXPECT_TRUE(trackers_mgr_.ApplySamplingPolicy(&sampled_tracker, 100, 0));
+
+  // Changing the rate does not affect connections that are already sampled.
+  trackers_mgr_.sampling_policy()->SetProtocolSampleRate(kProtocolHTTP, 0.0);
+  EXPECT_TRUE(trackers_mgr_.ApplySamplingPolicy(&sampled_tracker, 100, 0));
+
+  conn_id.fd = 2;
+  ConnTracker& tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  tracker.SetProtocol(kProtocolHTTP, "for testing");
+  EXPECT_FALSE(trackers_mgr_.ApplySamplingPolicy(&tracker, 100, 0));
+  EXPECT_EQ(tracker.state(), ConnTracker::State::kDisabled);
+  EXPECT_THAT(trackers_mgr_.StatsString(), HasSubstr("kSampledOut=1 "));
+}
+
+TEST_F(ConnTrackersManagerTest, ByteBudgetSamplesWholeConnections) {
+  constexpr uint64_t kNanosPerSec = 1000 * 1000 * 1000;
+
+  struct conn_id_t conn_id = {};
+  conn_id.upid.pid = 1;
+  conn_id.upid.start_time_ticks = 1;
+  conn_id.fd = 1;
+  conn_id.tsid = 1;
+
+  trackers_mgr_.sampling_policy()->SetProtocolByteBudget(kProtocolHTTP, 100);
+
+  ConnTracker& sampled_tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  sampled_tracker.SetProtocol(kProtocolHTTP, "for testing");
+  // Exceeding the budget does not cut off a connection that is already traced.
+  EXPECT_TRUE(trackers_mgr_.ApplySamplingPolicy(&sampled_tracker, 1000, kNanosPerSec));
+  EXPECT_TRUE(trackers_mgr_.ApplySamplingPolicy(&sampled_tracker, 1000, kNanosPerSec));
+  EXPECT_EQ(sampled_tracker.state(), ConnTracker::State::kCollecting);
+
+  // But new connections are not sampled until the budget refills.
+  conn_id.fd = 2;
+  ConnTracker& tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  tracker.SetProtocol(kProtocolHTTP, "for testing");
+  EXPECT_FALSE(trackers_mgr_.ApplySamplingPolicy(&tracker, 10, kNanosPerSec));
+  EXPECT_EQ(tracker.state(), ConnTracker::State::kDisabled);
+  EXPECT_THAT(trackers_mgr_.StatsString(), HasSubstr("kBudgetSampledOut=1"));
+
+  conn_id.fd = 3;
+  ConnTracker& later_tracker = trackers_mgr_.GetOrCreateConnTracker(conn_id);
+  later_tracker.SetProtocol(kProtocolHTTP, "for testing");
+  EXPECT_TRUE(trackers_mgr_.ApplySamplingPolicy(&later_tracker, 10, 2 * kNanosPerSec));
+}
+
 class ConnTrackerGenerationsTest : public ::testing::Test {
  protected:
   ConnTrackerGenerationsTest() : tracker_pool(1024) {
@@ -0,0 +1,237 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scan.h"
+
+#include <cstring>
+
+#include "src/common/base/arch.h"
+#include "src/common/base/base.h"
+
+#if X86_64
+#include <immintrin.h>
+#endif
+
+namespace px {
+namespace stirling {
+namespace protocols {
+namespace byte_scan_internal {
+
+size_t FindFirstOfScalar(std::string_view buf, std::string_view chars, size_t start_pos) {
+  // A lookup table avoids rescanning chars for every byte of buf.
+  bool match[256] = {};
+  for (char c : chars) {
+    match[static_cast<uint8_t>(c)] = true;
+  }
+  for (size_t i = start_pos; i < buf.size(); ++i) {
+    if (match[static_cast<uint8_t>(buf[i])]) {
+      return i;
+    }
+  }
+  return std::string_view::npos;
+}
+
+size_t FindSubstrScalar(std::string_view buf, std::string_view pattern, size_t start_pos) {
+  return buf.find(pattern, start_pos);
+}
+
+#if X86_64
+
+bool HasSSE42() {
+  static const bool kHasSSE42 = __builtin_cpu_supports("sse4.2");
+  return kHasSSE42;
+}
+
+bool HasAVX2() {
+  static const bool kHasAVX2 = __builtin_cpu_supports("avx2");
+  return kHasAVX2;
+}
+
+__attribute__((target("sse4.2"))) size_t FindFirstOfSSE42(std::string_view buf,
+                                                          std::string_view chars,
+                                                          size_t start_pos) {
+  DCHECK_LE(chars.size(), kMaxFindFirstOfChars);
+  constexpr int kBlockSize = 16;
+  constexpr int kMode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_LEAST_SIGNIFICANT;
+
+  char chars_block[kBlockSize] = {};
+  memcpy(chars_block, chars.data(), chars.size());
+  const __m128i needles = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chars_block));
+  const int num_needles = static_cast<int>(chars.size());
+
+  size_t i = start_pos;
+  for (; i + kBlockSize <= buf.size(); i += kBlockSize) {
+    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf.data() + i));
+    const int idx = _mm_cmpestri(needles, num_needles, block, kBlockSize, kMode);
+    if (idx != kBlockSize) {
+      return i + idx;
+    }
+  }
+  return FindFirstOfScalar(buf, chars, i);
+}
+
+__attribute__((target("avx2"))) size_t FindFirstOfAVX2(std::string_view buf,
+                                                       std::string_view chars, size_t start_pos) {
+  DCHECK_LE(chars.size(), kMaxFindFirstOfChars);
+  constexpr size_t kBlockSize = 32;
+
+  __m256i needles[kMaxFindFirstOfChars];
+  for (size_t j = 0; j < chars.size(); ++j) {
+    needles[j] = _mm256_set1_epi8(chars[j]);
+  }
+
+  size_t i = start_pos;
+  for (; i + kBlockSize <= buf.size(); i += kBlockSize) {
+    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf.data() + i));
+    __m256i eq = _mm256_setzero_si256();
+    for (size_t j = 0; j < chars.size(); ++j) {
+      eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, needles[j]));
+    }
+    const uint32_t mask = _mm256_movemask_epi8(eq);
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return FindFirstOfScalar(buf, chars, i);
+}
+
+// Substring search that compares the first and last bytes of the pattern against a whole block of
+// candidate positions at once, and only runs a full comparison on positions where both match.
+// Requires pattern.size() >= 2.
+__attribute__((target("sse2"))) size_t FindSubstrSSE2(std::string_view buf,
+                                                      std::string_view pattern,
+                                                      size_t start_pos) {
+  if (pattern.size() < 2) {
+    return FindSubstrScalar(buf, pattern, start_pos);
+  }
+  constexpr size_t kBlockSize = 16;
+  const size_t k = pattern.size();
+  const __m128i first = _mm_set1_epi8(pattern.front());
+  const __m128i last = _mm_set1_epi8(pattern.back());
+
+  size_t i = start_pos;
+  for (; i + k - 1 + kBlockSize <= buf.size(); i += kBlockSize) {
+    const char* p = buf.data() + i;
+    const __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k - 1));
+    uint32_t mask = _mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last)));
+    while (mask != 0) {
+      const int bit = __builtin_ctz(mask);
+      if (memcmp(p + bit + 1, pattern.data() + 1, k - 2) == 0) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return FindSubstrScalar(buf, pattern, i);
+}
+
+__attribute__((target("avx2"))) size_t FindSubstrAVX2(std::string_view buf,
+                                                      std::string_view pattern,
+                                                      size_t start_pos) {
+  if (pattern.size() < 2) {
+    return FindSubstrScalar(buf, pattern, start_pos);
+  }
+  constexpr size_t kBlockSize = 32;
+  const size_t k = pattern.size();
+  const __m256i first = _mm256_set1_epi8(pattern.front());
+  const __m256i last = _mm256_set1_epi8(pattern.back());
+
+  size_t i = start_pos;
+  for (; i + k - 1 + kBlockSize <= buf.size(); i += kBlockSize) {
+    const char* p = buf.data() + i;
+    const __m256i block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + k - 1));
+    uint32_t mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, block_first),
+                                                          _mm256_cmpeq_epi8(last, block_last)));
+    while (mask != 0) {
+      const int bit = __builtin_ctz(mask);
+      if (memcmp(p + bit + 1, pattern.data() + 1, k - 2) == 0) {
+        return i + bit;
+      }
+      mask &= mask - 1;
+    }
+  }
+  return FindSubstrScalar(buf, pattern, i);
+}
+
+#else
+
+bool HasSSE42() { return false; }
+bool HasAVX2() { return false; }
+
+size_t FindFirstOfSSE42(std::string_view buf, std::string_view chars, size_t start_pos) {
+  return FindFirstOfScalar(buf, chars, start_pos);
+}
+
+size_t FindFirstOfAVX2(std::string_view buf, std::string_view chars, size_t start_pos) {
+  return FindFirstOfScalar(buf, chars, start_pos);
+}
+
+size_t FindSubstrSSE2(std::string_view buf, std::string_view pattern, size_t start_pos) {
+  return FindSubstrScalar(buf, pattern, start_pos);
+}
+
+size_t FindSubstrAVX2(std::string_view buf, std::string_view pattern, size_t start_pos) {
+  return FindSubstrScalar(buf, pattern, start_pos);
+}
+
+#endif
+
+}  // namespace byte_scan_internal
+
+size_t FindFirstOf(std::string_view buf, std::string_view chars, size_t start_pos) {
+  if (start_pos >= buf.size() || chars.empty()) {
+    return std::string_view::npos;
+  }
+  if (chars.size() > kMaxFindFirstOfChars) {
+    DCHECK(false) << absl::Substitute("Too many chars to search for: $0", chars.size());
+    return byte_scan_internal::FindFirstOfScalar(buf, chars, start_pos);
+  }
+
+  // Each additional char costs one compare per block in the AVX2 version, while the SSE4.2
+  // version handles up to 16 chars in a single instruction.
+  constexpr size_t kAVX2MaxChars = 8;
+  if (byte_scan_internal::HasAVX2() && chars.size() <= kAVX2MaxChars) {
+    return byte_scan_internal::FindFirstOfAVX2(buf, chars, start_pos);
+  }
+  if (byte_scan_internal::HasSSE42()) {
+    return byte_scan_internal::FindFirstOfSSE42(buf, chars, start_pos);
+  }
+  return byte_scan_internal::FindFirstOfScalar(buf, chars, start_pos);
+}
+
+size_t FindSubstr(std::string_view buf, std::string_view pattern, size_t start_pos) {
+  if (start_pos > buf.size()) {
+    return std::string_view::npos;
+  }
+  if (byte_scan_internal::HasAVX2()) {
+    return byte_scan_internal::FindSubstrAVX2(buf, pattern, start_pos);
+  }
+#if X86_64
+  // SSE2 is part of the x86-64 baseline.
+  return byte_scan_internal::FindSubstrSSE2(buf, pattern, start_pos);
+#else
+  return byte_scan_internal::FindSubstrScalar(buf, pattern, start_pos);
+#endif
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
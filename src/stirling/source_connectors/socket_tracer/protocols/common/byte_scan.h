@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string_view>
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * Byte scanning routines used to search for frame boundaries in the data stream buffer.
+ *
+ * On x86-64, vectorized implementations (AVX2, or SSE4.2/SSE2) are selected at runtime based on
+ * the CPU features; otherwise a scalar implementation is used. All implementations return
+ * identical results.
+ */
+
+inline constexpr size_t kMaxFindFirstOfChars = 16;
+
+/**
+ * Returns the position of the first byte at or after start_pos that matches any byte in chars,
+ * or std::string_view::npos if there is no such byte.
+ *
+ * @param chars The set of bytes to search for. Must contain at most kMaxFindFirstOfChars bytes.
+ */
+size_t FindFirstOf(std::string_view buf, std::string_view chars, size_t start_pos = 0);
+
+/**
+ * Returns the position of the first occurrence of pattern at or after start_pos,
+ * or std::string_view::npos if there is no such occurrence.
+ */
+size_t FindSubstr(std::string_view buf, std::string_view pattern, size_t start_pos = 0);
+
+namespace byte_scan_internal {
+
+// The individual implementations, exposed for tests and benchmarks.
+// The vectorized versions must only be called if the CPU supports the corresponding features.
+
+size_t FindFirstOfScalar(std::string_view buf, std::string_view chars, size_t start_pos);
+size_t FindSubstrScalar(std::string_view buf, std::string_view pattern, size_t start_pos);
+
+bool HasSSE42();
+bool HasAVX2();
+
+size_t FindFirstOfSSE42(std::string_view buf, std::string_view chars, size_t start_pos);
+size_t FindFirstOfAVX2(std::string_view buf, std::string_view chars, size_t start_pos);
+size_t FindSubstrSSE2(std::string_view buf, std::string_view pattern, size_t start_pos);
+size_t FindSubstrAVX2(std::string_view buf, std::string_view pattern, size_t start_pos);
+
+}  // namespace byte_scan_internal
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
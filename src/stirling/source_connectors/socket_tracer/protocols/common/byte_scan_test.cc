@@ -0,0 +1,101 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scan.h"
+
+#include <random>
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+using byte_scan_internal::FindFirstOfAVX2;
+using byte_scan_internal::FindFirstOfScalar;
+using byte_scan_internal::FindFirstOfSSE42;
+using byte_scan_internal::FindSubstrAVX2;
+using byte_scan_internal::FindSubstrScalar;
+using byte_scan_internal::FindSubstrSSE2;
+using byte_scan_internal::HasAVX2;
+using byte_scan_internal::HasSSE42;
+
+TEST(FindFirstOfTest, Basic) {
+  std::string_view buf = "GET / HTTP/1.1\r\n*3\r\n";
+  EXPECT_EQ(FindFirstOf(buf, "+-:$*"), 16);
+  EXPECT_EQ(FindFirstOf(buf, "+-:$*", 17), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf(buf, "\r"), 14);
+  EXPECT_EQ(FindFirstOf(buf, "\r", 15), 18);
+  EXPECT_EQ(FindFirstOf(buf, "xyz"), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf(buf, ""), std::string_view::npos);
+  EXPECT_EQ(FindFirstOf(buf, "G", buf.size()), std::string_view::npos);
+}
+
+TEST(FindSubstrTest, Basic) {
+  std::string_view buf = "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\nHTTP/1.1 200 OK\r\n\r\n";
+  EXPECT_EQ(FindSubstr(buf, "\r\n\r\n"), 34);
+  EXPECT_EQ(FindSubstr(buf, "\r\n\r\n", 35), 53);
+  EXPECT_EQ(FindSubstr(buf, "HTTP/1.1", 1), 38);
+  EXPECT_EQ(FindSubstr(buf, "HTTP/2"), std::string_view::npos);
+  EXPECT_EQ(FindSubstr(buf, "H", 1), 38);
+  EXPECT_EQ(FindSubstr(buf, "", 3), 3);
+  EXPECT_EQ(FindSubstr(buf, "\r\n", buf.size() + 1), std::string_view::npos);
+}
+
+// Checks all implementations against the scalar ones on random inputs,
+// including matches that straddle the vector block boundaries.
+TEST(ByteScanTest, ImplementationsAgree) {
+  std::default_random_engine rng(37);
+  constexpr std::string_view kAlphabet = "ab\r\n*$xyz";
+
+  auto random_string = [&](size_t len, std::string_view alphabet) {
+    std::string s(len, '\0');
+    for (auto& c : s) {
+      c = alphabet[rng() % alphabet.size()];
+    }
+    return s;
+  };
+
+  for (int i = 0; i < 10000; ++i) {
+    const std::string buf = random_string(rng() % 300, kAlphabet);
+    const std::string chars = random_string(1 + rng() % kMaxFindFirstOfChars, "abcdefghijklm*$");
+    const std::string pattern = random_string(rng() % 6, "ab\r\n");
+    const size_t start_pos = rng() % (buf.size() + 1);
+
+    const size_t expected_first_of = FindFirstOfScalar(buf, chars, start_pos);
+    EXPECT_EQ(FindFirstOf(buf, chars, start_pos), expected_first_of);
+    if (HasSSE42()) {
+      EXPECT_EQ(FindFirstOfSSE42(buf, chars, start_pos), expected_first_of);
+    }
+    if (HasAVX2()) {
+      EXPECT_EQ(FindFirstOfAVX2(buf, chars, start_pos), expected_first_of);
+    }
+
+    const size_t expected_substr = FindSubstrScalar(buf, pattern, start_pos);
+    EXPECT_EQ(FindSubstr(buf, pattern, start_pos), expected_substr);
+    EXPECT_EQ(FindSubstrSSE2(buf, pattern, start_pos), expected_substr);
+    if (HasAVX2()) {
+      EXPECT_EQ(FindSubstrAVX2(buf, pattern, start_pos), expected_substr);
+    }
+  }
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
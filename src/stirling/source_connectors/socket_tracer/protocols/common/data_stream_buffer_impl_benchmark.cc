@@ -23,6 +23,7 @@
 #include "src/common/base/base.h"
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/always_contiguous_data_stream_buffer_impl.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scan.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/lazy_contiguous_data_stream_buffer_impl.h"
 
 template <typename TDataStreamBufferImpl>
@@ -229,6 +230,38 @@ static void BM_RemovePrefix(benchmark::State& state) {
   }
 }
 
+using ScanFn = size_t (*)(std::string_view, std::string_view, size_t);
+
+// Scans a buffer with the frame boundary search routines, as done when resyncing after data loss.
+// The only match is at the very end, so the whole buffer is scanned.
+template <ScanFn TFindFn>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_FindFirstOf(benchmark::State& state) {
+  std::string data(state.range(0), '0');
+  data.back() = '*';
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TFindFn(data, "+-:$*", 0));
+  }
+  state.SetBytesProcessed(static_cast<uint64_t>(state.iterations()) * data.size());
+}
+
+template <ScanFn TFindFn>
+// NOLINTNEXTLINE : runtime/references.
+static void BM_FindSubstr(benchmark::State& state) {
+  // Lots of partial matches of the pattern, as in an HTTP body made of many short lines.
+  std::string data;
+  while (data.size() < static_cast<size_t>(state.range(0))) {
+    data += "0123456789\r\n";
+  }
+  data += "\r\n\r\n";
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(TFindFn(data, "\r\n\r\n", 0));
+  }
+  state.SetBytesProcessed(static_cast<uint64_t>(state.iterations()) * data.size());
+}
+
 using px::stirling::protocols::AlwaysContiguousDataStreamBufferImpl;
 using px::stirling::protocols::LazyContiguousDataStreamBufferImpl;
 
@@ -269,3 +302,23 @@ BENCHMARK_TEMPLATE(BM_RemovePrefix, LazyContiguousDataStreamBufferImpl)
 BENCHMARK_TEMPLATE(BM_RemovePrefix, AlwaysContiguousDataStreamBufferImpl)
     ->Range(1024, 32 * 1024)
     ->Unit(benchmark::kMillisecond);
+
+// The vectorized variants are only valid on CPUs that support them; see byte_scan.h.
+using px::stirling::protocols::FindFirstOf;
+using px::stirling::protocols::FindSubstr;
+using px::stirling::protocols::byte_scan_internal::FindFirstOfAVX2;
+using px::stirling::protocols::byte_scan_internal::FindFirstOfScalar;
+using px::stirling::protocols::byte_scan_internal::FindFirstOfSSE42;
+using px::stirling::protocols::byte_scan_internal::FindSubstrAVX2;
+using px::stirling::protocols::byte_scan_internal::FindSubstrScalar;
+using px::stirling::protocols::byte_scan_internal::FindSubstrSSE2;
+
+BENCHMARK_TEMPLATE(BM_FindFirstOf, FindFirstOfScalar)->Range(64 * 1024, 16 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_FindFirstOf, FindFirstOfSSE42)->Range(64 * 1024, 16 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_FindFirstOf, FindFirstOfAVX2)->Range(64 * 1024, 16 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_FindFirstOf, FindFirstOf)->Range(64 * 1024, 16 * 1024 * 1024);
+
+BENCHMARK_TEMPLATE(BM_FindSubstr, FindSubstrScalar)->Range(64 * 1024, 16 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_FindSubstr, FindSubstrSSE2)->Range(64 * 1024, 16 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_FindSubstr, FindSubstrAVX2)->Range(64 * 1024, 16 * 1024 * 1024);
+BENCHMARK_TEMPLATE(BM_FindSubstr, FindSubstr)->Range(64 * 1024, 16 * 1024 * 1024);
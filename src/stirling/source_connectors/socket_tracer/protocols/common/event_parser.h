@@ -20,8 +20,11 @@
 
 #include <deque>
 #include <map>
+#include <memory_resource>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -81,6 +84,58 @@ struct ParseResult {
   size_t frame_bytes;
 };
 
+// Detects protocol states that can resume a partially parsed frame across ParseFrames() calls.
+// Such states expose `std::optional<size_t> parse_pos` in their global state, which the event
+// parser sets to the absolute stream position at which the next ParseFrame() call starts.
+// The protocol uses it to verify that a partial frame it saved is still at the head of the buffer.
+template <typename TStateType, typename = void>
+struct HasResumableParseState : std::false_type {};
+
+template <typename TStateType>
+struct HasResumableParseState<TStateType,
+                              std::void_t<decltype(std::declval<TStateType>().global.parse_pos)>>
+    : std::true_type {};
+
+template <typename TStateType>
+void SetParsePosition(std::optional<size_t> pos, TStateType* state) {
+  if constexpr (HasResumableParseState<TStateType>::value) {
+    if (state != nullptr) {
+      state->global.parse_pos = pos;
+    }
+  }
+}
+
+// Detects protocol states that allocate frames from the connection's FrameArena. Such states expose
+// `std::pmr::memory_resource* frame_resource` in their global state, and their frame type has a
+// constructor that takes the memory resource.
+template <typename TStateType, typename = void>
+struct HasFrameResource : std::false_type {};
+
+template <typename TStateType>
+struct HasFrameResource<TStateType,
+                        std::void_t<decltype(std::declval<TStateType>().global.frame_resource)>>
+    : std::true_type {};
+
+template <typename TStateType>
+void SetFrameResource(std::pmr::memory_resource* resource, TStateType* state) {
+  if constexpr (HasFrameResource<TStateType>::value) {
+    if (state != nullptr) {
+      state->global.frame_resource = resource;
+    }
+  }
+}
+
+// Returns a new frame, allocated from the frame resource of the state if there is one.
+template <typename TFrameType, typename TStateType>
+TFrameType NewFrame(TStateType* state) {
+  if constexpr (HasFrameResource<TStateType>::value) {
+    if (state != nullptr && state->global.frame_resource != nullptr) {
+      return TFrameType(state->global.frame_resource);
+    }
+  }
+  return TFrameType();
+}
+
 /**
  * Parses internal data buffer (see Append()) for frames, and writes resultant
  * parsed frames into the provided frames container.
@@ -124,7 +179,9 @@ ParseResult ParseFrames(message_type_t type, DataStreamBuffer* data_stream_buffe
   const size_t prev_size = frames->size();
 
   // Parse and append new frames to the frames vector.
-  ParseResult result = ParseFramesLoop(type, buf, frames, state);
+  // The absolute stream position lets stateful parsers resume partial frames from a prior call.
+  ParseResult result =
+      ParseFramesLoop(type, buf, frames, state, data_stream_buffer->position() + start_pos);
 
   VLOG(1) << absl::Substitute("Parsed $0 new frames", frames->size() - prev_size);
 
@@ -155,13 +212,16 @@ ParseResult ParseFrames(message_type_t type, DataStreamBuffer* data_stream_buffe
  * @param type The Type of frames to parse.
  * @param buf The raw bytes to parse
  * @param frames The output where the parsed frames will be placed.
+ * @param stream_pos The absolute stream position of buf, if known. Only when it is known can
+ * protocols with resumable parse state continue a frame left partial by a previous call.
  *
  * @return ParseResult with locations where parseable frames were found in the source buffer.
  */
 // TODO(oazizi): Convert tests to use ParseFrames() instead of ParseFramesLoop().
 template <typename TFrameType, typename TStateType = NoState>
 ParseResult ParseFramesLoop(message_type_t type, std::string_view buf,
-                            std::deque<TFrameType>* frames, TStateType* state = nullptr) {
+                            std::deque<TFrameType>* frames, TStateType* state = nullptr,
+                            std::optional<size_t> stream_pos = std::nullopt) {
   std::vector<StartEndPos> frame_positions;
   const size_t buf_size = buf.size();
   ParseState s = ParseState::kSuccess;
@@ -170,8 +230,13 @@ ParseResult ParseFramesLoop(message_type_t type, std::string_view buf,
   int invalid_count = 0;
 
   while (!buf.empty() && s != ParseState::kEOS) {
-    TFrameType frame;
+    TFrameType frame = NewFrame<TFrameType>(state);
 
+    std::optional<size_t> frame_pos;
+    if (stream_pos.has_value()) {
+      frame_pos = *stream_pos + (buf_size - buf.size());
+    }
+    SetParsePosition(frame_pos, state);
     s = ParseFrame(type, &buf, &frame, state);
 
     bool stop = false;
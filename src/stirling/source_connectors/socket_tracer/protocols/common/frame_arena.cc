@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/frame_arena.h"
+
+#include "src/common/base/base.h"
+
+DEFINE_uint32(stirling_frame_arena_max_bytes,
+              gflags::Uint32FromEnv("PL_STIRLING_FRAME_ARENA_MAX_BYTES", 256 * 1024),
+              "The number of bytes that the frames of a connection can hold in its arena. "
+              "Frames beyond that are allocated on the heap.");
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+void* FrameArena::CountingResource::do_allocate(size_t bytes, size_t alignment) {
+  void* p = std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  bytes_ += bytes;
+  return p;
+}
+
+void FrameArena::CountingResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+  DCHECK_GE(bytes_, bytes);
+  bytes_ -= bytes;
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
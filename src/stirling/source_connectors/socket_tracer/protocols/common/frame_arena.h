@@ -0,0 +1,94 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <memory_resource>
+
+#include <gflags/gflags.h>
+
+DECLARE_uint32(stirling_frame_arena_max_bytes);
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+/**
+ * Memory that the frames parsed from one connection are allocated from.
+ *
+ * Protocols whose frames support it (see HasFrameResource in event_parser.h) construct each frame
+ * with resource(), so the strings and containers of the frame are carved out of a few large blocks
+ * instead of being individually allocated on the heap. Frames keep their memory when they are
+ * moved into records, and the blocks are all returned to the heap at once by Release().
+ *
+ * Once the arena holds max_bytes, resource() falls back to the heap, so a connection that never
+ * drains its frames cannot grow the arena without bound.
+ */
+class FrameArena {
+ public:
+  FrameArena() : FrameArena(FLAGS_stirling_frame_arena_max_bytes) {}
+  explicit FrameArena(size_t max_bytes) : max_bytes_(max_bytes) {}
+
+  /**
+   * The resource that new frames should be allocated from.
+   */
+  std::pmr::memory_resource* resource() {
+    if (upstream_.bytes() >= max_bytes_) {
+      return std::pmr::new_delete_resource();
+    }
+    return &arena_;
+  }
+
+  /**
+   * Frees all memory of the arena. No object that was allocated from resource() may still be
+   * alive, since its memory is reused.
+   */
+  void Release() { arena_.release(); }
+
+  /**
+   * Number of bytes that the arena currently holds.
+   */
+  size_t bytes() const { return upstream_.bytes(); }
+
+ private:
+  // Blocks are small to start with, since most connections only hold a few frames at a time.
+  static constexpr size_t kInitialBlockBytes = 4 * 1024;
+
+  // Allocates the arena blocks from the heap, and keeps count of them.
+  class CountingResource : public std::pmr::memory_resource {
+   public:
+    size_t bytes() const { return bytes_; }
+
+   private:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+      return this == &other;
+    }
+
+    size_t bytes_ = 0;
+  };
+
+  const size_t max_bytes_;
+  CountingResource upstream_;
+  std::pmr::monotonic_buffer_resource arena_{kInitialBlockBytes, &upstream_};
+};
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
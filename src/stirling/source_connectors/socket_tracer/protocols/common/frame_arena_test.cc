@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/frame_arena.h"
+
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+namespace protocols {
+
+TEST(FrameArenaTest, AllocatesFromArenaUntilReleased) {
+  FrameArena arena(/* max_bytes */ 1024 * 1024);
+  EXPECT_EQ(arena.bytes(), 0UL);
+
+  {
+    std::pmr::string s(1000, 'x', arena.resource());
+    EXPECT_GE(arena.bytes(), 1000UL);
+
+    // Moves keep the memory of the arena, copies go to the heap.
+    std::pmr::string moved(std::move(s));
+    EXPECT_EQ(moved.get_allocator().resource(), arena.resource());
+    std::pmr::string copied(moved);
+    EXPECT_EQ(copied.get_allocator().resource(), std::pmr::get_default_resource());
+  }
+  // Destroying the strings doesn't return their memory, only Release() does.
+  EXPECT_GT(arena.bytes(), 0UL);
+
+  arena.Release();
+  EXPECT_EQ(arena.bytes(), 0UL);
+
+  std::pmr::string s(1000, 'y', arena.resource());
+  EXPECT_GT(arena.bytes(), 0UL);
+}
+
+TEST(FrameArenaTest, FallsBackToHeapWhenFull) {
+  FrameArena arena(/* max_bytes */ 16 * 1024);
+  EXPECT_NE(arena.resource(), std::pmr::new_delete_resource());
+
+  {
+    std::pmr::string s(32 * 1024, 'x', arena.resource());
+    EXPECT_GE(arena.bytes(), 32 * 1024UL);
+    EXPECT_EQ(arena.resource(), std::pmr::new_delete_resource());
+  }
+
+  arena.Release();
+  EXPECT_NE(arena.resource(), std::pmr::new_delete_resource());
+}
+
+}  // namespace protocols
+}  // namespace stirling
+}  // namespace px
@@ -47,10 +47,12 @@ template <typename TRecordType, typename TMessageType>
 RecordsWithErrorCount<TRecordType> StitchMessagesWithTimestampOrder(
     std::deque<TMessageType>* req_messages, std::deque<TMessageType>* resp_messages) {
   std::vector<TRecordType> records;
+  // Each response produces at most one record, so this avoids regrowing the vector.
+  records.reserve(resp_messages->size());
 
-  TRecordType record;
-  record.req.timestamp_ns = 0;
-  record.resp.timestamp_ns = 0;
+  // The latest request that has no response yet. It is left in the deque until it is matched, and
+  // then moved straight into the record, so that a frame allocated from an arena stays there.
+  TMessageType* req_to_match = nullptr;
 
   TMessageType placeholder_message;
   placeholder_message.timestamp_ns = std::numeric_limits<int64_t>::max();
@@ -67,19 +69,15 @@ RecordsWithErrorCount<TRecordType> StitchMessagesWithTimestampOrder(
     if (req.timestamp_ns < resp.timestamp_ns) {
       // Requests always go into the record (though not pushed yet).
       // If the next oldest item is a request too, it will (correctly) clobber this one.
-      record.req = std::move(req);
+      req_to_match = &req;
       ++req_iter;
     } else {
       // Two cases for a response:
       // 1) No older request was found: then we ignore the response.
       // 2) An older request was found: then it is considered a match. Push the record, and reset.
-      if (record.req.timestamp_ns != 0) {
-        record.resp = std::move(resp);
-        records.push_back(std::move(record));
-
-        // Reset record after pushing.
-        record.req.timestamp_ns = 0;
-        record.resp.timestamp_ns = 0;
+      if (req_to_match != nullptr && req_to_match->timestamp_ns != 0) {
+        records.push_back({std::move(*req_to_match), std::move(resp)});
+        req_to_match = nullptr;
       }
       ++resp_iter;
     }
@@ -22,7 +22,6 @@
 
 #include <algorithm>
 #include <utility>
-#include <vector>
 
 DEFINE_bool(use_pico_chunked_decoder, false,
             "If true, uses picohttpparser's chunked decoder; otherwise uses our custom decoder.");
@@ -124,13 +123,24 @@ ParseState ExtractChunkData(std::string_view* data, size_t chunk_len, std::strin
 // because that one is destructive on incomplete data.
 // We may attempt parsing in the middle of a stream and cannot
 // have both the result fail and the input buffer be modified.
+// Progress through complete chunks is recorded separately in `progress`, so that a subsequent
+// call with more data does not have to decode the same chunks again.
 // Reference: https://www.w3.org/Protocols/rfc2616/rfc2616-sec3.html#sec3.6.1
 ParseState CustomParseChunked(std::string_view* buf, size_t body_size_limit_bytes,
-                              std::string* result, size_t* body_size) {
-  std::vector<std::string_view> chunks;
-  size_t total_bytes = 0;
+                              std::pmr::string* result, size_t* body_size,
+                              ChunkedDecodeProgress* progress) {
+  ChunkedDecodeProgress local_progress;
+  if (progress == nullptr) {
+    progress = &local_progress;
+  }
+
+  // The buffer must be an extension of the one from which progress was recorded.
+  if (progress->consumed_bytes > buf->size()) {
+    DCHECK(false) << "Chunked decode progress is beyond the end of the buffer.";
+    *progress = {};
+  }
 
-  std::string_view data = *buf;
+  std::string_view data = buf->substr(progress->consumed_bytes);
 
   ParseState s;
 
@@ -156,14 +166,13 @@ ParseState CustomParseChunked(std::string_view* buf, size_t body_size_limit_byte
 
     // Only bother collecting chunks up to a certain size, since we will truncate anyways.
     // Don't break out of the parsing though, since we need to know where the body ends.
-    if (total_bytes + chunk_data.size() < body_size_limit_bytes) {
-      chunks.push_back(chunk_data);
-    } else if (total_bytes < body_size_limit_bytes) {
-      size_t bytes_available = body_size_limit_bytes - total_bytes;
-      chunks.push_back(chunk_data.substr(0, bytes_available));
+    if (progress->body_size < body_size_limit_bytes) {
+      size_t bytes_available = body_size_limit_bytes - progress->body_size;
+      progress->body.append(chunk_data.substr(0, bytes_available));
     }
 
-    total_bytes += chunk_data.size();
+    progress->body_size += chunk_data.size();
+    progress->consumed_bytes = buf->size() - data.size();
   }
 
   // Two scenarios to wrap up:
@@ -185,8 +194,9 @@ ParseState CustomParseChunked(std::string_view* buf, size_t body_size_limit_byte
     data.remove_prefix(pos + 4);
   }
 
-  *result = absl::StrJoin(chunks, "");
-  *body_size = total_bytes;
+  result->assign(progress->body);
+  *body_size = progress->body_size;
+  *progress = {};
 
   // Update the input buffer only if the data was parsed properly, because
   // we don't want to be destructive on failure.
@@ -199,7 +209,7 @@ ParseState CustomParseChunked(std::string_view* buf, size_t body_size_limit_byte
 // the final result is kNeedsMoreData.
 // See our Custom implementation for an alternative that doesn't have that cost.
 ParseState PicoParseChunked(std::string_view* data, size_t body_size_limit_bytes,
-                            std::string* result, size_t* body_size) {
+                            std::pmr::string* result, size_t* body_size) {
   // Make a copy of the data because phr_decode_chunked mutates the input,
   // and if the original parse fails due to a lack of data, we need the original
   // state to be preserved.
@@ -219,9 +229,7 @@ ParseState PicoParseChunked(std::string_view* data, size_t body_size_limit_bytes
     return ParseState::kNeedsMoreData;
   } else if (retval >= 0) {
     // Found a complete message.
-    data_copy.resize(std::min(buf_size, body_size_limit_bytes));
-    data_copy.shrink_to_fit();
-    *result = std::move(data_copy);
+    result->assign(data_copy.data(), std::min(buf_size, body_size_limit_bytes));
     *body_size = buf_size;
 
     // phr_decode_chunked rewrites the buffer in place, removing chunked-encoding headers.
@@ -238,15 +246,17 @@ ParseState PicoParseChunked(std::string_view* data, size_t body_size_limit_bytes
 
 // Parse an HTTP message body in the chunked transfer-encoding.
 // Reference: https://www.w3.org/Protocols/rfc2616/rfc2616-sec3.html#sec3.6.1
-ParseState ParseChunked(std::string_view* data, size_t body_size_limit_bytes, std::string* result,
-                        size_t* body_size) {
+ParseState ParseChunked(std::string_view* data, size_t body_size_limit_bytes,
+                        std::pmr::string* result, size_t* body_size,
+                        ChunkedDecodeProgress* progress) {
   return (FLAGS_use_pico_chunked_decoder)
              ? PicoParseChunked(data, body_size_limit_bytes, result, body_size)
-             : CustomParseChunked(data, body_size_limit_bytes, result, body_size);
+             : CustomParseChunked(data, body_size_limit_bytes, result, body_size, progress);
 }
 
 ParseState ParseContent(std::string_view content_len_str, std::string_view* data,
-                        size_t body_size_limit_bytes, std::string* result, size_t* body_size) {
+                        size_t body_size_limit_bytes, std::pmr::string* result,
+                        size_t* body_size) {
   size_t len;
   if (!absl::SimpleAtoi(content_len_str, &len)) {
     LOG(ERROR) << absl::Substitute("Unable to parse Content-Length: $0", content_len_str);
@@ -257,7 +267,7 @@ ParseState ParseContent(std::string_view content_len_str, std::string_view* data
     return ParseState::kNeedsMoreData;
   }
 
-  *result = data->substr(0, std::min(len, body_size_limit_bytes));
+  result->assign(data->substr(0, std::min(len, body_size_limit_bytes)));
   *body_size = len;
   data->remove_prefix(std::min(len, data->size()));
   return ParseState::kSuccess;
@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <memory_resource>
 #include <string>
 
 #include "src/stirling/utils/parse_state.h"
@@ -30,18 +31,38 @@ namespace stirling {
 namespace protocols {
 namespace http {
 
+/**
+ * Progress of a chunked body that could not be fully decoded with the data available.
+ * Passing it back into ParseChunked() along with more data resumes decoding at the last
+ * complete chunk, instead of decoding the body again from its start.
+ */
+struct ChunkedDecodeProgress {
+  // Number of bytes of the encoded body consumed so far. Always on a chunk boundary.
+  size_t consumed_bytes = 0;
+
+  // Decoded body collected so far, truncated to the body size limit.
+  std::string body;
+
+  // Size of the decoded body so far, including any bytes beyond the body size limit.
+  size_t body_size = 0;
+};
+
 /**
  * Parse an HTTP chunked body.
  *
  * @param buf The input data buffer. If parsing succeeds, the corresponding bytes are consumed;
  *            otherwise the string_view bytes are not modified.
  * @param result Result where the decoded chunked message is placed upon success.
+ * @param progress Optional resumable decode progress. If the body is incomplete, it records the
+ *                 complete chunks seen so far; on the next call with the same (extended) buf,
+ *                 decoding resumes from there. Ignored by the pico decoder.
  * @return ParseState::kInvalid if message is malformed.
  *         ParseState::kNeedsMoreData if the message is incomplete.
  *         ParseState::kSuccess if the chunk length was extracted and chunk header is well-formed.
  */
-ParseState ParseChunked(std::string_view* buf, size_t body_size_limit_bytes, std::string* result,
-                        size_t* body_size);
+ParseState ParseChunked(std::string_view* buf, size_t body_size_limit_bytes,
+                        std::pmr::string* result, size_t* body_size,
+                        ChunkedDecodeProgress* progress = nullptr);
 
 /**
  * Parse an HTTP body based on Content-Length.
@@ -55,7 +76,8 @@ ParseState ParseChunked(std::string_view* buf, size_t body_size_limit_bytes, std
  *         ParseState::kSuccess if the entire body is present and well-formed.
  */
 ParseState ParseContent(std::string_view content_len_str, std::string_view* data,
-                        size_t body_size_limit_bytes, std::string* result, size_t* body_size);
+                        size_t body_size_limit_bytes, std::pmr::string* result,
+                        size_t* body_size);
 
 }  // namespace http
 }  // namespace protocols
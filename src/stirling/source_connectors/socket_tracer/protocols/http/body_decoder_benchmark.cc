@@ -63,7 +63,7 @@ static void BM_custom_body_parser(benchmark::State& state) {
   FLAGS_use_pico_chunked_decoder = false;
 
   for (auto _ : state) {
-    std::string result;
+    std::pmr::string result;
     size_t body_size;
     std::string_view data_view(data);
     px::stirling::ParseState parse_state = px::stirling::protocols::http::ParseChunked(
@@ -79,7 +79,7 @@ static void BM_pico_body_parser(benchmark::State& state) {
   FLAGS_use_pico_chunked_decoder = true;
 
   for (auto _ : state) {
-    std::string result;
+    std::pmr::string result;
     size_t body_size;
     std::string_view data_view(data);
 
@@ -53,7 +53,7 @@ TEST_P(ChunkedDecoderTest, Basic) {
       "0\r\n"
       "\r\n";
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -72,7 +72,7 @@ TEST_P(ChunkedDecoderTest, IncludingNext) {
       "\r\n"
       "HTTP/1.1 200 OK\r\n";
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -86,7 +86,7 @@ TEST_P(ChunkedDecoderTest, Empty) {
       "0\r\n"
       "\r\n";
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -108,7 +108,7 @@ TEST_P(ChunkedDecoderTest, Incomplete) {
   for (size_t i = 0; i < body.size(); ++i) {
     std::string_view body_substr = body.substr(0, i);
 
-    std::string out;
+    std::pmr::string out;
     size_t body_size;
     ParseState result = ParseChunked(&body_substr, kBodySizeLimitBytes, &out, &body_size);
 
@@ -128,7 +128,7 @@ TEST_P(ChunkedDecoderTest, InconsistentLength) {
       "\r\n";
   std::string original(body);
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -147,7 +147,7 @@ TEST_P(ChunkedDecoderTest, UnexpectedTerminatorInLength) {
       "\r\n";
   std::string original(body);
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -171,7 +171,7 @@ TEST_P(ChunkedDecoderTest, UnexpectedTerminatorInData) {
       "\r\n";
   std::string original(body);
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -190,7 +190,7 @@ TEST_P(ChunkedDecoderTest, UnexpectedTerminatorAtEnd) {
       "\rx";
   std::string original(body);
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -209,7 +209,7 @@ TEST_P(ChunkedDecoderTest, ChunkExtensions) {
       "\r\n";
   std::string original(body);
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -229,7 +229,7 @@ TEST_P(ChunkedDecoderTest, Trailers) {
       "\r\n";
   std::string original(body);
 
-  std::string out;
+  std::pmr::string out;
   size_t body_size;
   ParseState result = ParseChunked(&body, kBodySizeLimitBytes, &out, &body_size);
 
@@ -238,6 +238,40 @@ TEST_P(ChunkedDecoderTest, Trailers) {
   EXPECT_EQ(body, "");
 }
 
+TEST(ChunkedDecoderResumeTest, ResumesFromLastCompleteChunk) {
+  FLAGS_use_pico_chunked_decoder = false;
+
+  const std::string_view body =
+      "9\r\n"
+      "pixielabs\r\n"
+      "C\r\n"
+      " is awesome!\r\n"
+      "0\r\n"
+      "\r\n";
+
+  ChunkedDecodeProgress progress;
+  std::pmr::string out;
+  size_t body_size;
+
+  // First chunk and part of the second chunk are available.
+  std::string_view partial = body.substr(0, 20);
+  EXPECT_EQ(ParseChunked(&partial, kBodySizeLimitBytes, &out, &body_size, &progress),
+            ParseState::kNeedsMoreData);
+  EXPECT_EQ(progress.consumed_bytes, 14);
+  EXPECT_EQ(progress.body, "pixielabs");
+  EXPECT_EQ(progress.body_size, 9);
+  EXPECT_EQ(partial, body.substr(0, 20));
+
+  // The rest of the body arrives.
+  std::string_view full = body;
+  EXPECT_EQ(ParseChunked(&full, kBodySizeLimitBytes, &out, &body_size, &progress),
+            ParseState::kSuccess);
+  EXPECT_EQ(out, "pixielabs is awesome!");
+  EXPECT_EQ(body_size, 21);
+  EXPECT_TRUE(full.empty());
+  EXPECT_EQ(progress.consumed_bytes, 0);
+}
+
 }  // namespace http
 }  // namespace protocols
 }  // namespace stirling
@@ -17,12 +17,14 @@
  */
 
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/parse.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scan.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/body_decoder.h"
 
 #include <picohttpparser.h>
 
 #include <algorithm>
 #include <string>
+#include <tuple>
 #include <utility>
 
 DEFINE_uint32(http_body_limit_bytes,
@@ -51,10 +53,12 @@ struct HTTPRequest {
   size_t num_headers = kMaxNumHeaders;
 };
 
-int ParseRequest(std::string_view buf, HTTPRequest* result) {
+// last_len is the length of buf when it was previously found to hold incomplete headers,
+// or 0 on the first attempt. See phr_parse_request().
+int ParseRequest(std::string_view buf, HTTPRequest* result, size_t last_len = 0) {
   return phr_parse_request(buf.data(), buf.size(), &result->method, &result->method_len,
                            &result->path, &result->path_len, &result->minor_version,
-                           result->headers, &result->num_headers, /*last_len*/ 0);
+                           result->headers, &result->num_headers, last_len);
 }
 
 // Fields populated by picohttpparser phr_parse_response().
@@ -69,25 +73,27 @@ struct HTTPResponse {
   size_t num_headers = kMaxNumHeaders;
 };
 
-int ParseResponse(std::string_view buf, HTTPResponse* result) {
+int ParseResponse(std::string_view buf, HTTPResponse* result, size_t last_len = 0) {
   return phr_parse_response(buf.data(), buf.size(), &result->minor_version, &result->status,
                             &result->msg, &result->msg_len, result->headers, &result->num_headers,
-                            /*last_len*/ 0);
+                            last_len);
 }
 
-HeadersMap GetHTTPHeadersMap(const phr_header* headers, size_t num_headers) {
-  HeadersMap result;
+// Replaces the contents of result with the headers. The strings are constructed in place in the
+// map nodes, with the memory resource of the map.
+void SetHTTPHeadersMap(const phr_header* headers, size_t num_headers, HeadersMap* result) {
+  result->clear();
   for (size_t i = 0; i < num_headers; i++) {
-    std::string name(headers[i].name, headers[i].name_len);
-    std::string value(headers[i].value, headers[i].value_len);
-    result.emplace(std::move(name), std::move(value));
+    result->emplace(std::piecewise_construct,
+                    std::forward_as_tuple(headers[i].name, headers[i].name_len),
+                    std::forward_as_tuple(headers[i].value, headers[i].value_len));
   }
-  return result;
 }
 
 }  // namespace pico_wrapper
 
-ParseState ParseRequestBody(std::string_view* buf, Message* result) {
+ParseState ParseRequestBody(std::string_view* buf, Message* result,
+                            ChunkedDecodeProgress* chunked_progress) {
   // From https://tools.ietf.org/html/rfc7230:
   //  A sender MUST NOT send a Content-Length header field in any message
   //  that contains a Transfer-Encoding header field.
@@ -115,7 +121,8 @@ ParseState ParseRequestBody(std::string_view* buf, Message* result) {
   const auto transfer_encoding_iter = result->headers.find(kTransferEncoding);
   if (transfer_encoding_iter != result->headers.end() &&
       transfer_encoding_iter->second == "chunked") {
-    auto s = ParseChunked(buf, FLAGS_http_body_limit_bytes, &result->body, &result->body_size);
+    auto s = ParseChunked(buf, FLAGS_http_body_limit_bytes, &result->body, &result->body_size,
+                          chunked_progress);
     DCHECK_LE(result->body.size(), FLAGS_http_body_limit_bytes);
     return s;
   }
@@ -131,7 +138,8 @@ ParseState ParseRequestBody(std::string_view* buf, Message* result) {
   return ParseState::kSuccess;
 }
 
-ParseState ParseResponseBody(std::string_view* buf, Message* result, State* state) {
+ParseState ParseResponseBody(std::string_view* buf, Message* result, State* state,
+                             ChunkedDecodeProgress* chunked_progress) {
   // Case 0: Check for a HEAD response with no body.
   // Responses to HEAD requests are special, because they may include Content-Length
   // or Transfer-Encoding, but the body will still be empty.
@@ -165,7 +173,8 @@ ParseState ParseResponseBody(std::string_view* buf, Message* result, State* stat
   const auto transfer_encoding_iter = result->headers.find(kTransferEncoding);
   if (transfer_encoding_iter != result->headers.end() &&
       transfer_encoding_iter->second == "chunked") {
-    auto s = ParseChunked(buf, FLAGS_http_body_limit_bytes, &result->body, &result->body_size);
+    auto s = ParseChunked(buf, FLAGS_http_body_limit_bytes, &result->body, &result->body_size,
+                          chunked_progress);
     DCHECK_LE(result->body.size(), FLAGS_http_body_limit_bytes);
     return s;
   }
@@ -211,21 +220,21 @@ ParseState ParseResponseBody(std::string_view* buf, Message* result, State* stat
   return ParseState::kNeedsMoreData;
 }
 
-ParseState ParseRequest(std::string_view* buf, Message* result) {
+ParseState ParseRequestHeaders(std::string_view* buf, Message* result, size_t last_len) {
   pico_wrapper::HTTPRequest req;
-  int retval = pico_wrapper::ParseRequest(*buf, &req);
+  int retval = pico_wrapper::ParseRequest(*buf, &req, last_len);
 
   if (retval >= 0) {
     buf->remove_prefix(retval);
 
     result->type = message_type_t::kRequest;
     result->minor_version = req.minor_version;
-    result->headers = pico_wrapper::GetHTTPHeadersMap(req.headers, req.num_headers);
-    result->req_method = std::string(req.method, req.method_len);
-    result->req_path = std::string(req.path, req.path_len);
+    pico_wrapper::SetHTTPHeadersMap(req.headers, req.num_headers, &result->headers);
+    result->req_method.assign(req.method, req.method_len);
+    result->req_path.assign(req.path, req.path_len);
     result->headers_byte_size = retval;
 
-    return ParseRequestBody(buf, result);
+    return ParseState::kSuccess;
   }
   if (retval == -2) {
     return ParseState::kNeedsMoreData;
@@ -233,21 +242,21 @@ ParseState ParseRequest(std::string_view* buf, Message* result) {
   return ParseState::kInvalid;
 }
 
-ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
+ParseState ParseResponseHeaders(std::string_view* buf, Message* result, size_t last_len) {
   pico_wrapper::HTTPResponse resp;
-  int retval = pico_wrapper::ParseResponse(*buf, &resp);
+  int retval = pico_wrapper::ParseResponse(*buf, &resp, last_len);
 
   if (retval >= 0) {
     buf->remove_prefix(retval);
 
     result->type = message_type_t::kResponse;
     result->minor_version = resp.minor_version;
-    result->headers = pico_wrapper::GetHTTPHeadersMap(resp.headers, resp.num_headers);
+    pico_wrapper::SetHTTPHeadersMap(resp.headers, resp.num_headers, &result->headers);
     result->resp_status = resp.status;
-    result->resp_message = std::string(resp.msg, resp.msg_len);
+    result->resp_message.assign(resp.msg, resp.msg_len);
     result->headers_byte_size = retval;
 
-    return ParseResponseBody(buf, result, state);
+    return ParseState::kSuccess;
   }
   if (retval == -2) {
     return ParseState::kNeedsMoreData;
@@ -255,10 +264,43 @@ ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
   return ParseState::kInvalid;
 }
 
+// Returns the partial message progress that applies to a message starting at the current parse
+// position, or nullptr if the parse position is unknown (resuming is then disabled).
+// Stale progress, recorded for a message at a different position, is discarded.
+PartialMessage* GetPartialMessage(message_type_t type, std::string_view buf, State* state) {
+  if (!state->parse_pos.has_value()) {
+    return nullptr;
+  }
+
+  PartialMessage* partial = nullptr;
+  switch (type) {
+    case message_type_t::kRequest:
+      partial = &state->partial_req;
+      break;
+    case message_type_t::kResponse:
+      partial = &state->partial_resp;
+      break;
+    default:
+      return nullptr;
+  }
+
+  // Data at a given stream position never changes, and can only grow. So if the message still
+  // starts at the recorded position and the buffer has not shrunk, the progress is still valid.
+  if (partial->start_pos != state->parse_pos || buf.size() < partial->seen_bytes) {
+    *partial = {};
+    partial->start_pos = state->parse_pos;
+  }
+  return partial;
+}
+
 /**
  * Parses a raw input buffer for HTTP messages.
  * HTTP headers are parsed by pico. Body is extracted separately.
  *
+ * If the message is incomplete and the stream position is known (see State::parse_pos), the
+ * progress made is saved in the state. The next call for the same message then resumes from there,
+ * so that long chunked bodies and slow uploads are not re-parsed from the start every time.
+ *
  * @param type: request or response
  * @param buf: The source buffer to parse. The prefix of this buffer will be consumed to indicate
  * the point until which the parse has progressed.
@@ -266,14 +308,48 @@ ParseState ParseResponse(std::string_view* buf, Message* result, State* state) {
  * @return parse state indicating how the parse progressed.
  */
 ParseState ParseFrame(message_type_t type, std::string_view* buf, Message* result, State* state) {
-  switch (type) {
-    case message_type_t::kRequest:
-      return ParseRequest(buf, result);
-    case message_type_t::kResponse:
-      return ParseResponse(buf, result, state);
-    default:
-      return ParseState::kInvalid;
+  if (type != message_type_t::kRequest && type != message_type_t::kResponse) {
+    return ParseState::kInvalid;
+  }
+
+  PartialMessage* partial = GetPartialMessage(type, *buf, state);
+  const size_t available_bytes = buf->size();
+
+  if (partial != nullptr && partial->headers_parsed) {
+    *result = std::move(partial->msg);
+    buf->remove_prefix(result->headers_byte_size);
+  } else {
+    size_t last_len = (partial != nullptr) ? partial->seen_bytes : 0;
+    ParseState s = (type == message_type_t::kRequest)
+                       ? ParseRequestHeaders(buf, result, last_len)
+                       : ParseResponseHeaders(buf, result, last_len);
+    if (s != ParseState::kSuccess) {
+      if (partial != nullptr) {
+        if (s == ParseState::kNeedsMoreData) {
+          partial->seen_bytes = available_bytes;
+        } else {
+          *partial = {};
+        }
+      }
+      return s;
+    }
+  }
+
+  ChunkedDecodeProgress* chunked_progress = (partial != nullptr) ? &partial->chunked : nullptr;
+  ParseState s = (type == message_type_t::kRequest)
+                     ? ParseRequestBody(buf, result, chunked_progress)
+                     : ParseResponseBody(buf, result, state, chunked_progress);
+
+  if (partial != nullptr) {
+    if (s == ParseState::kNeedsMoreData) {
+      partial->seen_bytes = available_bytes;
+      partial->headers_parsed = true;
+      partial->msg = std::move(*result);
+    } else {
+      *partial = {};
+    }
   }
+  return s;
 }
 
 // TODO(oazizi/yzhao): This function should use is_http_{response,request} inside
@@ -324,7 +400,7 @@ size_t FindFrameBoundary(message_type_t type, std::string_view buf, size_t start
   // Note that we don't search forwards for HTTP/1.1 directly, because it could result in matches
   // inside the request/response body.
   while (true) {
-    size_t marker_pos = buf.find(kBoundaryMarker, start_pos);
+    size_t marker_pos = FindSubstr(buf, kBoundaryMarker, start_pos);
 
     if (marker_pos == std::string::npos) {
       return std::string::npos;
@@ -928,6 +928,73 @@ TEST_P(HTTPParserTest, ParseHTTPResponsesWithLeftoverRepeatedly) {
 INSTANTIATE_TEST_SUITE_P(Stressor, HTTPParserTest,
                          ::testing::Values(TestParam{37337, 50}, TestParam{98237, 50}));
 
+TEST_F(HTTPParserTest, ResumePartialMessageAcrossParseFrames) {
+  StateWrapper state{};
+  std::string msg0 = HTTPRespWithSizedBody("foobar");
+  std::string msg1 = absl::StrCat(
+      "HTTP/1.1 200 OK\r\n"
+      "Transfer-Encoding: chunked\r\n"
+      "\r\n",
+      HTTPChunk("pixielabs "));
+  std::string msg2 = absl::StrCat(HTTPChunk("rocks!"), HTTPChunk(""));
+
+  std::vector<SocketDataEvent> events = CreateEvents<std::string>({msg0, msg1, msg2});
+  AddEvent(events[0]);
+  AddEvent(events[1]);
+
+  std::deque<Message> parsed_messages;
+  ParseResult result = ParseFrames(message_type_t::kResponse, &data_buffer_, &parsed_messages,
+                                   /* resync */ false, &state);
+  data_buffer_.RemovePrefix(result.end_position);
+
+  EXPECT_EQ(ParseState::kNeedsMoreData, result.state);
+  EXPECT_THAT(parsed_messages, ElementsAre(HasBody("foobar")));
+
+  // The headers and the complete chunk of the second message were retained for resuming.
+  const PartialMessage& partial = state.global.partial_resp;
+  EXPECT_EQ(partial.start_pos, msg0.size());
+  EXPECT_TRUE(partial.headers_parsed);
+  EXPECT_EQ(partial.chunked.body, "pixielabs ");
+
+  AddEvent(events[2]);
+
+  parsed_messages.clear();
+  result = ParseFrames(message_type_t::kResponse, &data_buffer_, &parsed_messages,
+                       /* resync */ false, &state);
+  data_buffer_.RemovePrefix(result.end_position);
+
+  EXPECT_EQ(ParseState::kSuccess, result.state);
+  EXPECT_EQ(msg1.size() + msg2.size(), result.end_position);
+  EXPECT_THAT(parsed_messages, ElementsAre(HasBody("pixielabs rocks!")));
+  EXPECT_THAT(parsed_messages[0].headers, Contains(Pair("Transfer-Encoding", "chunked")));
+  EXPECT_FALSE(state.global.partial_resp.headers_parsed);
+}
+
+TEST_F(HTTPParserTest, PartialMessageDiscardedWhenHeadMoves) {
+  StateWrapper state{};
+  std::string msg0 =
+      "HTTP/1.1 200 OK\r\n"
+      "Content-Length: 40\r\n"
+      "\r\n"
+      "Foo";
+
+  std::vector<SocketDataEvent> events = CreateEvents<std::string>({msg0});
+  AddEvent(events[0]);
+
+  std::deque<Message> parsed_messages;
+  ParseResult result = ParseFrames(message_type_t::kResponse, &data_buffer_, &parsed_messages,
+                                   /* resync */ false, &state);
+  EXPECT_EQ(ParseState::kNeedsMoreData, result.state);
+  EXPECT_TRUE(state.global.partial_resp.headers_parsed);
+
+  // Parsing now starts at a different position, so the saved progress no longer applies.
+  data_buffer_.RemovePrefix(1);
+  result = ParseFrames(message_type_t::kResponse, &data_buffer_, &parsed_messages,
+                       /* resync */ false, &state);
+  EXPECT_THAT(parsed_messages, IsEmpty());
+  EXPECT_FALSE(state.global.partial_resp.headers_parsed);
+}
+
 //=============================================================================
 // HTTP FindFrameBoundary Tests
 //=============================================================================
@@ -20,9 +20,12 @@
 
 #include <deque>
 #include <limits>
+#include <optional>
 #include <string>
 #include <utility>
 
+#include <absl/strings/ascii.h>
+
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
 #include "src/common/zlib/zlib_wrapper.h"
@@ -38,12 +41,69 @@ DEFINE_string(http_response_header_filters, "Content-Type:json,Content-Type:text
               "'Content-Type:json,Content-Type:text' will select a HTTP response "
               "with a Content-Type header whose value contains 'json' *or* 'text'.");
 
+DEFINE_uint32(http_body_decompression_budget_us, 20000,
+              "Maximum time per transfer iteration spent decompressing HTTP bodies. "
+              "Compressed bodies beyond the budget are replaced with a placeholder.");
+
 namespace px {
 namespace stirling {
 namespace protocols {
 namespace http {
 
-void PreProcessMessage(Message* message) {
+namespace {
+
+std::optional<zlib::InflateFormat> InflateFormatForEncoding(std::string_view encoding) {
+  if (encoding == "gzip" || encoding == "x-gzip") {
+    return zlib::InflateFormat::kGzip;
+  }
+  if (encoding == "deflate") {
+    return zlib::InflateFormat::kZlib;
+  }
+  return std::nullopt;
+}
+
+void DecompressBody(std::string_view content_encoding, Message* message,
+                    DecompressionBudget* budget) {
+  std::string encoding = absl::AsciiStrToLower(absl::StripAsciiWhitespace(content_encoding));
+  if (encoding.empty() || encoding == "identity") {
+    return;
+  }
+
+  std::optional<zlib::InflateFormat> format = InflateFormatForEncoding(encoding);
+  if (!format.has_value()) {
+    message->body = absl::Substitute("<removed: unsupported content-encoding $0>", encoding);
+    return;
+  }
+
+  if (budget != nullptr && budget->exhausted()) {
+    message->body = "<removed: decompression budget exhausted>";
+    return;
+  }
+
+  size_t max_output_bytes = budget != nullptr ? budget->max_output_bytes()
+                                              : std::numeric_limits<size_t>::max();
+  auto start = std::chrono::steady_clock::now();
+
+  auto result = zlib::InflatePrefix(message->body, format.value(), max_output_bytes);
+  // HTTP "deflate" is supposed to be zlib-wrapped, but some servers send raw deflate data.
+  if (!result.ok() && format.value() == zlib::InflateFormat::kZlib) {
+    result = zlib::InflatePrefix(message->body, zlib::InflateFormat::kRawDeflate, max_output_bytes);
+  }
+
+  if (budget != nullptr) {
+    budget->Charge(std::chrono::steady_clock::now() - start);
+  }
+
+  if (!result.ok()) {
+    message->body = absl::Substitute("<Failed to decompress $0 body>", encoding);
+    return;
+  }
+  message->body = result.ConsumeValueOrDie().out;
+}
+
+}  // namespace
+
+void PreProcessMessage(Message* message, DecompressionBudget* budget) {
   // Parse the flags on the first time only.
   static const HTTPHeaderFilter kHTTPResponseHeaderFilter =
       ParseHTTPHeaderFilters(FLAGS_http_response_header_filters);
@@ -70,8 +130,8 @@ void PreProcessMessage(Message* message) {
 
   auto content_encoding_iter = message->headers.find(kContentEncoding);
   // Replace body with decompressed version, if required.
-  if (content_encoding_iter != message->headers.end() && content_encoding_iter->second == "gzip") {
-    message->body = px::zlib::Inflate(message->body).ConsumeValueOr("<Failed to gunzip body>");
+  if (content_encoding_iter != message->headers.end() && message->body_size > 0) {
+    DecompressBody(content_encoding_iter->second, message, budget);
   }
 }
 
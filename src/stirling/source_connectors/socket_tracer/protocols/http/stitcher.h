@@ -18,6 +18,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <deque>
 #include <map>
 #include <string>
@@ -28,6 +29,7 @@
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/types.h"
 
 DECLARE_string(http_response_header_filters);
+DECLARE_uint32(http_body_decompression_budget_us);
 
 namespace px {
 namespace stirling {
@@ -45,7 +47,41 @@ namespace http {
 RecordsWithErrorCount<Record> ProcessMessages(std::deque<Message>* req_messages,
                                               std::deque<Message>* resp_messages);
 
-void PreProcessMessage(Message* message);
+/**
+ * Bounds the work spent decompressing HTTP bodies, so that highly compressible or large bodies
+ * cannot blow up memory or stall the transfer loop.
+ *
+ * The output limit applies to each body. The time budget is shared by all bodies decompressed
+ * until the next Reset(), which the caller does once per transfer iteration. Once it runs out,
+ * compressed bodies are replaced with a placeholder instead of being decompressed.
+ */
+class DecompressionBudget {
+ public:
+  DecompressionBudget(size_t max_output_bytes, std::chrono::nanoseconds time_per_iteration)
+      : max_output_bytes_(max_output_bytes),
+        time_per_iteration_(time_per_iteration),
+        time_remaining_(time_per_iteration) {}
+
+  void Reset() { time_remaining_ = time_per_iteration_; }
+
+  size_t max_output_bytes() const { return max_output_bytes_; }
+  bool exhausted() const { return time_remaining_ <= std::chrono::nanoseconds::zero(); }
+  void Charge(std::chrono::nanoseconds elapsed) { time_remaining_ -= elapsed; }
+
+ private:
+  size_t max_output_bytes_;
+  std::chrono::nanoseconds time_per_iteration_;
+  std::chrono::nanoseconds time_remaining_;
+};
+
+/**
+ * Filters out bodies of uninteresting content types, and decompresses bodies according to
+ * their Content-Encoding (gzip and deflate). Bodies truncated during parsing are decompressed
+ * as far as the available data allows.
+ *
+ * @param budget Optional limits on decompression. If null, decompression is unbounded.
+ */
+void PreProcessMessage(Message* message, DecompressionBudget* budget = nullptr);
 
 }  // namespace http
 
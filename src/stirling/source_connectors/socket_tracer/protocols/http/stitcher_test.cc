@@ -41,10 +41,62 @@ TEST(PreProcessRecordTest, GzipCompressedContentIsDecompressed) {
                                       0x85, 0x92, 0xd4, 0xe2, 0x12, 0x2e, 0x00, 0x8c, 0x2d,
                                       0xc0, 0xfa, 0x0f, 0x00, 0x00, 0x00};
   message.body.assign(reinterpret_cast<const char*>(compressed_bytes), sizeof(compressed_bytes));
+  message.body_size = message.body.size();
   PreProcessMessage(&message);
   EXPECT_EQ("This is a test\n", message.body);
 }
 
+class PreProcessCompressedRecordTest : public ::testing::Test {
+ protected:
+  static constexpr uint8_t kCompressedBytes[] = {
+      0x1f, 0x8b, 0x08, 0x00, 0x37, 0xf0, 0xbf, 0x5c, 0x00, 0x03, 0x0b,
+      0xc9, 0xc8, 0x2c, 0x56, 0x00, 0xa2, 0x44, 0x85, 0x92, 0xd4, 0xe2,
+      0x12, 0x2e, 0x00, 0x8c, 0x2d, 0xc0, 0xfa, 0x0f, 0x00, 0x00, 0x00};
+
+  Message GzipMessage(size_t num_bytes = sizeof(kCompressedBytes)) {
+    Message message;
+    message.type = message_type_t::kResponse;
+    message.headers.insert({kContentEncoding, "gzip"});
+    message.headers.insert({kContentType, "json"});
+    message.body.assign(reinterpret_cast<const char*>(kCompressedBytes), num_bytes);
+    message.body_size = sizeof(kCompressedBytes);
+    return message;
+  }
+};
+
+TEST_F(PreProcessCompressedRecordTest, OutputIsLimitedByBudget) {
+  DecompressionBudget budget(/*max_output_bytes*/ 4, std::chrono::seconds(1));
+  Message message = GzipMessage();
+  PreProcessMessage(&message, &budget);
+  EXPECT_EQ(message.body, "This");
+}
+
+TEST_F(PreProcessCompressedRecordTest, TruncatedBodyIsPartiallyDecompressed) {
+  Message message = GzipMessage(/*num_bytes*/ 20);
+  PreProcessMessage(&message);
+  EXPECT_THAT(std::string_view(message.body), ::testing::StartsWith("This is"));
+}
+
+TEST_F(PreProcessCompressedRecordTest, ExhaustedBudgetSkipsDecompression) {
+  DecompressionBudget budget(/*max_output_bytes*/ 1024, std::chrono::nanoseconds(0));
+  Message message = GzipMessage();
+  PreProcessMessage(&message, &budget);
+  EXPECT_EQ(message.body, "<removed: decompression budget exhausted>");
+
+  budget = DecompressionBudget(/*max_output_bytes*/ 1024, std::chrono::seconds(1));
+  message = GzipMessage();
+  PreProcessMessage(&message, &budget);
+  EXPECT_EQ(message.body, "This is a test\n");
+}
+
+TEST_F(PreProcessCompressedRecordTest, UnsupportedEncodingIsRemoved) {
+  Message message = GzipMessage();
+  message.headers.erase(kContentEncoding);
+  message.headers.insert({kContentEncoding, "br"});
+  PreProcessMessage(&message);
+  EXPECT_EQ(message.body, "<removed: unsupported content-encoding br>");
+}
+
 TEST(PreProcessRecordTest, ContentHeaderIsNotAdded) {
   Message message;
   message.type = message_type_t::kResponse;
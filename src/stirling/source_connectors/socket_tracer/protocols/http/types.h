@@ -19,10 +19,14 @@
 #pragma once
 
 #include <chrono>
+#include <map>
+#include <memory_resource>
+#include <optional>
 #include <string>
 
 #include "src/common/base/utils.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/common/event_parser.h"  // For FrameBase
+#include "src/stirling/source_connectors/socket_tracer/protocols/http/body_decoder.h"
 
 namespace px {
 namespace stirling {
@@ -38,7 +42,7 @@ using ::px::operator<<;
 
 // HTTP1.x headers can have multiple values for the same name, and field names are case-insensitive:
 // https://www.w3.org/Protocols/rfc2616/rfc2616-sec4.html#sec4.2
-using HeadersMap = std::multimap<std::string, std::string, CaseInsensitiveLess>;
+using HeadersMap = std::pmr::multimap<std::pmr::string, std::pmr::string, CaseInsensitiveLess>;
 
 inline constexpr char kContentEncoding[] = "Content-Encoding";
 inline constexpr char kContentLength[] = "Content-Length";
@@ -46,19 +50,30 @@ inline constexpr char kContentType[] = "Content-Type";
 inline constexpr char kTransferEncoding[] = "Transfer-Encoding";
 inline constexpr char kUpgrade[] = "Upgrade";
 
+// The strings and headers of a message are allocated from a memory resource. The event parser
+// constructs messages with the FrameArena of their connection, so a message and the record it is
+// moved into don't allocate on the heap. Copies of a message are allocated on the heap.
 struct Message : public FrameBase {
+  Message() = default;
+  explicit Message(std::pmr::memory_resource* resource)
+      : headers(resource),
+        req_method("-", resource),
+        req_path("-", resource),
+        resp_message("-", resource),
+        body("-", resource) {}
+
   message_type_t type = message_type_t::kUnknown;
 
   int minor_version = -1;
   HeadersMap headers = {};
 
-  std::string req_method = "-";
-  std::string req_path = "-";
+  std::pmr::string req_method = "-";
+  std::pmr::string req_path = "-";
 
   int resp_status = -1;
-  std::string resp_message = "-";
+  std::pmr::string resp_message = "-";
 
-  std::string body = "-";
+  std::pmr::string body = "-";
   size_t body_size = 0;
 
   // The number of bytes in the HTTP header, used in ByteSize(),
@@ -100,8 +115,45 @@ struct Record {
   }
 };
 
+/**
+ * Parse progress of an HTTP message that could not be completed with the data available.
+ * Kept across ParseFrames() calls, so that once more data arrives, parsing resumes where it
+ * left off instead of re-parsing the headers and body from the start of the message.
+ */
+struct PartialMessage {
+  // Absolute stream position of the first byte of the message.
+  // Progress is only valid while the message is still found at this position.
+  std::optional<size_t> start_pos;
+
+  // Number of bytes of the message that were available on the last attempt.
+  // While the headers are incomplete, this is passed to picohttpparser, so that only newly arrived
+  // bytes are scanned for the end of the headers.
+  size_t seen_bytes = 0;
+
+  // Whether the headers have been parsed. If so, msg contains the parsed header fields.
+  // The message is allocated on the heap rather than from the FrameArena, since the arena is
+  // released while a partial message can still be in progress.
+  bool headers_parsed = false;
+  Message msg;
+
+  // Progress of a chunked body.
+  ChunkedDecodeProgress chunked;
+};
+
 struct State {
   bool conn_closed = false;
+
+  // The memory resource that new frames are allocated from, if any. Set by the ConnTracker;
+  // see HasFrameResource.
+  std::pmr::memory_resource* frame_resource = nullptr;
+
+  // Absolute stream position at which the next ParseFrame() starts, if known.
+  // Set by the event parser; see HasResumableParseState.
+  std::optional<size_t> parse_pos;
+
+  // Partially parsed requests and responses, respectively.
+  PartialMessage partial_req;
+  PartialMessage partial_resp;
 };
 
 struct StateWrapper {
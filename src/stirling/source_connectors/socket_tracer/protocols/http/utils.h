@@ -64,6 +64,13 @@ bool MatchesHTTPHeaders(const HeadersMap& http_headers, const HTTPHeaderFilter&
  */
 bool IsJSONContent(const Message& message);
 
+/**
+ * Returns the headers as a JSON object string; same output as utils::ToJSONString(headers).
+ * The JSON is written out directly instead of building a document first, which avoids the
+ * document's memory pool allocation for every message.
+ */
+std::string HeadersToJSONString(const HeadersMap& headers);
+
 }  // namespace http
 }  // namespace protocols
 }  // namespace stirling
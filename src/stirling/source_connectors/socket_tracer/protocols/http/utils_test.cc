@@ -19,6 +19,7 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
 
+#include "src/common/json/json.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/http/utils.h"
 
 namespace px {
@@ -76,6 +77,18 @@ TEST(ParseHTTPHeaderFiltersAndMatchTest, FiltersAreAsExpectedAndMatchesWork) {
   }
 }
 
+TEST(HeadersToJSONStringTest, MatchesToJSONString) {
+  HeadersMap headers = {{"Content-Type", "application/json"},
+                        {"Set-Cookie", "a=1"},
+                        {"set-cookie", "b=\"2\""},
+                        {"Accept", "*/*"}};
+  EXPECT_EQ(HeadersToJSONString(headers), utils::ToJSONString(headers));
+  EXPECT_EQ(HeadersToJSONString(headers),
+            R"({"Accept":"*/*","Content-Type":"application/json","Set-Cookie":"a=1",)"
+            R"("set-cookie":"b=\"2\""})");
+  EXPECT_EQ(HeadersToJSONString({}), "{}");
+}
+
 }  // namespace http
 }  // namespace protocols
 }  // namespace stirling
@@ -32,6 +32,7 @@
 
 #include "src/common/base/base.h"
 #include "src/common/json/json.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scan.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/nats/types.h"
 #include "src/stirling/utils/binary_decoder.h"
 
@@ -51,8 +52,17 @@ size_t FindMessageBoundary(std::string_view buf, size_t start_pos) {
   // Based on https://github.com/nats-io/docs/blob/master/nats_protocol/nats-protocol.md.
   const std::vector<std::string_view> kmessage_type_ts = {kInfo, kConnect, kPub,  kSub, kUnsub,
                                                           kMsg,  kPing,    kPong, kOK,  kERR};
+  // The first characters of all message types above. Only positions that start with one of
+  // these are compared against the message types.
+  constexpr std::string_view kMessageTypeFirstChars = "ICPSUM+-";
   constexpr ssize_t kMinMsgSize = 3;
-  for (ssize_t i = start_pos; i < static_cast<ssize_t>(buf.size()) - kMinMsgSize; ++i) {
+  const ssize_t end_pos = static_cast<ssize_t>(buf.size()) - kMinMsgSize;
+  for (ssize_t i = start_pos; i < end_pos; ++i) {
+    size_t pos = FindFirstOf(buf.substr(0, end_pos), kMessageTypeFirstChars, i);
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    i = pos;
     auto buf_substr = buf.substr(i);
     for (auto msg_type : kmessage_type_ts) {
       if (absl::StartsWith(buf_substr, msg_type)) {
@@ -28,6 +28,7 @@
 #include <absl/container/flat_hash_map.h>
 
 #include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/protocols/common/byte_scan.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/redis/formatting.h"
 #include "src/stirling/source_connectors/socket_tracer/protocols/redis/types.h"
 #include "src/stirling/utils/binary_decoder.h"
@@ -181,15 +182,9 @@ Status ParseArray(message_type_t type, BinaryDecoder* decoder, Message* msg) {
 }  // namespace
 
 size_t FindMessageBoundary(std::string_view buf, size_t start_pos) {
-  for (; start_pos < buf.size(); ++start_pos) {
-    const char type_marker = buf[start_pos];
-    if (type_marker == kSimpleStringMarker || type_marker == kErrorMarker ||
-        type_marker == kIntegerMarker || type_marker == kBulkStringsMarker ||
-        type_marker == kArrayMarker) {
-      return start_pos;
-    }
-  }
-  return std::string_view::npos;
+  static constexpr char kTypeMarkers[] = {kSimpleStringMarker, kErrorMarker, kIntegerMarker,
+                                          kBulkStringsMarker, kArrayMarker};
+  return FindFirstOf(buf, std::string_view(kTypeMarkers, sizeof(kTypeMarkers)), start_pos);
 }
 
 // Redis protocol specification: https://redis.io/topics/protocol
@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/sampling_policy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <absl/strings/ascii.h>
+#include <absl/strings/numbers.h>
+#include <absl/strings/str_cat.h>
+#include <absl/strings/str_split.h>
+#include <magic_enum.hpp>
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+constexpr uint64_t kNanosPerSec = 1000 * 1000 * 1000;
+
+uint32_t ToDropRate(double sample_rate) {
+  sample_rate = std::clamp(sample_rate, 0.0, 1.0);
+  return static_cast<uint32_t>(std::lround((1.0 - sample_rate) * kSampleRateScale));
+}
+
+}  // namespace
+
+void ConnSamplingPolicy::SetProtocolSampleRate(traffic_protocol_t protocol, double sample_rate) {
+  protocol_drop_rates_[protocol] = ToDropRate(sample_rate);
+}
+
+void ConnSamplingPolicy::SetUPIDSampleRate(const struct upid_t& upid, double sample_rate) {
+  upid_drop_rates_[upid] = ToDropRate(sample_rate);
+}
+
+void ConnSamplingPolicy::ClearUPIDSampleRate(const struct upid_t& upid) {
+  upid_drop_rates_.erase(upid);
+}
+
+void ConnSamplingPolicy::SetProtocolByteBudget(traffic_protocol_t protocol,
+                                               uint64_t bytes_per_sec) {
+  if (bytes_per_sec == 0) {
+    byte_budgets_.erase(protocol);
+    return;
+  }
+  TokenBucket& bucket = byte_budgets_[protocol];
+  bucket.bytes_per_sec = bytes_per_sec;
+  bucket.tokens = std::min(bucket.tokens, bytes_per_sec);
+}
+
+bool ConnSamplingPolicy::ShouldSample(const struct conn_id_t& conn_id,
+                                      traffic_protocol_t protocol) const {
+  uint32_t drop_rate = 0;
+  if (auto iter = upid_drop_rates_.find(conn_id.upid); iter != upid_drop_rates_.end()) {
+    drop_rate = iter->second;
+  } else if (auto iter = protocol_drop_rates_.find(protocol); iter != protocol_drop_rates_.end()) {
+    drop_rate = iter->second;
+  }
+
+  if (drop_rate == 0) {
+    return true;
+  }
+  return conn_sample_bucket(&conn_id) >= drop_rate;
+}
+
+ConnSamplingPolicy::TokenBucket* ConnSamplingPolicy::RefillByteBudget(traffic_protocol_t protocol,
+                                                                      uint64_t now_ns) {
+  auto iter = byte_budgets_.find(protocol);
+  if (iter == byte_budgets_.end()) {
+    return nullptr;
+  }
+  TokenBucket& bucket = iter->second;
+
+  // Events are not strictly time-ordered, so a timestamp earlier than the last refill
+  // simply adds nothing.
+  uint64_t elapsed_ns = now_ns > bucket.last_refill_ns ? now_ns - bucket.last_refill_ns : 0;
+  elapsed_ns = std::min(elapsed_ns, kNanosPerSec);
+  uint64_t refill = elapsed_ns * bucket.bytes_per_sec / kNanosPerSec;
+  if (refill > 0) {
+    bucket.tokens = std::min(bucket.tokens + refill, bucket.bytes_per_sec);
+    bucket.last_refill_ns = now_ns;
+  }
+  return &bucket;
+}
+
+bool ConnSamplingPolicy::HasByteBudget(traffic_protocol_t protocol, uint64_t now_ns) {
+  TokenBucket* bucket = RefillByteBudget(protocol, now_ns);
+  return bucket == nullptr || bucket->tokens > 0;
+}
+
+void ConnSamplingPolicy::ChargeByteBudget(traffic_protocol_t protocol, size_t num_bytes,
+                                          uint64_t now_ns) {
+  TokenBucket* bucket = RefillByteBudget(protocol, now_ns);
+  if (bucket == nullptr) {
+    return;
+  }
+  bucket->tokens -= std::min<uint64_t>(bucket->tokens, num_bytes);
+}
+
+struct sampling_config_t ConnSamplingPolicy::BPFConfig(traffic_protocol_t protocol) const {
+  struct sampling_config_t config = {};
+  if (auto iter = protocol_drop_rates_.find(protocol); iter != protocol_drop_rates_.end()) {
+    config.drop_rate = iter->second;
+  }
+  if (auto iter = byte_budgets_.find(protocol); iter != byte_budgets_.end()) {
+    config.bytes_per_sec = iter->second.bytes_per_sec;
+  }
+  return config;
+}
+
+StatusOr<absl::flat_hash_map<traffic_protocol_t, double>> ConnSamplingPolicy::ParseProtocolValues(
+    std::string_view spec) {
+  absl::flat_hash_map<traffic_protocol_t, double> values;
+  auto case_insensitive_cmp = [](char a, char b) {
+    return absl::ascii_tolower(a) == absl::ascii_tolower(b);
+  };
+  for (std::string_view entry : absl::StrSplit(spec, ',', absl::SkipWhitespace())) {
+    std::vector<std::string_view> parts = absl::StrSplit(entry, ':');
+    if (parts.size() != 2) {
+      return error::InvalidArgument("Expected <protocol>:<value>, got '$0'", entry);
+    }
+
+    std::string name = absl::StrCat("kProtocol", absl::StripAsciiWhitespace(parts[0]));
+    auto protocol = magic_enum::enum_cast<traffic_protocol_t, decltype(case_insensitive_cmp)>(
+        name, case_insensitive_cmp);
+    if (!protocol.has_value() || protocol.value() == kProtocolUnknown) {
+      return error::InvalidArgument("Unknown protocol '$0'", parts[0]);
+    }
+
+    double value;
+    if (!absl::SimpleAtod(parts[1], &value) || value < 0) {
+      return error::InvalidArgument("Invalid value '$0' for protocol '$1'", parts[1], parts[0]);
+    }
+    values[protocol.value()] = value;
+  }
+  return values;
+}
+
+StatusOr<absl::flat_hash_map<std::pair<std::string, std::string>, double>>
+ConnSamplingPolicy::ParseServiceValues(std::string_view spec) {
+  absl::flat_hash_map<std::pair<std::string, std::string>, double> values;
+  for (std::string_view entry : absl::StrSplit(spec, ',', absl::SkipWhitespace())) {
+    std::vector<std::string_view> parts = absl::StrSplit(entry, ':');
+    if (parts.size() != 2) {
+      return error::InvalidArgument("Expected <namespace>/<service>:<value>, got '$0'", entry);
+    }
+
+    std::vector<std::string_view> name = absl::StrSplit(absl::StripAsciiWhitespace(parts[0]), '/');
+    if (name.size() != 2 || name[0].empty() || name[1].empty()) {
+      return error::InvalidArgument("Expected <namespace>/<service>, got '$0'", parts[0]);
+    }
+
+    double value;
+    if (!absl::SimpleAtod(parts[1], &value) || value < 0) {
+      return error::InvalidArgument("Invalid value '$0' for service '$1'", parts[1], parts[0]);
+    }
+    values[{std::string(name[0]), std::string(name[1])}] = value;
+  }
+  return values;
+}
+
+}  // namespace stirling
+}  // namespace px
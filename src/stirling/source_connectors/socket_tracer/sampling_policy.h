@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/common.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/socket_trace.h"
+#include "src/stirling/upid/upid.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * ConnSamplingPolicy decides which connections have their data traced, and how many bytes of
+ * data per second each protocol may contribute.
+ *
+ * Connections are sampled as a whole, so a sampled connection is traced without gaps.
+ * The decision is a deterministic function of the conn_id, shared with BPF (see
+ * conn_sample_bucket()), so user-space and BPF always agree on which connections are sampled.
+ * A per-UPID rate, when set, overrides the rate of the connection's protocol.
+ *
+ * The byte budget is a token bucket holding at most one second worth of budget. It is checked
+ * only when a connection starts, so an exhausted budget stops new connections from being sampled
+ * instead of cutting off the connections already being traced.
+ */
+class ConnSamplingPolicy {
+ public:
+  /**
+   * Sets the fraction of connections of the protocol that are traced, in [0, 1].
+   */
+  void SetProtocolSampleRate(traffic_protocol_t protocol, double sample_rate);
+
+  /**
+   * Sets the fraction of the process's connections that are traced, in [0, 1].
+   */
+  void SetUPIDSampleRate(const struct upid_t& upid, double sample_rate);
+  void ClearUPIDSampleRate(const struct upid_t& upid);
+
+  /**
+   * Limits the data bytes per second traced for the protocol. Zero means unlimited.
+   */
+  void SetProtocolByteBudget(traffic_protocol_t protocol, uint64_t bytes_per_sec);
+
+  /**
+   * Returns true if data on the connection should be traced.
+   */
+  bool ShouldSample(const struct conn_id_t& conn_id, traffic_protocol_t protocol) const;
+
+  /**
+   * Returns true if the protocol's byte budget allows a new connection to be sampled at now_ns.
+   */
+  bool HasByteBudget(traffic_protocol_t protocol, uint64_t now_ns);
+
+  /**
+   * Takes num_bytes from the protocol's byte budget at time now_ns. The budget does not go below
+   * zero, so the data of sampled connections is never dropped.
+   */
+  void ChargeByteBudget(traffic_protocol_t protocol, size_t num_bytes, uint64_t now_ns);
+
+  /**
+   * Returns the policy of the protocol in the form consumed by BPF.
+   */
+  struct sampling_config_t BPFConfig(traffic_protocol_t protocol) const;
+
+  const absl::flat_hash_map<struct upid_t, uint32_t>& upid_drop_rates() const {
+    return upid_drop_rates_;
+  }
+
+  /**
+   * Parses a comma-separated list of <protocol>:<value> pairs, such as "http:0.1,mysql:0.5".
+   * Protocol names are the traffic_protocol_t names without the kProtocol prefix,
+   * and are matched case-insensitively.
+   */
+  static StatusOr<absl::flat_hash_map<traffic_protocol_t, double>> ParseProtocolValues(
+      std::string_view spec);
+
+  /**
+   * Parses a comma-separated list of <namespace>/<service>:<rate> pairs, such as
+   * "pl/vizier-query-broker:0.1". The keys are (namespace, service name) pairs.
+   */
+  static StatusOr<absl::flat_hash_map<std::pair<std::string, std::string>, double>>
+  ParseServiceValues(std::string_view spec);
+
+ private:
+  struct TokenBucket {
+    uint64_t bytes_per_sec = 0;
+    uint64_t tokens = 0;
+    uint64_t last_refill_ns = 0;
+  };
+
+  // Returns the protocol's bucket refilled up to now_ns, or nullptr if the protocol is unlimited.
+  TokenBucket* RefillByteBudget(traffic_protocol_t protocol, uint64_t now_ns);
+
+  absl::flat_hash_map<traffic_protocol_t, uint32_t> protocol_drop_rates_;
+  absl::flat_hash_map<struct upid_t, uint32_t> upid_drop_rates_;
+  absl::flat_hash_map<traffic_protocol_t, TokenBucket> byte_budgets_;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "src/stirling/source_connectors/socket_tracer/sampling_policy.h"
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+struct conn_id_t MakeConnID(uint32_t pid, int32_t fd, uint64_t tsid) {
+  struct conn_id_t conn_id = {};
+  conn_id.upid.pid = pid;
+  conn_id.upid.start_time_ticks = 1;
+  conn_id.fd = fd;
+  conn_id.tsid = tsid;
+  return conn_id;
+}
+
+TEST(ConnSamplingPolicyTest, TracesEverythingByDefault) {
+  ConnSamplingPolicy policy;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(policy.ShouldSample(MakeConnID(1, i, 1000 + i), kProtocolHTTP));
+  }
+  EXPECT_TRUE(policy.HasByteBudget(kProtocolHTTP, 0));
+}
+
+TEST(ConnSamplingPolicyTest, ProtocolSampleRate) {
+  ConnSamplingPolicy policy;
+  policy.SetProtocolSampleRate(kProtocolHTTP, 0.25);
+
+  constexpr int kNumConns = 10000;
+  int num_sampled = 0;
+  for (int i = 0; i < kNumConns; ++i) {
+    struct conn_id_t conn_id = MakeConnID(100 + i % 7, i, 123456789 + 1000 * i);
+    bool sampled = policy.ShouldSample(conn_id, kProtocolHTTP);
+    // The decision is stable for a given connection.
+    EXPECT_EQ(policy.ShouldSample(conn_id, kProtocolHTTP), sampled);
+    // Other protocols are unaffected.
+    EXPECT_TRUE(policy.ShouldSample(conn_id, kProtocolMySQL));
+    num_sampled += sampled;
+  }
+  EXPECT_NEAR(num_sampled, kNumConns / 4, kNumConns / 50);
+
+  policy.SetProtocolSampleRate(kProtocolHTTP, 0.0);
+  EXPECT_FALSE(policy.ShouldSample(MakeConnID(1, 1, 1), kProtocolHTTP));
+}
+
+TEST(ConnSamplingPolicyTest, UPIDSampleRateOverridesProtocol) {
+  ConnSamplingPolicy policy;
+  policy.SetProtocolSampleRate(kProtocolHTTP, 1.0);
+
+  struct conn_id_t conn_id = MakeConnID(1, 3, 1000);
+  policy.SetUPIDSampleRate(conn_id.upid, 0.0);
+  EXPECT_FALSE(policy.ShouldSample(conn_id, kProtocolHTTP));
+  EXPECT_TRUE(policy.ShouldSample(MakeConnID(2, 3, 1000), kProtocolHTTP));
+
+  policy.ClearUPIDSampleRate(conn_id.upid);
+  EXPECT_TRUE(policy.ShouldSample(conn_id, kProtocolHTTP));
+}
+
+TEST(ConnSamplingPolicyTest, ByteBudget) {
+  constexpr uint64_t kNanosPerSec = 1000 * 1000 * 1000;
+
+  ConnSamplingPolicy policy;
+  policy.SetProtocolByteBudget(kProtocolHTTP, 1000);
+
+  // The bucket fills up to one second worth of budget.
+  uint64_t now = 10 * kNanosPerSec;
+  EXPECT_TRUE(policy.HasByteBudget(kProtocolHTTP, now));
+  policy.ChargeByteBudget(kProtocolHTTP, 600, now);
+  EXPECT_TRUE(policy.HasByteBudget(kProtocolHTTP, now));
+  // Charging more than what is left empties the bucket, without going into debt.
+  policy.ChargeByteBudget(kProtocolHTTP, 5000, now);
+  EXPECT_FALSE(policy.HasByteBudget(kProtocolHTTP, now));
+
+  // Half a second later, half the budget is back.
+  now += kNanosPerSec / 2;
+  EXPECT_TRUE(policy.HasByteBudget(kProtocolHTTP, now));
+  policy.ChargeByteBudget(kProtocolHTTP, 499, now);
+  EXPECT_TRUE(policy.HasByteBudget(kProtocolHTTP, now));
+  policy.ChargeByteBudget(kProtocolHTTP, 1, now);
+  EXPECT_FALSE(policy.HasByteBudget(kProtocolHTTP, now));
+
+  // Other protocols are unlimited.
+  policy.ChargeByteBudget(kProtocolMySQL, 1 << 30, now);
+  EXPECT_TRUE(policy.HasByteBudget(kProtocolMySQL, now));
+
+  struct sampling_config_t config = policy.BPFConfig(kProtocolHTTP);
+  EXPECT_EQ(config.bytes_per_sec, 1000);
+  EXPECT_EQ(config.drop_rate, 0);
+}
+
+TEST(ConnSamplingPolicyTest, ParseProtocolValues) {
+  ASSERT_OK_AND_THAT(ConnSamplingPolicy::ParseProtocolValues("http:0.1, MySQL:0.5"),
+                     UnorderedElementsAre(Pair(kProtocolHTTP, 0.1), Pair(kProtocolMySQL, 0.5)));
+  ASSERT_OK_AND_THAT(ConnSamplingPolicy::ParseProtocolValues(""), UnorderedElementsAre());
+
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseProtocolValues("http"));
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseProtocolValues("smtp:0.1"));
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseProtocolValues("http:abc"));
+}
+
+TEST(ConnSamplingPolicyTest, ParseServiceValues) {
+  ASSERT_OK_AND_THAT(
+      ConnSamplingPolicy::ParseServiceValues("pl/kelvin:0.1, default/frontend:0.5"),
+      UnorderedElementsAre(Pair(Pair("pl", "kelvin"), 0.1),
+                           Pair(Pair("default", "frontend"), 0.5)));
+  ASSERT_OK_AND_THAT(ConnSamplingPolicy::ParseServiceValues(""), UnorderedElementsAre());
+
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseServiceValues("pl/kelvin"));
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseServiceValues("kelvin:0.1"));
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseServiceValues("pl/:0.1"));
+  EXPECT_NOT_OK(ConnSamplingPolicy::ParseServiceValues("pl/kelvin:abc"));
+}
+
+}  // namespace stirling
+}  // namespace px
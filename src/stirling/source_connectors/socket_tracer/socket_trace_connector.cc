@@ -23,8 +23,11 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <cstring>
 #include <filesystem>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <absl/container/flat_hash_map.h>
 #include <absl/strings/match.h>
@@ -104,6 +107,21 @@ DEFINE_int32(stirling_enable_amqp_tracing, px::stirling::TraceMode::On,
 DEFINE_bool(stirling_disable_self_tracing, true,
             "If true, stirling will not trace and process syscalls made by itself.");
 
+DEFINE_string(stirling_conn_sample_rates, "",
+              "Comma-separated <protocol>:<rate> pairs, such as 'http:0.1,mysql:0.5', setting the "
+              "fraction of connections of each protocol whose data is traced. "
+              "Connections are sampled as a whole. Protocols not listed are fully traced.");
+DEFINE_string(stirling_protocol_byte_budgets, "",
+              "Comma-separated <protocol>:<bytes_per_sec> pairs capping the data traced for each "
+              "protocol. New connections are not traced while the budget is exhausted, but "
+              "connections already traced are never cut off. BPF enforces the budget on each "
+              "CPU, and user-space enforces it across all CPUs. Protocols not listed are "
+              "unlimited.");
+DEFINE_string(stirling_service_sample_rates, "",
+              "Comma-separated <namespace>/<service>:<rate> pairs, such as 'pl/kelvin:0.1', "
+              "setting the fraction of connections of each service's processes whose data is "
+              "traced. Overrides --stirling_conn_sample_rates for those processes.");
+
 // Assume a moderate default network bandwidth peak of 100MiB/s across socket connections for data.
 DEFINE_uint32(stirling_socket_tracer_target_data_bw_percpu, 100 * 1024 * 1024,
               "Target bytes/sec of data per CPU");
@@ -424,6 +442,8 @@ Status SocketTraceConnector::InitBPF() {
     }
   }
 
+  PX_RETURN_IF_ERROR(InitSamplingPolicy());
+
   PX_RETURN_IF_ERROR(TestOnlySetTargetPID());
   if (FLAGS_stirling_disable_self_tracing) {
     PX_RETURN_IF_ERROR(DisableSelfTracing());
@@ -575,6 +595,10 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
   // to maintain consistency with how BPF generates timestamps on its events.
   perf_buffer_drain_time_ = AdjustedSteadyClockNowNS();
 
+  // Decompressed bodies are truncated to max_body_bytes when appended, so don't produce more.
+  http_decompression_budget_ = protocols::http::DecompressionBudget(
+      FLAGS_max_body_bytes, std::chrono::microseconds(FLAGS_http_body_decompression_budget_us));
+
   // This drains all perf buffers, and causes Handle() callback functions to get called.
   // Note that it drains *all* perf buffers, not just those that are required for this table,
   // so raw data will be pushed to connection trackers more aggressively.
@@ -596,6 +620,14 @@ void SocketTraceConnector::UpdateCommonState(ConnectorContext* ctx) {
 
   conn_trackers_mgr_.CleanupTrackers();
 
+  // Service membership changes far less often than the sampling period.
+  constexpr auto kUpdateServiceSampleRatesPeriod = std::chrono::seconds(10);
+  constexpr int kUpdateServiceSampleRatesSamplingRatio =
+      kUpdateServiceSampleRatesPeriod / kSamplingPeriod;
+  if (sampling_freq_mgr_.count() % kUpdateServiceSampleRatesSamplingRatio == 0) {
+    UpdateServiceSampleRates(ctx);
+  }
+
   // Periodically check for leaking conn_info_map entries.
   // TODO(oazizi): Track down and plug the leaks, then zap this function.
   constexpr auto kCleanupBPFMapLeaksPeriod = std::chrono::minutes(5);
@@ -632,6 +664,7 @@ void SocketTraceConnector::TransferDataImpl(ConnectorContext* ctx) {
     conn_trackers_mgr_.ComputeProtocolStats();
     LOG(INFO) << "ConnTracker statistics: " << conn_trackers_mgr_.StatsString();
     LOG(INFO) << "SocketTracer statistics: " << stats_.Print();
+    LOG(INFO) << "BPF sampling statistics: " << BPFSamplingStatsString();
   }
 
   constexpr auto kDebugDumpPeriod = std::chrono::minutes(1);
@@ -701,6 +734,167 @@ Status SocketTraceConnector::UpdateBPFProtocolTraceRole(traffic_protocol_t proto
                                            &control_map_handle);
 }
 
+Status SocketTraceConnector::InitSamplingPolicy() {
+  ConnSamplingPolicy* policy = conn_trackers_mgr_.sampling_policy();
+
+  PX_ASSIGN_OR_RETURN(auto sample_rates,
+                      ConnSamplingPolicy::ParseProtocolValues(FLAGS_stirling_conn_sample_rates));
+  for (const auto& [protocol, rate] : sample_rates) {
+    policy->SetProtocolSampleRate(protocol, rate);
+  }
+
+  PX_ASSIGN_OR_RETURN(auto byte_budgets, ConnSamplingPolicy::ParseProtocolValues(
+                                             FLAGS_stirling_protocol_byte_budgets));
+  for (const auto& [protocol, bytes_per_sec] : byte_budgets) {
+    policy->SetProtocolByteBudget(protocol, static_cast<uint64_t>(bytes_per_sec));
+  }
+
+  PX_ASSIGN_OR_RETURN(service_sample_rates_, ConnSamplingPolicy::ParseServiceValues(
+                                                 FLAGS_stirling_service_sample_rates));
+
+  return UpdateBPFSamplingPolicy();
+}
+
+Status SocketTraceConnector::UpdateBPFSamplingPolicy() {
+  const ConnSamplingPolicy& policy = conn_trackers_mgr_.sampling_policy();
+  auto sampling_config_map = GetPerCPUArrayTable<struct sampling_config_t>(kSamplingConfigMapName);
+  for (const auto& p : magic_enum::enum_values<traffic_protocol_t>()) {
+    PX_RETURN_IF_ERROR(bpf_tools::UpdatePerCPUArrayValue(static_cast<int>(p), policy.BPFConfig(p),
+                                                         &sampling_config_map));
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// The key is a struct with padding, which must be zero for BPF hash lookups to match.
+struct upid_t UPIDSamplingKey(const struct upid_t& upid) {
+  struct upid_t key;
+  memset(&key, 0, sizeof(key));
+  key.tgid = upid.tgid;
+  key.start_time_ticks = upid.start_time_ticks;
+  return key;
+}
+
+}  // namespace
+
+Status SocketTraceConnector::SetUPIDSampleRate(const struct upid_t& upid, double sample_rate) {
+  ConnSamplingPolicy* policy = conn_trackers_mgr_.sampling_policy();
+  policy->SetUPIDSampleRate(upid, sample_rate);
+
+  auto upid_sampling_map = GetHashTable<struct upid_t, uint32_t>(kUPIDSamplingMapName);
+  auto update_res =
+      upid_sampling_map.update_value(UPIDSamplingKey(upid), policy->upid_drop_rates().at(upid));
+  if (!update_res.ok()) {
+    return error::Internal("Failed to set sample rate of pid=$0, error message: $1", upid.tgid,
+                           update_res.msg());
+  }
+  return Status::OK();
+}
+
+Status SocketTraceConnector::ClearUPIDSampleRate(const struct upid_t& upid) {
+  conn_trackers_mgr_.sampling_policy()->ClearUPIDSampleRate(upid);
+
+  auto upid_sampling_map = GetHashTable<struct upid_t, uint32_t>(kUPIDSamplingMapName);
+  auto remove_res = upid_sampling_map.remove_value(UPIDSamplingKey(upid));
+  if (!remove_res.ok()) {
+    return error::Internal("Failed to clear sample rate of pid=$0, error message: $1", upid.tgid,
+                           remove_res.msg());
+  }
+  return Status::OK();
+}
+
+void SocketTraceConnector::UpdateServiceSampleRates(ConnectorContext* ctx) {
+  const ConnSamplingPolicy& policy = conn_trackers_mgr_.sampling_policy();
+  if (service_sample_rates_.empty() && policy.upid_drop_rates().empty()) {
+    return;
+  }
+
+  const md::K8sMetadataState& k8s_md = ctx->GetK8SMetadata();
+  const absl::flat_hash_set<md::UPID>& upids = ctx->GetUPIDs();
+
+  absl::flat_hash_map<struct upid_t, double> upid_sample_rates;
+  for (const auto& [service_name, sample_rate] : service_sample_rates_) {
+    md::UID service_id = k8s_md.ServiceIDByName(service_name);
+    if (service_id.empty()) {
+      continue;
+    }
+    for (const auto& [pod_name, pod_id] : k8s_md.pods_by_name()) {
+      const md::PodInfo* pod_info = k8s_md.PodInfoByID(pod_id);
+      if (pod_info == nullptr || pod_info->stop_time_ns() != 0 ||
+          !pod_info->services().contains(service_id)) {
+        continue;
+      }
+      for (const auto& cid : pod_info->containers()) {
+        const md::ContainerInfo* container_info = k8s_md.ContainerInfoByID(cid);
+        if (container_info == nullptr) {
+          continue;
+        }
+        // Only the UPIDs of this node are active in the context; the others have exited.
+        for (const md::UPID& upid : container_info->active_upids()) {
+          if (!upids.contains(upid)) {
+            continue;
+          }
+          struct upid_t key = {};
+          key.pid = upid.pid();
+          key.start_time_ticks = upid.start_ts();
+          upid_sample_rates[key] = sample_rate;
+        }
+      }
+    }
+  }
+
+  std::vector<struct upid_t> stale_upids;
+  for (const auto& [upid, drop_rate] : policy.upid_drop_rates()) {
+    if (!upid_sample_rates.contains(upid)) {
+      stale_upids.push_back(upid);
+    }
+  }
+  for (const auto& upid : stale_upids) {
+    Status s = ClearUPIDSampleRate(upid);
+    if (!s.ok()) {
+      LOG_FIRST_N(WARNING, 10) << s.msg();
+    }
+  }
+
+  for (const auto& [upid, sample_rate] : upid_sample_rates) {
+    if (policy.upid_drop_rates().contains(upid)) {
+      continue;
+    }
+    Status s = SetUPIDSampleRate(upid, sample_rate);
+    if (!s.ok()) {
+      LOG_FIRST_N(WARNING, 10) << s.msg();
+    }
+  }
+}
+
+std::string SocketTraceConnector::BPFSamplingStatsString() {
+  auto sampling_stats_map = GetPerCPUArrayTable<struct sampling_stats_t>(kSamplingStatsMapName);
+
+  std::string out;
+  for (const auto& p : magic_enum::enum_values<traffic_protocol_t>()) {
+    std::vector<struct sampling_stats_t> per_cpu_stats;
+    if (!sampling_stats_map.get_value(static_cast<int>(p), per_cpu_stats).ok()) {
+      continue;
+    }
+
+    uint64_t sampled_out_bytes = 0;
+    uint64_t budget_dropped_bytes = 0;
+    for (const auto& stats : per_cpu_stats) {
+      sampled_out_bytes += stats.sampled_out_bytes;
+      budget_dropped_bytes += stats.budget_dropped_bytes;
+    }
+    if (sampled_out_bytes == 0 && budget_dropped_bytes == 0) {
+      continue;
+    }
+    absl::StrAppend(&out,
+                    absl::Substitute("$0=[sampled_out_bytes=$1 budget_dropped_bytes=$2] ",
+                                     magic_enum::enum_name(p), sampled_out_bytes,
+                                     budget_dropped_bytes));
+  }
+  return out;
+}
+
 Status SocketTraceConnector::TestOnlySetTargetPID() {
   int64_t pid = FLAGS_test_only_socket_trace_target_pid;
   if (pid != kTraceAllTGIDs) {
@@ -1118,7 +1312,7 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
 
   // Currently decompresses gzip content, but could handle other transformations too.
   // Note that we do this after filtering to avoid burning CPU cycles unnecessarily.
-  protocols::http::PreProcessMessage(&resp_message);
+  protocols::http::PreProcessMessage(&resp_message, &http_decompression_budget_);
 
   md::UPID upid(ctx->GetASID(), conn_tracker.conn_id().upid.pid,
                 conn_tracker.conn_id().upid.start_time_ticks);
@@ -1139,16 +1333,20 @@ void SocketTraceConnector::AppendMessage(ConnectorContext* ctx, const ConnTracke
   r.Append<r.ColIndex("major_version")>(1);
   r.Append<r.ColIndex("minor_version")>(resp_message.minor_version);
   r.Append<r.ColIndex("content_type")>(static_cast<uint64_t>(content_type));
-  r.Append<r.ColIndex("req_headers")>(ToJSONString(req_message.headers), kMaxHTTPHeadersBytes);
-  r.Append<r.ColIndex("req_method")>(std::move(req_message.req_method));
-  r.Append<r.ColIndex("req_path")>(std::move(req_message.req_path));
+  r.Append<r.ColIndex("req_headers")>(
+      protocols::http::HeadersToJSONString(req_message.headers), kMaxHTTPHeadersBytes);
+  // The message strings live in the FrameArena of the connection, and are copied straight into
+  // the table columns.
+  r.AppendView<r.ColIndex("req_method")>(req_message.req_method);
+  r.AppendView<r.ColIndex("req_path")>(req_message.req_path);
   r.Append<r.ColIndex("req_body_size")>(req_message.body_size);
-  r.Append<r.ColIndex("req_body")>(std::move(req_message.body), FLAGS_max_body_bytes);
-  r.Append<r.ColIndex("resp_headers")>(ToJSONString(resp_message.headers), kMaxHTTPHeadersBytes);
+  r.AppendView<r.ColIndex("req_body")>(req_message.body, FLAGS_max_body_bytes);
+  r.Append<r.ColIndex("resp_headers")>(
+      protocols::http::HeadersToJSONString(resp_message.headers), kMaxHTTPHeadersBytes);
   r.Append<r.ColIndex("resp_status")>(resp_message.resp_status);
-  r.Append<r.ColIndex("resp_message")>(std::move(resp_message.resp_message));
+  r.AppendView<r.ColIndex("resp_message")>(resp_message.resp_message);
   r.Append<r.ColIndex("resp_body_size")>(resp_message.body_size);
-  r.Append<r.ColIndex("resp_body")>(std::move(resp_message.body), FLAGS_max_body_bytes);
+  r.AppendView<r.ColIndex("resp_body")>(resp_message.body, FLAGS_max_body_bytes);
   r.Append<r.ColIndex("latency")>(
       CalculateLatency(req_message.timestamp_ns, resp_message.timestamp_ns));
 #ifndef NDEBUG
@@ -64,6 +64,9 @@ DECLARE_int32(stirling_enable_kafka_tracing);
 DECLARE_int32(stirling_enable_mux_tracing);
 DECLARE_int32(stirling_enable_amqp_tracing);
 DECLARE_bool(stirling_disable_self_tracing);
+DECLARE_string(stirling_conn_sample_rates);
+DECLARE_string(stirling_protocol_byte_budgets);
+DECLARE_string(stirling_service_sample_rates);
 DECLARE_string(stirling_role_to_trace);
 
 DECLARE_uint32(stirling_socket_tracer_target_data_bw_percpu);
@@ -132,6 +135,24 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   // data from inside BPF to user-space.
   Status UpdateBPFProtocolTraceRole(traffic_protocol_t protocol, uint64_t role_mask);
 
+  // Configures the connection sampling policy from --stirling_conn_sample_rates,
+  // --stirling_protocol_byte_budgets and --stirling_service_sample_rates, and pushes it to BPF.
+  Status InitSamplingPolicy();
+  Status UpdateBPFSamplingPolicy();
+
+  // Sets the fraction of the process's connections whose data is traced, overriding the
+  // protocol sample rates. Enforced in both BPF and user-space.
+  Status SetUPIDSampleRate(const struct upid_t& upid, double sample_rate);
+  Status ClearUPIDSampleRate(const struct upid_t& upid);
+
+  // Resolves the services of --stirling_service_sample_rates to the UPIDs of their pods, and sets
+  // the UPID sample rates accordingly. Rates of UPIDs that exited, or that no longer belong to
+  // a sampled service, are cleared.
+  void UpdateServiceSampleRates(ConnectorContext* ctx);
+
+  // Returns the per-protocol amount of data BPF dropped because of the sampling policy.
+  std::string BPFSamplingStatsString();
+
   // Instructs Stirling to log detailed debug information about the traced events from the PID
   // specified by --test_only_socket_trace_target_pid.
   Status TestOnlySetTargetPID();
@@ -213,8 +234,8 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
   void UpdateTrackerTraceLevel(ConnTracker* tracker);
 
   template <typename TRecordType>
-  static void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker,
-                            TRecordType record, DataTable* data_table);
+  void AppendMessage(ConnectorContext* ctx, const ConnTracker& conn_tracker, TRecordType record,
+                     DataTable* data_table);
 
   std::thread RunDeployUProbesThread(const absl::flat_hash_set<md::UPID>& pids);
 
@@ -228,6 +249,13 @@ class SocketTraceConnector : public SourceConnector, public bpf_tools::BCCWrappe
 
   ConnStats conn_stats_;
 
+  // Sample rates keyed by (namespace, service name), from --stirling_service_sample_rates.
+  absl::flat_hash_map<std::pair<std::string, std::string>, double> service_sample_rates_;
+
+  // Bounds HTTP body decompression. Reset at the start of every transfer iteration.
+  protocols::http::DecompressionBudget http_decompression_budget_{0,
+                                                                  std::chrono::nanoseconds::zero()};
+
   absl::flat_hash_set<int> pids_to_trace_disable_;
 
   std::function<std::chrono::steady_clock::time_point()> now_fn_ = std::chrono::steady_clock::now;
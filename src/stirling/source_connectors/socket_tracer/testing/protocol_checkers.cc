@@ -39,13 +39,13 @@ std::vector<http::Record> ToRecordVector(const types::ColumnWrapperRecordBatch&
 
   for (const auto& idx : indices) {
     http::Record r;
-    r.req.req_path = rb[kHTTPReqPathIdx]->Get<types::StringValue>(idx);
-    r.req.req_method = rb[kHTTPReqMethodIdx]->Get<types::StringValue>(idx);
-    r.req.body = rb[kHTTPReqBodyIdx]->Get<types::StringValue>(idx);
+    r.req.req_path = rb[kHTTPReqPathIdx]->GetView(idx);
+    r.req.req_method = rb[kHTTPReqMethodIdx]->GetView(idx);
+    r.req.body = rb[kHTTPReqBodyIdx]->GetView(idx);
 
     r.resp.resp_status = rb[kHTTPRespStatusIdx]->Get<types::Int64Value>(idx).val;
-    r.resp.resp_message = rb[kHTTPRespMessageIdx]->Get<types::StringValue>(idx);
-    r.resp.body = rb[kHTTPRespBodyIdx]->Get<types::StringValue>(idx);
+    r.resp.resp_message = rb[kHTTPRespMessageIdx]->GetView(idx);
+    r.resp.body = rb[kHTTPRespBodyIdx]->GetView(idx);
     result.push_back(r);
   }
   return result;
@@ -71,17 +71,19 @@ ContainsWithRelativeOrder(std::vector<Record> actual_records, Records... expecte
 inline auto EqHTTPReq(const protocols::http::Message& x) {
   using ::testing::Field;
 
-  return AllOf(Field(&protocols::http::Message::req_path, ::testing::Eq(x.req_path)),
-               Field(&protocols::http::Message::req_method, ::testing::StrEq(x.req_method)),
-               Field(&protocols::http::Message::body, ::testing::StrEq(x.body)));
+  return AllOf(
+      Field(&protocols::http::Message::req_path, ::testing::Eq(x.req_path)),
+      Field(&protocols::http::Message::req_method, ::testing::StrEq(std::string(x.req_method))),
+      Field(&protocols::http::Message::body, ::testing::StrEq(std::string(x.body))));
 }
 
 inline auto EqHTTPResp(const protocols::http::Message& x) {
   using ::testing::Field;
 
-  return AllOf(Field(&protocols::http::Message::resp_status, ::testing::Eq(x.resp_status)),
-               Field(&protocols::http::Message::resp_message, ::testing::StrEq(x.resp_message)),
-               Field(&protocols::http::Message::body, ::testing::StrEq(x.body)));
+  return AllOf(
+      Field(&protocols::http::Message::resp_status, ::testing::Eq(x.resp_status)),
+      Field(&protocols::http::Message::resp_message, ::testing::StrEq(std::string(x.resp_message))),
+      Field(&protocols::http::Message::body, ::testing::StrEq(std::string(x.body))));
 }
 
 // TODO(yzhao): http::Record misses many fields from the records in http data table. Consider adding
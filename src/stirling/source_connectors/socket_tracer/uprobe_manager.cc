@@ -51,6 +51,11 @@ DEFINE_bool(stirling_enable_grpc_c_tracing,
 DEFINE_double(stirling_rescan_exp_backoff_factor, 2.0,
               "Exponential backoff factor used in decided how often to rescan binaries for "
               "dynamically loaded libraries");
+DEFINE_string(stirling_uprobe_symaddrs_cache_path, "",
+              "If set, the symbol addresses of analyzed Go binaries are persisted to this file, "
+              "keyed by build-id, so that they need not be recomputed after a restart. "
+              "Should be on a host volume to survive restarts of the PEM pod. The file is tagged "
+              "with the build-id of Stirling, and files written by other builds are ignored.");
 
 namespace px {
 namespace stirling {
@@ -62,7 +67,29 @@ using ::px::stirling::utils::KernelVersion;
 using ::px::stirling::utils::KernelVersionOrder;
 using ::px::system::ProcPidRootPath;
 
-UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc) : bcc_(bcc) {
+// Bounds the size of the symaddrs cache; the least recently used binaries are dropped.
+constexpr size_t kMaxSymAddrsCacheEntries = 4096;
+
+namespace {
+
+// Symaddrs are only valid for the build that computed them, so the cache file is tagged with
+// the build-id of the running binary. Returns an empty string if the cache file is not used,
+// or if the build-id is unknown, in which case the cache is not persisted.
+std::string SymAddrsCacheFingerprint() {
+  if (FLAGS_stirling_uprobe_symaddrs_cache_path.empty()) {
+    return "";
+  }
+  StatusOr<std::unique_ptr<ElfReader>> elf_reader = ElfReader::Create("/proc/self/exe");
+  if (!elf_reader.ok()) {
+    return "";
+  }
+  return elf_reader.ValueOrDie()->BuildID().ConsumeValueOr("");
+}
+
+}  // namespace
+
+UProbeManager::UProbeManager(bpf_tools::BCCWrapper* bcc)
+    : bcc_(bcc), symaddrs_cache_(kMaxSymAddrsCacheEntries, SymAddrsCacheFingerprint()) {
   proc_parser_ = std::make_unique<system::ProcParser>();
 }
 
@@ -83,6 +110,24 @@ void UProbeManager::Init(bool enable_http2_tracing, bool disable_self_probing) {
           bcc_, "node_tlswrap_symaddrs_map");
   grpc_c_versions_map_ =
       UserSpaceManagedBPFMap<uint32_t, uint64_t>::Create(bcc_, "grpc_c_versions");
+
+  if (!FLAGS_stirling_uprobe_symaddrs_cache_path.empty() &&
+      symaddrs_cache_.fingerprint().empty()) {
+    LOG(WARNING) << "Not persisting the symaddrs cache: the build-id of Stirling is unknown.";
+  }
+  if (!FLAGS_stirling_uprobe_symaddrs_cache_path.empty() &&
+      !symaddrs_cache_.fingerprint().empty() &&
+      fs::Exists(FLAGS_stirling_uprobe_symaddrs_cache_path)) {
+    Status s = symaddrs_cache_.Load(FLAGS_stirling_uprobe_symaddrs_cache_path);
+    if (s.ok()) {
+      LOG(INFO) << absl::Substitute("Loaded symaddrs of $0 binaries from $1.",
+                                    symaddrs_cache_.size(),
+                                    FLAGS_stirling_uprobe_symaddrs_cache_path);
+    } else {
+      LOG(WARNING) << absl::Substitute("Ignoring symaddrs cache $0: $1",
+                                       FLAGS_stirling_uprobe_symaddrs_cache_path, s.msg());
+    }
+  }
 }
 
 void UProbeManager::NotifyMMapEvent(upid_t upid) {
@@ -166,39 +211,74 @@ Status UProbeManager::UpdateOpenSSLSymAddrs(obj_tools::RawFptrManager* fptr_mana
   return Status::OK();
 }
 
-Status UProbeManager::UpdateGoCommonSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                             const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_common_symaddrs_t symaddrs,
-                      GoCommonSymAddrs(elf_reader, dwarf_reader));
-
+void UProbeManager::UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
+                                           const std::vector<int32_t>& pids) {
   for (auto& pid : pids) {
     go_common_symaddrs_map_->UpdateValue(pid, symaddrs);
   }
-
-  return Status::OK();
 }
 
-Status UProbeManager::UpdateGoHTTP2SymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                            const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_http2_symaddrs_t symaddrs,
-                      GoHTTP2SymAddrs(elf_reader, dwarf_reader));
-
+void UProbeManager::UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
+                                          const std::vector<int32_t>& pids) {
   for (auto& pid : pids) {
     go_http2_symaddrs_map_->UpdateValue(pid, symaddrs);
   }
-
-  return Status::OK();
 }
 
-Status UProbeManager::UpdateGoTLSSymAddrs(ElfReader* elf_reader, DwarfReader* dwarf_reader,
-                                          const std::vector<int32_t>& pids) {
-  PX_ASSIGN_OR_RETURN(struct go_tls_symaddrs_t symaddrs, GoTLSSymAddrs(elf_reader, dwarf_reader));
-
+void UProbeManager::UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
+                                        const std::vector<int32_t>& pids) {
   for (auto& pid : pids) {
     go_tls_symaddrs_map_->UpdateValue(pid, symaddrs);
   }
+}
 
-  return Status::OK();
+StatusOr<GoBinarySymAddrs> UProbeManager::GetGoBinarySymAddrs(const std::string& binary,
+                                                              ElfReader* elf_reader) {
+  // Binaries without a build-id are analyzed every time, since there is no safe cache key.
+  StatusOr<std::string> build_id = elf_reader->BuildID();
+  if (build_id.ok()) {
+    const GoBinarySymAddrs* cached = symaddrs_cache_.Lookup(build_id.ValueOrDie());
+    if (cached != nullptr) {
+      return *cached;
+    }
+  }
+
+  // The DwarfReader is memory intensive and slow to create; this is what the cache avoids.
+  StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
+      DwarfReader::CreateIndexingAll(binary);
+  if (!dwarf_reader_status.ok()) {
+    return error::Internal("Failed to get binary $0 debug symbols. Message = $1", binary,
+                           dwarf_reader_status.msg());
+  }
+  std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
+
+  GoBinarySymAddrs symaddrs;
+  StatusOr<struct go_common_symaddrs_t> common = GoCommonSymAddrs(elf_reader, dwarf_reader.get());
+  if (common.ok()) {
+    symaddrs.common = common.ConsumeValueOrDie();
+  }
+  StatusOr<struct go_tls_symaddrs_t> tls = GoTLSSymAddrs(elf_reader, dwarf_reader.get());
+  if (tls.ok()) {
+    symaddrs.tls = tls.ConsumeValueOrDie();
+  }
+  StatusOr<struct go_http2_symaddrs_t> http2 = GoHTTP2SymAddrs(elf_reader, dwarf_reader.get());
+  if (http2.ok()) {
+    symaddrs.http2 = http2.ConsumeValueOrDie();
+  }
+
+  if (build_id.ok()) {
+    symaddrs_cache_.Insert(build_id.ValueOrDie(), symaddrs);
+  }
+  return symaddrs;
+}
+
+void UProbeManager::SaveSymAddrsCache() {
+  if (FLAGS_stirling_uprobe_symaddrs_cache_path.empty() ||
+      symaddrs_cache_.fingerprint().empty() || !symaddrs_cache_.dirty()) {
+    return;
+  }
+  Status s = symaddrs_cache_.Save(FLAGS_stirling_uprobe_symaddrs_cache_path);
+  LOG_IF(WARNING, !s.ok()) << absl::Substitute("Failed to save symaddrs cache: $0", s.msg());
 }
 
 Status UProbeManager::UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
@@ -416,17 +496,18 @@ StatusOr<int> UProbeManager::AttachNodeJsOpenSSLUprobes(const uint32_t pid) {
 
 StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
                                                 obj_tools::ElfReader* elf_reader,
-                                                obj_tools::DwarfReader* dwarf_reader,
+                                                const GoBinarySymAddrs& symaddrs,
                                                 const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symbols_map on all new PIDs.
-  Status s = UpdateGoTLSSymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!symaddrs.tls.has_value()) {
     // Doesn't appear to be a binary with the mandatory symbols.
     // Might not even be a golang binary.
     // Either way, not of interest to probe.
     return 0;
   }
 
+  // Step 1: Update BPF symbols_map on all new PIDs.
+  UpdateGoTLSSymAddrs(*symaddrs.tls, pids);
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_tls_probed_binaries_.insert(binary);
   if (!result.second) {
@@ -438,14 +519,15 @@ StatusOr<int> UProbeManager::AttachGoTLSUProbes(const std::string& binary,
 
 StatusOr<int> UProbeManager::AttachGoHTTP2UProbes(const std::string& binary,
                                                   obj_tools::ElfReader* elf_reader,
-                                                  obj_tools::DwarfReader* dwarf_reader,
+                                                  const GoBinarySymAddrs& symaddrs,
                                                   const std::vector<int32_t>& pids) {
-  // Step 1: Update BPF symaddrs for this binary.
-  Status s = UpdateGoHTTP2SymAddrs(elf_reader, dwarf_reader, pids);
-  if (!s.ok()) {
+  if (!symaddrs.http2.has_value()) {
     return 0;
   }
 
+  // Step 1: Update BPF symaddrs for this binary.
+  UpdateGoHTTP2SymAddrs(*symaddrs.http2, pids);
+
   // Step 2: Deploy uprobes on all new binaries.
   auto result = go_http2_probed_binaries_.insert(binary);
   if (!result.second) {
@@ -733,27 +815,23 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
       continue;
     }
 
-    StatusOr<std::unique_ptr<DwarfReader>> dwarf_reader_status =
-        DwarfReader::CreateIndexingAll(binary);
-    if (!dwarf_reader_status.ok()) {
-      VLOG(1) << absl::Substitute(
-          "Failed to get binary $0 debug symbols. Cannot deploy uprobes. "
-          "Message = $1",
-          binary, dwarf_reader_status.msg());
+    StatusOr<GoBinarySymAddrs> symaddrs_status = GetGoBinarySymAddrs(binary, elf_reader.get());
+    if (!symaddrs_status.ok()) {
+      VLOG(1) << absl::Substitute("Cannot deploy uprobes. Message = $0", symaddrs_status.msg());
       continue;
     }
-    std::unique_ptr<DwarfReader> dwarf_reader = dwarf_reader_status.ConsumeValueOrDie();
-    Status s = UpdateGoCommonSymAddrs(elf_reader.get(), dwarf_reader.get(), pid_vec);
-    if (!s.ok()) {
+    const GoBinarySymAddrs symaddrs = symaddrs_status.ConsumeValueOrDie();
+    if (!symaddrs.common.has_value()) {
       VLOG(1) << absl::Substitute(
           "Golang binary $0 does not have the mandatory symbols (e.g. TCPConn).", binary);
       continue;
     }
+    UpdateGoCommonSymAddrs(*symaddrs.common, pid_vec);
 
     // GoTLS Probes.
     {
       StatusOr<int> attach_status =
-          AttachGoTLSUProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+          AttachGoTLSUProbes(binary, elf_reader.get(), symaddrs, pid_vec);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoTLSUProbes");
@@ -767,7 +845,7 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
     // Go HTTP2 Probes.
     if (cfg_enable_http2_tracing_) {
       StatusOr<int> attach_status =
-          AttachGoHTTP2UProbes(binary, elf_reader.get(), dwarf_reader.get(), pid_vec);
+          AttachGoHTTP2UProbes(binary, elf_reader.get(), symaddrs, pid_vec);
       if (!attach_status.ok()) {
         monitor_.AppendSourceStatusRecord("socket_tracer", attach_status.status(),
                                           "AttachGoHTTP2UProbes");
@@ -779,6 +857,8 @@ int UProbeManager::DeployGoUProbes(const absl::flat_hash_set<md::UPID>& pids) {
     }
   }
 
+  SaveSymAddrsCache();
+
   return uprobe_count;
 }
 
@@ -37,6 +37,7 @@
 #include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
 
 #include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs.h"
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
 #include "src/stirling/utils/detect_application.h"
 #include "src/stirling/utils/monitor.h"
 #include "src/stirling/utils/proc_path_tools.h"
@@ -45,6 +46,7 @@
 DECLARE_bool(stirling_rescan_for_dlopen);
 DECLARE_bool(stirling_enable_grpc_c_tracing);
 DECLARE_double(stirling_rescan_exp_backoff_factor);
+DECLARE_string(stirling_uprobe_symaddrs_cache_path);
 
 namespace px {
 namespace stirling {
@@ -494,7 +496,7 @@ class UProbeManager {
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
    * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param symaddrs Symbol addresses of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not considered an error if the binary
@@ -502,7 +504,7 @@ class UProbeManager {
    *         zero.
    */
   StatusOr<int> AttachGoHTTP2UProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                     obj_tools::DwarfReader* dwarf_reader,
+                                     const GoBinarySymAddrs& symaddrs,
                                      const std::vector<int32_t>& pids);
 
   /**
@@ -511,16 +513,27 @@ class UProbeManager {
    *
    * @param binary The path to the binary on which to deploy Go HTTP2 probes.
    * @param elf_reader ELF reader for the binary.
-   * @param dwarf_reader DWARF reader for the binary.
+   * @param symaddrs Symbol addresses of the binary.
    * @param pids The list of PIDs that are new instances of the binary. Used to populate symbol
    *             addresses.
    * @return The number of uprobes deployed, or error. It is not an error if the binary
    *         is not a Go binary or doesn't use Go TLS; instead the return value will be zero.
    */
   StatusOr<int> AttachGoTLSUProbes(const std::string& binary, obj_tools::ElfReader* elf_reader,
-                                   obj_tools::DwarfReader* dwarf_reader,
+                                   const GoBinarySymAddrs& symaddrs,
                                    const std::vector<int32_t>& new_pids);
 
+  /**
+   * Returns the symbol addresses of a Go binary. They are read from the symaddrs cache if the
+   * binary was analyzed before, possibly by a previous instance of Stirling; otherwise they are
+   * computed from the binary's DWARF information, and cached.
+   */
+  StatusOr<GoBinarySymAddrs> GetGoBinarySymAddrs(const std::string& binary,
+                                                 obj_tools::ElfReader* elf_reader);
+
+  // Writes the symaddrs cache to disk, if persistence is enabled and it has new entries.
+  void SaveSymAddrsCache();
+
   /**
    * Attaches the required probes for OpenSSL tracing to the specified PID, if it uses OpenSSL.
    *
@@ -566,14 +579,12 @@ class UProbeManager {
 
   Status UpdateOpenSSLSymAddrs(px::stirling::obj_tools::RawFptrManager* fptrManager,
                                std::filesystem::path container_lib, uint32_t pid);
-  Status UpdateGoCommonSymAddrs(obj_tools::ElfReader* elf_reader,
-                                obj_tools::DwarfReader* dwarf_reader,
-                                const std::vector<int32_t>& pids);
-  Status UpdateGoHTTP2SymAddrs(obj_tools::ElfReader* elf_reader,
-                               obj_tools::DwarfReader* dwarf_reader,
-                               const std::vector<int32_t>& pids);
-  Status UpdateGoTLSSymAddrs(obj_tools::ElfReader* elf_reader, obj_tools::DwarfReader* dwarf_reader,
+  void UpdateGoCommonSymAddrs(const struct go_common_symaddrs_t& symaddrs,
+                              const std::vector<int32_t>& pids);
+  void UpdateGoHTTP2SymAddrs(const struct go_http2_symaddrs_t& symaddrs,
                              const std::vector<int32_t>& pids);
+  void UpdateGoTLSSymAddrs(const struct go_tls_symaddrs_t& symaddrs,
+                           const std::vector<int32_t>& pids);
   Status UpdateNodeTLSWrapSymAddrs(int32_t pid, const std::filesystem::path& node_exe,
                                    const SemVer& ver);
 
@@ -618,6 +629,10 @@ class UProbeManager {
   absl::flat_hash_set<std::string> nodejs_binaries_;
   absl::flat_hash_set<std::string> grpc_c_probed_binaries_;
 
+  // Symbol addresses of analyzed Go binaries, keyed by build-id. Persisted across restarts
+  // when --stirling_uprobe_symaddrs_cache_path is set.
+  UProbeSymAddrsCache symaddrs_cache_;
+
   // BPF maps through which the addresses of symbols for a given pid are communicated to uprobes.
   std::unique_ptr<UserSpaceManagedBPFMap<uint32_t, struct openssl_symaddrs_t>>
       openssl_symaddrs_map_;
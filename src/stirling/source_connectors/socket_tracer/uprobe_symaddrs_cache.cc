@@ -0,0 +1,208 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace px {
+namespace stirling {
+
+namespace {
+
+constexpr std::string_view kMagic = "PXSYMADDRS";
+constexpr uint32_t kVersion = 2;
+
+enum PresenceBits : uint8_t {
+  kHasCommon = 1 << 0,
+  kHasTLS = 1 << 1,
+  kHasHTTP2 = 1 << 2,
+};
+
+template <typename T>
+void AppendPOD(const T& val, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+// Reads POD values out of the cache file, failing on truncated input.
+class PODReader {
+ public:
+  explicit PODReader(std::string_view buf) : buf_(buf) {}
+
+  template <typename T>
+  bool Read(T* val) {
+    if (buf_.size() < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(val, buf_.data(), sizeof(T));
+    buf_.remove_prefix(sizeof(T));
+    return true;
+  }
+
+  bool ReadString(size_t len, std::string* str) {
+    if (buf_.size() < len) {
+      return false;
+    }
+    str->assign(buf_.data(), len);
+    buf_.remove_prefix(len);
+    return true;
+  }
+
+  bool empty() const { return buf_.empty(); }
+
+ private:
+  std::string_view buf_;
+};
+
+// The layout of the symaddrs structs, and the build that computed them, are part of the header.
+void AppendHeader(std::string_view fingerprint, uint32_t num_entries, std::string* out) {
+  out->append(kMagic);
+  AppendPOD(kVersion, out);
+  AppendPOD(static_cast<uint32_t>(sizeof(struct go_common_symaddrs_t)), out);
+  AppendPOD(static_cast<uint32_t>(sizeof(struct go_tls_symaddrs_t)), out);
+  AppendPOD(static_cast<uint32_t>(sizeof(struct go_http2_symaddrs_t)), out);
+  AppendPOD(static_cast<uint32_t>(fingerprint.size()), out);
+  out->append(fingerprint);
+  AppendPOD(num_entries, out);
+}
+
+}  // namespace
+
+const GoBinarySymAddrs* UProbeSymAddrsCache::Lookup(const std::string& build_id) {
+  auto iter = entries_.find(build_id);
+  if (iter == entries_.end()) {
+    return nullptr;
+  }
+  iter->second.last_use = ++use_counter_;
+  return &iter->second.symaddrs;
+}
+
+void UProbeSymAddrsCache::Insert(const std::string& build_id, GoBinarySymAddrs symaddrs) {
+  entries_[build_id] = Entry{std::move(symaddrs), ++use_counter_};
+  dirty_ = true;
+  EvictLeastRecentlyUsed();
+}
+
+void UProbeSymAddrsCache::EvictLeastRecentlyUsed() {
+  // Inserts are rare (once per newly seen Go binary), so a linear scan is cheap enough.
+  while (entries_.size() > max_entries_) {
+    auto lru = std::min_element(entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+      return a.second.last_use < b.second.last_use;
+    });
+    entries_.erase(lru);
+  }
+}
+
+Status UProbeSymAddrsCache::Load(const std::filesystem::path& path) {
+  PX_ASSIGN_OR_RETURN(std::string contents, ReadFileToString(path, std::ios_base::binary));
+
+  std::string expected_header;
+  AppendHeader(fingerprint_, /*num_entries*/ 0, &expected_header);
+  const size_t header_size_without_count = expected_header.size() - sizeof(uint32_t);
+  if (contents.compare(0, header_size_without_count, expected_header, 0,
+                       header_size_without_count) != 0) {
+    return error::FailedPrecondition(
+        "Symaddrs cache $0 has an incompatible format, or was written by a different build.",
+        path.string());
+  }
+
+  PODReader reader(std::string_view(contents).substr(header_size_without_count));
+  uint32_t num_entries;
+  if (!reader.Read(&num_entries)) {
+    return error::Internal("Symaddrs cache $0 is truncated.", path.string());
+  }
+
+  // Parse everything before touching the cache, so that a corrupt file has no effect.
+  std::vector<std::pair<std::string, GoBinarySymAddrs>> parsed;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    uint32_t build_id_len;
+    std::string build_id;
+    uint8_t presence;
+    GoBinarySymAddrs symaddrs;
+    bool ok = reader.Read(&build_id_len) && reader.ReadString(build_id_len, &build_id) &&
+              reader.Read(&presence);
+    if (ok && (presence & kHasCommon)) {
+      ok = reader.Read(&symaddrs.common.emplace());
+    }
+    if (ok && (presence & kHasTLS)) {
+      ok = reader.Read(&symaddrs.tls.emplace());
+    }
+    if (ok && (presence & kHasHTTP2)) {
+      ok = reader.Read(&symaddrs.http2.emplace());
+    }
+    if (!ok) {
+      return error::Internal("Symaddrs cache $0 is truncated.", path.string());
+    }
+    parsed.emplace_back(std::move(build_id), std::move(symaddrs));
+  }
+  if (!reader.empty()) {
+    return error::Internal("Symaddrs cache $0 has trailing data.", path.string());
+  }
+
+  for (auto& [build_id, symaddrs] : parsed) {
+    // Loaded entries are older than any entry inserted in this process.
+    entries_.try_emplace(std::move(build_id), Entry{std::move(symaddrs), /*last_use*/ 0});
+  }
+  EvictLeastRecentlyUsed();
+  return Status::OK();
+}
+
+Status UProbeSymAddrsCache::Save(const std::filesystem::path& path) {
+  std::string contents;
+  AppendHeader(fingerprint_, static_cast<uint32_t>(entries_.size()), &contents);
+  for (const auto& [build_id, entry] : entries_) {
+    const GoBinarySymAddrs& symaddrs = entry.symaddrs;
+
+    uint8_t presence = 0;
+    presence |= symaddrs.common.has_value() ? kHasCommon : 0;
+    presence |= symaddrs.tls.has_value() ? kHasTLS : 0;
+    presence |= symaddrs.http2.has_value() ? kHasHTTP2 : 0;
+
+    AppendPOD(static_cast<uint32_t>(build_id.size()), &contents);
+    contents.append(build_id);
+    AppendPOD(presence, &contents);
+    if (symaddrs.common.has_value()) {
+      AppendPOD(*symaddrs.common, &contents);
+    }
+    if (symaddrs.tls.has_value()) {
+      AppendPOD(*symaddrs.tls, &contents);
+    }
+    if (symaddrs.http2.has_value()) {
+      AppendPOD(*symaddrs.http2, &contents);
+    }
+  }
+
+  const std::filesystem::path tmp_path = path.string() + ".tmp";
+  PX_RETURN_IF_ERROR(WriteFileFromString(tmp_path, contents, std::ios_base::binary));
+
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path, ec);
+  if (ec) {
+    return error::Internal("Failed to replace symaddrs cache $0: $1", path.string(), ec.message());
+  }
+
+  dirty_ = false;
+  return Status::OK();
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <absl/container/flat_hash_map.h>
+
+#include "src/common/base/base.h"
+#include "src/stirling/source_connectors/socket_tracer/bcc_bpf_intf/symaddrs.h"
+
+namespace px {
+namespace stirling {
+
+/**
+ * The symaddrs of a Go binary. A member is empty if the binary lacks the symbols it requires.
+ */
+struct GoBinarySymAddrs {
+  std::optional<struct go_common_symaddrs_t> common;
+  std::optional<struct go_tls_symaddrs_t> tls;
+  std::optional<struct go_http2_symaddrs_t> http2;
+};
+
+/**
+ * Caches the symaddrs of Go binaries, keyed by build-id, so that the expensive DWARF analysis
+ * of a binary is done once per binary rather than once per PEM lifetime.
+ *
+ * The cache can be saved to, and loaded from, a local file, so that it survives PEM restarts.
+ * The symaddrs depend on the code that computed them, and the file layout follows the in-memory
+ * layout of the symaddrs structs, so the file is only ever read back by the same PEM build:
+ * its header records the fingerprint of the build that wrote it, and a file with a different
+ * fingerprint is rejected.
+ *
+ * The cache holds at most max_entries binaries; the least recently used ones are evicted.
+ */
+class UProbeSymAddrsCache {
+ public:
+  /**
+   * @param fingerprint Identifies the build computing the symaddrs, such as its build-id.
+   */
+  UProbeSymAddrsCache(size_t max_entries, std::string fingerprint)
+      : max_entries_(max_entries), fingerprint_(std::move(fingerprint)) {}
+
+  /**
+   * Returns the cached symaddrs of the binary with the given build-id, or nullptr.
+   */
+  const GoBinarySymAddrs* Lookup(const std::string& build_id);
+
+  void Insert(const std::string& build_id, GoBinarySymAddrs symaddrs);
+
+  /**
+   * Adds the entries in the file to the cache.
+   */
+  Status Load(const std::filesystem::path& path);
+
+  /**
+   * Writes the entries to the file. The file is replaced atomically, so a crash while saving
+   * never leaves a truncated cache behind.
+   */
+  Status Save(const std::filesystem::path& path);
+
+  // Whether entries were inserted since the cache was last loaded or saved.
+  bool dirty() const { return dirty_; }
+
+  size_t size() const { return entries_.size(); }
+
+  const std::string& fingerprint() const { return fingerprint_; }
+
+ private:
+  struct Entry {
+    GoBinarySymAddrs symaddrs;
+    uint64_t last_use = 0;
+  };
+
+  // Evicts the least recently used entries until at most max_entries_ remain.
+  void EvictLeastRecentlyUsed();
+
+  const size_t max_entries_;
+  const std::string fingerprint_;
+  absl::flat_hash_map<std::string, Entry> entries_;
+  uint64_t use_counter_ = 0;
+  bool dirty_ = false;
+};
+
+}  // namespace stirling
+}  // namespace px
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/stirling/source_connectors/socket_tracer/uprobe_symaddrs_cache.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+#include "src/common/testing/testing.h"
+
+namespace px {
+namespace stirling {
+
+using ::px::testing::TempDir;
+
+constexpr char kFingerprint[] = "0123456789abcdef";
+
+GoBinarySymAddrs TestSymAddrs(int32_t seed) {
+  GoBinarySymAddrs symaddrs;
+  symaddrs.common.emplace();
+  std::memset(&*symaddrs.common, 0, sizeof(*symaddrs.common));
+  symaddrs.common->net_TCPConn = 0x1000 + seed;
+  symaddrs.common->FD_Sysfd_offset = 16;
+  symaddrs.common->g_goid_offset = 152 + seed;
+  symaddrs.tls.emplace();
+  std::memset(&*symaddrs.tls, 0, sizeof(*symaddrs.tls));
+  return symaddrs;
+}
+
+TEST(UProbeSymAddrsCacheTest, SaveAndLoad) {
+  TempDir tmp_dir;
+  const std::filesystem::path cache_file = tmp_dir.path() / "symaddrs.cache";
+
+  UProbeSymAddrsCache cache(/*max_entries*/ 10, kFingerprint);
+  EXPECT_EQ(cache.Lookup("abc"), nullptr);
+  cache.Insert("abc", TestSymAddrs(1));
+  cache.Insert("go:def", GoBinarySymAddrs{});
+  EXPECT_TRUE(cache.dirty());
+  ASSERT_OK(cache.Save(cache_file));
+  EXPECT_FALSE(cache.dirty());
+
+  UProbeSymAddrsCache loaded(/*max_entries*/ 10, kFingerprint);
+  ASSERT_OK(loaded.Load(cache_file));
+  EXPECT_EQ(loaded.size(), 2);
+  EXPECT_FALSE(loaded.dirty());
+
+  const GoBinarySymAddrs* symaddrs = loaded.Lookup("abc");
+  ASSERT_NE(symaddrs, nullptr);
+  ASSERT_TRUE(symaddrs->common.has_value());
+  EXPECT_EQ(symaddrs->common->net_TCPConn, 0x1001);
+  EXPECT_EQ(symaddrs->common->FD_Sysfd_offset, 16);
+  EXPECT_EQ(symaddrs->common->g_goid_offset, 153);
+  EXPECT_TRUE(symaddrs->tls.has_value());
+  EXPECT_FALSE(symaddrs->http2.has_value());
+
+  // Binaries without the required symbols are cached too, so they are not analyzed again.
+  symaddrs = loaded.Lookup("go:def");
+  ASSERT_NE(symaddrs, nullptr);
+  EXPECT_FALSE(symaddrs->common.has_value());
+}
+
+TEST(UProbeSymAddrsCacheTest, EvictsLeastRecentlyUsed) {
+  TempDir tmp_dir;
+  const std::filesystem::path cache_file = tmp_dir.path() / "symaddrs.cache";
+
+  UProbeSymAddrsCache cache(/*max_entries*/ 2, kFingerprint);
+  cache.Insert("a", TestSymAddrs(1));
+  cache.Insert("b", TestSymAddrs(2));
+  cache.Lookup("a");
+  cache.Insert("c", TestSymAddrs(3));
+  EXPECT_EQ(cache.size(), 2);
+  EXPECT_NE(cache.Lookup("a"), nullptr);
+  EXPECT_EQ(cache.Lookup("b"), nullptr);
+  EXPECT_NE(cache.Lookup("c"), nullptr);
+  ASSERT_OK(cache.Save(cache_file));
+
+  UProbeSymAddrsCache loaded(/*max_entries*/ 2, kFingerprint);
+  ASSERT_OK(loaded.Load(cache_file));
+  EXPECT_NE(loaded.Lookup("a"), nullptr);
+  EXPECT_EQ(loaded.Lookup("b"), nullptr);
+  EXPECT_NE(loaded.Lookup("c"), nullptr);
+
+  // Loading never grows the cache beyond max_entries.
+  UProbeSymAddrsCache small(/*max_entries*/ 1, kFingerprint);
+  ASSERT_OK(small.Load(cache_file));
+  EXPECT_EQ(small.size(), 1);
+}
+
+TEST(UProbeSymAddrsCacheTest, RejectsFilesOfOtherBuilds) {
+  TempDir tmp_dir;
+  const std::filesystem::path cache_file = tmp_dir.path() / "symaddrs.cache";
+
+  UProbeSymAddrsCache cache(/*max_entries*/ 10, kFingerprint);
+  cache.Insert("abc", TestSymAddrs(1));
+  ASSERT_OK(cache.Save(cache_file));
+
+  UProbeSymAddrsCache loaded(/*max_entries*/ 10, "other-build");
+  EXPECT_NOT_OK(loaded.Load(cache_file));
+  EXPECT_EQ(loaded.size(), 0);
+}
+
+TEST(UProbeSymAddrsCacheTest, RejectsCorruptFiles) {
+  TempDir tmp_dir;
+  const std::filesystem::path cache_file = tmp_dir.path() / "symaddrs.cache";
+
+  UProbeSymAddrsCache cache(/*max_entries*/ 10, kFingerprint);
+  cache.Insert("abc", TestSymAddrs(1));
+  ASSERT_OK(cache.Save(cache_file));
+  ASSERT_OK_AND_ASSIGN(std::string contents, ReadFileToString(cache_file));
+
+  UProbeSymAddrsCache loaded(/*max_entries*/ 10, kFingerprint);
+
+  ASSERT_OK(WriteFileFromString(cache_file, contents.substr(0, contents.size() - 1)));
+  EXPECT_NOT_OK(loaded.Load(cache_file));
+
+  ASSERT_OK(WriteFileFromString(cache_file, "not a symaddrs cache"));
+  EXPECT_NOT_OK(loaded.Load(cache_file));
+
+  EXPECT_NOT_OK(loaded.Load(tmp_dir.path() / "missing.cache"));
+  EXPECT_EQ(loaded.size(), 0);
+}
+
+}  // namespace stirling
+}  // namespace px
@@ -130,10 +130,12 @@ class BatchSizeAccountant {
    * update hot_bytes_ and cold_bytes_ accordingly. It returns the number of rows that need to be
    * removed from start of the first hot batch in order to prevent duplicated data between the hot
    * and cold stores.
+   * @param cold_batch_bytes the size of the batch in the cold store, if it differs from the size of
+   * the hot rows it was compacted from (eg. because the cold batch is encoded).
    * @return Number of rows to remove from the front of the hot store, since those rows were moved
    * into the cold store via CompactedBatchSpec.
    */
-  uint64_t FinishCompactedBatch();
+  uint64_t FinishCompactedBatch(std::optional<uint64_t> cold_batch_bytes = std::nullopt);
   /**
    * @return the number of bytes stored in the hot store.
    */
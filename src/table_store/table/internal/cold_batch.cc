@@ -0,0 +1,322 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include "src/table_store/table/internal/cold_batch.h"
+
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include "src/common/base/base.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/shared/types/type_utils.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+namespace {
+
+void PutVarint(uint64_t val, std::string* out) {
+  while (val >= 0x80) {
+    out->push_back(static_cast<char>(val | 0x80));
+    val >>= 7;
+  }
+  out->push_back(static_cast<char>(val));
+}
+
+uint64_t GetVarint(const char** ptr) {
+  uint64_t val = 0;
+  for (int shift = 0;; shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(*(*ptr)++);
+    val |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      return val;
+    }
+  }
+}
+
+// Maps signed values to unsigned ones, such that values of small magnitude get short varints.
+uint64_t ZigZagEncode(int64_t val) {
+  return (static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t val) {
+  return static_cast<int64_t>((val >> 1) ^ (~(val & 1) + 1));
+}
+
+}  // namespace
+
+template <types::DataType TDataType>
+struct ColumnCodec {
+  using NativeType = typename types::DataTypeTraits<TDataType>::native_type;
+  using BuilderType = typename types::DataTypeTraits<TDataType>::arrow_builder_type;
+
+  static constexpr bool kSupportsDeltaOfDelta =
+      TDataType == types::DataType::INT64 || TDataType == types::DataType::TIME64NS;
+
+  static auto Value(const arrow::Array* arr, int64_t idx) {
+    if constexpr (TDataType == types::DataType::STRING) {
+      return types::GetStringViewFromArrowArray(arr, idx);
+    } else {
+      return types::GetValueFromArrowArray<TDataType>(arr, idx);
+    }
+  }
+
+  static bool Equal(const arrow::Array* arr, int64_t a, int64_t b) {
+    if constexpr (TDataType == types::DataType::FLOAT64) {
+      // Compare the bit patterns, so that runs don't merge signed zeros.
+      double val_a = Value(arr, a);
+      double val_b = Value(arr, b);
+      return std::memcmp(&val_a, &val_b, sizeof(double)) == 0;
+    } else {
+      return Value(arr, a) == Value(arr, b);
+    }
+  }
+
+  // Matches the sizing of BatchSizeAccountant.
+  static int64_t ValueBytes(const arrow::Array* arr, int64_t idx) {
+    if constexpr (TDataType == types::DataType::STRING) {
+      return sizeof(int32_t) + Value(arr, idx).size();
+    } else {
+      return sizeof(NativeType);
+    }
+  }
+
+  static int64_t PlainBytes(const arrow::Array* arr) {
+    if constexpr (TDataType == types::DataType::STRING) {
+      int64_t bytes = 0;
+      for (int64_t i = 0; i < arr->length(); ++i) {
+        bytes += ValueBytes(arr, i);
+      }
+      return bytes;
+    } else {
+      return arr->length() * sizeof(NativeType);
+    }
+  }
+
+  static std::unique_ptr<BuilderType> MakeBuilder(arrow::MemoryPool* mem_pool) {
+    return std::unique_ptr<BuilderType>(
+        static_cast<BuilderType*>(types::GetArrowBuilder<TDataType>(mem_pool).release()));
+  }
+
+  template <typename TValue>
+  static void UnsafeAppend(BuilderType* builder, const TValue& val) {
+    if constexpr (TDataType == types::DataType::STRING) {
+      builder->UnsafeAppend(val.data(), static_cast<int32_t>(val.size()));
+    } else {
+      builder->UnsafeAppend(val);
+    }
+  }
+
+  static std::string EncodeDeltas(const arrow::Array* arr) {
+    std::string out;
+    uint64_t prev = 0;
+    uint64_t prev_delta = 0;
+    for (int64_t i = 0; i < arr->length(); ++i) {
+      // Unsigned arithmetic wraps around instead of overflowing.
+      uint64_t val = static_cast<uint64_t>(Value(arr, i));
+      if (i == 0) {
+        PutVarint(ZigZagEncode(static_cast<int64_t>(val)), &out);
+      } else {
+        uint64_t delta = val - prev;
+        PutVarint(ZigZagEncode(static_cast<int64_t>(delta - prev_delta)), &out);
+        prev_delta = delta;
+      }
+      prev = val;
+    }
+    return out;
+  }
+
+  static void DecodeDeltas(const std::string& deltas, int64_t length, BuilderType* builder) {
+    const char* ptr = deltas.data();
+    uint64_t val = 0;
+    uint64_t delta = 0;
+    for (int64_t i = 0; i < length; ++i) {
+      if (i == 0) {
+        val = static_cast<uint64_t>(ZigZagDecode(GetVarint(&ptr)));
+      } else {
+        delta += static_cast<uint64_t>(ZigZagDecode(GetVarint(&ptr)));
+        val += delta;
+      }
+      builder->UnsafeAppend(static_cast<NativeType>(val));
+    }
+    DCHECK_EQ(ptr, deltas.data() + deltas.size());
+  }
+
+  static EncodedColumn Encode(ArrowArrayPtr arr, arrow::MemoryPool* mem_pool) {
+    const arrow::Array* data = arr.get();
+    const int64_t length = data->length();
+    if (length == 0 || data->null_count() > 0) {
+      return EncodedColumn(std::move(arr));
+    }
+
+    int64_t plain_bytes = 0;
+    int64_t run_length_bytes = 0;
+    std::vector<uint32_t> run_ends;
+    for (int64_t i = 0; i < length; ++i) {
+      int64_t value_bytes = ValueBytes(data, i);
+      plain_bytes += value_bytes;
+      if (i + 1 == length || !Equal(data, i, i + 1)) {
+        run_ends.push_back(i + 1);
+        run_length_bytes += value_bytes + sizeof(uint32_t);
+      }
+    }
+
+    std::string deltas;
+    int64_t delta_bytes = std::numeric_limits<int64_t>::max();
+    if constexpr (kSupportsDeltaOfDelta) {
+      deltas = EncodeDeltas(data);
+      delta_bytes = deltas.size();
+    }
+
+    if (delta_bytes < plain_bytes && delta_bytes <= run_length_bytes) {
+      EncodedColumn col(TDataType, EncodedColumn::Encoding::kDeltaOfDelta, length, delta_bytes);
+      col.deltas_ = std::move(deltas);
+      return col;
+    }
+
+    if (run_length_bytes < plain_bytes) {
+      auto builder = MakeBuilder(mem_pool);
+      PX_CHECK_OK(builder->Reserve(run_ends.size()));
+      if constexpr (TDataType == types::DataType::STRING) {
+        int64_t data_bytes = 0;
+        for (uint32_t run_end : run_ends) {
+          data_bytes += Value(data, run_end - 1).size();
+        }
+        PX_CHECK_OK(builder->ReserveData(data_bytes));
+      }
+      for (uint32_t run_end : run_ends) {
+        UnsafeAppend(builder.get(), Value(data, run_end - 1));
+      }
+
+      EncodedColumn col(TDataType, EncodedColumn::Encoding::kRunLength, length, run_length_bytes);
+      PX_CHECK_OK(builder->Finish(&col.values_));
+      col.run_ends_ = std::move(run_ends);
+      return col;
+    }
+
+    return EncodedColumn(std::move(arr));
+  }
+
+  static ArrowArrayPtr Decode(const EncodedColumn& col, arrow::MemoryPool* mem_pool) {
+    if (col.encoding_ == EncodedColumn::Encoding::kPlain) {
+      return col.values_;
+    }
+
+    auto builder = MakeBuilder(mem_pool);
+    PX_CHECK_OK(builder->Reserve(col.length_));
+    if (col.encoding_ == EncodedColumn::Encoding::kRunLength) {
+      const arrow::Array* values = col.values_.get();
+      if constexpr (TDataType == types::DataType::STRING) {
+        int64_t data_bytes = 0;
+        uint32_t run_start = 0;
+        for (const auto& [i, run_end] : Enumerate(col.run_ends_)) {
+          data_bytes += (run_end - run_start) * Value(values, i).size();
+          run_start = run_end;
+        }
+        PX_CHECK_OK(builder->ReserveData(data_bytes));
+      }
+      uint32_t run_start = 0;
+      for (const auto& [i, run_end] : Enumerate(col.run_ends_)) {
+        auto val = Value(values, i);
+        for (uint32_t row = run_start; row < run_end; ++row) {
+          UnsafeAppend(builder.get(), val);
+        }
+        run_start = run_end;
+      }
+    } else if constexpr (kSupportsDeltaOfDelta) {
+      DecodeDeltas(col.deltas_, col.length_, builder.get());
+    }
+
+    ArrowArrayPtr out;
+    PX_CHECK_OK(builder->Finish(&out));
+    return out;
+  }
+};
+
+EncodedColumn::EncodedColumn(types::DataType data_type, Encoding encoding, int64_t length,
+                             int64_t bytes)
+    : data_type_(data_type), encoding_(encoding), length_(length), bytes_(bytes) {}
+
+EncodedColumn::EncodedColumn(ArrowArrayPtr arr)
+    : data_type_(types::ArrowToDataType(arr->type_id())),
+      encoding_(Encoding::kPlain),
+      length_(arr->length()),
+      bytes_(0),
+      values_(std::move(arr)) {
+#define TYPE_CASE(_dt_) bytes_ = ColumnCodec<_dt_>::PlainBytes(values_.get());
+  PX_SWITCH_FOREACH_DATATYPE(data_type_, TYPE_CASE);
+#undef TYPE_CASE
+}
+
+EncodedColumn EncodedColumn::Encode(types::DataType data_type, ArrowArrayPtr arr,
+                                    arrow::MemoryPool* mem_pool) {
+#define TYPE_CASE(_dt_) return ColumnCodec<_dt_>::Encode(std::move(arr), mem_pool);
+  PX_SWITCH_FOREACH_DATATYPE(data_type, TYPE_CASE);
+#undef TYPE_CASE
+  return EncodedColumn(std::move(arr));
+}
+
+ArrowArrayPtr EncodedColumn::Decode(arrow::MemoryPool* mem_pool) const {
+#define TYPE_CASE(_dt_) return ColumnCodec<_dt_>::Decode(*this, mem_pool);
+  PX_SWITCH_FOREACH_DATATYPE(data_type_, TYPE_CASE);
+#undef TYPE_CASE
+  return values_;
+}
+
+ColdBatch::ColdBatch(const std::vector<ArrowArrayPtr>& columns) {
+  columns_.reserve(columns.size());
+  for (const auto& col : columns) {
+    columns_.emplace_back(col);
+  }
+}
+
+ColdBatch ColdBatch::Encode(const schema::Relation& rel, const std::vector<ArrowArrayPtr>& columns,
+                            arrow::MemoryPool* mem_pool) {
+  DCHECK_EQ(rel.NumColumns(), columns.size());
+  ColdBatch batch;
+  batch.columns_.reserve(columns.size());
+  for (const auto& [col_idx, col] : Enumerate(columns)) {
+    batch.columns_.push_back(EncodedColumn::Encode(rel.col_types()[col_idx], col, mem_pool));
+  }
+  return batch;
+}
+
+size_t ColdBatch::length() const {
+  DCHECK(!columns_.empty());
+  return columns_[0].length();
+}
+
+ArrowArrayPtr ColdBatch::column(int64_t col_idx) const {
+  // Decoded columns are short-lived copies, so they use the default pool like the compactor.
+  return columns_[col_idx].Decode(arrow::default_memory_pool());
+}
+
+int64_t ColdBatch::bytes() const {
+  int64_t bytes = 0;
+  for (const auto& col : columns_) {
+    bytes += col.bytes();
+  }
+  return bytes;
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#pragma once
+
+#include <arrow/memory_pool.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/shared/types/types.h"
+#include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/types.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+/**
+ * EncodedColumn stores a single column of a cold batch. The column is either stored as a plain
+ * arrow::Array, or in one of the following encodings, and then decoded back into an arrow::Array
+ * whenever it is read:
+ *  - RunLength stores one value per run of equal consecutive values. This suits columns that stay
+ *    constant across many rows, such as the upid and pod columns of periodic metric tables.
+ *  - DeltaOfDelta stores the difference between consecutive deltas as zigzag varints. It only
+ *    applies to INT64 and TIME64NS columns, and suits values that grow at a steady rate, such as
+ *    sampling times and counters.
+ */
+class EncodedColumn {
+ public:
+  enum class Encoding {
+    kPlain,
+    kRunLength,
+    kDeltaOfDelta,
+  };
+
+  /**
+   * Creates a plain (unencoded) column.
+   */
+  explicit EncodedColumn(ArrowArrayPtr arr);
+
+  /**
+   * Encode returns the column in whichever encoding takes the fewest bytes.
+   * @param data_type the data type of the column.
+   * @param arr the column to encode.
+   * @param mem_pool arrow MemoryPool used for the encoded values.
+   */
+  static EncodedColumn Encode(types::DataType data_type, ArrowArrayPtr arr,
+                              arrow::MemoryPool* mem_pool);
+
+  /**
+   * Decode returns the column as an arrow::Array. Plain columns are returned without copying.
+   * @param mem_pool arrow MemoryPool used for the decoded array.
+   */
+  ArrowArrayPtr Decode(arrow::MemoryPool* mem_pool) const;
+
+  Encoding encoding() const { return encoding_; }
+  types::DataType data_type() const { return data_type_; }
+  int64_t length() const { return length_; }
+
+  /**
+   * @return the number of bytes used by the column. Plain columns are sized in the same way as
+   * BatchSizeAccountant sizes rows, so that encoded and plain batches can be compared.
+   */
+  int64_t bytes() const { return bytes_; }
+
+ private:
+  EncodedColumn(types::DataType data_type, Encoding encoding, int64_t length, int64_t bytes);
+
+  types::DataType data_type_;
+  Encoding encoding_;
+  int64_t length_;
+  int64_t bytes_;
+
+  // Plain: the column itself. RunLength: the value of each run.
+  ArrowArrayPtr values_;
+  // RunLength: the row index one past the end of each run.
+  std::vector<uint32_t> run_ends_;
+  // DeltaOfDelta: the first value, the first delta, and then the difference of each delta from the
+  // previous one, all as zigzag varints.
+  std::string deltas_;
+
+  template <types::DataType TDataType>
+  friend struct ColumnCodec;
+};
+
+/**
+ * ColdBatch is a batch in the cold store of a Table, made up of one EncodedColumn per column of
+ * the table.
+ */
+class ColdBatch {
+ public:
+  /**
+   * Creates a batch of plain (unencoded) columns.
+   */
+  explicit ColdBatch(const std::vector<ArrowArrayPtr>& columns);
+
+  /**
+   * Encode creates a batch in which each column uses its smallest encoding.
+   * @param rel the relation of the table.
+   * @param columns the compacted columns of the batch.
+   * @param mem_pool arrow MemoryPool used for the encoded values.
+   */
+  static ColdBatch Encode(const schema::Relation& rel, const std::vector<ArrowArrayPtr>& columns,
+                          arrow::MemoryPool* mem_pool);
+
+  /**
+   * @return the number of rows in the batch.
+   */
+  size_t length() const;
+
+  /**
+   * column returns the given column, decoding it if necessary.
+   * @param col_idx the index of the column.
+   * @return the column as an arrow::Array.
+   */
+  ArrowArrayPtr column(int64_t col_idx) const;
+
+  const EncodedColumn& encoded_column(int64_t col_idx) const { return columns_[col_idx]; }
+
+  /**
+   * @return the number of bytes used by all the columns of the batch.
+   */
+  int64_t bytes() const;
+
+ private:
+  ColdBatch() = default;
+
+  std::vector<EncodedColumn> columns_;
+};
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
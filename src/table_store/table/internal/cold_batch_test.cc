@@ -0,0 +1,150 @@
+/*
+ * Copyright 2018- The Pixie Authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/testing/testing.h"
+#include "src/shared/types/arrow_adapter.h"
+#include "src/table_store/table/internal/cold_batch.h"
+
+namespace px {
+namespace table_store {
+namespace internal {
+
+using Encoding = EncodedColumn::Encoding;
+
+template <typename TValue>
+ArrowArrayPtr MakeArray(const std::vector<TValue>& values) {
+  return types::ToArrow(values, arrow::default_memory_pool());
+}
+
+void ExpectDecodesTo(const EncodedColumn& col, const ArrowArrayPtr& expected) {
+  auto decoded = col.Decode(arrow::default_memory_pool());
+  EXPECT_EQ(expected->length(), col.length());
+  EXPECT_TRUE(decoded->Equals(expected)) << decoded->ToString() << "\n" << expected->ToString();
+}
+
+TEST(EncodedColumnTest, PlainColumn) {
+  auto arr = MakeArray(std::vector<types::StringValue>{"ab", "cde"});
+  EncodedColumn col(arr);
+  EXPECT_EQ(Encoding::kPlain, col.encoding());
+  // Each string costs its offset and its data.
+  EXPECT_EQ(2 * sizeof(int32_t) + 5, col.bytes());
+  EXPECT_EQ(arr, col.Decode(arrow::default_memory_pool()));
+}
+
+TEST(EncodedColumnTest, RunLengthConstantColumns) {
+  auto upids = MakeArray(std::vector<types::UInt128Value>(100, types::UInt128Value(1, 2)));
+  auto col = EncodedColumn::Encode(types::DataType::UINT128, upids, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kRunLength, col.encoding());
+  EXPECT_EQ(sizeof(absl::uint128) + sizeof(uint32_t), col.bytes());
+  ExpectDecodesTo(col, upids);
+
+  std::vector<types::StringValue> pod_values(50, "pl/pod-a");
+  pod_values.insert(pod_values.end(), 50, "pl/pod-b");
+  auto pods = MakeArray(pod_values);
+  col = EncodedColumn::Encode(types::DataType::STRING, pods, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kRunLength, col.encoding());
+  EXPECT_EQ(2 * (sizeof(int32_t) + 8 + sizeof(uint32_t)), col.bytes());
+  ExpectDecodesTo(col, pods);
+
+  auto bools = MakeArray(std::vector<types::BoolValue>(100, true));
+  col = EncodedColumn::Encode(types::DataType::BOOLEAN, bools, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kRunLength, col.encoding());
+  ExpectDecodesTo(col, bools);
+}
+
+TEST(EncodedColumnTest, DeltaOfDeltaPeriodicColumns) {
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> counters;
+  for (int64_t i = 0; i < 1000; ++i) {
+    // A sample every second, with a little jitter.
+    times.emplace_back(1'600'000'000'000'000'000 + i * 1'000'000'000 + (i % 3));
+    counters.emplace_back(5000 + i * 4096);
+  }
+  auto time_arr = MakeArray(times);
+  auto col =
+      EncodedColumn::Encode(types::DataType::TIME64NS, time_arr, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kDeltaOfDelta, col.encoding());
+  EXPECT_LT(col.bytes(), 1000 * sizeof(int64_t) / 4);
+  ExpectDecodesTo(col, time_arr);
+
+  auto counter_arr = MakeArray(counters);
+  col = EncodedColumn::Encode(types::DataType::INT64, counter_arr, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kDeltaOfDelta, col.encoding());
+  ExpectDecodesTo(col, counter_arr);
+}
+
+TEST(EncodedColumnTest, DeltaOfDeltaWrapsAround) {
+  // A counter that overflows: the deltas are computed with wrap-around arithmetic.
+  std::vector<types::Int64Value> values;
+  for (uint64_t i = 0; i < 100; ++i) {
+    values.emplace_back(
+        static_cast<int64_t>(static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) - 50 + i));
+  }
+  auto arr = MakeArray(values);
+  auto col = EncodedColumn::Encode(types::DataType::INT64, arr, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kDeltaOfDelta, col.encoding());
+  ExpectDecodesTo(col, arr);
+}
+
+TEST(EncodedColumnTest, KeepsIncompressibleColumnsPlain) {
+  auto arr = MakeArray(std::vector<types::Float64Value>{0.5, -0.0, 0.0, 1e300});
+  auto col = EncodedColumn::Encode(types::DataType::FLOAT64, arr, arrow::default_memory_pool());
+  EXPECT_EQ(Encoding::kPlain, col.encoding());
+  EXPECT_EQ(4 * sizeof(double), col.bytes());
+  ExpectDecodesTo(col, arr);
+}
+
+TEST(ColdBatchTest, EncodeAndReadColumns) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::UINT128,
+                        types::DataType::INT64, types::DataType::FLOAT64},
+                       {"time_", "upid", "rss_bytes", "cpu"});
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> rss;
+  std::vector<types::Float64Value> cpu;
+  for (int64_t i = 0; i < 100; ++i) {
+    times.emplace_back(1000 + i * 10);
+    rss.emplace_back(4096);
+    cpu.emplace_back(0.01 * i);
+  }
+  std::vector<ArrowArrayPtr> columns = {
+      MakeArray(times), MakeArray(std::vector<types::UInt128Value>(100, types::UInt128Value(1, 2))),
+      MakeArray(rss), MakeArray(cpu)};
+
+  ColdBatch plain(columns);
+  auto encoded = ColdBatch::Encode(rel, columns, arrow::default_memory_pool());
+  EXPECT_EQ(100, encoded.length());
+  EXPECT_LT(encoded.bytes(), plain.bytes() / 2);
+  EXPECT_EQ(Encoding::kPlain, encoded.encoded_column(3).encoding());
+
+  for (const auto& [col_idx, col] : Enumerate(columns)) {
+    EXPECT_TRUE(encoded.column(col_idx)->Equals(col));
+    EXPECT_EQ(col, plain.column(col_idx));
+  }
+}
+
+}  // namespace internal
+}  // namespace table_store
+}  // namespace px
@@ -28,6 +28,7 @@
 #include "src/shared/types/arrow_adapter.h"
 #include "src/shared/types/column_wrapper.h"
 #include "src/table_store/schema/relation.h"
+#include "src/table_store/table/internal/cold_batch.h"
 #include "src/table_store/table/internal/types.h"
 
 namespace px {
@@ -182,9 +183,7 @@ class StoreWithRowTimeAccounting {
 
     row_ids_.emplace_back(first_row_id, first_row_id + BatchLength(batch) - 1);
     if (time_col_idx_ != -1) {
-      auto first_time = GetTimeValue(batch, 0);
-      auto last_time = GetTimeValue(batch, BatchLength(batch) - 1);
-      times_.emplace_back(first_time, last_time);
+      times_.push_back(GetTimeInterval(batch));
     }
     return batch;
   }
@@ -342,7 +341,7 @@ class StoreWithRowTimeAccounting {
 
   size_t BatchLength(const TBatch& batch) const {
     if constexpr (std::is_same_v<ColdBatch, TBatch>) {
-      return batch[0]->length();
+      return batch.length();
     } else if constexpr (std::is_same_v<HotBatch, TBatch>) {
       return batch.Length();
     } else {
@@ -353,7 +352,7 @@ class StoreWithRowTimeAccounting {
   size_t FindTimeFirstGreaterThanOrEqual(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::SearchArrowArrayGreaterThanOrEqual<types::DataType::TIME64NS>(
-          batch[time_col_idx_].get(), time);
+          batch.column(time_col_idx_).get(), time);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThanOrEqual(time_col_idx_, time);
     } else {
@@ -364,7 +363,7 @@ class StoreWithRowTimeAccounting {
   size_t FindTimeFirstGreaterThan(const TBatch& batch, Time time) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       return types::SearchArrowArrayLessThanOrEqual<types::DataType::TIME64NS>(
-                 batch[time_col_idx_].get(), time) +
+                 batch.column(time_col_idx_).get(), time) +
              1;
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.FindTimeFirstGreaterThan(time_col_idx_, time);
@@ -375,8 +374,8 @@ class StoreWithRowTimeAccounting {
 
   Time GetTimeValue(const TBatch& batch, int64_t row_idx) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
-      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(batch[time_col_idx_].get(),
-                                                                      row_idx);
+      return types::GetValueFromArrowArray<types::DataType::TIME64NS>(
+          batch.column(time_col_idx_).get(), row_idx);
     } else if constexpr (std::is_same_v<TBatch, HotBatch>) {
       return batch.GetTimeValue(time_col_idx_, row_idx);
     } else {
@@ -384,12 +383,24 @@ class StoreWithRowTimeAccounting {
     }
   }
 
+  TimeInterval GetTimeInterval(const TBatch& batch) const {
+    auto last_row_idx = BatchLength(batch) - 1;
+    if constexpr (std::is_same_v<TBatch, ColdBatch>) {
+      // Decode the time column once for both ends.
+      auto times = batch.column(time_col_idx_);
+      return {types::GetValueFromArrowArray<types::DataType::TIME64NS>(times.get(), 0),
+              types::GetValueFromArrowArray<types::DataType::TIME64NS>(times.get(), last_row_idx)};
+    } else {
+      return {GetTimeValue(batch, 0), GetTimeValue(batch, last_row_idx)};
+    }
+  }
+
   Status AddBatchSliceToRowBatch(const TBatch& batch, size_t row_offset, size_t batch_size,
                                  const std::vector<int64_t>& cols,
                                  schema::RowBatch* output_rb) const {
     if constexpr (std::is_same_v<TBatch, ColdBatch>) {
       for (auto col_idx : cols) {
-        auto arr = batch[col_idx]->Slice(row_offset, batch_size);
+        auto arr = batch.column(col_idx)->Slice(row_offset, batch_size);
         PX_RETURN_IF_ERROR(output_rb->AddColumn(arr));
       }
       return Status::OK();
@@ -168,11 +168,12 @@ StatusOr<std::unique_ptr<schema::RowBatch>> Table::Cursor::GetNextRowBatch(
 }
 
 Table::Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
-             size_t compacted_batch_size)
+             size_t compacted_batch_size, bool encode_cold_batches)
     : metrics_(&(GetMetricsRegistry()), std::string(table_name)),
       rel_(relation),
       max_table_size_(max_table_size),
       compacted_batch_size_(compacted_batch_size),
+      encode_cold_batches_(encode_cold_batches),
       // TODO(james): move mem_pool into constructor.
       compactor_(rel_, arrow::default_memory_pool()) {
   absl::base_internal::SpinLockHolder cold_lock(&cold_lock_);
@@ -421,7 +422,7 @@ TableStats Table::GetTableStats() const {
   return info;
 }
 
-Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
+Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool* mem_pool) {
   const auto& compaction_spec = batch_size_accountant_->GetNextCompactedBatchSpec();
 
   PX_RETURN_IF_ERROR(
@@ -441,9 +442,17 @@ Status Table::CompactSingleBatchUnlocked(arrow::MemoryPool*) {
 
   PX_ASSIGN_OR_RETURN(std::vector<ArrowArrayPtr> out_columns, compactor_.Finish());
 
-  cold_store_->EmplaceBack(first_row_id, out_columns);
+  std::optional<uint64_t> cold_batch_bytes;
+  if (encode_cold_batches_) {
+    auto& cold_batch =
+        cold_store_->EmplaceBack(first_row_id, ColdBatch::Encode(rel_, out_columns, mem_pool));
+    // Account for the encoded size, so that encoding lets the table retain more rows.
+    cold_batch_bytes = cold_batch.bytes();
+  } else {
+    cold_store_->EmplaceBack(first_row_id, ColdBatch(out_columns));
+  }
 
-  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch();
+  auto num_rows_to_remove = batch_size_accountant_->FinishCompactedBatch(cold_batch_bytes);
   if (num_rows_to_remove > 0) {
     hot_store_->RemovePrefix(num_rows_to_remove);
   }
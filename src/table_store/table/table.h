@@ -43,6 +43,7 @@
 #include "src/table_store/schemapb/schema.pb.h"
 #include "src/table_store/table/internal/arrow_array_compactor.h"
 #include "src/table_store/table/internal/batch_size_accountant.h"
+#include "src/table_store/table/internal/cold_batch.h"
 #include "src/table_store/table/internal/record_or_row_batch.h"
 #include "src/table_store/table/internal/store_with_row_accounting.h"
 #include "src/table_store/table/internal/types.h"
@@ -111,9 +112,8 @@ class Table : public NotCopyable {
   using RowIDInterval = internal::RowIDInterval;
   using BatchID = internal::BatchID;
 
-  static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
-
  public:
+  static inline constexpr int64_t kDefaultColdBatchMinSize = 64 * 1024;
   static inline constexpr int64_t kMaxBatchesPerCompactionCall = 256;
   using StopPosition = int64_t;
   static inline std::shared_ptr<Table> Create(std::string_view table_name,
@@ -226,8 +226,15 @@ class Table : public NotCopyable {
                  size_t max_table_size)
       : Table(table_name, relation, max_table_size, kDefaultColdBatchMinSize) {}
 
+  /**
+   * @param compacted_batch_size_ the minimum size of the batches in the cold partition.
+   * @param encode_cold_batches whether to encode the columns of cold batches (see
+   * internal::EncodedColumn). Encoding suits tables that write nearly identical rows every period,
+   * such as metric tables: it lets them retain more rows within max_table_size, at the cost of
+   * decoding the columns that queries read.
+   */
   Table(std::string_view table_name, const schema::Relation& relation, size_t max_table_size,
-        size_t compacted_batch_size_);
+        size_t compacted_batch_size_, bool encode_cold_batches = false);
 
   /**
    * Get a RowBatch of data corresponding to the next data after the given cursor.
@@ -313,6 +320,7 @@ class Table : public NotCopyable {
   int64_t compacted_batches_ ABSL_GUARDED_BY(stats_lock_) = 0;
   int64_t max_table_size_ = 0;
   const int64_t compacted_batch_size_;
+  const bool encode_cold_batches_;
   mutable absl::base_internal::SpinLock hot_lock_;
   std::unique_ptr<internal::StoreWithRowTimeAccounting<internal::StoreType::Hot>> hot_store_
       ABSL_GUARDED_BY(hot_lock_);
@@ -656,6 +656,68 @@ TEST(TableTest, find_rowid_from_time_first_greater_than_or_equal_with_compaction
             table.FindRowIDFromTimeFirstGreaterThanOrEqual(24));
 }
 
+TEST(TableTest, encoded_cold_batches) {
+  schema::Relation rel({types::DataType::TIME64NS, types::DataType::UINT128,
+                        types::DataType::INT64},
+                       {"time_", "upid", "rss_bytes"});
+  constexpr int kNumBatches = 10;
+  constexpr int kRowsPerBatch = 100;
+  int64_t batch_size = kRowsPerBatch * (2 * sizeof(int64_t) + sizeof(absl::uint128));
+
+  Table plain_table("plain_table", rel, 128 * 1024, 2 * batch_size);
+  Table encoded_table("encoded_table", rel, 128 * 1024, 2 * batch_size,
+                      /*encode_cold_batches*/ true);
+
+  std::vector<types::Time64NSValue> times;
+  std::vector<types::Int64Value> rss;
+  for (int i = 0; i < kNumBatches * kRowsPerBatch; ++i) {
+    times.emplace_back(1000 + 10 * i);
+    rss.emplace_back(4096 * (i / 50));
+  }
+  for (Table* table : {&plain_table, &encoded_table}) {
+    for (int batch = 0; batch < kNumBatches; ++batch) {
+      auto time_col = std::make_shared<types::Time64NSValueColumnWrapper>(0);
+      auto upid_col = std::make_shared<types::UInt128ValueColumnWrapper>(0);
+      auto rss_col = std::make_shared<types::Int64ValueColumnWrapper>(0);
+      for (int i = batch * kRowsPerBatch; i < (batch + 1) * kRowsPerBatch; ++i) {
+        time_col->Append(times[i]);
+        upid_col->Append(types::UInt128Value(1, 2));
+        rss_col->Append(rss[i]);
+      }
+      auto wrapper_batch = std::make_unique<types::ColumnWrapperRecordBatch>();
+      wrapper_batch->push_back(time_col);
+      wrapper_batch->push_back(upid_col);
+      wrapper_batch->push_back(rss_col);
+      EXPECT_OK(table->TransferRecordBatch(std::move(wrapper_batch)));
+    }
+    EXPECT_OK(table->CompactHotToCold(arrow::default_memory_pool()));
+  }
+
+  EXPECT_EQ(kNumBatches * batch_size, plain_table.GetTableStats().bytes);
+  EXPECT_EQ(0, encoded_table.GetTableStats().hot_bytes);
+  EXPECT_LT(encoded_table.GetTableStats().cold_bytes, plain_table.GetTableStats().cold_bytes / 4);
+
+  // Reads decode the columns transparently.
+  EXPECT_EQ(250, encoded_table.FindRowIDFromTimeFirstGreaterThanOrEqual(3495));
+  EXPECT_EQ(251, encoded_table.FindRowIDFromTimeFirstGreaterThan(3500));
+  Table::Cursor cursor(&encoded_table);
+  std::vector<types::Time64NSValue> out_times;
+  std::vector<types::Int64Value> out_rss;
+  while (!cursor.Done()) {
+    auto rb = cursor.GetNextRowBatch({0, 1, 2}).ConsumeValueOrDie();
+    for (int64_t i = 0; i < rb->num_rows(); ++i) {
+      out_times.emplace_back(
+          types::GetValueFromArrowArray<types::DataType::TIME64NS>(rb->ColumnAt(0).get(), i));
+      EXPECT_EQ(absl::MakeUint128(1, 2), types::GetValueFromArrowArray<types::DataType::UINT128>(
+                                             rb->ColumnAt(1).get(), i));
+      out_rss.emplace_back(
+          types::GetValueFromArrowArray<types::DataType::INT64>(rb->ColumnAt(2).get(), i));
+    }
+  }
+  EXPECT_EQ(times, out_times);
+  EXPECT_EQ(rss, out_rss);
+}
+
 TEST(TableTest, ToProto) {
   auto table = TestTable();
   table_store::schemapb::Table table_proto;
@@ -18,6 +18,9 @@
 
 #include "src/vizier/services/agent/pem/pem_manager.h"
 
+#include <absl/container/flat_hash_set.h>
+#include <absl/strings/str_split.h>
+
 #include "src/common/system/config.h"
 #include "src/vizier/services/agent/shared/manager/exec.h"
 #include "src/vizier/services/agent/shared/manager/manager.h"
@@ -43,6 +46,12 @@ DEFINE_int32(table_store_proc_exit_events_limit_bytes,
              gflags::Int32FromEnv("PL_TABLE_STORE_PROC_EXIT_EVENTS_LIMIT_BYTES", 10 * 1024 * 1024),
              "The maximum amount of data to store in the proc_exit_events table.");
 
+DEFINE_string(table_store_encoded_tables,
+              gflags::StringFromEnv("PL_TABLE_STORE_ENCODED_TABLES",
+                                    "process_stats,network_stats,jvm_stats"),
+              "Comma-separated list of tables whose cold data is stored with delta and run-length "
+              "encoded columns. Suits tables that write nearly identical rows every period.");
+
 namespace px {
 namespace vizier {
 namespace agent {
@@ -102,6 +111,9 @@ Status PEMManager::InitSchemas() {
                               probe_status_table_size - proc_exit_events_table_size) /
                              (num_tables - 4);
 
+  absl::flat_hash_set<std::string_view> encoded_tables =
+      absl::StrSplit(FLAGS_table_store_encoded_tables, ',', absl::SkipEmpty());
+
   for (const auto& relation_info : relation_info_vec) {
     std::shared_ptr<table_store::Table> table_ptr;
     if (relation_info.name == "http_events") {
@@ -120,8 +132,11 @@ Status PEMManager::InitSchemas() {
       table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
                                                        proc_exit_events_table_size);
     } else {
+      bool encode_cold_batches = encoded_tables.contains(relation_info.name);
       table_ptr = std::make_shared<table_store::Table>(relation_info.name, relation_info.relation,
-                                                       other_table_size);
+                                                       other_table_size,
+                                                       table_store::Table::kDefaultColdBatchMinSize,
+                                                       encode_cold_batches);
     }
 
     table_store()->AddTable(std::move(table_ptr), relation_info.name, relation_info.id);